@@ -786,6 +786,28 @@ static fixed_t mapxstart=0; //x-value for the bitmap.
 
 static bool stopped = true;
 
+// cached boundary classification of each line (see AM_classifyLine)
+enum
+{
+	AMLC_Teleport	= 1,
+	AMLC_Exit		= 2,
+	AMLC_Lock		= 4,
+	AMLC_Trigger	= 8,
+	AMLC_Valid		= 128
+};
+
+struct AMLineClass
+{
+	int special;
+	int args[5];
+	DWORD activation;
+	int locknumber;
+	int lock;
+	int flags;
+};
+
+static TArray<AMLineClass> AMLineClasses;
+
 static void AM_calcMinMaxMtoF();
 
 static void DrawMarker (FTexture *tex, fixed_t x, fixed_t y, int yadjust,
@@ -1340,6 +1362,7 @@ void AM_LevelInit ()
 	}
 
 	AM_clearMarks();
+	AMLineClasses.Clear();
 
 	AM_findMinMaxBoundaries();
 	scale_mtof = MapDiv(min_scale_mtof, (int) (0.7*MAPUNIT));
@@ -1893,6 +1916,83 @@ void AM_drawGrid (int color)
 	}
 }
 
+//=============================================================================
+//
+// AM_getWindowBox
+//
+// Gets the part of the map the automap window can show, in map coordinates.
+// When the map rotates, this is the area the window covers while turning
+// around its center.
+//
+//=============================================================================
+
+static void AM_getWindowBox (fixed_t box[4])
+{
+	if (am_rotate == 1 || (am_rotate == 2 && viewactive))
+	{
+		fixed_t cx = m_x + m_w/2;
+		fixed_t cy = m_y + m_h/2;
+		fixed_t r = fixed_t(sqrt(double(m_w) * m_w + double(m_h) * m_h) / 2) + 1;
+
+		box[BOXLEFT] = cx - r;
+		box[BOXRIGHT] = cx + r;
+		box[BOXBOTTOM] = cy - r;
+		box[BOXTOP] = cy + r;
+	}
+	else
+	{
+		box[BOXLEFT] = m_x;
+		box[BOXRIGHT] = m_x + m_w;
+		box[BOXBOTTOM] = m_y;
+		box[BOXTOP] = m_y + m_h;
+	}
+}
+
+//=============================================================================
+//
+// AM_isOutsideWindow
+//
+// Checks a bounding box in fixed point against the window box from
+// AM_getWindowBox.
+//
+//=============================================================================
+
+static inline bool AM_isOutsideWindow (const fixed_t *bbox, const fixed_t *box)
+{
+	return (bbox[BOXRIGHT] >> FRACTOMAPBITS) < box[BOXLEFT]
+		|| (bbox[BOXLEFT] >> FRACTOMAPBITS) > box[BOXRIGHT]
+		|| (bbox[BOXTOP] >> FRACTOMAPBITS) < box[BOXBOTTOM]
+		|| (bbox[BOXBOTTOM] >> FRACTOMAPBITS) > box[BOXTOP];
+}
+
+//=============================================================================
+//
+// AM_collectSubsectors
+//
+// Walks the BSP and collects the subsectors whose nodes' bounding boxes
+// touch the automap window.
+//
+//=============================================================================
+
+static void AM_collectSubsectors (void *node, const fixed_t *box, TArray<subsector_t *> &list)
+{
+	while (!((size_t)node & 1))
+	{
+		node_t *bsp = (node_t *)node;
+
+		if (!AM_isOutsideWindow(bsp->bbox[1], box))
+		{
+			AM_collectSubsectors(bsp->children[1], box, list);
+		}
+		if (AM_isOutsideWindow(bsp->bbox[0], box))
+		{
+			return;
+		}
+		node = bsp->children[0];
+	}
+	list.Push((subsector_t *)((BYTE *)node - 1));
+}
+
 //=============================================================================
 //
 // AM_drawSubsectors
@@ -1902,6 +2002,7 @@ void AM_drawGrid (int color)
 void AM_drawSubsectors()
 {
 	static TArray<FVector2> points;
+	static TArray<subsector_t *> visible;
 	float scale = float(scale_mtof);
 	angle_t rotation;
 	sector_t tempsec;
@@ -1910,24 +2011,38 @@ void AM_drawSubsectors()
 	double originx, originy;
 	FDynamicColormap *colormap;
 	mpoint_t originpt;
+	fixed_t box[4];
+
+	AM_getWindowBox(box);
+	visible.Clear();
+	if (numnodes == 0)
+	{
+		visible.Push(&subsectors[0]);
+	}
+	else
+	{
+		AM_collectSubsectors(&nodes[numnodes-1], box, visible);
+	}
 
-	for (int i = 0; i < numsubsectors; ++i)
+	for (unsigned int n = 0; n < visible.Size(); ++n)
 	{
-		if (subsectors[i].flags & SSECF_POLYORG)
+		subsector_t *sub = visible[n];
+
+		if (sub->flags & SSECF_POLYORG)
 		{
 			continue;
 		}
 
-		if ((!(subsectors[i].flags & SSECF_DRAWN) || (subsectors[i].render_sector->MoreFlags & SECF_HIDDEN)) && am_cheat == 0)
+		if ((!(sub->flags & SSECF_DRAWN) || (sub->render_sector->MoreFlags & SECF_HIDDEN)) && am_cheat == 0)
 		{
 			continue;
 		}
 		// Fill the points array from the subsector.
-		points.Resize(subsectors[i].numlines);
-		for (DWORD j = 0; j < subsectors[i].numlines; ++j)
+		points.Resize(sub->numlines);
+		for (DWORD j = 0; j < sub->numlines; ++j)
 		{
-			mpoint_t pt = { subsectors[i].firstline[j].v1->x >> FRACTOMAPBITS,
-							subsectors[i].firstline[j].v1->y >> FRACTOMAPBITS };
+			mpoint_t pt = { sub->firstline[j].v1->x >> FRACTOMAPBITS,
+							sub->firstline[j].v1->y >> FRACTOMAPBITS };
 			if (am_rotate == 1 || (am_rotate == 2 && viewactive))
 			{
 				AM_rotatePoint(&pt.x, &pt.y);
@@ -1936,7 +2051,7 @@ void AM_drawSubsectors()
 			points[j].Y = f_y + (f_h - (pt.y - m_y) * scale / float(1 << 24));
 		}
 		// For lighting and texture determination
-		sector_t *sec = Renderer->FakeFlat (subsectors[i].render_sector, &tempsec, &floorlight,	&ceilinglight, false);
+		sector_t *sec = Renderer->FakeFlat (sub->render_sector, &tempsec, &floorlight,	&ceilinglight, false);
 		// Find texture origin.
 		originpt.x = -sec->GetXOffset(sector_t::floor) >> FRACTOMAPBITS;
 		originpt.y = sec->GetYOffset(sector_t::floor) >> FRACTOMAPBITS;
@@ -2030,7 +2145,7 @@ void AM_drawSubsectors()
 
 		// If this subsector has not actually been seen yet (because you are cheating
 		// to see it on the map), tint and desaturate it.
-		if (!(subsectors[i].flags & SSECF_DRAWN))
+		if (!(sub->flags & SSECF_DRAWN))
 		{
 			colormap = GetSpecialLights(
 				MAKERGB(
@@ -2375,119 +2490,224 @@ bool AM_isLockBoundary (line_t &line, int *lockptr = NULL)
 
 //=============================================================================
 //
-// Determines visible lines, draws them.
-// This is LineDef based, not LineSeg based.
+// AM_classifyLine
+//
+// Tells whether a line is a teleporter, exit, lock or trigger boundary.
+// Working that out looks up the line's special and the sector actions on
+// both sides, so the answer is kept per line and only redone when the
+// line's special, arguments, activation or lock number change. Lines next
+// to sector actions are not kept, since whether the player can trigger
+// those can change at any time.
 //
 //=============================================================================
 
-void AM_drawWalls (bool allmap)
+static int AM_classifyLine (line_t &line, int *lock)
 {
-	int i;
-	static mline_t l;
-	int lock, color;
+	AMLineClass *lc = NULL;
 
-	for (i = 0; i < numlines; i++)
+	if (line.frontsector->SecActTarget == NULL &&
+		(line.backsector == NULL || line.backsector->SecActTarget == NULL))
 	{
-		l.a.x = lines[i].v1->x >> FRACTOMAPBITS;
-		l.a.y = lines[i].v1->y >> FRACTOMAPBITS;
-		l.b.x = lines[i].v2->x >> FRACTOMAPBITS;
-		l.b.y = lines[i].v2->y >> FRACTOMAPBITS;
-
-		if (am_rotate == 1 || (am_rotate == 2 && viewactive))
+		if (AMLineClasses.Size() != (unsigned)numlines)
 		{
-			AM_rotatePoint (&l.a.x, &l.a.y);
-			AM_rotatePoint (&l.b.x, &l.b.y);
+			AMLineClasses.Resize(numlines);
+			memset(&AMLineClasses[0], 0, numlines * sizeof(AMLineClass));
+		}
+		lc = &AMLineClasses[int(&line - lines)];
+		if ((lc->flags & AMLC_Valid) &&
+			lc->special == line.special &&
+			lc->activation == line.activation &&
+			lc->locknumber == line.locknumber &&
+			memcmp(lc->args, line.args, sizeof(lc->args)) == 0)
+		{
+			*lock = lc->lock;
+			return lc->flags;
 		}
+	}
+
+	int flags = 0;
+
+	*lock = 0;
+	if (AM_isTeleportBoundary(line)) flags |= AMLC_Teleport;
+	if (AM_isExitBoundary(line)) flags |= AMLC_Exit;
+	if (AM_isLockBoundary(line, lock)) flags |= AMLC_Lock;
+	if (AM_isTriggerBoundary(line)) flags |= AMLC_Trigger;
+
+	if (lc != NULL)
+	{
+		lc->special = line.special;
+		memcpy(lc->args, line.args, sizeof(lc->args));
+		lc->activation = line.activation;
+		lc->locknumber = line.locknumber;
+		lc->lock = *lock;
+		lc->flags = flags | AMLC_Valid;
+	}
+	return flags;
+}
+
+//=============================================================================
+//
+// AM_drawWall
+//
+//=============================================================================
+
+static void AM_drawWall (line_t *line, bool allmap)
+{
+	static mline_t l;
+	int color;
 
-		if (am_cheat != 0 || (lines[i].flags & ML_MAPPED))
+	l.a.x = line->v1->x >> FRACTOMAPBITS;
+	l.a.y = line->v1->y >> FRACTOMAPBITS;
+	l.b.x = line->v2->x >> FRACTOMAPBITS;
+	l.b.y = line->v2->y >> FRACTOMAPBITS;
+
+	if (am_rotate == 1 || (am_rotate == 2 && viewactive))
+	{
+		AM_rotatePoint (&l.a.x, &l.a.y);
+		AM_rotatePoint (&l.b.x, &l.b.y);
+	}
+
+	if (am_cheat != 0 || (line->flags & ML_MAPPED))
+	{
+		if ((line->flags & ML_DONTDRAW) && (am_cheat == 0 || am_cheat >= 4))
 		{
-			if ((lines[i].flags & ML_DONTDRAW) && (am_cheat == 0 || am_cheat >= 4))
+			if (!am_showallenabled || CheckCheatmode(false))
 			{
-				if (!am_showallenabled || CheckCheatmode(false))
-				{
-					continue;
-				}
+				return;
 			}
+		}
 
-			if (AM_CheckSecret(&lines[i]))
-			{
-				// map secret sectors like Boom
-				AM_drawMline(&l, AMColors.SecretSectorColor);
-			}
-			else if (lines[i].flags & ML_SECRET)
-			{ // secret door
-				if (am_cheat != 0 && lines[i].backsector != NULL)
-					AM_drawMline(&l, AMColors.SecretWallColor);
-			    else
-					AM_drawMline(&l, AMColors.WallColor);
-			}
-			else if (AM_isTeleportBoundary(lines[i]) && AMColors.isValid(AMColors.IntraTeleportColor))
-			{ // intra-level teleporters
-				AM_drawMline(&l, AMColors.IntraTeleportColor);
-			}
-			else if (AM_isExitBoundary(lines[i]) && AMColors.isValid(AMColors.InterTeleportColor))
-			{ // inter-level/game-ending teleporters
-				AM_drawMline(&l, AMColors.InterTeleportColor);
-			}
-			else if (AM_isLockBoundary(lines[i], &lock))
+		int lock;
+		int lineclass = AM_classifyLine(*line, &lock);
+
+		if (AM_CheckSecret(line))
+		{
+			// map secret sectors like Boom
+			AM_drawMline(&l, AMColors.SecretSectorColor);
+		}
+		else if (line->flags & ML_SECRET)
+		{ // secret door
+			if (am_cheat != 0 && line->backsector != NULL)
+				AM_drawMline(&l, AMColors.SecretWallColor);
+		    else
+				AM_drawMline(&l, AMColors.WallColor);
+		}
+		else if ((lineclass & AMLC_Teleport) && AMColors.isValid(AMColors.IntraTeleportColor))
+		{ // intra-level teleporters
+			AM_drawMline(&l, AMColors.IntraTeleportColor);
+		}
+		else if ((lineclass & AMLC_Exit) && AMColors.isValid(AMColors.InterTeleportColor))
+		{ // inter-level/game-ending teleporters
+			AM_drawMline(&l, AMColors.InterTeleportColor);
+		}
+		else if (lineclass & AMLC_Lock)
+		{
+			if (AMColors.displayLocks)
 			{
-				if (AMColors.displayLocks)
-				{
-					color = P_GetMapColorForLock(lock);
+				color = P_GetMapColorForLock(lock);
 
-					AMColor c;
+				AMColor c;
 
-					if (color >= 0)	c.FromRGB(RPART(color), GPART(color), BPART(color));
-					else c = AMColors[AMColors.LockedColor];
+				if (color >= 0)	c.FromRGB(RPART(color), GPART(color), BPART(color));
+				else c = AMColors[AMColors.LockedColor];
 
-					AM_drawMline (&l, c);
-				}
-				else
-				{
-					AM_drawMline (&l, AMColors.LockedColor);  // locked special
-				}
-			}
-			else if (am_showtriggerlines
-				&& AMColors.isValid(AMColors.SpecialWallColor)
-				&& AM_isTriggerBoundary(lines[i]))
-			{
-				AM_drawMline(&l, AMColors.SpecialWallColor);	// wall with special non-door action the player can do
+				AM_drawMline (&l, c);
 			}
-			else if (lines[i].backsector == NULL)
-			{
-				AM_drawMline(&l, AMColors.WallColor);	// one-sided wall
-			}
-			else if (lines[i].backsector->floorplane
-				  != lines[i].frontsector->floorplane)
-			{
-				AM_drawMline(&l, AMColors.FDWallColor); // floor level change
-			}
-			else if (lines[i].backsector->ceilingplane
-				  != lines[i].frontsector->ceilingplane)
+			else
 			{
-				AM_drawMline(&l, AMColors.CDWallColor); // ceiling level change
+				AM_drawMline (&l, AMColors.LockedColor);  // locked special
 			}
-			else if (AM_Check3DFloors(&lines[i]))
+		}
+		else if (am_showtriggerlines
+			&& AMColors.isValid(AMColors.SpecialWallColor)
+			&& (lineclass & AMLC_Trigger))
+		{
+			AM_drawMline(&l, AMColors.SpecialWallColor);	// wall with special non-door action the player can do
+		}
+		else if (line->backsector == NULL)
+		{
+			AM_drawMline(&l, AMColors.WallColor);	// one-sided wall
+		}
+		else if (line->backsector->floorplane
+			  != line->frontsector->floorplane)
+		{
+			AM_drawMline(&l, AMColors.FDWallColor); // floor level change
+		}
+		else if (line->backsector->ceilingplane
+			  != line->frontsector->ceilingplane)
+		{
+			AM_drawMline(&l, AMColors.CDWallColor); // ceiling level change
+		}
+		else if (AM_Check3DFloors(line))
+		{
+			AM_drawMline(&l, AMColors.EFWallColor); // Extra floor border
+		}
+		else if (am_cheat > 0 && am_cheat < 4)
+		{
+			AM_drawMline(&l, AMColors.TSWallColor);
+		}
+	}
+	else if (allmap)
+	{
+		if ((line->flags & ML_DONTDRAW) && (am_cheat == 0 || am_cheat >= 4))
+		{
+			if (!am_showallenabled || CheckCheatmode(false))
 			{
-				AM_drawMline(&l, AMColors.EFWallColor); // Extra floor border
+				return;
 			}
-			else if (am_cheat > 0 && am_cheat < 4)
+		}
+		AM_drawMline(&l, AMColors.NotSeenColor);
+	}
+}
+
+//=============================================================================
+//
+// Determines visible lines, draws them.
+// This is LineDef based, not LineSeg based.
+//
+// Only lines whose bounding boxes touch the window are drawn. If the window
+// covers just a small part of the map, they are found through the blockmap
+// instead of checking every line.
+//
+//=============================================================================
+
+void AM_drawWalls (bool allmap)
+{
+	fixed_t box[4];
+	int shift = MAPBLOCKSHIFT - FRACTOMAPBITS;
+	int orgx = bmaporgx >> FRACTOMAPBITS;
+	int orgy = bmaporgy >> FRACTOMAPBITS;
+
+	AM_getWindowBox(box);
+
+	int x1 = clamp((box[BOXLEFT] - orgx) >> shift, 0, bmapwidth - 1);
+	int x2 = clamp((box[BOXRIGHT] - orgx) >> shift, 0, bmapwidth - 1);
+	int y1 = clamp((box[BOXBOTTOM] - orgy) >> shift, 0, bmapheight - 1);
+	int y2 = clamp((box[BOXTOP] - orgy) >> shift, 0, bmapheight - 1);
+
+	if ((x2 - x1 + 1) * (y2 - y1 + 1) * 4 < bmapwidth * bmapheight)
+	{
+		FBlockLinesIterator it(x1, y1, x2, y2);
+		line_t *line;
+
+		while ((line = it.Next()) != NULL)
+		{
+			if (!AM_isOutsideWindow(line->bbox, box))
 			{
-				AM_drawMline(&l, AMColors.TSWallColor);
+				AM_drawWall(line, allmap);
 			}
 		}
-		else if (allmap)
+	}
+	else
+	{
+		for (int i = 0; i < numlines; i++)
 		{
-			if ((lines[i].flags & ML_DONTDRAW) && (am_cheat == 0 || am_cheat >= 4))
+			if (!AM_isOutsideWindow(lines[i].bbox, box))
 			{
-				if (!am_showallenabled || CheckCheatmode(false))
-				{
-					continue;
-				}
+				AM_drawWall(&lines[i], allmap);
 			}
-			AM_drawMline(&l, AMColors.NotSeenColor);
 		}
-    }
+	}
 }
 
 
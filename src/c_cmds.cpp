@@ -836,15 +836,16 @@ CCMD (save)
 //
 // CCMD wdir
 //
-// Lists the contents of a loaded wad file.
+// Lists the contents of a loaded wad file. For archives with directories,
+// the listing can be limited to a path prefix or to one extension (*.ext).
 //
 //==========================================================================
 
 CCMD (wdir)
 {
-	if (argv.argc() != 2)
+	if (argv.argc() != 2 && argv.argc() != 3)
 	{
-		Printf ("usage: wdir <wadfile>\n");
+		Printf ("usage: wdir <wadfile> [<path prefix>|*.<ext>]\n");
 		return;
 	}
 	int wadnum = Wads.CheckIfWadLoaded (argv[1]);
@@ -853,12 +854,30 @@ CCMD (wdir)
 		Printf ("%s must be loaded to view its directory.\n", argv[1]);
 		return;
 	}
-	for (int i = 0; i < Wads.GetNumLumps(); ++i)
+	if (argv.argc() == 3)
 	{
-		if (Wads.GetLumpFile(i) == wadnum)
+		TArray<int> lumps;
+		const char *filter = argv[2];
+
+		if (filter[0] == '*' && filter[1] == '.')
+		{
+			Wads.GetLumpsByExtension (filter + 2, lumps, wadnum);
+		}
+		else
 		{
-			Printf ("%s\n", Wads.GetLumpFullName(i));
+			Wads.GetLumpsByPrefix (filter, lumps, wadnum);
 		}
+		for (unsigned i = 0; i < lumps.Size(); ++i)
+		{
+			Printf ("%s\n", Wads.GetLumpFullName(lumps[i]));
+		}
+		return;
+	}
+	int first = Wads.GetFirstLump(wadnum);
+	int last = Wads.GetLastLump(wadnum);
+	for (int i = first; i <= last; ++i)
+	{
+		Printf ("%s\n", Wads.GetLumpFullName(i));
 	}
 }
 
@@ -34,14 +34,23 @@
 ** It was, but the results were not as good as I would like, so I didn't
 ** actually use it. But I did keep the code around in case I ever felt like
 ** revisiting the problem. I never did, so now it's relegated to the mists
-** of SVN history, and this is just a thin wrapper around BestColor().
+** of SVN history.
+**
+** This time around, the RGB cube is split into 32x32x32 cells, and each cell
+** gets a list of the palette entries that could possibly be the closest
+** match for any color inside it. A palette entry can be dropped from a cell
+** if even its nearest point in the cell is farther away than the farthest
+** point of some other entry, so Pick() only has to compare against a handful
+** of colors and still returns exactly what BestColor() would.
 **
 */
 
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 
 #include "doomtype.h"
+#include "templates.h"
 #include "colormatcher.h"
 #include "v_palette.h"
 
@@ -63,18 +72,134 @@ FColorMatcher::FColorMatcher (const FColorMatcher &other)
 FColorMatcher &FColorMatcher::operator= (const FColorMatcher &other)
 {
 	Pal = other.Pal;
+	Cells = other.Cells;
+	Candidates = other.Candidates;
 	return *this;
 }
 
 void FColorMatcher::SetPalette (const DWORD *palette)
 {
 	Pal = (const PalEntry *)palette;
+	BuildCells ();
+}
+
+//==========================================================================
+//
+// FColorMatcher :: BuildCells
+//
+// Builds the candidate lists for every cell of the RGB cube. This only
+// considers palette entries 1-254, same as the default range of BestColor().
+//
+//==========================================================================
+
+void FColorMatcher::BuildCells ()
+{
+	// Squared distances from each palette component to the nearest and
+	// farthest edge of every cell along each axis.
+	static int mindist[3][CELLS_PER_AXIS][256];
+	static int maxdist[3][CELLS_PER_AXIS][256];
+	BYTE list[256];
+	int color;
+
+	Cells.Clear();
+	Candidates.Clear();
+	if (Pal == NULL)
+	{
+		return;
+	}
+	Cells.Resize(CELLS_PER_AXIS * CELLS_PER_AXIS * CELLS_PER_AXIS);
+
+	for (color = 1; color < 255; ++color)
+	{
+		int comp[3] = { Pal[color].r, Pal[color].g, Pal[color].b };
+
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int cell = 0; cell < CELLS_PER_AXIS; ++cell)
+			{
+				int lo = cell << CELL_SHIFT;
+				int hi = lo + CELL_SIZE - 1;
+				int mn = comp[i] < lo ? lo - comp[i] : comp[i] > hi ? comp[i] - hi : 0;
+				int mx = MAX(abs(comp[i] - lo), abs(comp[i] - hi));
+				mindist[i][cell][color] = mn * mn;
+				maxdist[i][cell][color] = mx * mx;
+			}
+		}
+	}
+
+	for (int r = 0; r < CELLS_PER_AXIS; ++r)
+	{
+		for (int g = 0; g < CELLS_PER_AXIS; ++g)
+		{
+			for (int b = 0; b < CELLS_PER_AXIS; ++b)
+			{
+				int bestmax = INT_MAX;
+
+				for (color = 1; color < 255; ++color)
+				{
+					int maxd = maxdist[0][r][color] + maxdist[1][g][color] + maxdist[2][b][color];
+					if (maxd < bestmax)
+					{
+						bestmax = maxd;
+					}
+				}
+
+				int count = 0;
+				for (color = 1; color < 255; ++color)
+				{
+					if (mindist[0][r][color] + mindist[1][g][color] + mindist[2][b][color] <= bestmax)
+					{
+						list[count++] = (BYTE)color;
+					}
+				}
+				Cells[(r * CELLS_PER_AXIS + g) * CELLS_PER_AXIS + b] = (Candidates.Size() << 8) | count;
+				for (int i = 0; i < count; ++i)
+				{
+					Candidates.Push(list[i]);
+				}
+			}
+		}
+	}
+	Candidates.ShrinkToFit();
 }
 
+//==========================================================================
+//
+// FColorMatcher :: Pick
+//
+//==========================================================================
+
 BYTE FColorMatcher::Pick (int r, int g, int b)
 {
 	if (Pal == NULL)
 		return 1;
 
-	return (BYTE)BestColor ((uint32 *)Pal, r, g, b);
+	if ((unsigned)(r | g | b) > 255 || Cells.Size() == 0)
+	{
+		return (BYTE)BestColor ((uint32 *)Pal, r, g, b);
+	}
+
+	DWORD cell = Cells[((r >> CELL_SHIFT) * CELLS_PER_AXIS + (g >> CELL_SHIFT)) * CELLS_PER_AXIS + (b >> CELL_SHIFT)];
+	const BYTE *list = &Candidates[cell >> 8];
+	int count = cell & 0xFF;
+	int bestcolor = list[0];
+	int bestdist = 257*257+257*257+257*257;
+
+	for (int i = 0; i < count; ++i)
+	{
+		const PalEntry &pe = Pal[list[i]];
+		int x = r - pe.r;
+		int y = g - pe.g;
+		int z = b - pe.b;
+		int dist = x*x + y*y + z*z;
+		if (dist < bestdist)
+		{
+			if (dist == 0)
+				return list[i];
+
+			bestdist = dist;
+			bestcolor = list[i];
+		}
+	}
+	return (BYTE)bestcolor;
 }
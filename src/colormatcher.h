@@ -34,6 +34,8 @@
 #ifndef __COLORMATCHER_H__
 #define __COLORMATCHER_H__
 
+#include "tarray.h"
+
 class FColorMatcher
 {
 public:
@@ -50,8 +52,28 @@ public:
 
 	FColorMatcher &operator= (const FColorMatcher &other);
 
+	const PalEntry *GetPalette () const
+	{
+		return Pal;
+	}
+
 private:
+	enum
+	{
+		CELL_SHIFT = 3,						// each cell covers 8x8x8 RGB values
+		CELL_SIZE = 1 << CELL_SHIFT,
+		CELLS_PER_AXIS = 256 >> CELL_SHIFT
+	};
+
+	void BuildCells ();
+
 	const PalEntry *Pal;
+
+	// For each cell, the (offset << 8) | count of its candidate list in
+	// Candidates. A candidate list holds every palette entry that can be
+	// the closest match for some color inside the cell, in index order.
+	TArray<DWORD> Cells;
+	TArray<BYTE> Candidates;
 };
 
 extern FColorMatcher ColorMatcher;
@@ -109,6 +109,9 @@
 #include "p_local.h"
 #include "autosegs.h"
 #include "fragglescript/t_fs.h"
+#include "d_startupprof.h"
+#include "sc_prescan.h"
+#include "w_dirwatch.h"
 
 EXTERN_CVAR(Bool, hud_althud)
 void DrawHUD();
@@ -981,6 +984,7 @@ void D_DoomLoop ()
 			{
 				lasttic = gametic;
 				I_StartFrame ();
+				W_CheckWatchedFiles ();
 			}
 			
 			// process one or more tics
@@ -2250,8 +2254,11 @@ void D_DoomMain (void)
 		}
 	}
 
+	D_InitStartupProfile();
 	D_DoomInit();
 
+	D_StartupPhase("IWADINFO");
+
 	// [RH] Make sure zdoom.pk3 is always loaded,
 	// as it contains magic stuff we need.
 	wad = BaseFileSearch (BASEWAD, NULL, true);
@@ -2283,6 +2290,7 @@ void D_DoomMain (void)
 		// Load zdoom.pk3 alone so that we can get access to the internal gameinfos before 
 		// the IWAD is known.
 
+		D_StartupPhase("CheckGameInfo");
 		GetCmdLineFiles(pwads);
 		FString iwad = CheckGameInfo(pwads);
 
@@ -2339,15 +2347,20 @@ void D_DoomMain (void)
 			Printf("Notice: File hashing is incredibly verbose. Expect loading files to take much longer than usual.\n");
 		}
 
+		D_StartupPhase("W_Init");
 		Printf ("W_Init: Init WADfiles.\n");
 		Wads.InitMultipleFiles (allwads);
 		allwads.Clear();
 		allwads.ShrinkToFit();
 		SetMapxxFlag();
 
+		// Start tokenizing the definition lumps while the rest is set up.
+		SC_StartPrescan();
+
 		GameConfig->DoKeySetup(gameinfo.ConfigName);
 
 		// Now that wads are loaded, define mod-specific cvars.
+		D_StartupPhase("ParseCVarInfo");
 		ParseCVarInfo();
 
 		// Actually exec command line commands and exec files.
@@ -2359,6 +2372,7 @@ void D_DoomMain (void)
 		}
 
 		// [RH] Initialize localizable strings.
+		D_StartupPhase("LoadStrings");
 		GStrings.LoadStrings (false);
 
 		V_InitFontColors ();
@@ -2370,20 +2384,24 @@ void D_DoomMain (void)
 
 		if (!restart)
 		{
+			D_StartupPhase("I_Init");
 			Printf ("I_Init: Setting up machine state.\n");
 			I_Init ();
 			I_CreateRenderer();
 		}
 
+		D_StartupPhase("V_Init");
 		Printf ("V_Init: allocate screen.\n");
 		V_Init (!!restart);
 
 		// Base systems have been inited; enable cvar callbacks
 		FBaseCVar::EnableCallbacks ();
 
+		D_StartupPhase("S_Init");
 		Printf ("S_Init: Setting up sound.\n");
 		S_Init ();
 
+		D_StartupPhase("ST_Init");
 		Printf ("ST_Init: Init startup screen.\n");
 		if (!restart)
 		{
@@ -2399,13 +2417,16 @@ void D_DoomMain (void)
 		CheckCmdLine();
 
 		// [RH] Load sound environments
+		D_StartupPhase("S_ParseReverbDef");
 		S_ParseReverbDef ();
 
 		// [RH] Parse any SNDINFO lumps
+		D_StartupPhase("S_InitData");
 		Printf ("S_InitData: Load sound definitions.\n");
 		S_InitData ();
 
 		// [RH] Parse through all loaded mapinfo lumps
+		D_StartupPhase("G_ParseMapInfo");
 		Printf ("G_ParseMapInfo: Load map definitions.\n");
 		G_ParseMapInfo (iwad_info->MapInfo);
 		ReadStatistics();
@@ -2413,14 +2434,17 @@ void D_DoomMain (void)
 		// MUSINFO must be parsed after MAPINFO
 		S_ParseMusInfo();
 
+		D_StartupPhase("TexMan.Init");
 		Printf ("Texman.Init: Init texture manager.\n");
 		TexMan.Init();
 		C_InitConback();
 
 		// [CW] Parse any TEAMINFO lumps.
+		D_StartupPhase("ParseTeamInfo");
 		Printf ("ParseTeamInfo: Load team definitions.\n");
 		TeamLibrary.ParseTeamInfo ();
 
+		D_StartupPhase("PClassActor::StaticInit");
 		PClassActor::StaticInit ();
 
 		// [GRB] Initialize player class list
@@ -2437,13 +2461,17 @@ void D_DoomMain (void)
 
 		StartScreen->Progress ();
 
+		D_StartupPhase("R_Init");
 		Printf ("R_Init: Init %s refresh subsystem.\n", gameinfo.ConfigName.GetChars());
 		StartScreen->LoadingStatus ("Loading graphics", 0x3f);
 		R_Init ();
 
+		D_StartupPhase("DecalLibrary");
 		Printf ("DecalLibrary: Load decals.\n");
 		DecalLibrary.ReadAllDecals ();
 
+		D_StartupPhase("Dehacked");
+
 		// [RH] Add any .deh and .bex files on the command line.
 		// If there are none, try adding any in the config file.
 		// Note that the command line overrides defaults from the config.
@@ -2483,9 +2511,11 @@ void D_DoomMain (void)
 		bglobal.spawn_tries = 0;
 		bglobal.wanted_botnum = bglobal.getspawned.Size();
 
+		D_StartupPhase("M_Init");
 		Printf ("M_Init: Init menus.\n");
 		M_Init ();
 
+		D_StartupPhase("P_Init");
 		Printf ("P_Init: Init Playloop state.\n");
 		StartScreen->LoadingStatus ("Init game engine", 0x3f);
 		AM_StaticInit();
@@ -2493,6 +2523,8 @@ void D_DoomMain (void)
 
 		P_SetupWeapons_ntohton();
 
+		D_StartupPhase("SBarInfo");
+
 		//SBarInfo support.
 		SBarInfo::Load();
 		HUD_InitHud();
@@ -2510,6 +2542,12 @@ void D_DoomMain (void)
 			}
 		}
 
+		SC_EndPrescan();
+		W_WatchDirectories();
+
+		// Stop before waiting on other players so the net game doesn't skew it.
+		D_EndStartupProfile();
+
 		if (!restart)
 		{
 			Printf ("D_CheckNetGame: Checking network game status.\n");
@@ -2646,6 +2684,7 @@ void D_DoomMain (void)
 			gameinfo.~gameinfo_t();
 			new (&gameinfo) gameinfo_t;		// Reset gameinfo
 			S_Shutdown();					// free all channels and delete playlist
+			W_StopWatching();				// lump numbers are about to change
 			C_ClearAliases();				// CCMDs won't be reinitialized so these need to be deleted here
 			DestroyCVarsFlagged(CVAR_MOD);	// Delete any cvar left by mods
 
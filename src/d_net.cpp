@@ -165,18 +165,24 @@ CUSTOM_CVAR(Int, net_extratic, 0, CVAR_SERVERINFO | CVAR_NOSAVE)
 	}
 }
 
-#ifdef _DEBUG
-CVAR(Int, net_fakelatency, 0, 0);
-
-struct PacketStore
-{
-	int timer;
-	doomcom_t message;
-};
-
-static TArray<PacketStore> InBuffer;
-static TArray<PacketStore> OutBuffer;
-#endif
+// [net soak] -netsoak <tics> runs the game without drawing, with random
+// input, for that many tics. It counts the tics where consistency checks
+// failed and measures how late each node's tics arrive compared to when
+// we made ours, then prints a report and quits.
+#define SOAK_MAXLATENCY		1000			// Latency histogram has 1 ms buckets up to this
+
+static int			SoakTics;
+static DWORD		SoakSeed;
+static usercmd_t	SoakCmd;
+static unsigned int	SoakStartTime;
+static unsigned int	SoakMakeTime[BACKUPTICS];
+static DWORD		SoakLatency[MAXNETNODES][SOAK_MAXLATENCY + 1];
+static int			SoakDesyncs[MAXPLAYERS];
+static int			SoakFirstDesync;
+
+static void Net_SoakMakeTic (ticcmd_t *cmd);
+static void Net_SoakReceived (int node, int start, int end);
+static void Net_SoakTicker ();
 
 // [RH] Special "ticcmds" get stored in here
 static struct TicSpecial
@@ -517,30 +523,7 @@ void HSendPacket (int node, int len)
 	doomcom.remotenode = node;
 	doomcom.datalength = len;
 
-#ifdef _DEBUG
-	if (net_fakelatency / 2 > 0)
-	{
-		PacketStore store;
-		store.message = doomcom;
-		store.timer = I_GetTime(false) + ((net_fakelatency / 2) / (1000 / TICRATE));
-		OutBuffer.Push(store);
-	}
-	else
-		I_NetCmd();
-
-	for (unsigned int i = 0; i < OutBuffer.Size(); i++)
-	{
-		if (OutBuffer[i].timer <= I_GetTime(false))
-		{
-			doomcom = OutBuffer[i].message;
-			I_NetCmd();
-			OutBuffer.Delete(i);
-			i = -1;
-		}
-	}
-#else
 	I_NetCmd();
-#endif
 }
 
 //
@@ -566,38 +549,10 @@ bool HGetPacket (void)
 	doomcom.command = CMD_GET;
 	I_NetCmd ();
 
-#ifdef _DEBUG
-	if (net_fakelatency / 2 > 0 && doomcom.remotenode != -1)
-	{
-		PacketStore store;
-		store.message = doomcom;
-		store.timer = I_GetTime(false) + ((net_fakelatency / 2) / (1000 / TICRATE));
-		InBuffer.Push(store);
-		doomcom.remotenode = -1;
-	}
-	
-	if (doomcom.remotenode == -1)
-	{
-		bool gotmessage = false;
-		for (unsigned int i = 0; i < InBuffer.Size(); i++)
-		{
-			if (InBuffer[i].timer <= I_GetTime(false))
-			{
-				doomcom = InBuffer[i].message;
-				InBuffer.Delete(i);
-				gotmessage = true;
-				break;
-			}
-		}
-		if (!gotmessage)
-			return false;
-	}
-#else
 	if (doomcom.remotenode == -1)
 	{
 		return false;
 	}
-#endif
 		
 	if (debugfile)
 	{
@@ -912,6 +867,10 @@ void GetPackets (void)
 			{
 				int node = nodeforplayer[playerbytes[i]];
 
+				if (SoakTics > 0)
+				{
+					Net_SoakReceived (node, nettics[node], realend);
+				}
 				SkipTicCmd (&start, nettics[node] - realstart);
 				for (tics = nettics[node]; tics < realend; tics++)
 					ReadTicCmd (&start, playerbytes[i], tics);
@@ -978,6 +937,10 @@ void NetUpdate (void)
 		
 		//Printf ("mk:%i ",maketic);
 		G_BuildTiccmd (&localcmds[maketic % LOCALCMDTICS]);
+		if (SoakTics > 0)
+		{
+			Net_SoakMakeTic (&localcmds[maketic % LOCALCMDTICS]);
+		}
 		maketic++;
 
 		if (ticdup == 1 || maketic == 0)
@@ -1741,6 +1704,17 @@ void D_CheckNetGame (void)
 
 	Printf ("player %i of %i (%i nodes)\n",
 			consoleplayer+1, doomcom.numplayers, doomcom.numnodes);
+
+	v = Args->CheckValue ("-netsoak");
+	if (v != NULL && atoi (v) > 0)
+	{
+		SoakTics = atoi (v);
+		SoakSeed = consoleplayer * 2 + 1;
+		SoakStartTime = I_MSTime ();
+		SoakFirstDesync = -1;
+		nodrawers = true;
+		Printf ("Soak testing for %d tics\n", SoakTics);
+	}
 }
 
 
@@ -1941,6 +1915,10 @@ void TryRunTics (void)
 			I_GetTime (true);
 			G_Ticker();
 			gametic++;
+			if (SoakTics > 0)
+			{
+				Net_SoakTicker ();
+			}
 
 			NetUpdate ();	// check for new console commands
 		}
@@ -1949,6 +1927,154 @@ void TryRunTics (void)
 	}
 }
 
+//==========================================================================
+//
+// Net_SoakMakeTic
+//
+// Replaces the player's input with a random walk, changing direction and
+// buttons every half second or so. Also notes when the tic was made.
+//
+//==========================================================================
+
+static DWORD Net_SoakRandom ()
+{
+	// Not one of the game's RNGs: every node makes different input.
+	SoakSeed = SoakSeed * 1664525 + 1013904223;
+	return SoakSeed >> 8;
+}
+
+static void Net_SoakMakeTic (ticcmd_t *cmd)
+{
+	if (maketic % ticdup == 0)
+	{
+		SoakMakeTime[(maketic / ticdup) % BACKUPTICS] = I_MSTime ();
+	}
+	if (Net_SoakRandom () % 16 == 0)
+	{
+		SoakCmd.forwardmove = short(Net_SoakRandom () % 0x6400) - 0x3200;
+		SoakCmd.sidemove = short(Net_SoakRandom () % 0x5000) - 0x2800;
+		SoakCmd.yaw = short(Net_SoakRandom () % 0x1000) - 0x800;
+		SoakCmd.buttons = 0;
+		if (Net_SoakRandom () % 3 == 0) SoakCmd.buttons |= BT_ATTACK;
+		if (Net_SoakRandom () % 8 == 0) SoakCmd.buttons |= BT_USE;
+		if (Net_SoakRandom () % 8 == 0) SoakCmd.buttons |= BT_JUMP;
+	}
+	cmd->ucmd = SoakCmd;
+}
+
+//==========================================================================
+//
+// Net_SoakReceived
+//
+// Tics start to end-1 for this node have just arrived.
+//
+//==========================================================================
+
+static void Net_SoakReceived (int node, int start, int end)
+{
+	int made = maketic / ticdup;
+	unsigned int now = I_MSTime ();
+
+	for (int tic = MAX (start, made - BACKUPTICS + 1); tic < end; ++tic)
+	{
+		unsigned int late = 0;
+		if (tic < made)
+		{
+			late = MIN<unsigned int> (now - SoakMakeTime[tic % BACKUPTICS], SOAK_MAXLATENCY);
+		}
+		SoakLatency[node][late]++;
+	}
+}
+
+//==========================================================================
+//
+// Net_SoakPercentile
+//
+//==========================================================================
+
+static int Net_SoakPercentile (int node, double fraction)
+{
+	QWORD total = 0, sum = 0;
+	int i;
+
+	for (i = 0; i <= SOAK_MAXLATENCY; ++i)
+	{
+		total += SoakLatency[node][i];
+	}
+	for (i = 0; i < SOAK_MAXLATENCY; ++i)
+	{
+		sum += SoakLatency[node][i];
+		if (sum > 0 && sum >= total * fraction)
+		{
+			break;
+		}
+	}
+	return i;
+}
+
+//==========================================================================
+//
+// Net_SoakTicker
+//
+// Called after every tic. The consistency check in G_Ticker sets a
+// player's inconsistant field when their tic didn't match ours. Count it
+// and clear it so the next mismatch gets counted, too.
+//
+//==========================================================================
+
+static void Net_SoakTicker ()
+{
+	int i, desyncs = 0;
+
+	for (i = 0; i < MAXPLAYERS; ++i)
+	{
+		if (playeringame[i] && players[i].inconsistant != 0)
+		{
+			if (SoakFirstDesync < 0)
+			{
+				SoakFirstDesync = players[i].inconsistant;
+				Printf (TEXTCOLOR_RED "%s went out of sync at tic %d\n", players[i].userinfo.GetName(), SoakFirstDesync);
+			}
+			SoakDesyncs[i]++;
+			players[i].inconsistant = 0;
+		}
+		desyncs += SoakDesyncs[i];
+	}
+	if (gametic < SoakTics)
+	{
+		return;
+	}
+
+	double seconds = MAX (1u, I_MSTime () - SoakStartTime) / 1000.;
+
+	Printf ("Soak test: %d tics in %.1f seconds, %d nodes, %d desynced tics\n",
+		gametic, seconds, doomcom.numnodes, desyncs);
+	for (i = 0; i < MAXPLAYERS; ++i)
+	{
+		if (SoakDesyncs[i] > 0)
+		{
+			Printf ("  %s: %d desynced tics\n", players[i].userinfo.GetName(), SoakDesyncs[i]);
+		}
+	}
+	for (i = 1; i < doomcom.numnodes; ++i)
+	{
+		const FNetTraffic &traffic = I_GetNetTraffic (i);
+		int max;
+
+		for (max = SOAK_MAXLATENCY; max > 0 && SoakLatency[i][max] == 0; --max)
+		{ }
+		Printf ("  node %d (%s): sent %u packets, %.2f KB/s; received %u packets, %.2f KB/s; %u lost\n",
+			i, players[playerfornode[i]].userinfo.GetName(),
+			traffic.PacketsSent, traffic.BytesSent / 1024. / seconds,
+			traffic.PacketsReceived, traffic.BytesReceived / 1024. / seconds,
+			traffic.PacketsLost);
+		Printf ("    tic latency: 50%% %d ms, 90%% %d ms, 99%% %d ms, max %d%s ms\n",
+			Net_SoakPercentile (i, 0.5), Net_SoakPercentile (i, 0.9), Net_SoakPercentile (i, 0.99),
+			max, max == SOAK_MAXLATENCY ? "+" : "");
+	}
+	exit (desyncs > 0 ? 1 : 0);
+}
+
 void Net_CheckLastReceived (int counts)
 {
 	// [Ed850] Check to see the last time a packet was received.
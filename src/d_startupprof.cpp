@@ -0,0 +1,422 @@
+/*
+** d_startupprof.cpp
+** Startup phase timing and lump I/O accounting
+**
+**---------------------------------------------------------------------------
+** Copyright 2016 The ZDoom Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define USE_WINDOWS_DWORD
+#else
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+#include "doomtype.h"
+#include "d_startupprof.h"
+#include "m_argv.h"
+#include "stats.h"
+#include "tarray.h"
+#include "templates.h"
+#include "w_wad.h"
+#include "v_text.h"
+
+// MACROS ------------------------------------------------------------------
+
+#define DEFAULT_PROFILE_FILE	"startupprofile.json"
+#define NUM_SLOWEST_LUMPS		20
+
+// TYPES -------------------------------------------------------------------
+
+struct FStartupPhase
+{
+	const char *Name;
+	double WallMS;
+	double CPUMS;
+	unsigned int LumpsOpened;
+	QWORD BytesOpened;
+	unsigned int LumpsDecompressed;
+	QWORD BytesDecompressed;
+	unsigned int ScriptsParsed;
+};
+
+struct FOpenScript
+{
+	int Id;
+	int Lump;
+	cycle_t Clock;
+	double ChildMS;
+};
+
+struct FParsedScript
+{
+	int Lump;
+	unsigned int Phase;
+	double MS;
+};
+
+// PRIVATE DATA DEFINITIONS ------------------------------------------------
+
+static bool Profiling;
+static bool Finished;
+static FString ProfileFile;
+
+static TArray<FStartupPhase> Phases;
+static cycle_t PhaseClock;
+static double PhaseCPUStart;
+
+static TArray<FOpenScript> OpenScripts;
+static TArray<FParsedScript> ParsedScripts;
+static int NextScriptId;
+
+// CODE --------------------------------------------------------------------
+
+//==========================================================================
+//
+// CPUTimeMS
+//
+// User plus kernel time for the whole process, so worker threads count.
+//
+//==========================================================================
+
+static double CPUTimeMS()
+{
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+	{
+		return 0;
+	}
+	QWORD k = ((QWORD)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+	QWORD u = ((QWORD)user.dwHighDateTime << 32) | user.dwLowDateTime;
+	return (k + u) / 10000.;	// 100 ns units
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0;
+	}
+	return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000. +
+		(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.;
+#endif
+}
+
+//==========================================================================
+//
+// EndPhase
+//
+//==========================================================================
+
+static void EndPhase()
+{
+	if (Phases.Size() > 0)
+	{
+		FStartupPhase &phase = Phases.Last();
+		PhaseClock.Unclock();
+		phase.WallMS = PhaseClock.TimeMS();
+		phase.CPUMS = CPUTimeMS() - PhaseCPUStart;
+	}
+}
+
+//==========================================================================
+//
+// D_InitStartupProfile
+//
+//==========================================================================
+
+void D_InitStartupProfile()
+{
+	int p = Args->CheckParm("-profilestartup");
+	if (p == 0)
+	{
+		return;
+	}
+	// The file name is optional.
+	const char *file = (p + 1 < Args->NumArgs()) ? Args->GetArg(p + 1) : NULL;
+	ProfileFile = (file != NULL && file[0] != '-' && file[0] != '+') ? file : DEFAULT_PROFILE_FILE;
+	Profiling = true;
+	D_StartupPhase("D_DoomInit");
+}
+
+//==========================================================================
+//
+// D_StartupPhase
+//
+//==========================================================================
+
+void D_StartupPhase(const char *name)
+{
+	if (!Profiling)
+	{
+		return;
+	}
+	EndPhase();
+
+	FStartupPhase phase = { name, 0, 0, 0, 0, 0, 0, 0 };
+	Phases.Push(phase);
+	PhaseCPUStart = CPUTimeMS();
+	PhaseClock.Reset();
+	PhaseClock.Clock();
+}
+
+//==========================================================================
+//
+// D_StartupLumpOpened
+//
+//==========================================================================
+
+void D_StartupLumpOpened(int lump, long size)
+{
+	if (Profiling && Phases.Size() > 0)
+	{
+		FStartupPhase &phase = Phases.Last();
+		phase.LumpsOpened++;
+		phase.BytesOpened += size;
+	}
+}
+
+//==========================================================================
+//
+// D_StartupLumpDecompressed
+//
+//==========================================================================
+
+void D_StartupLumpDecompressed(long size)
+{
+	if (Profiling && Phases.Size() > 0)
+	{
+		FStartupPhase &phase = Phases.Last();
+		phase.LumpsDecompressed++;
+		phase.BytesDecompressed += size;
+	}
+}
+
+//==========================================================================
+//
+// D_StartupBeginParse
+//
+//==========================================================================
+
+int D_StartupBeginParse(int lump)
+{
+	if (!Profiling || Phases.Size() == 0)
+	{
+		return 0;
+	}
+	FOpenScript script;
+	script.Id = ++NextScriptId;
+	script.Lump = lump;
+	script.ChildMS = 0;
+	script.Clock.Reset();
+	script.Clock.Clock();
+	OpenScripts.Push(script);
+	Phases.Last().ScriptsParsed++;
+	return script.Id;
+}
+
+//==========================================================================
+//
+// D_StartupEndParse
+//
+// Scanners are not always closed in the order they were opened, so look
+// the script up rather than assuming it is on top. Its total time is
+// charged to whatever script was opened before it and is still open.
+//
+//==========================================================================
+
+void D_StartupEndParse(int id)
+{
+	if (id == 0)
+	{
+		return;
+	}
+	for (int i = (int)OpenScripts.Size() - 1; i >= 0; --i)
+	{
+		if (OpenScripts[i].Id == id)
+		{
+			FOpenScript &script = OpenScripts[i];
+			script.Clock.Unclock();
+			double total = script.Clock.TimeMS();
+			if (i > 0)
+			{
+				OpenScripts[i - 1].ChildMS += total;
+			}
+			FParsedScript parsed = { script.Lump, Phases.Size() - 1, total - script.ChildMS };
+			ParsedScripts.Push(parsed);
+			OpenScripts.Delete(i);
+			return;
+		}
+	}
+}
+
+//==========================================================================
+//
+// WriteJSONString
+//
+//==========================================================================
+
+static void WriteJSONString(FILE *f, const char *str)
+{
+	fputc('"', f);
+	for (; *str != '\0'; ++str)
+	{
+		unsigned char c = *str;
+		if (c == '"' || c == '\\')
+		{
+			fprintf(f, "\\%c", c);
+		}
+		else if (c < 0x20)
+		{
+			fprintf(f, "\\u%04x", c);
+		}
+		else
+		{
+			fputc(c, f);
+		}
+	}
+	fputc('"', f);
+}
+
+//==========================================================================
+//
+// WriteProfile
+//
+//==========================================================================
+
+static void WriteProfile(const FStartupPhase &total, unsigned int numslow)
+{
+	FILE *f = fopen(ProfileFile, "w");
+	if (f == NULL)
+	{
+		Printf(TEXTCOLOR_RED "Could not write startup profile to %s\n", ProfileFile.GetChars());
+		return;
+	}
+
+	fprintf(f, "{\n\t\"wall_ms\": %.3f,\n\t\"cpu_ms\": %.3f,\n\t\"phases\": [\n", total.WallMS, total.CPUMS);
+	for (unsigned int i = 0; i < Phases.Size(); ++i)
+	{
+		const FStartupPhase &phase = Phases[i];
+		fprintf(f, "\t\t{ \"name\": ");
+		WriteJSONString(f, phase.Name);
+		fprintf(f, ", \"wall_ms\": %.3f, \"cpu_ms\": %.3f, \"lumps_opened\": %u, \"bytes_opened\": %llu, "
+			"\"lumps_decompressed\": %u, \"bytes_decompressed\": %llu, \"scripts_parsed\": %u }%s\n",
+			phase.WallMS, phase.CPUMS, phase.LumpsOpened, (unsigned long long)phase.BytesOpened,
+			phase.LumpsDecompressed, (unsigned long long)phase.BytesDecompressed, phase.ScriptsParsed,
+			i + 1 < Phases.Size() ? "," : "");
+	}
+	fprintf(f, "\t],\n\t\"slowest_scripts\": [\n");
+	for (unsigned int i = 0; i < numslow; ++i)
+	{
+		const FParsedScript &script = ParsedScripts[i];
+		fprintf(f, "\t\t{ \"lump\": %d, \"name\": ", script.Lump);
+		WriteJSONString(f, Wads.GetLumpFullPath(script.Lump));
+		fprintf(f, ", \"phase\": ");
+		WriteJSONString(f, Phases[script.Phase].Name);
+		fprintf(f, ", \"ms\": %.3f }%s\n", script.MS, i + 1 < numslow ? "," : "");
+	}
+	fprintf(f, "\t]\n}\n");
+	fclose(f);
+	Printf("Startup profile written to %s\n", ProfileFile.GetChars());
+}
+
+//==========================================================================
+//
+// D_EndStartupProfile
+//
+//==========================================================================
+
+static int SortSlowest(const void *a, const void *b)
+{
+	double ma = ((const FParsedScript *)a)->MS;
+	double mb = ((const FParsedScript *)b)->MS;
+	return ma < mb ? 1 : ma > mb ? -1 : 0;
+}
+
+void D_EndStartupProfile()
+{
+	if (!Profiling || Finished)
+	{
+		return;
+	}
+	EndPhase();
+	Profiling = false;
+	Finished = true;
+
+	FStartupPhase total = { "Total", 0, 0, 0, 0, 0, 0, 0 };
+	Printf(TEXTCOLOR_YELLOW "%-24s %9s %9s %6s %10s %6s %10s %7s\n",
+		"Startup phase", "wall ms", "cpu ms", "lumps", "KB", "unpack", "KB", "scripts");
+	for (unsigned int i = 0; i <= Phases.Size(); ++i)
+	{
+		const FStartupPhase &phase = i < Phases.Size() ? Phases[i] : total;
+		Printf("%s%-24s %9.1f %9.1f %6u %10llu %6u %10llu %7u\n", i < Phases.Size() ? "" : TEXTCOLOR_YELLOW,
+			phase.Name, phase.WallMS, phase.CPUMS, phase.LumpsOpened, (unsigned long long)(phase.BytesOpened >> 10),
+			phase.LumpsDecompressed, (unsigned long long)(phase.BytesDecompressed >> 10), phase.ScriptsParsed);
+		if (i < Phases.Size())
+		{
+			total.WallMS += phase.WallMS;
+			total.CPUMS += phase.CPUMS;
+			total.LumpsOpened += phase.LumpsOpened;
+			total.BytesOpened += phase.BytesOpened;
+			total.LumpsDecompressed += phase.LumpsDecompressed;
+			total.BytesDecompressed += phase.BytesDecompressed;
+			total.ScriptsParsed += phase.ScriptsParsed;
+		}
+	}
+
+	if (ParsedScripts.Size() > 1)
+	{
+		qsort(&ParsedScripts[0], ParsedScripts.Size(), sizeof(FParsedScript), SortSlowest);
+	}
+	unsigned int numslow = MIN<unsigned int>(ParsedScripts.Size(), NUM_SLOWEST_LUMPS);
+	if (numslow > 0)
+	{
+		Printf(TEXTCOLOR_YELLOW "Slowest scripts to parse:\n");
+		for (unsigned int i = 0; i < numslow; ++i)
+		{
+			const FParsedScript &script = ParsedScripts[i];
+			Printf("%9.1f ms  %s (%s)\n", script.MS, Wads.GetLumpFullPath(script.Lump).GetChars(), Phases[script.Phase].Name);
+		}
+	}
+
+	WriteProfile(total, numslow);
+
+	Phases.Clear();
+	Phases.ShrinkToFit();
+	OpenScripts.Clear();
+	OpenScripts.ShrinkToFit();
+	ParsedScripts.Clear();
+	ParsedScripts.ShrinkToFit();
+}
@@ -0,0 +1,60 @@
+/*
+** d_startupprof.h
+** Startup phase timing and lump I/O accounting
+**
+**---------------------------------------------------------------------------
+** Copyright 2016 The ZDoom Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+
+#ifndef __D_STARTUPPROF_H__
+#define __D_STARTUPPROF_H__
+
+// Checks for -profilestartup and, if given, starts timing the first phase.
+void D_InitStartupProfile();
+
+// Ends the current phase and starts a new one. The name must be a string
+// literal or otherwise outlive the profile.
+void D_StartupPhase(const char *name);
+
+// Ends the last phase, prints the report and writes the JSON file.
+// Does nothing after the first call, so restarts are not profiled.
+void D_EndStartupProfile();
+
+// I/O accounting, charged to the current phase.
+void D_StartupLumpOpened(int lump, long size);
+void D_StartupLumpDecompressed(long size);
+
+// Times a script lump from the moment a scanner opens it until it is closed.
+// Nested scripts (e.g. #include) are subtracted from their parent's time.
+// Begin returns 0 when not profiling; End ignores 0.
+int D_StartupBeginParse(int lump);
+void D_StartupEndParse(int id);
+
+#endif
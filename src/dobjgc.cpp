@@ -353,7 +353,7 @@ static void MarkRoot()
 		SectorMarker->SecNum = 0;
 	}
 	Mark(SectorMarker);
-	Mark(interpolator.Head);
+	interpolator.MarkInterpolations();
 	// Mark action functions
 	if (!FinalGC)
 	{
@@ -54,6 +54,7 @@ void DSectorEffect::Destroy()
 		{
 			m_Sector->lightingdata = NULL;
 		}
+		P_WakeScriptsForSector (m_Sector);
 	}
 	Super::Destroy();
 }
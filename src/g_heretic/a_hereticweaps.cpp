@@ -167,8 +167,8 @@ DEFINE_ACTION_FUNCTION(AActor, A_FireGoldWandPL2)
 	angle_t pitch = P_BulletSlope(self);
 	velz = FixedMul (GetDefaultByName("GoldWandFX2")->Speed,
 		finetangent[FINEANGLES/4-((signed)pitch>>ANGLETOFINESHIFT)]);
-	P_SpawnMissileAngle (self, PClass::FindActor("GoldWandFX2"), self->angle-(ANG45/8), velz);
-	P_SpawnMissileAngle (self, PClass::FindActor("GoldWandFX2"), self->angle+(ANG45/8), velz);
+	P_SpawnMissileAngle (self, PClass::FindActor(NAME_LITERAL("GoldWandFX2")), self->angle-(ANG45/8), velz);
+	P_SpawnMissileAngle (self, PClass::FindActor(NAME_LITERAL("GoldWandFX2")), self->angle+(ANG45/8), velz);
 	angle = self->angle-(ANG45/8);
 	for(i = 0; i < 5; i++)
 	{
@@ -203,9 +203,9 @@ DEFINE_ACTION_FUNCTION(AActor, A_FireCrossbowPL1)
 		if (!weapon->DepleteAmmo (weapon->bAltFire))
 			return 0;
 	}
-	P_SpawnPlayerMissile (self, PClass::FindActor("CrossbowFX1"));
-	P_SpawnPlayerMissile (self, PClass::FindActor("CrossbowFX3"), self->angle-(ANG45/10));
-	P_SpawnPlayerMissile (self, PClass::FindActor("CrossbowFX3"), self->angle+(ANG45/10));
+	P_SpawnPlayerMissile (self, PClass::FindActor(NAME_LITERAL("CrossbowFX1")));
+	P_SpawnPlayerMissile (self, PClass::FindActor(NAME_LITERAL("CrossbowFX3")), self->angle-(ANG45/10));
+	P_SpawnPlayerMissile (self, PClass::FindActor(NAME_LITERAL("CrossbowFX3")), self->angle+(ANG45/10));
 	return 0;
 }
 
@@ -232,11 +232,11 @@ DEFINE_ACTION_FUNCTION(AActor, A_FireCrossbowPL2)
 		if (!weapon->DepleteAmmo (weapon->bAltFire))
 			return 0;
 	}
-	P_SpawnPlayerMissile (self, PClass::FindActor("CrossbowFX2"));
-	P_SpawnPlayerMissile (self, PClass::FindActor("CrossbowFX2"), self->angle-(ANG45/10));
-	P_SpawnPlayerMissile (self, PClass::FindActor("CrossbowFX2"), self->angle+(ANG45/10));
-	P_SpawnPlayerMissile (self, PClass::FindActor("CrossbowFX3"), self->angle-(ANG45/5));
-	P_SpawnPlayerMissile (self, PClass::FindActor("CrossbowFX3"), self->angle+(ANG45/5));
+	P_SpawnPlayerMissile (self, PClass::FindActor(NAME_LITERAL("CrossbowFX2")));
+	P_SpawnPlayerMissile (self, PClass::FindActor(NAME_LITERAL("CrossbowFX2")), self->angle-(ANG45/10));
+	P_SpawnPlayerMissile (self, PClass::FindActor(NAME_LITERAL("CrossbowFX2")), self->angle+(ANG45/10));
+	P_SpawnPlayerMissile (self, PClass::FindActor(NAME_LITERAL("CrossbowFX3")), self->angle-(ANG45/5));
+	P_SpawnPlayerMissile (self, PClass::FindActor(NAME_LITERAL("CrossbowFX3")), self->angle+(ANG45/5));
 	return 0;
 }
 
@@ -281,14 +281,14 @@ DEFINE_ACTION_FUNCTION_PARAMS(AActor, A_GauntletAttack)
 		damage = pr_gatk.HitDice (2);
 		dist = 4*MELEERANGE;
 		angle += pr_gatk.Random2() << 17;
-		pufftype = PClass::FindActor("GauntletPuff2");
+		pufftype = PClass::FindActor(NAME_LITERAL("GauntletPuff2"));
 	}
 	else
 	{
 		damage = pr_gatk.HitDice (2);
 		dist = MELEERANGE+1;
 		angle += pr_gatk.Random2() << 18;
-		pufftype = PClass::FindActor("GauntletPuff1");
+		pufftype = PClass::FindActor(NAME_LITERAL("GauntletPuff1"));
 	}
 	slope = P_AimLineAttack (self, angle, dist, &linetarget);
 	P_LineAttack (self, angle, dist, slope, damage, NAME_Melee, pufftype, false, &linetarget, &actualdamage);
@@ -446,7 +446,7 @@ DEFINE_ACTION_FUNCTION(AActor, A_FireMacePL1)
 	}
 	player->psprites[ps_weapon].sx = ((pr_maceatk()&3)-2)*FRACUNIT;
 	player->psprites[ps_weapon].sy = WEAPONTOP+(pr_maceatk()&3)*FRACUNIT;
-	ball = P_SpawnPlayerMissile (self, PClass::FindActor("MaceFX1"),
+	ball = P_SpawnPlayerMissile (self, PClass::FindActor(NAME_LITERAL("MaceFX1")),
 		self->angle+(((pr_maceatk()&7)-4)<<24));
 	if (ball)
 	{
@@ -722,7 +722,7 @@ public:
 
 int ABlasterFX1::DoSpecialDamage (AActor *target, int damage, FName damagetype)
 {
-	if (target->IsKindOf (PClass::FindClass ("Ironlich")))
+	if (target->IsKindOf (PClass::FindClass(NAME_Ironlich)))
 	{ // Less damage to Ironlich bosses
 		damage = pr_bfx1() & 1;
 		if (!damage)
@@ -757,7 +757,7 @@ IMPLEMENT_CLASS(ARipper)
 
 int ARipper::DoSpecialDamage (AActor *target, int damage, FName damagetype)
 {
-	if (target->IsKindOf (PClass::FindClass ("Ironlich")))
+	if (target->IsKindOf (PClass::FindClass(NAME_Ironlich)))
 	{ // Less damage to Ironlich bosses
 		damage = pr_ripd() & 1;
 		if (!damage)
@@ -849,7 +849,7 @@ IMPLEMENT_CLASS (AHornRodFX2)
 
 int AHornRodFX2::DoSpecialDamage (AActor *target, int damage, FName damagetype)
 {
-	if (target->IsKindOf (PClass::FindClass("Sorcerer2")) && pr_hrfx2() < 96)
+	if (target->IsKindOf (PClass::FindClass(NAME_Sorcerer2)) && pr_hrfx2() < 96)
 	{ // D'Sparil teleports away
 		P_DSparilTeleport (target);
 		return -1;
@@ -919,7 +919,7 @@ DEFINE_ACTION_FUNCTION(AActor, A_FireSkullRodPL1)
 		if (!weapon->DepleteAmmo (weapon->bAltFire))
 			return 0;
 	}
-	mo = P_SpawnPlayerMissile (self, PClass::FindActor("HornRodFX1"));
+	mo = P_SpawnPlayerMissile (self, PClass::FindActor(NAME_LITERAL("HornRodFX1")));
 	// Randomize the first frame
 	if (mo && pr_fsr1() > 128)
 	{
@@ -1194,7 +1194,7 @@ IMPLEMENT_CLASS (APhoenixFX1)
 
 int APhoenixFX1::DoSpecialDamage (AActor *target, int damage, FName damagetype)
 {
-	if (target->IsKindOf (PClass::FindClass("Sorcerer2")) && pr_hrfx2() < 96)
+	if (target->IsKindOf (PClass::FindClass(NAME_Sorcerer2)) && pr_hrfx2() < 96)
 	{ // D'Sparil teleports away
 		P_DSparilTeleport (target);
 		return -1;
@@ -1035,7 +1035,7 @@ DEFINE_MAP_OPTION(specialaction, true)
 	int min_arg, max_arg;
 	if (parse.format_type == parse.FMT_Old) parse.sc.SetCMode(true);
 	parse.sc.MustGetString();
-	sa->Type = FName(parse.sc.String);
+	sa->Type = parse.sc.ViewName();
 	parse.sc.CheckString(",");
 	parse.sc.MustGetString();
 	sa->Action = P_FindLineSpecial(parse.sc.String, &min_arg, &max_arg);
@@ -1087,7 +1087,7 @@ DEFINE_MAP_OPTION(redirect, true)
 {
 	parse.ParseAssign();
 	parse.sc.MustGetString();
-	info->RedirectType = parse.sc.String;
+	info->RedirectType = parse.sc.ViewName();
 	parse.ParseComma();
 	parse.ParseNextMap(info->RedirectMapName);
 }
@@ -1773,6 +1773,7 @@ static void SetLevelNum (level_info_t *info, int num)
 void FMapInfoParser::ParseMapInfo (int lump, level_info_t &gamedefaults, level_info_t &defaultinfo)
 {
 	sc.OpenLumpNum(lump);
+	sc.SetViewMode(true);
 
 	defaultinfo = gamedefaults;
 	HexenHack = false;
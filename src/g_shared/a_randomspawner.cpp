@@ -202,7 +202,7 @@ class ARandomSpawner : public AActor
 			if (newmobj->flags & MF_MISSILE)
 				P_CheckMissileSpawn(newmobj, 0);
 			// Bouncecount is used to count how many recursions we're in.
-			if (newmobj->IsKindOf(PClass::FindClass("RandomSpawner")))
+			if (newmobj->IsKindOf(PClass::FindClass(NAME_LITERAL("RandomSpawner"))))
 				newmobj->bouncecount = ++bouncecount;
 			// If the spawned actor has either of those flags, it's a boss.
 			if ((newmobj->flags4 & MF4_BOSSDEATH) || (newmobj->flags2 & MF2_BOSS))
@@ -64,6 +64,7 @@
 #include "st_start.h"
 #include "m_misc.h"
 #include "doomstat.h"
+#include "c_cvars.h"
 
 #include "i_net.h"
 
@@ -195,6 +196,219 @@ int FindNode (const sockaddr_in *address)
 	return i;
 }
 
+//
+// Transports
+//
+// A transport moves packets between game nodes once everyone has connected.
+// PacketSend and PacketGet do the compression and bookkeeping on top of it.
+// Get returns the length of the packet it read, or 0 if there was none.
+//
+class FNetTransport
+{
+public:
+	virtual ~FNetTransport() {}
+	virtual void Send (int node, const BYTE *data, int len) = 0;
+	virtual int Get (BYTE *data, int maxlen, int &node) = 0;
+};
+
+static FNetTransport *Transport;
+static FNetTraffic NodeTraffic[MAXNETNODES];
+
+//
+// FUDPTransport
+//
+// Sends packets over mysocket to the addresses found during connection.
+//
+class FUDPTransport : public FNetTransport
+{
+public:
+	void Send (int node, const BYTE *data, int len);
+	int Get (BYTE *data, int maxlen, int &node);
+};
+
+void FUDPTransport::Send (int node, const BYTE *data, int len)
+{
+	sendto(mysocket, (const char *)data, len,
+		0, (sockaddr *)&sendaddress[node],
+		sizeof(sendaddress[node]));
+	//	if (c == -1)
+	//			I_Error ("SendPacket error: %s",strerror(errno));
+}
+
+int FUDPTransport::Get (BYTE *data, int maxlen, int &node)
+{
+	int c;
+	socklen_t fromlen;
+	sockaddr_in fromaddress;
+
+	fromlen = sizeof(fromaddress);
+	c = recvfrom (mysocket, (char*)data, maxlen, 0,
+				  (sockaddr *)&fromaddress, &fromlen);
+	node = FindNode (&fromaddress);
+
+	if (node >= 0 && c == SOCKET_ERROR)
+	{
+		int err = WSAGetLastError();
+
+		if (err == WSAECONNRESET)
+		{ // The remote node aborted unexpectedly, so pretend it sent an exit packet
+
+			if (StartScreen != NULL)
+			{
+				StartScreen->NetMessage ("The connection from %s was dropped.\n",
+					players[sendplayer[node]].userinfo.GetName());
+			}
+			else
+			{
+				Printf("The connection from %s was dropped.\n",
+					players[sendplayer[node]].userinfo.GetName());
+			}
+
+			data[0] = 0x80;	// NCMD_EXIT
+			return 1;
+		}
+		else if (err != WSAEWOULDBLOCK)
+		{
+			I_Error ("GetPacket: %s", neterror ());
+		}
+		return 0;		// no packet
+	}
+	else if (node < 0 && c > 0)
+	{	//The packet is not from any in-game node, so we might as well discard it.
+		// Don't show the message for disconnect notifications.
+		if (c != 2 || data[0] != PRE_FAKE || data[1] != PRE_DISCONNECT)
+		{
+			DPrintf("Dropped packet: Unknown host (%s:%d)\n", inet_ntoa(fromaddress.sin_addr), fromaddress.sin_port);
+		}
+		return 0;
+	}
+	return MAX(c, 0);
+}
+
+//
+// FSimulatedTransport
+//
+// Sits in front of another transport and makes the connection worse on
+// purpose, so that bad network conditions can be reproduced between
+// games running on the same machine. Only packets this node sends are
+// affected, so every node in the game should use the same settings.
+//
+struct FDelayedPacket
+{
+	unsigned int DeliverTime;
+	int Node;
+	TArray<BYTE> Data;
+};
+
+class FSimulatedTransport : public FNetTransport
+{
+public:
+	FSimulatedTransport (FNetTransport *link);
+	~FSimulatedTransport ();
+	void Send (int node, const BYTE *data, int len);
+	int Get (BYTE *data, int maxlen, int &node);
+
+private:
+	void Flush ();
+	DWORD Random ();
+
+	FNetTransport *Link;
+	TArray<FDelayedPacket> Pending;		// Sorted by delivery time
+	DWORD Seed;
+};
+
+CVAR (Int, net_simlatency, 0, 0)		// Milliseconds added to every packet sent
+CVAR (Int, net_simjitter, 0, 0)			// Up to this many more milliseconds, at random
+CVAR (Float, net_simloss, 0, 0)			// Percentage of packets that are never sent
+CVAR (Int, net_simreorder, 0, 0)		// Percentage of packets held back behind later ones
+
+FSimulatedTransport::FSimulatedTransport (FNetTransport *link)
+	: Link(link)
+{
+	// Not one of the game's RNGs, since those have to stay in sync.
+	Seed = I_MSTime() * 2 + 1;
+}
+
+FSimulatedTransport::~FSimulatedTransport ()
+{
+	delete Link;
+}
+
+DWORD FSimulatedTransport::Random ()
+{
+	Seed ^= Seed << 13;
+	Seed ^= Seed >> 17;
+	Seed ^= Seed << 5;
+	return Seed;
+}
+
+void FSimulatedTransport::Send (int node, const BYTE *data, int len)
+{
+	if (net_simloss > 0 && Random() % 10000 < unsigned(net_simloss * 100))
+	{
+		NodeTraffic[node].PacketsLost++;
+		return;
+	}
+
+	int delay = MAX(0, *net_simlatency);
+	if (net_simjitter > 0)
+	{
+		delay += Random() % (net_simjitter + 1);
+	}
+	if (net_simreorder > 0 && int(Random() % 100) < net_simreorder)
+	{ // Hold it long enough for at least a couple of later packets to pass it.
+		delay += MAX<int>(net_simjitter, 1000 / TICRATE) * 2;
+	}
+	if (delay == 0 && Pending.Size() == 0)
+	{
+		Link->Send (node, data, len);
+		return;
+	}
+
+	FDelayedPacket packet;
+	packet.DeliverTime = I_MSTime() + delay;
+	packet.Node = node;
+	packet.Data.Resize(len);
+	memcpy (&packet.Data[0], data, len);
+
+	unsigned int i = Pending.Size();
+	while (i > 0 && int(Pending[i-1].DeliverTime - packet.DeliverTime) > 0)
+	{
+		i--;
+	}
+	Pending.Insert (i, packet);
+	Flush ();
+}
+
+void FSimulatedTransport::Flush ()
+{
+	unsigned int now = I_MSTime();
+	unsigned int i;
+
+	for (i = 0; i < Pending.Size() && int(now - Pending[i].DeliverTime) >= 0; ++i)
+	{
+		Link->Send (Pending[i].Node, &Pending[i].Data[0], Pending[i].Data.Size());
+	}
+	if (i > 0)
+	{
+		Pending.Delete (0, i);
+	}
+}
+
+int FSimulatedTransport::Get (BYTE *data, int maxlen, int &node)
+{
+	Flush ();
+	return Link->Get (data, maxlen, node);
+}
+
+//
+// I_GetNetTraffic
+//
+const FNetTraffic &I_GetNetTraffic (int node)
+{
+	return NodeTraffic[node];
+}
+
 //
 // PacketSend
 //
@@ -225,9 +439,7 @@ void PacketSend (void)
 	if (c == Z_OK && size < (uLong)doomcom.datalength)
 	{
 //		Printf("send %lu/%d\n", size, doomcom.datalength);
-		c = sendto(mysocket, (char *)TransmitBuffer, size,
-			0, (sockaddr *)&sendaddress[doomcom.remotenode],
-			sizeof(sendaddress[doomcom.remotenode]));
+		Transport->Send (doomcom.remotenode, TransmitBuffer, size);
 	}
 	else
 	{
@@ -238,13 +450,12 @@ void PacketSend (void)
 		else
 		{
 //			Printf("send %d\n", doomcom.datalength);
-			c = sendto(mysocket, (char *)doomcom.data, doomcom.datalength,
-				0, (sockaddr *)&sendaddress[doomcom.remotenode],
-				sizeof(sendaddress[doomcom.remotenode]));
+			size = doomcom.datalength;
+			Transport->Send (doomcom.remotenode, doomcom.data, size);
 		}
 	}
-	//	if (c == -1)
-	//			I_Error ("SendPacket error: %s",strerror(errno));
+	NodeTraffic[doomcom.remotenode].PacketsSent++;
+	NodeTraffic[doomcom.remotenode].BytesSent += size;
 }
 
 
@@ -254,78 +465,37 @@ void PacketSend (void)
 void PacketGet (void)
 {
 	int c;
-	socklen_t fromlen;
-	sockaddr_in fromaddress;
 	int node;
 
-	fromlen = sizeof(fromaddress);
-	c = recvfrom (mysocket, (char*)TransmitBuffer, TRANSMIT_SIZE, 0,
-				  (sockaddr *)&fromaddress, &fromlen);
-	node = FindNode (&fromaddress);
+	c = Transport->Get (TransmitBuffer, TRANSMIT_SIZE, node);
 
-	if (node >= 0 && c == SOCKET_ERROR)
+	if (c <= 0 || node < 0)
 	{
-		int err = WSAGetLastError();
-
-		if (err == WSAECONNRESET)
-		{ // The remote node aborted unexpectedly, so pretend it sent an exit packet
-
-			if (StartScreen != NULL)
-			{
-				StartScreen->NetMessage ("The connection from %s was dropped.\n",
-					players[sendplayer[node]].userinfo.GetName());
-			}
-			else
-			{
-				Printf("The connection from %s was dropped.\n",
-					players[sendplayer[node]].userinfo.GetName());
-			}
+		doomcom.remotenode = -1;		// no packet
+		return;
+	}
+	NodeTraffic[node].PacketsReceived++;
+	NodeTraffic[node].BytesReceived += c;
 
-			doomcom.data[0] = 0x80;	// NCMD_EXIT
-			c = 1;
-		}
-		else if (err != WSAEWOULDBLOCK)
-		{
-			I_Error ("GetPacket: %s", neterror ());
-		}
-		else
+	doomcom.data[0] = TransmitBuffer[0] & ~NCMD_COMPRESSED;
+	if (TransmitBuffer[0] & NCMD_COMPRESSED)
+	{
+		uLongf msgsize = MAX_MSGLEN - 1;
+		int err = uncompress(doomcom.data + 1, &msgsize, TransmitBuffer + 1, c - 1);
+//		Printf("recv %d/%lu\n", c, msgsize + 1);
+		if (err != Z_OK)
 		{
-			doomcom.remotenode = -1;		// no packet
+			Printf("Net decompression failed (zlib error %s)\n", M_ZLibError(err).GetChars());
+			// Pretend no packet
+			doomcom.remotenode = -1;
 			return;
 		}
+		c = msgsize + 1;
 	}
-	else if (node >= 0 && c > 0)
+	else
 	{
-		doomcom.data[0] = TransmitBuffer[0] & ~NCMD_COMPRESSED;
-		if (TransmitBuffer[0] & NCMD_COMPRESSED)
-		{
-			uLongf msgsize = MAX_MSGLEN - 1;
-			int err = uncompress(doomcom.data + 1, &msgsize, TransmitBuffer + 1, c - 1);
-//			Printf("recv %d/%lu\n", c, msgsize + 1);
-			if (err != Z_OK)
-			{
-				Printf("Net decompression failed (zlib error %s)\n", M_ZLibError(err).GetChars());
-				// Pretend no packet
-				doomcom.remotenode = -1;
-				return;
-			}
-			c = msgsize + 1;
-		}
-		else
-		{
-//			Printf("recv %d\n", c);
-			memcpy(doomcom.data + 1, TransmitBuffer + 1, c - 1);
-		}
-	}
-	else if (c > 0)
-	{	//The packet is not from any in-game node, so we might as well discard it.
-		// Don't show the message for disconnect notifications.
-		if (c != 2 || TransmitBuffer[0] != PRE_FAKE || TransmitBuffer[1] != PRE_DISCONNECT)
-		{
-			DPrintf("Dropped packet: Unknown host (%s:%d)\n", inet_ntoa(fromaddress.sin_addr), fromaddress.sin_port);
-		}
-		doomcom.remotenode = -1;
-		return;
+//		Printf("recv %d\n", c);
+		memcpy(doomcom.data + 1, TransmitBuffer + 1, c - 1);
 	}
 
 	doomcom.remotenode = node;
@@ -413,6 +583,11 @@ void BuildAddress (sockaddr_in *address, const char *name)
 
 void CloseNetwork (void)
 {
+	if (Transport != NULL)
+	{
+		delete Transport;
+		Transport = NULL;
+	}
 	if (mysocket != INVALID_SOCKET)
 	{
 		closesocket (mysocket);
@@ -448,6 +623,8 @@ void StartNetwork (bool autoPort)
 #else
 	fcntl(mysocket, F_SETFL, trueval | O_NONBLOCK);
 #endif
+
+	Transport = new FSimulatedTransport (new FUDPTransport);
 }
 
 void SendAbort (void)
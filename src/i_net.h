@@ -23,8 +23,20 @@
 #ifndef __I_NET_H__
 #define __I_NET_H__
 
+#include "doomtype.h"
+
 // Called by D_DoomMain.
 bool I_InitNetwork (void);
 void I_NetCmd (void);
 
+// Packets and bytes as they went over the wire (i.e. compressed).
+struct FNetTraffic
+{
+	DWORD PacketsSent, PacketsReceived;
+	DWORD PacketsLost;			// Thrown away by net_simloss
+	QWORD BytesSent, BytesReceived;
+};
+
+const FNetTraffic &I_GetNetTraffic (int node);
+
 #endif
@@ -407,6 +407,26 @@ FRandom *FRandom::StaticFindRNG (const char *name)
 	return probe;
 }
 
+//==========================================================================
+//
+// FRandom :: StaticFindRNGByCRC
+//
+// Finds an existing named RNG by its CRC. Returns NULL if there is none.
+//
+//==========================================================================
+
+FRandom *FRandom::StaticFindRNGByCRC (DWORD crc)
+{
+	for (FRandom *probe = RNGList; probe != NULL; probe = probe->Next)
+	{
+		if (probe->NameCRC == crc)
+		{
+			return probe;
+		}
+	}
+	return NULL;
+}
+
 //==========================================================================
 //
 // FRandom :: StaticPrintSeeds
@@ -177,6 +177,9 @@ public:
 	static void StaticReadRNGState (PNGHandle *png);
 	static void StaticWriteRNGState (FILE *file);
 	static FRandom *StaticFindRNG(const char *name);
+	static FRandom *StaticFindRNGByCRC(DWORD crc);
+
+	DWORD GetNameCRC() const { return NameCRC; }
 
 #ifndef NDEBUG
 	static void StaticPrintSeeds ();
@@ -46,6 +46,10 @@
 // How many entries to grow the NameArray by when it needs to grow.
 #define NAME_GROW_AMOUNT	256
 
+// The hash table starts with this many buckets and doubles whenever there
+// are more names than buckets. Must be a power of 2.
+#define INITIAL_BUCKETS		1024
+
 // TYPES -------------------------------------------------------------------
 
 // Name text is stored in a linked list of NameBlock structures. This
@@ -100,8 +104,7 @@ int FName::NameManager::FindName (const char *text, bool noCreate)
 	}
 
 	unsigned int hash = MakeKey (text);
-	unsigned int bucket = hash % HASH_SIZE;
-	int scanner = Buckets[bucket];
+	int scanner = Buckets[hash & (NumBuckets - 1)];
 
 	// See if the name already exists.
 	while (scanner >= 0)
@@ -119,7 +122,7 @@ int FName::NameManager::FindName (const char *text, bool noCreate)
 		return 0;
 	}
 
-	return AddName (text, hash, bucket);
+	return AddName (text, strlen (text), hash);
 }
 
 //==========================================================================
@@ -130,6 +133,18 @@ int FName::NameManager::FindName (const char *text, bool noCreate)
 //==========================================================================
 
 int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreate)
+{
+	return FindName (text, textLen, MakeKey (text, textLen), noCreate);
+}
+
+//==========================================================================
+//
+// The same as above, but with the hash already computed, either by MakeKey
+// or at compile time by MakeNameKey.
+//
+//==========================================================================
+
+int FName::NameManager::FindName (const char *text, size_t textLen, unsigned int hash, bool noCreate)
 {
 	if (!Inited)
 	{
@@ -141,9 +156,8 @@ int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreat
 		return 0;
 	}
 
-	unsigned int hash = MakeKey (text, textLen);
-	unsigned int bucket = hash % HASH_SIZE;
-	int scanner = Buckets[bucket];
+	assert (hash == MakeKey (text, textLen) && "Precomputed name hash does not match");
+	int scanner = Buckets[hash & (NumBuckets - 1)];
 
 	// See if the name already exists.
 	while (scanner >= 0)
@@ -163,7 +177,7 @@ int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreat
 		return 0;
 	}
 
-	return AddName (text, hash, bucket);
+	return AddName (text, textLen, hash);
 }
 
 //==========================================================================
@@ -177,7 +191,7 @@ int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreat
 void FName::NameManager::InitBuckets ()
 {
 	Inited = true;
-	memset (Buckets, -1, sizeof(Buckets));
+	Rehash (INITIAL_BUCKETS);
 
 	// Register built-in names. 'None' must be name 0.
 	for (size_t i = 0; i < countof(PredefinedNames); ++i)
@@ -195,11 +209,11 @@ void FName::NameManager::InitBuckets ()
 //
 //==========================================================================
 
-int FName::NameManager::AddName (const char *text, unsigned int hash, unsigned int bucket)
+int FName::NameManager::AddName (const char *text, size_t textLen, unsigned int hash)
 {
 	char *textstore;
 	NameBlock *block = Blocks;
-	size_t len = strlen (text) + 1;
+	size_t len = textLen + 1;
 
 	// Get a block large enough for the name. Only the first block in the
 	// list is ever considered for name storage.
@@ -210,7 +224,8 @@ int FName::NameManager::AddName (const char *text, unsigned int hash, unsigned i
 
 	// Copy the string into the block.
 	textstore = (char *)block + block->NextAlloc;
-	strcpy (textstore, text);
+	memcpy (textstore, text, textLen);
+	textstore[textLen] = '\0';
 	block->NextAlloc += len;
 
 	// Add an entry for the name to the NameArray
@@ -223,12 +238,40 @@ int FName::NameManager::AddName (const char *text, unsigned int hash, unsigned i
 		NameArray = (NameEntry *)M_Realloc (NameArray, MaxNames * sizeof(NameEntry));
 	}
 
+	unsigned int bucket = hash & (NumBuckets - 1);
 	NameArray[NumNames].Text = textstore;
 	NameArray[NumNames].Hash = hash;
 	NameArray[NumNames].NextHash = Buckets[bucket];
 	Buckets[bucket] = NumNames;
 
-	return NumNames++;
+	if (++NumNames > NumBuckets)
+	{
+		Rehash (NumBuckets * 2);
+	}
+	return NumNames - 1;
+}
+
+//==========================================================================
+//
+// FName :: NameManager :: Rehash
+//
+// Resizes the hash table and relinks every name into it. Names are linked
+// in creation order, so each chain still lists the newest name first.
+//
+//==========================================================================
+
+void FName::NameManager::Rehash (int numbuckets)
+{
+	Buckets = (int *)M_Realloc (Buckets, numbuckets * sizeof(int));
+	NumBuckets = numbuckets;
+	memset (Buckets, -1, numbuckets * sizeof(int));
+
+	for (int i = 0; i < NumNames; ++i)
+	{
+		unsigned int bucket = NameArray[i].Hash & (numbuckets - 1);
+		NameArray[i].NextHash = Buckets[bucket];
+		Buckets[bucket] = i;
+	}
 }
 
 //==========================================================================
@@ -281,5 +324,12 @@ FName::NameManager::~NameManager()
 		NameArray = NULL;
 	}
 	NumNames = MaxNames = 0;
-	memset (Buckets, -1, sizeof(Buckets));
+
+	if (Buckets != NULL)
+	{
+		M_Free (Buckets);
+		Buckets = NULL;
+	}
+	NumBuckets = 0;
+	Inited = false;
 }
@@ -43,6 +43,53 @@ enum ENamedName
 
 class FString;
 
+// MakeNameKey computes the same hash as MakeKey, but can do it at compile
+// time. It only lowercases ASCII letters, so it is meant for literals.
+namespace NameKey
+{
+	constexpr unsigned int Lower(const char *s, size_t i)
+	{
+		return (s[i] >= 'A' && s[i] <= 'Z') ? unsigned(s[i] - 'A' + 'a') : (unsigned char)s[i];
+	}
+	constexpr unsigned int Get16(const char *s)
+	{
+		return (Lower(s, 1) << 8) + Lower(s, 0);
+	}
+	constexpr unsigned int Xor(unsigned int h, int shift) { return h ^ (h << shift); }
+	constexpr unsigned int Add(unsigned int h, int shift) { return h + (h >> shift); }
+
+	constexpr unsigned int Block(unsigned int h, const char *s)
+	{
+		return Add((h << 16) ^ ((Get16(s + 2) << 11) ^ h), 11);
+	}
+	constexpr unsigned int Blocks(unsigned int h, const char *s, size_t count)
+	{
+		return count == 0 ? h : Blocks(Block(h + Get16(s), s), s + 4, count - 1);
+	}
+	constexpr unsigned int Tail(unsigned int h, const char *s, size_t rem)
+	{
+		return rem == 3 ? Add(Xor(h + Get16(s), 16) ^ (Lower(s, 2) << 18), 11) :
+			rem == 2 ? Add(Xor(h + Get16(s), 11), 17) :
+			rem == 1 ? Add(Xor(h + Lower(s, 0), 10), 1) : h;
+	}
+	constexpr unsigned int Avalanche(unsigned int h)
+	{
+		return Add(Xor(Add(Xor(Add(Xor(h, 3), 5), 4), 17), 25), 6);
+	}
+}
+
+constexpr unsigned int MakeNameKey(const char *s, size_t len)
+{
+	return len == 0 ? 0 : NameKey::Avalanche(NameKey::Tail(NameKey::Blocks(0, s, len >> 2), s + (len & ~size_t(3)), len & 3));
+}
+
+// Evaluates to the FName for a string literal. The hash is computed at
+// compile time and the lookup is only done the first time through.
+#define NAME_LITERAL(s) ([]() -> FName { \
+	constexpr unsigned int key = MakeNameKey(s, sizeof(s) - 1); \
+	static const FName name(s, sizeof(s) - 1, key, false); \
+	return name; }())
+
 class FName
 {
 public:
@@ -50,6 +97,7 @@ public:
 	FName (const char *text) { Index = NameData.FindName (text, false); }
 	FName (const char *text, bool noCreate) { Index = NameData.FindName (text, noCreate); }
 	FName (const char *text, size_t textlen, bool noCreate) { Index = NameData.FindName (text, textlen, noCreate); }
+	FName (const char *text, size_t textlen, unsigned int hash, bool noCreate) { Index = NameData.FindName (text, textlen, hash, noCreate); }
 	FName (const FString &text);
 	FName (const FString &text, bool noCreate);
 	FName (const FName &other) { Index = other.Index; }
@@ -70,6 +118,9 @@ public:
 
 	bool IsValidName() const { return (unsigned)Index < (unsigned)NameData.NumNames; }
 
+	// Names are numbered consecutively as they are created.
+	static int GetNumNames() { return NameData.NumNames; }
+
 	// Note that the comparison operators compare the names' indices, not
 	// their text, so they cannot be used to do a lexicographical sort.
 	bool operator == (const FName &other) const { return Index == other.Index; }
@@ -103,19 +154,21 @@ protected:
 		// means this struct must only exist in the program's BSS section.
 		~NameManager();
 
-		enum { HASH_SIZE = 1024 };
 		struct NameBlock;
 
 		NameBlock *Blocks;
 		NameEntry *NameArray;
 		int NumNames, MaxNames;
-		int Buckets[HASH_SIZE];
+		int *Buckets;
+		int NumBuckets;
 
 		int FindName (const char *text, bool noCreate);
 		int FindName (const char *text, size_t textlen, bool noCreate);
-		int AddName (const char *text, unsigned int hash, unsigned int bucket);
+		int FindName (const char *text, size_t textlen, unsigned int hash, bool noCreate);
+		int AddName (const char *text, size_t textlen, unsigned int hash);
 		NameBlock *AddBlock (size_t len);
 		void InitBuckets ();
+		void Rehash (int numbuckets);
 		static bool Inited;
 	};
 
@@ -52,6 +52,7 @@
 #include "c_console.h"
 #include "c_dispatch.h"
 #include "s_sndseq.h"
+#include "stats.h"
 #include "i_system.h"
 #include "i_movie.h"
 #include "sbar.h"
@@ -222,6 +223,120 @@ FWorldGlobalArray ACS_WorldArrays[NUM_WORLDVARS];
 SDWORD ACS_GlobalVars[NUM_GLOBALVARS];
 FWorldGlobalArray ACS_GlobalArrays[NUM_GLOBALVARS];
 
+//============================================================================
+//
+// FWorldGlobalArray :: Allocate
+//
+// Slow path of operator[]: allocates the chunk for a dense index or falls
+// back to the map for everything else.
+//
+//============================================================================
+
+SDWORD &FWorldGlobalArray::Allocate(SDWORD index)
+{
+	if ((unsigned int)index >= DENSE_SIZE)
+	{
+		return Sparse[index];
+	}
+
+	unsigned int chunk = (unsigned int)index >> CHUNK_BITS;
+	if (chunk >= Chunks.Size())
+	{
+		unsigned int oldsize = Chunks.Size();
+		Chunks.Resize(chunk + 1);
+		memset(&Chunks[oldsize], 0, (chunk + 1 - oldsize) * sizeof(SDWORD *));
+	}
+	Chunks[chunk] = new SDWORD[CHUNK_SIZE];
+	memset(Chunks[chunk], 0, CHUNK_SIZE * sizeof(SDWORD));
+	return Chunks[chunk][index & (CHUNK_SIZE - 1)];
+}
+
+//============================================================================
+//
+// FWorldGlobalArray :: Clear
+//
+//============================================================================
+
+void FWorldGlobalArray::Clear()
+{
+	for (unsigned int i = 0; i < Chunks.Size(); ++i)
+	{
+		if (Chunks[i] != NULL)
+		{
+			delete[] Chunks[i];
+		}
+	}
+	Chunks.Clear();
+	Sparse.Clear();
+}
+
+//============================================================================
+//
+// FWorldGlobalArray :: CountUsed
+//
+//============================================================================
+
+unsigned int FWorldGlobalArray::CountUsed() const
+{
+	unsigned int count = Sparse.CountUsed();
+
+	for (unsigned int i = 0; i < Chunks.Size(); ++i)
+	{
+		if (Chunks[i] != NULL)
+		{
+			for (int j = 0; j < CHUNK_SIZE; ++j)
+			{
+				count += Chunks[i][j] != 0;
+			}
+		}
+	}
+	return count;
+}
+
+//============================================================================
+//
+// FWorldGlobalArray :: ConstIterator
+//
+// Zero elements of the chunks are skipped. They read back as zero anyway.
+//
+//============================================================================
+
+FWorldGlobalArray::ConstIterator::ConstIterator(const FWorldGlobalArray &array)
+: Array(array), Chunk(0), Element(0), SparseIt(array.Sparse)
+{
+}
+
+bool FWorldGlobalArray::ConstIterator::Next(SDWORD &index, SDWORD &value)
+{
+	for (; Chunk < Array.Chunks.Size(); ++Chunk, Element = 0)
+	{
+		const SDWORD *data = Array.Chunks[Chunk];
+		if (data == NULL)
+		{
+			continue;
+		}
+		while (Element < CHUNK_SIZE)
+		{
+			unsigned int i = Element++;
+			if (data[i] != 0)
+			{
+				index = (Chunk << CHUNK_BITS) + i;
+				value = data[i];
+				return true;
+			}
+		}
+	}
+
+	SparseMap::ConstPair *pair;
+	if (SparseIt.NextPair(pair))
+	{
+		index = pair->Key;
+		value = pair->Value;
+		return true;
+	}
+	return false;
+}
+
 //----------------------------------------------------------------------------
 //
 // ACS stack manager
@@ -519,11 +634,10 @@ void ACSStringPool::MarkStringArray(const int *strnum, unsigned int count)
 void ACSStringPool::MarkStringMap(const FWorldGlobalArray &aray)
 {
 	FWorldGlobalArray::ConstIterator it(aray);
-	FWorldGlobalArray::ConstPair *pair;
+	SDWORD index, num;
 
-	while (it.NextPair(pair))
+	while (it.Next(index, num))
 	{
-		int num = pair->Value;
 		if ((num & LIBRARYID_MASK) == STRPOOL_LIBRARYID_OR)
 		{
 			num &= ~LIBRARYID_MASK;
@@ -1000,12 +1114,12 @@ static void WriteArrayVars (FILE *file, FWorldGlobalArray *vars, unsigned int co
 			arc.WriteCount (vars[i].CountUsed());
 
 			FWorldGlobalArray::ConstIterator it(vars[i]);
-			const FWorldGlobalArray::Pair *pair;
+			SDWORD key, val;
 
-			while (it.NextPair (pair))
+			while (it.Next (key, val))
 			{
-				arc.WriteCount (pair->Key);
-				arc.WriteCount (pair->Value);
+				arc.WriteCount (key);
+				arc.WriteCount (val);
 			}
 		}
 	}
@@ -2229,6 +2343,8 @@ bool FBehavior::Init(int lumpnum, FileReader * fr, int len)
 		}
 	}
 
+	TranslateCode (Code, InstrByRaw, InstrByCode);
+
 	DPrintf ("Loaded %d scripts, %d functions\n", NumScripts, NumFunctions);
 	return true;
 }
@@ -2275,6 +2391,102 @@ FBehavior::~FBehavior ()
 	}
 }
 
+//==========================================================================
+//
+// FBehavior :: TranslateCode
+//
+// Translates this module's script code, starting from its scripts,
+// functions and GOTOSTACK jump points.
+//
+//==========================================================================
+
+unsigned int FBehavior::TranslateCode (TArray<int> &code, TArray<ACSInstrOffset> &byraw, TArray<ACSInstrOffset> &bycode) const
+{
+	TArray<DWORD> entries;
+	int i;
+
+	for (i = 0; i < NumScripts; ++i)
+	{
+		entries.Push(Scripts[i].Address);
+	}
+	for (i = 0; i < NumFunctions; ++i)
+	{
+		if (Functions[i].ImportNum == 0 && Functions[i].Address != 0)
+		{
+			entries.Push(Functions[i].Address);
+		}
+	}
+	for (i = 0; i < (int)JumpPoints.Size(); ++i)
+	{
+		entries.Push(JumpPoints[i]);
+	}
+	return DLevelScript::TranslateCode(Data, DataSize, Format, entries, code, byraw, bycode);
+}
+
+//==========================================================================
+//
+// FBehavior :: PC2Ofs
+//
+// Returns the offset in the object of a position in the translated code.
+//
+//==========================================================================
+
+DWORD FBehavior::PC2Ofs (int *pc) const
+{
+	DWORD codeofs = DWORD(pc - &Code[0]);
+	unsigned int min = 0, max = InstrByCode.Size();
+
+	while (min < max)
+	{
+		unsigned int mid = (min + max) / 2;
+		if (InstrByCode[mid].CodeOfs < codeofs)
+		{
+			min = mid + 1;
+		}
+		else
+		{
+			max = mid;
+		}
+	}
+	if (min < InstrByCode.Size() && InstrByCode[min].CodeOfs == codeofs)
+	{
+		return InstrByCode[min].RawOfs;
+	}
+	return 0;
+}
+
+//==========================================================================
+//
+// FBehavior :: Ofs2PC
+//
+// Returns the translated code for an offset in the object. Offsets that
+// do not hold a translated instruction lead to a PCD_TERMINATE.
+//
+//==========================================================================
+
+int *FBehavior::Ofs2PC (DWORD ofs) const
+{
+	unsigned int min = 0, max = InstrByRaw.Size();
+
+	while (min < max)
+	{
+		unsigned int mid = (min + max) / 2;
+		if (InstrByRaw[mid].RawOfs < ofs)
+		{
+			min = mid + 1;
+		}
+		else
+		{
+			max = mid;
+		}
+	}
+	if (min < InstrByRaw.Size() && InstrByRaw[min].RawOfs == ofs)
+	{
+		return (int *)&Code[InstrByRaw[min].CodeOfs];
+	}
+	return (int *)&Code[0];
+}
+
 void FBehavior::LoadScriptsDirectory ()
 {
 	union
@@ -2913,6 +3125,11 @@ END_POINTERS
 
 TObjPtr<DACSThinker> DACSThinker::ActiveThinker;
 
+// Time spent running scripts this tic, the scripts run and the p-codes they executed
+static cycle_t ACSCycles;
+static unsigned int ACSScriptCount;
+static unsigned int ACSInstrCount;
+
 DACSThinker::DACSThinker ()
 : DThinker(STAT_SCRIPTS)
 {
@@ -2926,6 +3143,8 @@ DACSThinker::DACSThinker ()
 		Scripts = NULL;
 		LastScript = NULL;
 		RunningScripts.Clear();
+		Tic = 0;
+		ResetSchedule ();
 	}
 }
 
@@ -3016,43 +3235,400 @@ void DACSThinker::Serialize (FArchive &arc)
 			RunningScripts[scriptnum] = script;
 			arc << script;
 		}
+
+		// Rebuild the schedule. Waiting scripts check their condition once
+		// more on the next tic, as they would have without the save.
+		ResetSchedule ();
+		for (script = Scripts; script != NULL; script = script->next)
+		{
+			script->OrderKey = ++LastKey;
+			script->ReadyIndex = -1;
+			script->ParkList = NULL;
+			Schedule (script, true);
+		}
+	}
+}
+
+void DACSThinker::Tick ()
+{
+	ACSCycles.Reset();
+	ACSCycles.Clock();
+	ACSScriptCount = 0;
+	ACSInstrCount = 0;
+
+	Tic++;
+	RunTimers ();
+	Ticking = true;
+	while (Ready.Size() > 0 && int(Ready[0]->VisitTic - Tic) <= 0)
+	{
+		DLevelScript *script = Ready[0];
+
+		ReadyRemove (script);
+		CurrentKey = script->OrderKey;
+		script->RunScript ();
+		ACSScriptCount++;
+	}
+	Ticking = false;
+	ACSCycles.Unclock();
+
+//	GlobalACSStrings.Clear();
+
+	if (ACS_StringBuilderStack.Size())
+	{
+		int size = ACS_StringBuilderStack.Size();
+		ACS_StringBuilderStack.Clear();
+		I_Error("Error: %d garbage entries on ACS string builder stack.", size);
+	}
+}
+
+ADD_STAT (acs)
+{
+	FString out;
+	out.Format ("ACS time = %04.2f ms, %u scripts, %u p-codes", ACSCycles.TimeMS(), ACSScriptCount, ACSInstrCount);
+	return out;
+}
+
+void DACSThinker::StopScriptsFor (AActor *actor)
+{
+	DLevelScript *script = Scripts;
+
+	while (script != NULL)
+	{
+		DLevelScript *next = script->next;
+		if (script->activator == actor)
+		{
+			script->SetState (DLevelScript::SCRIPT_PleaseRemove);
+		}
+		script = next;
+	}
+}
+
+//==========================================================================
+//
+// DACSThinker :: ResetSchedule
+//
+//==========================================================================
+
+void DACSThinker::ResetSchedule ()
+{
+	Ready.Clear();
+	memset (Timers, 0, sizeof(Timers));
+	FarTimers = NULL;
+	Waiting = NULL;
+	FirstKey = LastKey = CurrentKey = 0;
+	Ticking = false;
+}
+
+//==========================================================================
+//
+// DACSThinker :: Schedule
+//
+// Decides when a script that just ran, or had its state changed, needs to
+// be visited again. A script that starts waiting is still checked on its
+// next visit, like before; if it has to keep waiting after that, it is
+// parked until something it waits for happens.
+//
+//==========================================================================
+
+void DACSThinker::Schedule (DLevelScript *script, bool ran)
+{
+	Unschedule (script);
+
+	switch (script->state)
+	{
+	case DLevelScript::SCRIPT_Suspended:
+		break;
+
+	case DLevelScript::SCRIPT_Delayed:
+		// The delay counts visits, the first of which is the one Wake would pick.
+		if (script->statedata > 0)
+		{
+			unsigned int first = (Ticking && script->OrderKey > CurrentKey) ? Tic : Tic + 1;
+
+			script->VisitTic = first + script->statedata - 1;
+			if (script->VisitTic == Tic)
+			{
+				ReadyPush (script);
+			}
+			else
+			{
+				AddTimer (script, Tic + 1);
+			}
+		}
+		break;
+
+	case DLevelScript::SCRIPT_TagWait:
+	case DLevelScript::SCRIPT_PolyWait:
+	case DLevelScript::SCRIPT_ScriptWaitPre:
+	case DLevelScript::SCRIPT_ScriptWait:
+		if (!ran)
+		{
+			Park (script, &Waiting);
+			break;
+		}
+		// fall through
+	default:
+		Wake (script);
+		break;
+	}
+}
+
+void DACSThinker::Unschedule (DLevelScript *script)
+{
+	if (script->ReadyIndex >= 0)
+	{
+		ReadyRemove (script);
+	}
+	if (script->ParkList != NULL)
+	{
+		Unpark (script);
+	}
+}
+
+//==========================================================================
+//
+// DACSThinker :: Wake
+//
+// Visits a script on its next turn: later this tic if the script comes
+// after the one that is running now, otherwise on the next tic.
+//
+//==========================================================================
+
+void DACSThinker::Wake (DLevelScript *script)
+{
+	Unschedule (script);
+	script->VisitTic = (Ticking && script->OrderKey > CurrentKey) ? Tic : Tic + 1;
+	ReadyPush (script);
+}
+
+//==========================================================================
+//
+// DACSThinker :: WakeWaiters
+//
+// Wakes the scripts parked in the given wait state on the given data.
+//
+//==========================================================================
+
+void DACSThinker::WakeWaiters (DLevelScript::EScriptState state, int data)
+{
+	DLevelScript *script = Waiting;
+
+	while (script != NULL)
+	{
+		DLevelScript *next = script->ParkNext;
+		if (script->state == state && script->statedata == data)
+		{
+			Wake (script);
+		}
+		script = next;
+	}
+}
+
+void DACSThinker::WakeTagWaiters (sector_t *sector)
+{
+	DLevelScript *script = Waiting;
+
+	while (script != NULL)
+	{
+		DLevelScript *next = script->ParkNext;
+		if (script->state == DLevelScript::SCRIPT_TagWait &&
+			(script->statedata == 0 || tagManager.SectorHasTag(sector, script->statedata)))
+		{
+			Wake (script);
+		}
+		script = next;
+	}
+}
+
+//==========================================================================
+//
+// DACSThinker :: AddTimer
+//
+// Puts a delayed script into the timer wheel. Level 0 has a slot for each
+// of the next 256 tics, and each level above covers 256 times the span of
+// the one below it. Slots of the upper levels are moved down one level
+// when the level below wraps around. base is the first tic whose timers
+// have not run yet.
+//
+//==========================================================================
+
+void DACSThinker::AddTimer (DLevelScript *script, unsigned int base)
+{
+	unsigned int when = script->VisitTic;
+	unsigned int delta = when - base;
+
+	for (int level = 0; level < TIMER_LEVELS; ++level)
+	{
+		if (delta < 1u << (TIMER_BITS * (level + 1)))
+		{
+			Park (script, &Timers[level][(when >> (TIMER_BITS * level)) & (TIMER_SLOTS - 1)]);
+			return;
+		}
+	}
+	Park (script, &FarTimers);
+}
+
+void DACSThinker::CascadeTimers (DLevelScript **list)
+{
+	DLevelScript *script = *list;
+
+	*list = NULL;
+	while (script != NULL)
+	{
+		DLevelScript *next = script->ParkNext;
+		script->ParkList = NULL;
+		AddTimer (script, Tic);
+		script = next;
+	}
+}
+
+//==========================================================================
+//
+// DACSThinker :: RunTimers
+//
+// Moves the delayed scripts that are due this tic to the ready heap.
+//
+//==========================================================================
+
+void DACSThinker::RunTimers ()
+{
+	int wrapped = 0;
+
+	while (wrapped < TIMER_LEVELS && ((Tic >> (TIMER_BITS * wrapped)) & (TIMER_SLOTS - 1)) == 0)
+	{
+		wrapped++;
+	}
+	if (wrapped == TIMER_LEVELS)
+	{
+		CascadeTimers (&FarTimers);
+	}
+	for (int level = MIN<int>(wrapped, TIMER_LEVELS - 1); level > 0; --level)
+	{
+		CascadeTimers (&Timers[level][(Tic >> (TIMER_BITS * level)) & (TIMER_SLOTS - 1)]);
+	}
+
+	DLevelScript **list = &Timers[0][Tic & (TIMER_SLOTS - 1)];
+	while (*list != NULL)
+	{
+		DLevelScript *script = *list;
+		assert (script->VisitTic == Tic);
+		Unpark (script);
+		ReadyPush (script);
+	}
+}
+
+//==========================================================================
+//
+// DACSThinker :: Park / Unpark
+//
+//==========================================================================
+
+void DACSThinker::Park (DLevelScript *script, DLevelScript **list)
+{
+	script->ParkList = list;
+	script->ParkPrev = NULL;
+	script->ParkNext = *list;
+	if (*list != NULL)
+	{
+		(*list)->ParkPrev = script;
+	}
+	*list = script;
+}
+
+void DACSThinker::Unpark (DLevelScript *script)
+{
+	if (script->ParkPrev != NULL)
+	{
+		script->ParkPrev->ParkNext = script->ParkNext;
+	}
+	else
+	{
+		*script->ParkList = script->ParkNext;
+	}
+	if (script->ParkNext != NULL)
+	{
+		script->ParkNext->ParkPrev = script->ParkPrev;
 	}
+	script->ParkList = NULL;
 }
 
-void DACSThinker::Tick ()
+//==========================================================================
+//
+// DACSThinker :: Ready heap
+//
+//==========================================================================
+
+bool DACSThinker::ReadyBefore (const DLevelScript *a, const DLevelScript *b)
 {
-	DLevelScript *script = Scripts;
+	int diff = int(a->VisitTic - b->VisitTic);
+	return diff < 0 || (diff == 0 && a->OrderKey < b->OrderKey);
+}
+
+void DACSThinker::ReadyPush (DLevelScript *script)
+{
+	ReadyUp (Ready.Push (script));
+}
+
+void DACSThinker::ReadyRemove (DLevelScript *script)
+{
+	unsigned int index = script->ReadyIndex;
+	DLevelScript *last;
 
-	while (script)
+	script->ReadyIndex = -1;
+	Ready.Pop (last);
+	if (index < Ready.Size())
 	{
-		DLevelScript *next = script->next;
-		script->RunScript ();
-		script = next;
+		Ready[index] = last;
+		ReadyDown (index);
+		ReadyUp (last->ReadyIndex);
 	}
+}
 
-//	GlobalACSStrings.Clear();
+void DACSThinker::ReadyUp (unsigned int index)
+{
+	DLevelScript *script = Ready[index];
 
-	if (ACS_StringBuilderStack.Size())
+	while (index > 0)
 	{
-		int size = ACS_StringBuilderStack.Size();
-		ACS_StringBuilderStack.Clear();
-		I_Error("Error: %d garbage entries on ACS string builder stack.", size);
+		unsigned int parent = (index - 1) / 2;
+		if (!ReadyBefore (script, Ready[parent]))
+		{
+			break;
+		}
+		Ready[index] = Ready[parent];
+		Ready[index]->ReadyIndex = index;
+		index = parent;
 	}
+	Ready[index] = script;
+	script->ReadyIndex = index;
 }
 
-void DACSThinker::StopScriptsFor (AActor *actor)
+void DACSThinker::ReadyDown (unsigned int index)
 {
-	DLevelScript *script = Scripts;
+	DLevelScript *script = Ready[index];
+	unsigned int count = Ready.Size();
 
-	while (script != NULL)
+	for (;;)
 	{
-		DLevelScript *next = script->next;
-		if (script->activator == actor)
+		unsigned int child = index * 2 + 1;
+		if (child >= count)
 		{
-			script->SetState (DLevelScript::SCRIPT_PleaseRemove);
+			break;
 		}
-		script = next;
+		if (child + 1 < count && ReadyBefore (Ready[child + 1], Ready[child]))
+		{
+			child++;
+		}
+		if (!ReadyBefore (Ready[child], script))
+		{
+			break;
+		}
+		Ready[index] = Ready[child];
+		Ready[index]->ReadyIndex = index;
+		index = child;
 	}
+	Ready[index] = script;
+	script->ReadyIndex = index;
 }
 
 IMPLEMENT_POINTY_CLASS (DLevelScript)
@@ -3079,6 +3655,13 @@ void DLevelScript::Serialize (FArchive &arc)
 
 	P_SerializeACSScriptNumber(arc, script, false);
 
+	// Delayed scripts keep their wake tic in the timer wheel, but saves
+	// still count the tics that are left.
+	if (arc.IsStoring() && state == SCRIPT_Delayed && ParkList != NULL)
+	{
+		statedata = VisitTic - DACSThinker::ActiveThinker->Tic;
+	}
+
 	arc	<< state
 		<< statedata
 		<< activator
@@ -3134,6 +3717,9 @@ void DLevelScript::Serialize (FArchive &arc)
 DLevelScript::DLevelScript ()
 {
 	next = prev = NULL;
+	OrderKey = 0;
+	ReadyIndex = -1;
+	ParkList = NULL;
 	if (DACSThinker::ActiveThinker == NULL)
 		new DACSThinker;
 	activefont = SmallFont;
@@ -3185,6 +3771,7 @@ void DLevelScript::Link ()
 		GC::WriteBarrier(controller->Scripts, this);
 	}
 	prev = NULL;
+	OrderKey = --controller->FirstKey;
 	controller->Scripts = this;
 	GC::WriteBarrier(controller, this);
 	if (controller->LastScript == NULL)
@@ -3211,6 +3798,7 @@ void DLevelScript::PutLast ()
 			controller->LastScript->next = this;
 		prev = controller->LastScript;
 		next = NULL;
+		OrderKey = ++controller->LastKey;
 		controller->LastScript = this;
 	}
 }
@@ -3226,6 +3814,12 @@ void DLevelScript::PutFirst ()
 	Link ();
 }
 
+void DLevelScript::SetState (EScriptState newstate)
+{
+	state = newstate;
+	DACSThinker::ActiveThinker->Schedule (this, false);
+}
+
 int DLevelScript::Random (int min, int max)
 {
 	if (max < min)
@@ -6116,27 +6710,694 @@ enum
 };
 
 
-#define NEXTWORD	(LittleLong(*pc++))
-#define NEXTBYTE	(fmt==ACS_LittleEnhanced?getbyte(pc):NEXTWORD)
-#define NEXTSHORT	(fmt==ACS_LittleEnhanced?getshort(pc):NEXTWORD)
-#define STACK(a)	(Stack[sp - (a)])
-#define PushToStack(a)	(Stack[sp++] = (a))
-// Direct instructions that take strings need to have the tag applied.
-#define TAGSTR(a)	(a|activeBehavior->GetLibraryID())
+//==========================================================================
+//
+// FACSCodeReader
+//
+// Reads opcodes and operands from a module's script code in whichever
+// encoding the module uses. Reading past the end of the code sets Overrun
+// instead of touching anything outside it.
+//
+//==========================================================================
+
+struct FACSCodeReader
+{
+	const BYTE *Data;
+	DWORD Size;
+	DWORD Pos;
+	bool Compact;
+	bool Overrun;
+
+	int Byte ()
+	{
+		if (Pos >= Size)
+		{
+			Overrun = true;
+			return 0;
+		}
+		return Data[Pos++];
+	}
+
+	int Short ()
+	{
+		int lo = Byte();
+		return (SWORD)(lo | (Byte() << 8));
+	}
+
+	int Word ()
+	{
+		if (Pos > Size || Size - Pos < 4)
+		{
+			Overrun = true;
+			Pos = Size;
+			return 0;
+		}
+		const BYTE *p = Data + Pos;
+		Pos += 4;
+		return (int)(p[0] | (p[1] << 8) | (p[2] << 16) | ((DWORD)p[3] << 24));
+	}
+
+	// Operands that the compact format stores in a byte or a short
+	int ByteOp () { return Compact ? Byte() : Word(); }
+	int ShortOp () { return Compact ? Short() : Word(); }
+
+	int Opcode ()
+	{
+		if (!Compact)
+		{
+			return Word();
+		}
+		int pcd = Byte();
+		if (pcd >= 256-16)
+		{
+			pcd = (256-16) + ((pcd - (256-16)) << 8) + Byte();
+		}
+		return pcd;
+	}
+};
+
+struct FACSDecodedInstr
+{
+	DWORD Ofs;			// where the instruction is in the object
+	DWORD Next;			// where the instruction after it is
+	int Op;
+	int FirstArg;		// operands, in the translator's argument list
+	int NumArgs;
+	int FirstJump;		// first operand that is a jump target, or -1
+	int JumpStep;		// distance from one jump target operand to the next
+	int Refs;			// number of ways this instruction can be reached
+	bool FallsThrough;
+};
+
+//==========================================================================
+//
+// DLevelScript :: DecodeInstr
+//
+// Decodes the instruction at the reader's position. Operands are appended
+// to args as full words, and instructions with byte-sized operands are
+// replaced by their full-sized versions. Returns false if execution can't
+// continue with the next instruction.
+//
+//==========================================================================
+
+bool DLevelScript::DecodeInstr (FACSCodeReader &reader, FACSDecodedInstr &instr, TArray<int> &args)
+{
+	int i, count;
+	int words = 0;
+
+	instr.Op = reader.Opcode();
+	if (instr.Op < 0 || instr.Op >= PCODE_COMMAND_COUNT)
+	{
+		args.Push(instr.Op);
+		instr.Op = PCD_BADPCODE;
+		return false;
+	}
+
+	switch (instr.Op)
+	{
+	case PCD_TERMINATE:
+	case PCD_RESTART:
+	case PCD_GOTOSTACK:
+	case PCD_RETURNVOID:
+	case PCD_RETURNVAL:
+		return false;
+
+	// RunScript does not implement these, so they end the script, too.
+	case PCD_PLAYERBLUESKULL:
+	case PCD_PLAYERREDSKULL:
+	case PCD_PLAYERYELLOWSKULL:
+	case PCD_PLAYERMASTERSKULL:
+	case PCD_PLAYERBLUECARD:
+	case PCD_PLAYERREDCARD:
+	case PCD_PLAYERYELLOWCARD:
+	case PCD_PLAYERMASTERCARD:
+	case PCD_PLAYERBLACKSKULL:
+	case PCD_PLAYERSILVERSKULL:
+	case PCD_PLAYERGOLDSKULL:
+	case PCD_PLAYERBLACKCARD:
+	case PCD_PLAYERSILVERCARD:
+	case PCD_PLAYERONTEAM:
+	case PCD_PLAYERTEAM:
+	case PCD_PLAYEREXPERT:
+	case PCD_BLUETEAMCOUNT:
+	case PCD_REDTEAMCOUNT:
+	case PCD_BLUETEAMSCORE:
+	case PCD_REDTEAMSCORE:
+	case PCD_ISONEFLAGCTF:
+	case PCD_LSPEC6:
+	case PCD_LSPEC6DIRECT:
+	case PCD_TEAM2FRAGPOINTS:
+	case PCD_SETSTYLE:
+	case PCD_SETSTYLEDIRECT:
+	case PCD_WRITETOINI:
+	case PCD_GETFROMINI:
+	case PCD_GRABINPUT:
+	case PCD_SETMOUSEPOINTER:
+	case PCD_MOVEMOUSEPOINTER:
+		return false;
+
+	case PCD_GOTO:
+		instr.FirstJump = 0;
+		args.Push(reader.Word());
+		return false;
+
+	case PCD_IFGOTO:
+	case PCD_IFNOTGOTO:
+		instr.FirstJump = 0;
+		words = 1;
+		break;
+
+	case PCD_CASEGOTO:
+		instr.FirstJump = 1;
+		words = 2;
+		break;
+
+	case PCD_CASEGOTOSORTED:
+		// The count and jump table are 4-byte aligned
+		reader.Pos = (reader.Pos + 3) & ~3;
+		count = reader.Word();
+		if (count < 0 || (reader.Pos <= reader.Size && (DWORD)count > (reader.Size - reader.Pos) / 8))
+		{
+			reader.Overrun = true;
+			break;
+		}
+		args.Push(count);
+		instr.FirstJump = 2;
+		instr.JumpStep = 2;
+		words = count * 2;
+		break;
+
+	// All pushes of constants become PCD_PUSHWORDS, so that runs of them
+	// can be merged later.
+	case PCD_PUSHNUMBER:
+		instr.Op = PCD_PUSHWORDS;
+		words = 1;
+		break;
+
+	case PCD_PUSHBYTE:
+		instr.Op = PCD_PUSHWORDS;
+		args.Push(reader.Byte());
+		break;
+
+	case PCD_PUSH2BYTES:
+	case PCD_PUSH3BYTES:
+	case PCD_PUSH4BYTES:
+	case PCD_PUSH5BYTES:
+		count = instr.Op - PCD_PUSH2BYTES + 2;
+		instr.Op = PCD_PUSHWORDS;
+		for (i = 0; i < count; ++i)
+		{
+			args.Push(reader.Byte());
+		}
+		break;
+
+	case PCD_PUSHBYTES:
+		count = reader.Byte();
+		instr.Op = PCD_PUSHWORDS;
+		for (i = 0; i < count; ++i)
+		{
+			args.Push(reader.Byte());
+		}
+		break;
+
+	// Parameters for PCD_LSPEC?DIRECTB are bytes, so they are the same as
+	// the PCD_LSPEC?DIRECT version after being and-ed with specialargmask.
+	case PCD_LSPEC1DIRECTB:
+	case PCD_LSPEC2DIRECTB:
+	case PCD_LSPEC3DIRECTB:
+	case PCD_LSPEC4DIRECTB:
+	case PCD_LSPEC5DIRECTB:
+		count = instr.Op - PCD_LSPEC1DIRECTB + 1;
+		instr.Op = PCD_LSPEC1DIRECT + count - 1;
+		for (i = 0; i <= count; ++i)
+		{
+			args.Push(reader.Byte());
+		}
+		break;
+
+	case PCD_DELAYDIRECTB:
+		instr.Op = PCD_DELAYDIRECT;
+		args.Push(reader.Byte());
+		break;
+
+	case PCD_RANDOMDIRECTB:
+		instr.Op = PCD_RANDOMDIRECT;
+		args.Push(reader.Byte());
+		args.Push(reader.Byte());
+		break;
+
+	case PCD_LSPEC1DIRECT:
+	case PCD_LSPEC2DIRECT:
+	case PCD_LSPEC3DIRECT:
+	case PCD_LSPEC4DIRECT:
+	case PCD_LSPEC5DIRECT:
+		args.Push(reader.ByteOp());
+		words = instr.Op - PCD_LSPEC1DIRECT + 1;
+		break;
+
+	case PCD_CALLFUNC:
+		args.Push(reader.ByteOp());
+		args.Push(reader.ShortOp());
+		break;
+
+	case PCD_LSPEC1:
+	case PCD_LSPEC2:
+	case PCD_LSPEC3:
+	case PCD_LSPEC4:
+	case PCD_LSPEC5:
+	case PCD_LSPEC5RESULT:
+	case PCD_PUSHFUNCTION:
+	case PCD_CALL:
+	case PCD_CALLDISCARD:
+	case PCD_ASSIGNSCRIPTVAR:
+	case PCD_ASSIGNMAPVAR:
+	case PCD_ASSIGNWORLDVAR:
+	case PCD_ASSIGNGLOBALVAR:
+	case PCD_ASSIGNSCRIPTARRAY:
+	case PCD_ASSIGNMAPARRAY:
+	case PCD_ASSIGNWORLDARRAY:
+	case PCD_ASSIGNGLOBALARRAY:
+	case PCD_PUSHSCRIPTVAR:
+	case PCD_PUSHMAPVAR:
+	case PCD_PUSHWORLDVAR:
+	case PCD_PUSHGLOBALVAR:
+	case PCD_PUSHSCRIPTARRAY:
+	case PCD_PUSHMAPARRAY:
+	case PCD_PUSHWORLDARRAY:
+	case PCD_PUSHGLOBALARRAY:
+	case PCD_ADDSCRIPTVAR:
+	case PCD_ADDMAPVAR:
+	case PCD_ADDWORLDVAR:
+	case PCD_ADDGLOBALVAR:
+	case PCD_ADDSCRIPTARRAY:
+	case PCD_ADDMAPARRAY:
+	case PCD_ADDWORLDARRAY:
+	case PCD_ADDGLOBALARRAY:
+	case PCD_SUBSCRIPTVAR:
+	case PCD_SUBMAPVAR:
+	case PCD_SUBWORLDVAR:
+	case PCD_SUBGLOBALVAR:
+	case PCD_SUBSCRIPTARRAY:
+	case PCD_SUBMAPARRAY:
+	case PCD_SUBWORLDARRAY:
+	case PCD_SUBGLOBALARRAY:
+	case PCD_MULSCRIPTVAR:
+	case PCD_MULMAPVAR:
+	case PCD_MULWORLDVAR:
+	case PCD_MULGLOBALVAR:
+	case PCD_MULSCRIPTARRAY:
+	case PCD_MULMAPARRAY:
+	case PCD_MULWORLDARRAY:
+	case PCD_MULGLOBALARRAY:
+	case PCD_DIVSCRIPTVAR:
+	case PCD_DIVMAPVAR:
+	case PCD_DIVWORLDVAR:
+	case PCD_DIVGLOBALVAR:
+	case PCD_DIVSCRIPTARRAY:
+	case PCD_DIVMAPARRAY:
+	case PCD_DIVWORLDARRAY:
+	case PCD_DIVGLOBALARRAY:
+	case PCD_MODSCRIPTVAR:
+	case PCD_MODMAPVAR:
+	case PCD_MODWORLDVAR:
+	case PCD_MODGLOBALVAR:
+	case PCD_MODSCRIPTARRAY:
+	case PCD_MODMAPARRAY:
+	case PCD_MODWORLDARRAY:
+	case PCD_MODGLOBALARRAY:
+	case PCD_ANDSCRIPTVAR:
+	case PCD_ANDMAPVAR:
+	case PCD_ANDWORLDVAR:
+	case PCD_ANDGLOBALVAR:
+	case PCD_ANDSCRIPTARRAY:
+	case PCD_ANDMAPARRAY:
+	case PCD_ANDWORLDARRAY:
+	case PCD_ANDGLOBALARRAY:
+	case PCD_EORSCRIPTVAR:
+	case PCD_EORMAPVAR:
+	case PCD_EORWORLDVAR:
+	case PCD_EORGLOBALVAR:
+	case PCD_EORSCRIPTARRAY:
+	case PCD_EORMAPARRAY:
+	case PCD_EORWORLDARRAY:
+	case PCD_EORGLOBALARRAY:
+	case PCD_ORSCRIPTVAR:
+	case PCD_ORMAPVAR:
+	case PCD_ORWORLDVAR:
+	case PCD_ORGLOBALVAR:
+	case PCD_ORSCRIPTARRAY:
+	case PCD_ORMAPARRAY:
+	case PCD_ORWORLDARRAY:
+	case PCD_ORGLOBALARRAY:
+	case PCD_LSSCRIPTVAR:
+	case PCD_LSMAPVAR:
+	case PCD_LSWORLDVAR:
+	case PCD_LSGLOBALVAR:
+	case PCD_LSSCRIPTARRAY:
+	case PCD_LSMAPARRAY:
+	case PCD_LSWORLDARRAY:
+	case PCD_LSGLOBALARRAY:
+	case PCD_RSSCRIPTVAR:
+	case PCD_RSMAPVAR:
+	case PCD_RSWORLDVAR:
+	case PCD_RSGLOBALVAR:
+	case PCD_RSSCRIPTARRAY:
+	case PCD_RSMAPARRAY:
+	case PCD_RSWORLDARRAY:
+	case PCD_RSGLOBALARRAY:
+	case PCD_INCSCRIPTVAR:
+	case PCD_INCMAPVAR:
+	case PCD_INCWORLDVAR:
+	case PCD_INCGLOBALVAR:
+	case PCD_INCSCRIPTARRAY:
+	case PCD_INCMAPARRAY:
+	case PCD_INCWORLDARRAY:
+	case PCD_INCGLOBALARRAY:
+	case PCD_DECSCRIPTVAR:
+	case PCD_DECMAPVAR:
+	case PCD_DECWORLDVAR:
+	case PCD_DECGLOBALVAR:
+	case PCD_DECSCRIPTARRAY:
+	case PCD_DECMAPARRAY:
+	case PCD_DECWORLDARRAY:
+	case PCD_DECGLOBALARRAY:
+		args.Push(reader.ByteOp());
+		break;
+
+	case PCD_LSPEC5EX:
+	case PCD_LSPEC5EXRESULT:
+	case PCD_DELAYDIRECT:
+	case PCD_TAGWAITDIRECT:
+	case PCD_POLYWAITDIRECT:
+	case PCD_SCRIPTWAITDIRECT:
+	case PCD_SETFONTDIRECT:
+	case PCD_SETGRAVITYDIRECT:
+	case PCD_SETAIRCONTROLDIRECT:
+	case PCD_CHECKINVENTORYDIRECT:
+		words = 1;
+		break;
+
+	case PCD_RANDOMDIRECT:
+	case PCD_THINGCOUNTDIRECT:
+	case PCD_CHANGEFLOORDIRECT:
+	case PCD_CHANGECEILINGDIRECT:
+	case PCD_GIVEINVENTORYDIRECT:
+	case PCD_TAKEINVENTORYDIRECT:
+		words = 2;
+		break;
+
+	case PCD_SETMUSICDIRECT:
+	case PCD_LOCALSETMUSICDIRECT:
+		words = 3;
+		break;
+
+	case PCD_SPAWNSPOTDIRECT:
+		words = 4;
+		break;
+
+	case PCD_SPAWNDIRECT:
+		words = 6;
+		break;
+
+	default:
+		break;
+	}
+	for (i = 0; i < words && !reader.Overrun; ++i)
+	{
+		args.Push(reader.Word());
+	}
+	return true;
+}
+
+static void QueueCode (TArray<int> &instrat, TArray<DWORD> &pending, DWORD ofs)
+{
+	if (ofs < instrat.Size() && instrat[ofs] == -1)
+	{
+		instrat[ofs] = -2;
+		pending.Push(ofs);
+	}
+}
+
+static void CountCodeRef (TArray<FACSDecodedInstr> &instrs, const TArray<int> &instrat, DWORD ofs)
+{
+	if (ofs < instrat.Size() && instrat[ofs] >= 0)
+	{
+		instrs[instrat[ofs]].Refs++;
+	}
+}
 
-inline int getbyte (int *&pc)
+// An instruction can only be merged into the one before it if that is
+// the only way to get to it.
+static inline bool CanMergeCode (const FACSDecodedInstr &prev, const FACSDecodedInstr &next)
 {
-	int res = *(BYTE *)pc;
-	pc = (int *)((BYTE *)pc+1);
-	return res;
+	return next.Refs == 1 && prev.FallsThrough && prev.Next == next.Ofs;
+}
+
+//==========================================================================
+//
+// DLevelScript :: TranslateCode
+//
+// Converts script code into the form RunScript executes: every opcode and
+// operand is one native int, so running it needs no knowledge of the
+// object's format, alignment or byte order. Jump operands hold the
+// distance from the operand to the target. Runs of pushed constants are
+// merged, and a comparison followed by PCD_IFNOTGOTO becomes a single
+// instruction.
+//
+// Only code that can be reached from one of the entry points is
+// translated. Code[0] is a PCD_TERMINATE that jumps to anything else lead
+// to. The offsets of the translated instructions are returned in byraw
+// and bycode. Returns the number of instructions decoded.
+//
+//==========================================================================
+
+unsigned int DLevelScript::TranslateCode (const BYTE *data, DWORD size, ACSFormat format, const TArray<DWORD> &entries,
+	TArray<int> &code, TArray<ACSInstrOffset> &byraw, TArray<ACSInstrOffset> &bycode)
+{
+	FACSCodeReader reader = { data, size, 0, format == ACS_LittleEnhanced, false };
+	TArray<FACSDecodedInstr> instrs;
+	TArray<int> args;
+	TArray<int> instrat;
+	TArray<int> order;
+	TArray<int> instrcode;
+	TArray<DWORD> pending;
+	TArray<ACSInstrOffset> fixups;
+	ACSInstrOffset where;
+	DWORD ofs;
+	unsigned int i, j;
+	int k, count;
+
+	code.Clear();
+	byraw.Clear();
+	bycode.Clear();
+
+	// Decode every instruction that can be reached, once each.
+	instrat.Resize(size);
+	for (ofs = 0; ofs < size; ++ofs)
+	{
+		instrat[ofs] = -1;
+	}
+	for (i = 0; i < entries.Size(); ++i)
+	{
+		QueueCode(instrat, pending, entries[i]);
+	}
+	while (pending.Pop(ofs))
+	{
+		FACSDecodedInstr instr;
+
+		reader.Pos = ofs;
+		reader.Overrun = false;
+		instr.Ofs = ofs;
+		instr.FirstArg = args.Size();
+		instr.FirstJump = -1;
+		instr.JumpStep = 1;
+		instr.Refs = 0;
+		instr.FallsThrough = DecodeInstr(reader, instr, args);
+		if (reader.Overrun)
+		{ // The instruction does not fit in the code.
+			args.Resize(instr.FirstArg);
+			instr.Op = PCD_TERMINATE;
+			instr.FirstJump = -1;
+			instr.FallsThrough = false;
+		}
+		instr.NumArgs = args.Size() - instr.FirstArg;
+		instr.Next = reader.Pos;
+		instrat[ofs] = instrs.Push(instr);
+
+		if (instr.FallsThrough)
+		{
+			QueueCode(instrat, pending, instr.Next);
+		}
+		if (instr.FirstJump >= 0)
+		{
+			for (k = instr.FirstJump; k < instr.NumArgs; k += instr.JumpStep)
+			{
+				QueueCode(instrat, pending, args[instr.FirstArg + k]);
+			}
+		}
+	}
+
+	// Count the ways each instruction can be reached.
+	for (i = 0; i < entries.Size(); ++i)
+	{
+		CountCodeRef(instrs, instrat, entries[i]);
+	}
+	for (i = 0; i < instrs.Size(); ++i)
+	{
+		if (instrs[i].FallsThrough)
+		{
+			CountCodeRef(instrs, instrat, instrs[i].Next);
+		}
+		if (instrs[i].FirstJump >= 0)
+		{
+			for (k = instrs[i].FirstJump; k < instrs[i].NumArgs; k += instrs[i].JumpStep)
+			{
+				CountCodeRef(instrs, instrat, args[instrs[i].FirstArg + k]);
+			}
+		}
+	}
+
+	// Keep the instructions in the order they are in the object, so that
+	// falling through to the next one rarely needs an extra jump.
+	for (ofs = 0; ofs < size; ++ofs)
+	{
+		if (instrat[ofs] >= 0)
+		{
+			order.Push(instrat[ofs]);
+		}
+	}
+
+	instrcode.Resize(instrs.Size());
+	for (i = 0; i < instrs.Size(); ++i)
+	{
+		instrcode[i] = -1;
+	}
+	code.Push(PCD_TERMINATE);
+
+	for (i = 0; i < order.Size(); i = j)
+	{
+		FACSDecodedInstr *instr = &instrs[order[i]];
+		int fused;
+
+		where.RawOfs = instr->Ofs;
+		where.CodeOfs = code.Size();
+		byraw.Push(where);
+		bycode.Push(where);
+		instrcode[order[i]] = code.Size();
+
+		switch (instr->Op)
+		{
+		case PCD_EQ:	fused = PCD_IFNOTEQGOTO;	break;
+		case PCD_NE:	fused = PCD_IFNOTNEGOTO;	break;
+		case PCD_LT:	fused = PCD_IFNOTLTGOTO;	break;
+		case PCD_GT:	fused = PCD_IFNOTGTGOTO;	break;
+		case PCD_LE:	fused = PCD_IFNOTLEGOTO;	break;
+		case PCD_GE:	fused = PCD_IFNOTGEGOTO;	break;
+		default:		fused = 0;					break;
+		}
+
+		j = i + 1;
+		if (instr->Op == PCD_PUSHWORDS)
+		{
+			count = instr->NumArgs;
+			while (j < order.Size() && instrs[order[j]].Op == PCD_PUSHWORDS &&
+				CanMergeCode(instrs[order[j-1]], instrs[order[j]]))
+			{
+				count += instrs[order[j]].NumArgs;
+				j++;
+			}
+			if (count == 1)
+			{
+				code.Push(PCD_PUSHNUMBER);
+			}
+			else
+			{
+				code.Push(PCD_PUSHWORDS);
+				code.Push(count);
+			}
+			for (; i < j; ++i)
+			{
+				FACSDecodedInstr *push = &instrs[order[i]];
+				for (k = 0; k < push->NumArgs; ++k)
+				{
+					code.Push(args[push->FirstArg + k]);
+				}
+			}
+		}
+		else if (fused != 0 && j < order.Size() && instrs[order[j]].Op == PCD_IFNOTGOTO &&
+			CanMergeCode(*instr, instrs[order[j]]))
+		{
+			where.RawOfs = args[instrs[order[j]].FirstArg];
+			where.CodeOfs = code.Size() + 1;
+			fixups.Push(where);
+			code.Push(fused);
+			code.Push(0);
+			j++;
+		}
+		else
+		{
+			code.Push(instr->Op);
+			for (k = 0; k < instr->NumArgs; ++k)
+			{
+				if (instr->FirstJump >= 0 && k >= instr->FirstJump && (k - instr->FirstJump) % instr->JumpStep == 0)
+				{
+					where.RawOfs = args[instr->FirstArg + k];
+					where.CodeOfs = code.Size();
+					fixups.Push(where);
+				}
+				code.Push(args[instr->FirstArg + k]);
+			}
+		}
+
+		// If the next instruction was laid out somewhere else, jump to it.
+		instr = &instrs[order[j-1]];
+		if (instr->FallsThrough && (j == order.Size() || instrs[order[j]].Ofs != instr->Next))
+		{
+			where.RawOfs = instr->Next;
+			where.CodeOfs = code.Size();
+			bycode.Push(where);
+			code.Push(PCD_GOTO);
+			where.CodeOfs = code.Size();
+			fixups.Push(where);
+			code.Push(0);
+		}
+	}
+
+	// Jumps to anywhere that is not an instruction go to the PCD_TERMINATE at 0.
+	for (i = 0; i < fixups.Size(); ++i)
+	{
+		int target = 0;
+
+		ofs = fixups[i].RawOfs;
+		if (ofs < size && instrat[ofs] >= 0 && instrcode[instrat[ofs]] >= 0)
+		{
+			target = instrcode[instrat[ofs]];
+		}
+		code[fixups[i].CodeOfs] = target - (int)fixups[i].CodeOfs;
+	}
+	return instrs.Size();
 }
 
-inline int getshort (int *&pc)
-{
-	int res = LittleShort( *(SWORD *)pc);
-	pc = (int *)((BYTE *)pc+2);
-	return res;
-}
+// Every operand of translated code is a native word.
+#define NEXTWORD	(*pc++)
+#define NEXTBYTE	NEXTWORD
+#define NEXTSHORT	NEXTWORD
+#define STACK(a)	(Stack[sp - (a)])
+#define PushToStack(a)	(Stack[sp++] = (a))
+// Direct instructions that take strings need to have the tag applied.
+#define TAGSTR(a)	(a|activeBehavior->GetLibraryID())
+
+// GCC and Clang can jump straight to a p-code's case through a table of
+// label addresses. That saves the range check of the switch, and the jump
+// is easier for the CPU to predict. Other compilers just use the switch.
+#if defined(__GNUC__) && !defined(ACS_NO_COMPUTED_GOTO)
+#define ACS_COMPUTED_GOTO
+#define PCODE(op)		case op: TARGET_##op
+#define PCODE_DEFAULT	default: TARGET_default
+#else
+#define PCODE(op)		case op
+#define PCODE_DEFAULT	default
+#endif
 
 static bool CharArrayParms(int &capacity, int &offset, int &a, int *Stack, int &sp, bool ranged)
 {
@@ -6185,13 +7446,17 @@ int DLevelScript::RunScript ()
 	// Hexen truncates all special arguments to bytes (only when using an old MAPINFO and old ACS format
 	const int specialargmask = ((level.flags2 & LEVEL2_HEXENHACK) && activeBehavior->GetFormat() == ACS_Old) ? 255 : ~0;
 
+	// Keep the scheduler out of the way while the script runs; it gets
+	// rescheduled according to its state once it stops.
+	controller->Unschedule (this);
+
 	switch (state)
 	{
 	case SCRIPT_Delayed:
-		// Decrement the delay counter and enter state running
-		// if it hits 0
-		if (--statedata == 0)
-			state = SCRIPT_Running;
+		// The timer only brings the script back once its delay has
+		// run out, so enter state running
+		statedata = 0;
+		state = SCRIPT_Running;
 		break;
 
 	case SCRIPT_TagWait:
@@ -6203,7 +7468,10 @@ int DLevelScript::RunScript ()
 		while ((secnum = it.Next()) >= 0)
 		{
 			if (sectors[secnum].floordata || sectors[secnum].ceilingdata)
+			{
+				controller->Schedule (this, false);
 				return resultValue;
+			}
 		}
 
 		// If we got here, none of the tagged sectors were busy
@@ -6228,7 +7496,10 @@ int DLevelScript::RunScript ()
 	case SCRIPT_ScriptWait:
 		// Wait for a script to stop running, then enter state running
 		if (controller->RunningScripts.CheckKey(statedata) != NULL)
+		{
+			controller->Schedule (this, false);
 			return resultValue;
+		}
 
 		state = SCRIPT_Running;
 		PutFirst ();
@@ -6251,6 +7522,21 @@ int DLevelScript::RunScript ()
 	const char *lookup;
 	int optstart = -1;
 	int temp;
+	bool ran = (state == SCRIPT_Running);
+
+#ifdef ACS_COMPUTED_GOTO
+	static void *Targets[PCD_BADPCODE + 1];
+	if (Targets[0] == NULL)
+	{
+		for (int i = 0; i <= PCD_BADPCODE; ++i)
+		{
+			Targets[i] = &&TARGET_default;
+		}
+#define xx(op)	Targets[op] = &&TARGET_##op;
+#include "p_acs_targets.h"
+#undef xx
+	}
+#endif
 
 	while (state == SCRIPT_Running)
 	{
@@ -6261,118 +7547,73 @@ int DLevelScript::RunScript ()
 			break;
 		}
 
-		if (fmt == ACS_LittleEnhanced)
-		{
-			pcd = getbyte(pc);
-			if (pcd >= 256-16)
-			{
-				pcd = (256-16) + ((pcd - (256-16)) << 8) + getbyte(pc);
-			}
-		}
-		else
-		{
-			pcd = NEXTWORD;
-		}
+		pcd = NEXTWORD;
 
+#ifdef ACS_COMPUTED_GOTO
+		// TranslateCode only emits p-codes up to PCD_BADPCODE.
+		goto *Targets[pcd];
+#endif
 		switch (pcd)
 		{
-		default:
+		PCODE(PCD_BADPCODE):
+			pcd = NEXTWORD;
+			// fall through
+		PCODE_DEFAULT:
 			Printf ("Unknown P-Code %d in %s\n", pcd, ScriptPresentation(script).GetChars());
 			activeBehavior = savedActiveBehavior;
 			// fall through
-		case PCD_TERMINATE:
+		PCODE(PCD_TERMINATE):
 			DPrintf ("%s finished\n", ScriptPresentation(script).GetChars());
 			state = SCRIPT_PleaseRemove;
 			break;
 
-		case PCD_NOP:
+		PCODE(PCD_NOP):
 			break;
 
-		case PCD_SUSPEND:
+		PCODE(PCD_SUSPEND):
 			state = SCRIPT_Suspended;
 			break;
 
-		case PCD_TAGSTRING:
+		PCODE(PCD_TAGSTRING):
 			//Stack[sp-1] |= activeBehavior->GetLibraryID();
 			Stack[sp-1] = GlobalACSStrings.AddString(activeBehavior->LookupString(Stack[sp-1]));
 			break;
 
-		case PCD_PUSHNUMBER:
-			PushToStack (uallong(pc[0]));
+		PCODE(PCD_PUSHNUMBER):
+			PushToStack (pc[0]);
 			pc++;
 			break;
 
-		case PCD_PUSHBYTE:
-			PushToStack (*(BYTE *)pc);
-			pc = (int *)((BYTE *)pc + 1);
-			break;
-
-		case PCD_PUSH2BYTES:
-			Stack[sp] = ((BYTE *)pc)[0];
-			Stack[sp+1] = ((BYTE *)pc)[1];
-			sp += 2;
-			pc = (int *)((BYTE *)pc + 2);
-			break;
-
-		case PCD_PUSH3BYTES:
-			Stack[sp] = ((BYTE *)pc)[0];
-			Stack[sp+1] = ((BYTE *)pc)[1];
-			Stack[sp+2] = ((BYTE *)pc)[2];
-			sp += 3;
-			pc = (int *)((BYTE *)pc + 3);
-			break;
-
-		case PCD_PUSH4BYTES:
-			Stack[sp] = ((BYTE *)pc)[0];
-			Stack[sp+1] = ((BYTE *)pc)[1];
-			Stack[sp+2] = ((BYTE *)pc)[2];
-			Stack[sp+3] = ((BYTE *)pc)[3];
-			sp += 4;
-			pc = (int *)((BYTE *)pc + 4);
-			break;
-
-		case PCD_PUSH5BYTES:
-			Stack[sp] = ((BYTE *)pc)[0];
-			Stack[sp+1] = ((BYTE *)pc)[1];
-			Stack[sp+2] = ((BYTE *)pc)[2];
-			Stack[sp+3] = ((BYTE *)pc)[3];
-			Stack[sp+4] = ((BYTE *)pc)[4];
-			sp += 5;
-			pc = (int *)((BYTE *)pc + 5);
-			break;
-
-		case PCD_PUSHBYTES:
-			temp = *(BYTE *)pc;
-			pc = (int *)((BYTE *)pc + temp + 1);
-			for (temp = -temp; temp; temp++)
-			{
-				PushToStack (*((BYTE *)pc + temp));
-			}
+		PCODE(PCD_PUSHWORDS):
+			temp = NEXTWORD;
+			memcpy(&Stack[sp], pc, temp * sizeof(int));
+			sp += temp;
+			pc += temp;
 			break;
 
-		case PCD_DUP:
+		PCODE(PCD_DUP):
 			Stack[sp] = Stack[sp-1];
 			sp++;
 			break;
 
-		case PCD_SWAP:
+		PCODE(PCD_SWAP):
 			swapvalues(Stack[sp-2], Stack[sp-1]);
 			break;
 
-		case PCD_LSPEC1:
+		PCODE(PCD_LSPEC1):
 			P_ExecuteSpecial(NEXTBYTE, activationline, activator, backSide,
 									STACK(1) & specialargmask, 0, 0, 0, 0);
 			sp -= 1;
 			break;
 
-		case PCD_LSPEC2:
+		PCODE(PCD_LSPEC2):
 			P_ExecuteSpecial(NEXTBYTE, activationline, activator, backSide,
 									STACK(2) & specialargmask,
 									STACK(1) & specialargmask, 0, 0, 0);
 			sp -= 2;
 			break;
 
-		case PCD_LSPEC3:
+		PCODE(PCD_LSPEC3):
 			P_ExecuteSpecial(NEXTBYTE, activationline, activator, backSide,
 									STACK(3) & specialargmask,
 									STACK(2) & specialargmask,
@@ -6380,7 +7621,7 @@ int DLevelScript::RunScript ()
 			sp -= 3;
 			break;
 
-		case PCD_LSPEC4:
+		PCODE(PCD_LSPEC4):
 			P_ExecuteSpecial(NEXTBYTE, activationline, activator, backSide,
 									STACK(4) & specialargmask,
 									STACK(3) & specialargmask,
@@ -6389,7 +7630,7 @@ int DLevelScript::RunScript ()
 			sp -= 4;
 			break;
 
-		case PCD_LSPEC5:
+		PCODE(PCD_LSPEC5):
 			P_ExecuteSpecial(NEXTBYTE, activationline, activator, backSide,
 									STACK(5) & specialargmask,
 									STACK(4) & specialargmask,
@@ -6399,7 +7640,7 @@ int DLevelScript::RunScript ()
 			sp -= 5;
 			break;
 
-		case PCD_LSPEC5RESULT:
+		PCODE(PCD_LSPEC5RESULT):
 			STACK(5) = P_ExecuteSpecial(NEXTBYTE, activationline, activator, backSide,
 									STACK(5) & specialargmask,
 									STACK(4) & specialargmask,
@@ -6409,7 +7650,7 @@ int DLevelScript::RunScript ()
 			sp -= 4;
 			break;
 
-		case PCD_LSPEC5EX:
+		PCODE(PCD_LSPEC5EX):
 			P_ExecuteSpecial(NEXTWORD, activationline, activator, backSide,
 									STACK(5) & specialargmask,
 									STACK(4) & specialargmask,
@@ -6419,7 +7660,7 @@ int DLevelScript::RunScript ()
 			sp -= 5;
 			break;
 
-		case PCD_LSPEC5EXRESULT:
+		PCODE(PCD_LSPEC5EXRESULT):
 			STACK(5) = P_ExecuteSpecial(NEXTWORD, activationline, activator, backSide,
 									STACK(5) & specialargmask,
 									STACK(4) & specialargmask,
@@ -6429,85 +7670,52 @@ int DLevelScript::RunScript ()
 			sp -= 4;
 			break;
 
-		case PCD_LSPEC1DIRECT:
+		PCODE(PCD_LSPEC1DIRECT):
 			temp = NEXTBYTE;
 			P_ExecuteSpecial(temp, activationline, activator, backSide,
-								uallong(pc[0]) & specialargmask ,0, 0, 0, 0);
+								pc[0] & specialargmask ,0, 0, 0, 0);
 			pc += 1;
 			break;
 
-		case PCD_LSPEC2DIRECT:
+		PCODE(PCD_LSPEC2DIRECT):
 			temp = NEXTBYTE;
 			P_ExecuteSpecial(temp, activationline, activator, backSide,
-								uallong(pc[0]) & specialargmask,
-								uallong(pc[1]) & specialargmask, 0, 0, 0);
+								pc[0] & specialargmask,
+								pc[1] & specialargmask, 0, 0, 0);
 			pc += 2;
 			break;
 
-		case PCD_LSPEC3DIRECT:
+		PCODE(PCD_LSPEC3DIRECT):
 			temp = NEXTBYTE;
 			P_ExecuteSpecial(temp, activationline, activator, backSide,
-								uallong(pc[0]) & specialargmask,
-								uallong(pc[1]) & specialargmask,
-								uallong(pc[2]) & specialargmask, 0, 0);
+								pc[0] & specialargmask,
+								pc[1] & specialargmask,
+								pc[2] & specialargmask, 0, 0);
 			pc += 3;
 			break;
 
-		case PCD_LSPEC4DIRECT:
+		PCODE(PCD_LSPEC4DIRECT):
 			temp = NEXTBYTE;
 			P_ExecuteSpecial(temp, activationline, activator, backSide,
-								uallong(pc[0]) & specialargmask,
-								uallong(pc[1]) & specialargmask,
-								uallong(pc[2]) & specialargmask,
-								uallong(pc[3]) & specialargmask, 0);
+								pc[0] & specialargmask,
+								pc[1] & specialargmask,
+								pc[2] & specialargmask,
+								pc[3] & specialargmask, 0);
 			pc += 4;
 			break;
 
-		case PCD_LSPEC5DIRECT:
+		PCODE(PCD_LSPEC5DIRECT):
 			temp = NEXTBYTE;
 			P_ExecuteSpecial(temp, activationline, activator, backSide,
-								uallong(pc[0]) & specialargmask,
-								uallong(pc[1]) & specialargmask,
-								uallong(pc[2]) & specialargmask,
-								uallong(pc[3]) & specialargmask,
-								uallong(pc[4]) & specialargmask);
+								pc[0] & specialargmask,
+								pc[1] & specialargmask,
+								pc[2] & specialargmask,
+								pc[3] & specialargmask,
+								pc[4] & specialargmask);
 			pc += 5;
 			break;
 
-		// Parameters for PCD_LSPEC?DIRECTB are by definition bytes so never need and-ing.
-		case PCD_LSPEC1DIRECTB:
-			P_ExecuteSpecial(((BYTE *)pc)[0], activationline, activator, backSide,
-				((BYTE *)pc)[1], 0, 0, 0, 0);
-			pc = (int *)((BYTE *)pc + 2);
-			break;
-
-		case PCD_LSPEC2DIRECTB:
-			P_ExecuteSpecial(((BYTE *)pc)[0], activationline, activator, backSide,
-				((BYTE *)pc)[1], ((BYTE *)pc)[2], 0, 0, 0);
-			pc = (int *)((BYTE *)pc + 3);
-			break;
-
-		case PCD_LSPEC3DIRECTB:
-			P_ExecuteSpecial(((BYTE *)pc)[0], activationline, activator, backSide,
-				((BYTE *)pc)[1], ((BYTE *)pc)[2], ((BYTE *)pc)[3], 0, 0);
-			pc = (int *)((BYTE *)pc + 4);
-			break;
-
-		case PCD_LSPEC4DIRECTB:
-			P_ExecuteSpecial(((BYTE *)pc)[0], activationline, activator, backSide,
-				((BYTE *)pc)[1], ((BYTE *)pc)[2], ((BYTE *)pc)[3],
-				((BYTE *)pc)[4], 0);
-			pc = (int *)((BYTE *)pc + 5);
-			break;
-
-		case PCD_LSPEC5DIRECTB:
-			P_ExecuteSpecial(((BYTE *)pc)[0], activationline, activator, backSide,
-				((BYTE *)pc)[1], ((BYTE *)pc)[2], ((BYTE *)pc)[3],
-				((BYTE *)pc)[4], ((BYTE *)pc)[5]);
-			pc = (int *)((BYTE *)pc + 6);
-			break;
-
-		case PCD_CALLFUNC:
+		PCODE(PCD_CALLFUNC):
 			{
 				int argCount = NEXTBYTE;
 				int funcIndex = NEXTSHORT;
@@ -6518,16 +7726,16 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_PUSHFUNCTION:
+		PCODE(PCD_PUSHFUNCTION):
 		{
 			int funcnum = NEXTBYTE;
 			// Not technically a string, but since we use the same tagging mechanism
 			PushToStack(TAGSTR(funcnum));
 			break;
 		}
-		case PCD_CALL:
-		case PCD_CALLDISCARD:
-		case PCD_CALLSTACK:
+		PCODE(PCD_CALL):
+		PCODE(PCD_CALLDISCARD):
+		PCODE(PCD_CALLSTACK):
 			{
 				int funcnum;
 				int i;
@@ -6582,8 +7790,8 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_RETURNVOID:
-		case PCD_RETURNVAL:
+		PCODE(PCD_RETURNVOID):
+		PCODE(PCD_RETURNVAL):
 			{
 				int value;
 				union
@@ -6618,22 +7826,22 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_ADD:
+		PCODE(PCD_ADD):
 			STACK(2) = STACK(2) + STACK(1);
 			sp--;
 			break;
 
-		case PCD_SUBTRACT:
+		PCODE(PCD_SUBTRACT):
 			STACK(2) = STACK(2) - STACK(1);
 			sp--;
 			break;
 
-		case PCD_MULTIPLY:
+		PCODE(PCD_MULTIPLY):
 			STACK(2) = STACK(2) * STACK(1);
 			sp--;
 			break;
 
-		case PCD_DIVIDE:
+		PCODE(PCD_DIVIDE):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -6645,7 +7853,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_MODULUS:
+		PCODE(PCD_MODULUS):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -6657,130 +7865,130 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_EQ:
+		PCODE(PCD_EQ):
 			STACK(2) = (STACK(2) == STACK(1));
 			sp--;
 			break;
 
-		case PCD_NE:
+		PCODE(PCD_NE):
 			STACK(2) = (STACK(2) != STACK(1));
 			sp--;
 			break;
 
-		case PCD_LT:
+		PCODE(PCD_LT):
 			STACK(2) = (STACK(2) < STACK(1));
 			sp--;
 			break;
 
-		case PCD_GT:
+		PCODE(PCD_GT):
 			STACK(2) = (STACK(2) > STACK(1));
 			sp--;
 			break;
 
-		case PCD_LE:
+		PCODE(PCD_LE):
 			STACK(2) = (STACK(2) <= STACK(1));
 			sp--;
 			break;
 
-		case PCD_GE:
+		PCODE(PCD_GE):
 			STACK(2) = (STACK(2) >= STACK(1));
 			sp--;
 			break;
 
-		case PCD_ASSIGNSCRIPTVAR:
+		PCODE(PCD_ASSIGNSCRIPTVAR):
 			locals[NEXTBYTE] = STACK(1);
 			sp--;
 			break;
 
 
-		case PCD_ASSIGNMAPVAR:
+		PCODE(PCD_ASSIGNMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) = STACK(1);
 			sp--;
 			break;
 
-		case PCD_ASSIGNWORLDVAR:
+		PCODE(PCD_ASSIGNWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] = STACK(1);
 			sp--;
 			break;
 
-		case PCD_ASSIGNGLOBALVAR:
+		PCODE(PCD_ASSIGNGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] = STACK(1);
 			sp--;
 			break;
 
-		case PCD_ASSIGNSCRIPTARRAY:
+		PCODE(PCD_ASSIGNSCRIPTARRAY):
 			localarrays->Set(locals, NEXTBYTE, STACK(2), STACK(1));
 			sp -= 2;
 			break;
 
-		case PCD_ASSIGNMAPARRAY:
+		PCODE(PCD_ASSIGNMAPARRAY):
 			activeBehavior->SetArrayVal (*(activeBehavior->MapVars[NEXTBYTE]), STACK(2), STACK(1));
 			sp -= 2;
 			break;
 
-		case PCD_ASSIGNWORLDARRAY:
+		PCODE(PCD_ASSIGNWORLDARRAY):
 			ACS_WorldArrays[NEXTBYTE][STACK(2)] = STACK(1);
 			sp -= 2;
 			break;
 
-		case PCD_ASSIGNGLOBALARRAY:
+		PCODE(PCD_ASSIGNGLOBALARRAY):
 			ACS_GlobalArrays[NEXTBYTE][STACK(2)] = STACK(1);
 			sp -= 2;
 			break;
 
-		case PCD_PUSHSCRIPTVAR:
+		PCODE(PCD_PUSHSCRIPTVAR):
 			PushToStack (locals[NEXTBYTE]);
 			break;
 
-		case PCD_PUSHMAPVAR:
+		PCODE(PCD_PUSHMAPVAR):
 			PushToStack (*(activeBehavior->MapVars[NEXTBYTE]));
 			break;
 
-		case PCD_PUSHWORLDVAR:
+		PCODE(PCD_PUSHWORLDVAR):
 			PushToStack (ACS_WorldVars[NEXTBYTE]);
 			break;
 
-		case PCD_PUSHGLOBALVAR:
+		PCODE(PCD_PUSHGLOBALVAR):
 			PushToStack (ACS_GlobalVars[NEXTBYTE]);
 			break;
 
-		case PCD_PUSHSCRIPTARRAY:
+		PCODE(PCD_PUSHSCRIPTARRAY):
 			STACK(1) = localarrays->Get(locals, NEXTBYTE, STACK(1));
 			break;
 
-		case PCD_PUSHMAPARRAY:
+		PCODE(PCD_PUSHMAPARRAY):
 			STACK(1) = activeBehavior->GetArrayVal (*(activeBehavior->MapVars[NEXTBYTE]), STACK(1));
 			break;
 
-		case PCD_PUSHWORLDARRAY:
+		PCODE(PCD_PUSHWORLDARRAY):
 			STACK(1) = ACS_WorldArrays[NEXTBYTE][STACK(1)];
 			break;
 
-		case PCD_PUSHGLOBALARRAY:
+		PCODE(PCD_PUSHGLOBALARRAY):
 			STACK(1) = ACS_GlobalArrays[NEXTBYTE][STACK(1)];
 			break;
 
-		case PCD_ADDSCRIPTVAR:
+		PCODE(PCD_ADDSCRIPTVAR):
 			locals[NEXTBYTE] += STACK(1);
 			sp--;
 			break;
 
-		case PCD_ADDMAPVAR:
+		PCODE(PCD_ADDMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) += STACK(1);
 			sp--;
 			break;
 
-		case PCD_ADDWORLDVAR:
+		PCODE(PCD_ADDWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] += STACK(1);
 			sp--;
 			break;
 
-		case PCD_ADDGLOBALVAR:
+		PCODE(PCD_ADDGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] += STACK(1);
 			sp--;
 			break;
 
-		case PCD_ADDSCRIPTARRAY:
+		PCODE(PCD_ADDSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(2);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) + STACK(1));
@@ -6788,7 +7996,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_ADDMAPARRAY:
+		PCODE(PCD_ADDMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(2);
@@ -6797,7 +8005,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_ADDWORLDARRAY:
+		PCODE(PCD_ADDWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] += STACK(1);
@@ -6805,7 +8013,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_ADDGLOBALARRAY:
+		PCODE(PCD_ADDGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] += STACK(1);
@@ -6813,27 +8021,27 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_SUBSCRIPTVAR:
+		PCODE(PCD_SUBSCRIPTVAR):
 			locals[NEXTBYTE] -= STACK(1);
 			sp--;
 			break;
 
-		case PCD_SUBMAPVAR:
+		PCODE(PCD_SUBMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) -= STACK(1);
 			sp--;
 			break;
 
-		case PCD_SUBWORLDVAR:
+		PCODE(PCD_SUBWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] -= STACK(1);
 			sp--;
 			break;
 
-		case PCD_SUBGLOBALVAR:
+		PCODE(PCD_SUBGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] -= STACK(1);
 			sp--;
 			break;
 
-		case PCD_SUBSCRIPTARRAY:
+		PCODE(PCD_SUBSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(2);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) - STACK(1));
@@ -6841,7 +8049,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_SUBMAPARRAY:
+		PCODE(PCD_SUBMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(2);
@@ -6850,7 +8058,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_SUBWORLDARRAY:
+		PCODE(PCD_SUBWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] -= STACK(1);
@@ -6858,7 +8066,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_SUBGLOBALARRAY:
+		PCODE(PCD_SUBGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] -= STACK(1);
@@ -6866,27 +8074,27 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_MULSCRIPTVAR:
+		PCODE(PCD_MULSCRIPTVAR):
 			locals[NEXTBYTE] *= STACK(1);
 			sp--;
 			break;
 
-		case PCD_MULMAPVAR:
+		PCODE(PCD_MULMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) *= STACK(1);
 			sp--;
 			break;
 
-		case PCD_MULWORLDVAR:
+		PCODE(PCD_MULWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] *= STACK(1);
 			sp--;
 			break;
 
-		case PCD_MULGLOBALVAR:
+		PCODE(PCD_MULGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] *= STACK(1);
 			sp--;
 			break;
 
-		case PCD_MULSCRIPTARRAY:
+		PCODE(PCD_MULSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(2);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) * STACK(1));
@@ -6894,7 +8102,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_MULMAPARRAY:
+		PCODE(PCD_MULMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(2);
@@ -6903,7 +8111,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_MULWORLDARRAY:
+		PCODE(PCD_MULWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] *= STACK(1);
@@ -6911,7 +8119,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_MULGLOBALARRAY:
+		PCODE(PCD_MULGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] *= STACK(1);
@@ -6919,7 +8127,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_DIVSCRIPTVAR:
+		PCODE(PCD_DIVSCRIPTVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -6931,7 +8139,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_DIVMAPVAR:
+		PCODE(PCD_DIVMAPVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -6943,7 +8151,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_DIVWORLDVAR:
+		PCODE(PCD_DIVWORLDVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -6955,7 +8163,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_DIVGLOBALVAR:
+		PCODE(PCD_DIVGLOBALVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -6967,7 +8175,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_DIVSCRIPTARRAY:
+		PCODE(PCD_DIVSCRIPTARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -6980,7 +8188,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_DIVMAPARRAY:
+		PCODE(PCD_DIVMAPARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -6994,7 +8202,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_DIVWORLDARRAY:
+		PCODE(PCD_DIVWORLDARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -7007,7 +8215,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_DIVGLOBALARRAY:
+		PCODE(PCD_DIVGLOBALARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -7020,7 +8228,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_MODSCRIPTVAR:
+		PCODE(PCD_MODSCRIPTVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7032,7 +8240,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_MODMAPVAR:
+		PCODE(PCD_MODMAPVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7044,7 +8252,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_MODWORLDVAR:
+		PCODE(PCD_MODWORLDVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7056,7 +8264,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_MODGLOBALVAR:
+		PCODE(PCD_MODGLOBALVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7068,7 +8276,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_MODSCRIPTARRAY:
+		PCODE(PCD_MODSCRIPTARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7081,7 +8289,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_MODMAPARRAY:
+		PCODE(PCD_MODMAPARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7095,7 +8303,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_MODWORLDARRAY:
+		PCODE(PCD_MODWORLDARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7108,7 +8316,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_MODGLOBALARRAY:
+		PCODE(PCD_MODGLOBALARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7122,27 +8330,27 @@ int DLevelScript::RunScript ()
 			break;
 
 		//[MW] start
-		case PCD_ANDSCRIPTVAR:
+		PCODE(PCD_ANDSCRIPTVAR):
 			locals[NEXTBYTE] &= STACK(1);
 			sp--;
 			break;
 
-		case PCD_ANDMAPVAR:
+		PCODE(PCD_ANDMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) &= STACK(1);
 			sp--;
 			break;
 
-		case PCD_ANDWORLDVAR:
+		PCODE(PCD_ANDWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] &= STACK(1);
 			sp--;
 			break;
 
-		case PCD_ANDGLOBALVAR:
+		PCODE(PCD_ANDGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] &= STACK(1);
 			sp--;
 			break;
 
-		case PCD_ANDSCRIPTARRAY:
+		PCODE(PCD_ANDSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(2);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) & STACK(1));
@@ -7150,7 +8358,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_ANDMAPARRAY:
+		PCODE(PCD_ANDMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(2);
@@ -7159,7 +8367,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_ANDWORLDARRAY:
+		PCODE(PCD_ANDWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] &= STACK(1);
@@ -7167,7 +8375,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_ANDGLOBALARRAY:
+		PCODE(PCD_ANDGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] &= STACK(1);
@@ -7175,27 +8383,27 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_EORSCRIPTVAR:
+		PCODE(PCD_EORSCRIPTVAR):
 			locals[NEXTBYTE] ^= STACK(1);
 			sp--;
 			break;
 
-		case PCD_EORMAPVAR:
+		PCODE(PCD_EORMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) ^= STACK(1);
 			sp--;
 			break;
 
-		case PCD_EORWORLDVAR:
+		PCODE(PCD_EORWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] ^= STACK(1);
 			sp--;
 			break;
 
-		case PCD_EORGLOBALVAR:
+		PCODE(PCD_EORGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] ^= STACK(1);
 			sp--;
 			break;
 
-		case PCD_EORSCRIPTARRAY:
+		PCODE(PCD_EORSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(2);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) ^ STACK(1));
@@ -7203,7 +8411,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_EORMAPARRAY:
+		PCODE(PCD_EORMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(2);
@@ -7212,7 +8420,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_EORWORLDARRAY:
+		PCODE(PCD_EORWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] ^= STACK(1);
@@ -7220,7 +8428,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_EORGLOBALARRAY:
+		PCODE(PCD_EORGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] ^= STACK(1);
@@ -7228,27 +8436,27 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_ORSCRIPTVAR:
+		PCODE(PCD_ORSCRIPTVAR):
 			locals[NEXTBYTE] |= STACK(1);
 			sp--;
 			break;
 
-		case PCD_ORMAPVAR:
+		PCODE(PCD_ORMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) |= STACK(1);
 			sp--;
 			break;
 
-		case PCD_ORWORLDVAR:
+		PCODE(PCD_ORWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] |= STACK(1);
 			sp--;
 			break;
 
-		case PCD_ORGLOBALVAR:
+		PCODE(PCD_ORGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] |= STACK(1);
 			sp--;
 			break;
 
-		case PCD_ORSCRIPTARRAY:
+		PCODE(PCD_ORSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(2);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) | STACK(1));
@@ -7256,7 +8464,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_ORMAPARRAY:
+		PCODE(PCD_ORMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(2);
@@ -7265,7 +8473,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_ORWORLDARRAY:
+		PCODE(PCD_ORWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] |= STACK(1);
@@ -7273,7 +8481,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_ORGLOBALARRAY:
+		PCODE(PCD_ORGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				int i = STACK(2);
@@ -7282,27 +8490,27 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_LSSCRIPTVAR:
+		PCODE(PCD_LSSCRIPTVAR):
 			locals[NEXTBYTE] <<= STACK(1);
 			sp--;
 			break;
 
-		case PCD_LSMAPVAR:
+		PCODE(PCD_LSMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) <<= STACK(1);
 			sp--;
 			break;
 
-		case PCD_LSWORLDVAR:
+		PCODE(PCD_LSWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] <<= STACK(1);
 			sp--;
 			break;
 
-		case PCD_LSGLOBALVAR:
+		PCODE(PCD_LSGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] <<= STACK(1);
 			sp--;
 			break;
 
-		case PCD_LSSCRIPTARRAY:
+		PCODE(PCD_LSSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(2);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) << STACK(1));
@@ -7310,7 +8518,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_LSMAPARRAY:
+		PCODE(PCD_LSMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(2);
@@ -7319,7 +8527,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_LSWORLDARRAY:
+		PCODE(PCD_LSWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] <<= STACK(1);
@@ -7327,7 +8535,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_LSGLOBALARRAY:
+		PCODE(PCD_LSGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] <<= STACK(1);
@@ -7335,27 +8543,27 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_RSSCRIPTVAR:
+		PCODE(PCD_RSSCRIPTVAR):
 			locals[NEXTBYTE] >>= STACK(1);
 			sp--;
 			break;
 
-		case PCD_RSMAPVAR:
+		PCODE(PCD_RSMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) >>= STACK(1);
 			sp--;
 			break;
 
-		case PCD_RSWORLDVAR:
+		PCODE(PCD_RSWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] >>= STACK(1);
 			sp--;
 			break;
 
-		case PCD_RSGLOBALVAR:
+		PCODE(PCD_RSGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] >>= STACK(1);
 			sp--;
 			break;
 
-		case PCD_RSSCRIPTARRAY:
+		PCODE(PCD_RSSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(2);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) >> STACK(1));
@@ -7363,7 +8571,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_RSMAPARRAY:
+		PCODE(PCD_RSMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(2);
@@ -7372,7 +8580,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_RSWORLDARRAY:
+		PCODE(PCD_RSWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] >>= STACK(1);
@@ -7380,7 +8588,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_RSGLOBALARRAY:
+		PCODE(PCD_RSGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] >>= STACK(1);
@@ -7389,23 +8597,23 @@ int DLevelScript::RunScript ()
 			break;
 		//[MW] end
 
-		case PCD_INCSCRIPTVAR:
+		PCODE(PCD_INCSCRIPTVAR):
 			++locals[NEXTBYTE];
 			break;
 
-		case PCD_INCMAPVAR:
+		PCODE(PCD_INCMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) += 1;
 			break;
 
-		case PCD_INCWORLDVAR:
+		PCODE(PCD_INCWORLDVAR):
 			++ACS_WorldVars[NEXTBYTE];
 			break;
 
-		case PCD_INCGLOBALVAR:
+		PCODE(PCD_INCGLOBALVAR):
 			++ACS_GlobalVars[NEXTBYTE];
 			break;
 
-		case PCD_INCSCRIPTARRAY:
+		PCODE(PCD_INCSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(1);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) + 1);
@@ -7413,7 +8621,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_INCMAPARRAY:
+		PCODE(PCD_INCMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(1);
@@ -7422,7 +8630,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_INCWORLDARRAY:
+		PCODE(PCD_INCWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(1)] += 1;
@@ -7430,7 +8638,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_INCGLOBALARRAY:
+		PCODE(PCD_INCGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(1)] += 1;
@@ -7438,23 +8646,23 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_DECSCRIPTVAR:
+		PCODE(PCD_DECSCRIPTVAR):
 			--locals[NEXTBYTE];
 			break;
 
-		case PCD_DECMAPVAR:
+		PCODE(PCD_DECMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) -= 1;
 			break;
 
-		case PCD_DECWORLDVAR:
+		PCODE(PCD_DECWORLDVAR):
 			--ACS_WorldVars[NEXTBYTE];
 			break;
 
-		case PCD_DECGLOBALVAR:
+		PCODE(PCD_DECGLOBALVAR):
 			--ACS_GlobalVars[NEXTBYTE];
 			break;
 
-		case PCD_DECSCRIPTARRAY:
+		PCODE(PCD_DECSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(1);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) - 1);
@@ -7462,7 +8670,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_DECMAPARRAY:
+		PCODE(PCD_DECMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(1);
@@ -7471,7 +8679,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_DECWORLDARRAY:
+		PCODE(PCD_DECWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(1)] -= 1;
@@ -7479,7 +8687,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_DECGLOBALARRAY:
+		PCODE(PCD_DECGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				int i = STACK(1);
@@ -7488,30 +8696,30 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_GOTO:
-			pc = activeBehavior->Ofs2PC (LittleLong(*pc));
+		PCODE(PCD_GOTO):
+			pc += *pc;
 			break;
 
-		case PCD_GOTOSTACK:
+		PCODE(PCD_GOTOSTACK):
 			pc = activeBehavior->Jump2PC (STACK(1));
 			sp--;
 			break;
 
-		case PCD_IFGOTO:
+		PCODE(PCD_IFGOTO):
 			if (STACK(1))
-				pc = activeBehavior->Ofs2PC (LittleLong(*pc));
+				pc += *pc;
 			else
 				pc++;
 			sp--;
 			break;
 
-		case PCD_SETRESULTVALUE:
+		PCODE(PCD_SETRESULTVALUE):
 			resultValue = STACK(1);
-		case PCD_DROP: //fall through.
+		PCODE(PCD_DROP): //fall through.
 			sp--;
 			break;
 
-		case PCD_DELAY:
+		PCODE(PCD_DELAY):
 			statedata = STACK(1) + (fmt == ACS_Old && gameinfo.gametype == GAME_Hexen);
 			if (statedata > 0)
 			{
@@ -7520,8 +8728,8 @@ int DLevelScript::RunScript ()
 			sp--;
 			break;
 
-		case PCD_DELAYDIRECT:
-			statedata = uallong(pc[0]) + (fmt == ACS_Old && gameinfo.gametype == GAME_Hexen);
+		PCODE(PCD_DELAYDIRECT):
+			statedata = pc[0] + (fmt == ACS_Old && gameinfo.gametype == GAME_Hexen);
 			pc++;
 			if (statedata > 0)
 			{
@@ -7529,100 +8737,86 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_DELAYDIRECTB:
-			statedata = *(BYTE *)pc + (fmt == ACS_Old && gameinfo.gametype == GAME_Hexen);
-			if (statedata > 0)
-			{
-				state = SCRIPT_Delayed;
-			}
-			pc = (int *)((BYTE *)pc + 1);
-			break;
-
-		case PCD_RANDOM:
+		PCODE(PCD_RANDOM):
 			STACK(2) = Random (STACK(2), STACK(1));
 			sp--;
 			break;
 
-		case PCD_RANDOMDIRECT:
-			PushToStack (Random (uallong(pc[0]), uallong(pc[1])));
+		PCODE(PCD_RANDOMDIRECT):
+			PushToStack (Random (pc[0], pc[1]));
 			pc += 2;
 			break;
 
-		case PCD_RANDOMDIRECTB:
-			PushToStack (Random (((BYTE *)pc)[0], ((BYTE *)pc)[1]));
-			pc = (int *)((BYTE *)pc + 2);
-			break;
-
-		case PCD_THINGCOUNT:
+		PCODE(PCD_THINGCOUNT):
 			STACK(2) = ThingCount (STACK(2), -1, STACK(1), -1);
 			sp--;
 			break;
 
-		case PCD_THINGCOUNTDIRECT:
-			PushToStack (ThingCount (uallong(pc[0]), -1, uallong(pc[1]), -1));
+		PCODE(PCD_THINGCOUNTDIRECT):
+			PushToStack (ThingCount (pc[0], -1, pc[1], -1));
 			pc += 2;
 			break;
 
-		case PCD_THINGCOUNTNAME:
+		PCODE(PCD_THINGCOUNTNAME):
 			STACK(2) = ThingCount (-1, STACK(2), STACK(1), -1);
 			sp--;
 			break;
 
-		case PCD_THINGCOUNTNAMESECTOR:
+		PCODE(PCD_THINGCOUNTNAMESECTOR):
 			STACK(3) = ThingCount (-1, STACK(3), STACK(2), STACK(1));
 			sp -= 2;
 			break;
 
-		case PCD_THINGCOUNTSECTOR:
+		PCODE(PCD_THINGCOUNTSECTOR):
 			STACK(3) = ThingCount (STACK(3), -1, STACK(2), STACK(1));
 			sp -= 2;
 			break;
 
-		case PCD_TAGWAIT:
+		PCODE(PCD_TAGWAIT):
 			state = SCRIPT_TagWait;
 			statedata = STACK(1);
 			sp--;
 			break;
 
-		case PCD_TAGWAITDIRECT:
+		PCODE(PCD_TAGWAITDIRECT):
 			state = SCRIPT_TagWait;
-			statedata = uallong(pc[0]);
+			statedata = pc[0];
 			pc++;
 			break;
 
-		case PCD_POLYWAIT:
+		PCODE(PCD_POLYWAIT):
 			state = SCRIPT_PolyWait;
 			statedata = STACK(1);
 			sp--;
 			break;
 
-		case PCD_POLYWAITDIRECT:
+		PCODE(PCD_POLYWAITDIRECT):
 			state = SCRIPT_PolyWait;
-			statedata = uallong(pc[0]);
+			statedata = pc[0];
 			pc++;
 			break;
 
-		case PCD_CHANGEFLOOR:
+		PCODE(PCD_CHANGEFLOOR):
 			ChangeFlat (STACK(2), STACK(1), 0);
 			sp -= 2;
 			break;
 
-		case PCD_CHANGEFLOORDIRECT:
-			ChangeFlat (uallong(pc[0]), TAGSTR(uallong(pc[1])), 0);
+		PCODE(PCD_CHANGEFLOORDIRECT):
+			ChangeFlat (pc[0], TAGSTR(pc[1]), 0);
 			pc += 2;
 			break;
 
-		case PCD_CHANGECEILING:
+		PCODE(PCD_CHANGECEILING):
 			ChangeFlat (STACK(2), STACK(1), 1);
 			sp -= 2;
 			break;
 
-		case PCD_CHANGECEILINGDIRECT:
-			ChangeFlat (uallong(pc[0]), TAGSTR(uallong(pc[1])), 1);
+		PCODE(PCD_CHANGECEILINGDIRECT):
+			ChangeFlat (pc[0], TAGSTR(pc[1]), 1);
 			pc += 2;
 			break;
 
-		case PCD_RESTART:
+		PCODE(PCD_RESTART):
 			{
 				const ScriptPtr *scriptp;
 
@@ -7631,69 +8825,118 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_ANDLOGICAL:
+		PCODE(PCD_ANDLOGICAL):
 			STACK(2) = (STACK(2) && STACK(1));
 			sp--;
 			break;
 
-		case PCD_ORLOGICAL:
+		PCODE(PCD_ORLOGICAL):
 			STACK(2) = (STACK(2) || STACK(1));
 			sp--;
 			break;
 
-		case PCD_ANDBITWISE:
+		PCODE(PCD_ANDBITWISE):
 			STACK(2) = (STACK(2) & STACK(1));
 			sp--;
 			break;
 
-		case PCD_ORBITWISE:
+		PCODE(PCD_ORBITWISE):
 			STACK(2) = (STACK(2) | STACK(1));
 			sp--;
 			break;
 
-		case PCD_EORBITWISE:
+		PCODE(PCD_EORBITWISE):
 			STACK(2) = (STACK(2) ^ STACK(1));
 			sp--;
 			break;
 
-		case PCD_NEGATELOGICAL:
+		PCODE(PCD_NEGATELOGICAL):
 			STACK(1) = !STACK(1);
 			break;
 
 
 
 
-		case PCD_NEGATEBINARY:
+		PCODE(PCD_NEGATEBINARY):
 			STACK(1) = ~STACK(1);
 			break;
 
-		case PCD_LSHIFT:
+		PCODE(PCD_LSHIFT):
 			STACK(2) = (STACK(2) << STACK(1));
 			sp--;
 			break;
 
-		case PCD_RSHIFT:
+		PCODE(PCD_RSHIFT):
 			STACK(2) = (STACK(2) >> STACK(1));
 			sp--;
 			break;
 
-		case PCD_UNARYMINUS:
+		PCODE(PCD_UNARYMINUS):
 			STACK(1) = -STACK(1);
 			break;
 
-		case PCD_IFNOTGOTO:
+		PCODE(PCD_IFNOTGOTO):
 			if (!STACK(1))
-				pc = activeBehavior->Ofs2PC (LittleLong(*pc));
+				pc += *pc;
 			else
 				pc++;
 			sp--;
 			break;
 
-		case PCD_LINESIDE:
+		// A comparison followed by PCD_IFNOTGOTO
+		PCODE(PCD_IFNOTEQGOTO):
+			if (!(STACK(2) == STACK(1)))
+				pc += *pc;
+			else
+				pc++;
+			sp -= 2;
+			break;
+
+		PCODE(PCD_IFNOTNEGOTO):
+			if (!(STACK(2) != STACK(1)))
+				pc += *pc;
+			else
+				pc++;
+			sp -= 2;
+			break;
+
+		PCODE(PCD_IFNOTLTGOTO):
+			if (!(STACK(2) < STACK(1)))
+				pc += *pc;
+			else
+				pc++;
+			sp -= 2;
+			break;
+
+		PCODE(PCD_IFNOTGTGOTO):
+			if (!(STACK(2) > STACK(1)))
+				pc += *pc;
+			else
+				pc++;
+			sp -= 2;
+			break;
+
+		PCODE(PCD_IFNOTLEGOTO):
+			if (!(STACK(2) <= STACK(1)))
+				pc += *pc;
+			else
+				pc++;
+			sp -= 2;
+			break;
+
+		PCODE(PCD_IFNOTGEGOTO):
+			if (!(STACK(2) >= STACK(1)))
+				pc += *pc;
+			else
+				pc++;
+			sp -= 2;
+			break;
+
+		PCODE(PCD_LINESIDE):
 			PushToStack (backSide);
 			break;
 
-		case PCD_SCRIPTWAIT:
+		PCODE(PCD_SCRIPTWAIT):
 			statedata = STACK(1);
 			sp--;
 scriptwait:
@@ -7704,17 +8947,17 @@ scriptwait:
 			PutLast ();
 			break;
 
-		case PCD_SCRIPTWAITDIRECT:
-			statedata = uallong(pc[0]);
+		PCODE(PCD_SCRIPTWAITDIRECT):
+			statedata = pc[0];
 			pc++;
 			goto scriptwait;
 
-		case PCD_SCRIPTWAITNAMED:
+		PCODE(PCD_SCRIPTWAITNAMED):
 			statedata = -FName(FBehavior::StaticLookupString(STACK(1)));
 			sp--;
 			goto scriptwait;
 
-		case PCD_CLEARLINESPECIAL:
+		PCODE(PCD_CLEARLINESPECIAL):
 			if (activationline != NULL)
 			{
 				activationline->special = 0;
@@ -7722,10 +8965,10 @@ scriptwait:
 			}
 			break;
 
-		case PCD_CASEGOTO:
-			if (STACK(1) == uallong(pc[0]))
+		PCODE(PCD_CASEGOTO):
+			if (STACK(1) == pc[0])
 			{
-				pc = activeBehavior->Ofs2PC (uallong(pc[1]));
+				pc += 1 + pc[1];
 				sp--;
 			}
 			else
@@ -7734,19 +8977,17 @@ scriptwait:
 			}
 			break;
 
-		case PCD_CASEGOTOSORTED:
-			// The count and jump table are 4-byte aligned
-			pc = (int *)(((size_t)pc + 3) & ~3);
+		PCODE(PCD_CASEGOTOSORTED):
 			{
-				int numcases = uallong(pc[0]); pc++;
+				int numcases = NEXTWORD;
 				int min = 0, max = numcases-1;
 				while (min <= max)
 				{
 					int mid = (min + max) / 2;
-					SDWORD caseval = LittleLong(pc[mid*2]);
+					SDWORD caseval = pc[mid*2];
 					if (caseval == STACK(1))
 					{
-						pc = activeBehavior->Ofs2PC (LittleLong(pc[mid*2+1]));
+						pc += mid*2+1 + pc[mid*2+1];
 						sp--;
 						break;
 					}
@@ -7767,12 +9008,12 @@ scriptwait:
 			}
 			break;
 
-		case PCD_BEGINPRINT:
+		PCODE(PCD_BEGINPRINT):
 			STRINGBUILDER_START(work);
 			break;
 
-		case PCD_PRINTSTRING:
-		case PCD_PRINTLOCALIZED:
+		PCODE(PCD_PRINTSTRING):
+		PCODE(PCD_PRINTLOCALIZED):
 			lookup = FBehavior::StaticLookupString (STACK(1));
 			if (pcd == PCD_PRINTLOCALIZED)
 			{
@@ -7785,36 +9026,36 @@ scriptwait:
 			--sp;
 			break;
 
-		case PCD_PRINTNUMBER:
+		PCODE(PCD_PRINTNUMBER):
 			work.AppendFormat ("%d", STACK(1));
 			--sp;
 			break;
 
-		case PCD_PRINTBINARY:
+		PCODE(PCD_PRINTBINARY):
 			IGNORE_FORMAT_PRE
 			work.AppendFormat ("%B", STACK(1));
 			IGNORE_FORMAT_POST
 			--sp;
 			break;
 
-		case PCD_PRINTHEX:
+		PCODE(PCD_PRINTHEX):
 			work.AppendFormat ("%X", STACK(1));
 			--sp;
 			break;
 
-		case PCD_PRINTCHARACTER:
+		PCODE(PCD_PRINTCHARACTER):
 			work += (char)STACK(1);
 			--sp;
 			break;
 
-		case PCD_PRINTFIXED:
+		PCODE(PCD_PRINTFIXED):
 			work.AppendFormat ("%g", FIXED2FLOAT(STACK(1)));
 			--sp;
 			break;
 
 		// [BC] Print activator's name
 		// [RH] Fancied up a bit
-		case PCD_PRINTNAME:
+		PCODE(PCD_PRINTNAME):
 			{
 				player_t *player = NULL;
 
@@ -7876,8 +9117,8 @@ scriptwait:
 			break;
 
 		// Print script character array
-		case PCD_PRINTSCRIPTCHARARRAY:
-		case PCD_PRINTSCRIPTCHRANGE:
+		PCODE(PCD_PRINTSCRIPTCHARARRAY):
+		PCODE(PCD_PRINTSCRIPTCHRANGE):
 			{
 				int capacity, offset, a, c;
 				if (CharArrayParms(capacity, offset, a, Stack, sp, pcd == PCD_PRINTSCRIPTCHRANGE))
@@ -7892,8 +9133,8 @@ scriptwait:
 			break;
 
 		// [JB] Print map character array
-		case PCD_PRINTMAPCHARARRAY:
-		case PCD_PRINTMAPCHRANGE:
+		PCODE(PCD_PRINTMAPCHARARRAY):
+		PCODE(PCD_PRINTMAPCHRANGE):
 			{
 				int capacity, offset, a, c;
 				if (CharArrayParms(capacity, offset, a, Stack, sp, pcd == PCD_PRINTMAPCHRANGE))
@@ -7908,8 +9149,8 @@ scriptwait:
 			break;
 
 		// [JB] Print world character array
-		case PCD_PRINTWORLDCHARARRAY:
-		case PCD_PRINTWORLDCHRANGE:
+		PCODE(PCD_PRINTWORLDCHARARRAY):
+		PCODE(PCD_PRINTWORLDCHRANGE):
 			{
 				int capacity, offset, a, c;
 				if (CharArrayParms(capacity, offset, a, Stack, sp, pcd == PCD_PRINTWORLDCHRANGE))
@@ -7924,8 +9165,8 @@ scriptwait:
 			break;
 
 		// [JB] Print global character array
-		case PCD_PRINTGLOBALCHARARRAY:
-		case PCD_PRINTGLOBALCHRANGE:
+		PCODE(PCD_PRINTGLOBALCHARARRAY):
+		PCODE(PCD_PRINTGLOBALCHRANGE):
 			{
 				int capacity, offset, a, c;
 				if (CharArrayParms(capacity, offset, a, Stack, sp, pcd == PCD_PRINTGLOBALCHRANGE))
@@ -7940,7 +9181,7 @@ scriptwait:
 			break;
 
 		// [GRB] Print key name(s) for a command
-		case PCD_PRINTBIND:
+		PCODE(PCD_PRINTBIND):
 			lookup = FBehavior::StaticLookupString (STACK(1));
 			if (lookup != NULL)
 			{
@@ -7958,10 +9199,10 @@ scriptwait:
 			--sp;
 			break;
 
-		case PCD_ENDPRINT:
-		case PCD_ENDPRINTBOLD:
-		case PCD_MOREHUDMESSAGE:
-		case PCD_ENDLOG:
+		PCODE(PCD_ENDPRINT):
+		PCODE(PCD_ENDPRINTBOLD):
+		PCODE(PCD_MOREHUDMESSAGE):
+		PCODE(PCD_ENDLOG):
 			if (pcd == PCD_ENDLOG)
 			{
 				Printf ("%s\n", work.GetChars());
@@ -7992,12 +9233,12 @@ scriptwait:
 			}
 			break;
 
-		case PCD_OPTHUDMESSAGE:
+		PCODE(PCD_OPTHUDMESSAGE):
 			optstart = sp;
 			break;
 
-		case PCD_ENDHUDMESSAGE:
-		case PCD_ENDHUDMESSAGEBOLD:
+		PCODE(PCD_ENDHUDMESSAGE):
+		PCODE(PCD_ENDHUDMESSAGEBOLD):
 			if (optstart == -1)
 			{
 				optstart = sp;
@@ -8103,21 +9344,21 @@ scriptwait:
 			sp = optstart-6;
 			break;
 
-		case PCD_SETFONT:
+		PCODE(PCD_SETFONT):
 			DoSetFont (STACK(1));
 			sp--;
 			break;
 
-		case PCD_SETFONTDIRECT:
-			DoSetFont (TAGSTR(uallong(pc[0])));
+		PCODE(PCD_SETFONTDIRECT):
+			DoSetFont (TAGSTR(pc[0]));
 			pc++;
 			break;
 
-		case PCD_PLAYERCOUNT:
+		PCODE(PCD_PLAYERCOUNT):
 			PushToStack (CountPlayers ());
 			break;
 
-		case PCD_GAMETYPE:
+		PCODE(PCD_GAMETYPE):
 			if (gamestate == GS_TITLELEVEL)
 				PushToStack (GAME_TITLE_MAP);
 			else if (deathmatch)
@@ -8128,19 +9369,19 @@ scriptwait:
 				PushToStack (GAME_SINGLE_PLAYER);
 			break;
 
-		case PCD_GAMESKILL:
+		PCODE(PCD_GAMESKILL):
 			PushToStack (G_SkillProperty(SKILLP_ACSReturn));
 			break;
 
 // [BC] Start ST PCD's
-		case PCD_PLAYERHEALTH:
+		PCODE(PCD_PLAYERHEALTH):
 			if (activator)
 				PushToStack (activator->health);
 			else
 				PushToStack (0);
 			break;
 
-		case PCD_PLAYERARMORPOINTS:
+		PCODE(PCD_PLAYERARMORPOINTS):
 			if (activator)
 			{
 				ABasicArmor *armor = activator->FindInventory<ABasicArmor>();
@@ -8152,14 +9393,14 @@ scriptwait:
 			}
 			break;
 
-		case PCD_PLAYERFRAGS:
+		PCODE(PCD_PLAYERFRAGS):
 			if (activator && activator->player)
 				PushToStack (activator->player->fragcount);
 			else
 				PushToStack (0);
 			break;
 
-		case PCD_MUSICCHANGE:
+		PCODE(PCD_MUSICCHANGE):
 			lookup = FBehavior::StaticLookupString (STACK(2));
 			if (lookup != NULL)
 			{
@@ -8168,16 +9409,16 @@ scriptwait:
 			sp -= 2;
 			break;
 
-		case PCD_SINGLEPLAYER:
+		PCODE(PCD_SINGLEPLAYER):
 			PushToStack (!netgame);
 			break;
 // [BC] End ST PCD's
 
-		case PCD_TIMER:
+		PCODE(PCD_TIMER):
 			PushToStack (level.time);
 			break;
 
-		case PCD_SECTORSOUND:
+		PCODE(PCD_SECTORSOUND):
 			lookup = FBehavior::StaticLookupString (STACK(2));
 			if (lookup != NULL)
 			{
@@ -8202,7 +9443,7 @@ scriptwait:
 			sp -= 2;
 			break;
 
-		case PCD_AMBIENTSOUND:
+		PCODE(PCD_AMBIENTSOUND):
 			lookup = FBehavior::StaticLookupString (STACK(2));
 			if (lookup != NULL)
 			{
@@ -8213,7 +9454,7 @@ scriptwait:
 			sp -= 2;
 			break;
 
-		case PCD_LOCALAMBIENTSOUND:
+		PCODE(PCD_LOCALAMBIENTSOUND):
 			lookup = FBehavior::StaticLookupString (STACK(2));
 			if (lookup != NULL && activator->CheckLocalView (consoleplayer))
 			{
@@ -8224,7 +9465,7 @@ scriptwait:
 			sp -= 2;
 			break;
 
-		case PCD_ACTIVATORSOUND:
+		PCODE(PCD_ACTIVATORSOUND):
 			lookup = FBehavior::StaticLookupString (STACK(2));
 			if (lookup != NULL)
 			{
@@ -8244,7 +9485,7 @@ scriptwait:
 			sp -= 2;
 			break;
 
-		case PCD_SOUNDSEQUENCE:
+		PCODE(PCD_SOUNDSEQUENCE):
 			lookup = FBehavior::StaticLookupString (STACK(1));
 			if (lookup != NULL)
 			{
@@ -8256,17 +9497,17 @@ scriptwait:
 			sp--;
 			break;
 
-		case PCD_SETLINETEXTURE:
+		PCODE(PCD_SETLINETEXTURE):
 			SetLineTexture (STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 4;
 			break;
 
-		case PCD_REPLACETEXTURES:
+		PCODE(PCD_REPLACETEXTURES):
 			ReplaceTextures (STACK(3), STACK(2), STACK(1));
 			sp -= 3;
 			break;
 
-		case PCD_SETLINEBLOCKING:
+		PCODE(PCD_SETLINEBLOCKING):
 			{
 				int line;
 
@@ -8302,7 +9543,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_SETLINEMONSTERBLOCKING:
+		PCODE(PCD_SETLINEMONSTERBLOCKING):
 			{
 				int line;
 
@@ -8319,7 +9560,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_SETLINESPECIAL:
+		PCODE(PCD_SETLINESPECIAL):
 			{
 				int linenum = -1;
 				int specnum = STACK(6);
@@ -8349,7 +9590,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_SETTHINGSPECIAL:
+		PCODE(PCD_SETTHINGSPECIAL):
 			{
 				int specnum = STACK(6);
 				int arg0 = STACK(5);
@@ -8389,7 +9630,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_THINGSOUND:
+		PCODE(PCD_THINGSOUND):
 			lookup = FBehavior::StaticLookupString (STACK(2));
 			if (lookup != NULL)
 			{
@@ -8406,68 +9647,68 @@ scriptwait:
 			sp -= 3;
 			break;
 
-		case PCD_FIXEDMUL:
+		PCODE(PCD_FIXEDMUL):
 			STACK(2) = FixedMul (STACK(2), STACK(1));
 			sp--;
 			break;
 
-		case PCD_FIXEDDIV:
+		PCODE(PCD_FIXEDDIV):
 			STACK(2) = FixedDiv (STACK(2), STACK(1));
 			sp--;
 			break;
 
-		case PCD_SETGRAVITY:
+		PCODE(PCD_SETGRAVITY):
 			level.gravity = (float)STACK(1) / 65536.f;
 			sp--;
 			break;
 
-		case PCD_SETGRAVITYDIRECT:
-			level.gravity = (float)uallong(pc[0]) / 65536.f;
+		PCODE(PCD_SETGRAVITYDIRECT):
+			level.gravity = (float)pc[0] / 65536.f;
 			pc++;
 			break;
 
-		case PCD_SETAIRCONTROL:
+		PCODE(PCD_SETAIRCONTROL):
 			level.aircontrol = STACK(1);
 			sp--;
 			G_AirControlChanged ();
 			break;
 
-		case PCD_SETAIRCONTROLDIRECT:
-			level.aircontrol = uallong(pc[0]);
+		PCODE(PCD_SETAIRCONTROLDIRECT):
+			level.aircontrol = pc[0];
 			pc++;
 			G_AirControlChanged ();
 			break;
 
-		case PCD_SPAWN:
+		PCODE(PCD_SPAWN):
 			STACK(6) = DoSpawn (STACK(6), STACK(5), STACK(4), STACK(3), STACK(2), STACK(1), false);
 			sp -= 5;
 			break;
 
-		case PCD_SPAWNDIRECT:
-			PushToStack (DoSpawn (TAGSTR(uallong(pc[0])), uallong(pc[1]), uallong(pc[2]), uallong(pc[3]), uallong(pc[4]), uallong(pc[5]), false));
+		PCODE(PCD_SPAWNDIRECT):
+			PushToStack (DoSpawn (TAGSTR(pc[0]), pc[1], pc[2], pc[3], pc[4], pc[5], false));
 			pc += 6;
 			break;
 
-		case PCD_SPAWNSPOT:
+		PCODE(PCD_SPAWNSPOT):
 			STACK(4) = DoSpawnSpot (STACK(4), STACK(3), STACK(2), STACK(1), false);
 			sp -= 3;
 			break;
 
-		case PCD_SPAWNSPOTDIRECT:
-			PushToStack (DoSpawnSpot (TAGSTR(uallong(pc[0])), uallong(pc[1]), uallong(pc[2]), uallong(pc[3]), false));
+		PCODE(PCD_SPAWNSPOTDIRECT):
+			PushToStack (DoSpawnSpot (TAGSTR(pc[0]), pc[1], pc[2], pc[3], false));
 			pc += 4;
 			break;
 
-		case PCD_SPAWNSPOTFACING:
+		PCODE(PCD_SPAWNSPOTFACING):
 			STACK(3) = DoSpawnSpotFacing (STACK(3), STACK(2), STACK(1), false);
 			sp -= 2;
 			break;
 
-		case PCD_CLEARINVENTORY:
+		PCODE(PCD_CLEARINVENTORY):
 			ClearInventory (activator);
 			break;
 
-		case PCD_CLEARACTORINVENTORY:
+		PCODE(PCD_CLEARACTORINVENTORY):
 			if (STACK(1) == 0)
 			{
 				ClearInventory(NULL);
@@ -8484,12 +9725,12 @@ scriptwait:
 			sp--;
 			break;
 
-		case PCD_GIVEINVENTORY:
+		PCODE(PCD_GIVEINVENTORY):
 			GiveInventory (activator, FBehavior::StaticLookupString (STACK(2)), STACK(1));
 			sp -= 2;
 			break;
 
-		case PCD_GIVEACTORINVENTORY:
+		PCODE(PCD_GIVEACTORINVENTORY):
 			{
 				const char *type = FBehavior::StaticLookupString(STACK(2));
 				if (STACK(3) == 0)
@@ -8509,17 +9750,17 @@ scriptwait:
 			}
 			break;
 
-		case PCD_GIVEINVENTORYDIRECT:
-			GiveInventory (activator, FBehavior::StaticLookupString (TAGSTR(uallong(pc[0]))), uallong(pc[1]));
+		PCODE(PCD_GIVEINVENTORYDIRECT):
+			GiveInventory (activator, FBehavior::StaticLookupString (TAGSTR(pc[0])), pc[1]);
 			pc += 2;
 			break;
 
-		case PCD_TAKEINVENTORY:
+		PCODE(PCD_TAKEINVENTORY):
 			TakeInventory (activator, FBehavior::StaticLookupString (STACK(2)), STACK(1));
 			sp -= 2;
 			break;
 
-		case PCD_TAKEACTORINVENTORY:
+		PCODE(PCD_TAKEACTORINVENTORY):
 			{
 				const char *type = FBehavior::StaticLookupString(STACK(2));
 				if (STACK(3) == 0)
@@ -8539,31 +9780,31 @@ scriptwait:
 			}
 			break;
 
-		case PCD_TAKEINVENTORYDIRECT:
-			TakeInventory (activator, FBehavior::StaticLookupString (TAGSTR(uallong(pc[0]))), uallong(pc[1]));
+		PCODE(PCD_TAKEINVENTORYDIRECT):
+			TakeInventory (activator, FBehavior::StaticLookupString (TAGSTR(pc[0])), pc[1]);
 			pc += 2;
 			break;
 
-		case PCD_CHECKINVENTORY:
+		PCODE(PCD_CHECKINVENTORY):
 			STACK(1) = CheckInventory (activator, FBehavior::StaticLookupString (STACK(1)), false);
 			break;
 
-		case PCD_CHECKACTORINVENTORY:
+		PCODE(PCD_CHECKACTORINVENTORY):
 			STACK(2) = CheckInventory (SingleActorFromTID(STACK(2), NULL),
 										FBehavior::StaticLookupString (STACK(1)), false);
 			sp--;
 			break;
 
-		case PCD_CHECKINVENTORYDIRECT:
-			PushToStack (CheckInventory (activator, FBehavior::StaticLookupString (TAGSTR(uallong(pc[0]))), false));
+		PCODE(PCD_CHECKINVENTORYDIRECT):
+			PushToStack (CheckInventory (activator, FBehavior::StaticLookupString (TAGSTR(pc[0])), false));
 			pc += 1;
 			break;
 
-		case PCD_USEINVENTORY:
+		PCODE(PCD_USEINVENTORY):
 			STACK(1) = UseInventory (activator, FBehavior::StaticLookupString (STACK(1)));
 			break;
 
-		case PCD_USEACTORINVENTORY:
+		PCODE(PCD_USEACTORINVENTORY):
 			{
 				int ret = 0;
 				const char *type = FBehavior::StaticLookupString(STACK(1));
@@ -8585,7 +9826,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_GETSIGILPIECES:
+		PCODE(PCD_GETSIGILPIECES):
 			{
 				ASigil *sigil;
 
@@ -8600,7 +9841,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_GETAMMOCAPACITY:
+		PCODE(PCD_GETAMMOCAPACITY):
 			if (activator != NULL)
 			{
 				PClass *type = PClass::FindClass (FBehavior::StaticLookupString (STACK(1)));
@@ -8629,7 +9870,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_SETAMMOCAPACITY:
+		PCODE(PCD_SETAMMOCAPACITY):
 			if (activator != NULL)
 			{
 				PClass *type = PClass::FindClass (FBehavior::StaticLookupString (STACK(2)));
@@ -8653,17 +9894,17 @@ scriptwait:
 			sp -= 2;
 			break;
 
-		case PCD_SETMUSIC:
+		PCODE(PCD_SETMUSIC):
 			S_ChangeMusic (FBehavior::StaticLookupString (STACK(3)), STACK(2));
 			sp -= 3;
 			break;
 
-		case PCD_SETMUSICDIRECT:
-			S_ChangeMusic (FBehavior::StaticLookupString (TAGSTR(uallong(pc[0]))), uallong(pc[1]));
+		PCODE(PCD_SETMUSICDIRECT):
+			S_ChangeMusic (FBehavior::StaticLookupString (TAGSTR(pc[0])), pc[1]);
 			pc += 3;
 			break;
 
-		case PCD_LOCALSETMUSIC:
+		PCODE(PCD_LOCALSETMUSIC):
 			if (activator == players[consoleplayer].mo)
 			{
 				S_ChangeMusic (FBehavior::StaticLookupString (STACK(3)), STACK(2));
@@ -8671,26 +9912,26 @@ scriptwait:
 			sp -= 3;
 			break;
 
-		case PCD_LOCALSETMUSICDIRECT:
+		PCODE(PCD_LOCALSETMUSICDIRECT):
 			if (activator == players[consoleplayer].mo)
 			{
-				S_ChangeMusic (FBehavior::StaticLookupString (TAGSTR(uallong(pc[0]))), uallong(pc[1]));
+				S_ChangeMusic (FBehavior::StaticLookupString (TAGSTR(pc[0])), pc[1]);
 			}
 			pc += 3;
 			break;
 
-		case PCD_FADETO:
+		PCODE(PCD_FADETO):
 			DoFadeTo (STACK(5), STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 5;
 			break;
 
-		case PCD_FADERANGE:
+		PCODE(PCD_FADERANGE):
 			DoFadeRange (STACK(9), STACK(8), STACK(7), STACK(6),
 						 STACK(5), STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 9;
 			break;
 
-		case PCD_CANCELFADE:
+		PCODE(PCD_CANCELFADE):
 			{
 				TThinkerIterator<DFlashFader> iterator;
 				DFlashFader *fader;
@@ -8705,11 +9946,11 @@ scriptwait:
 			}
 			break;
 
-		case PCD_PLAYMOVIE:
+		PCODE(PCD_PLAYMOVIE):
 			STACK(1) = I_PlayMovie (FBehavior::StaticLookupString (STACK(1)));
 			break;
 
-		case PCD_SETACTORPOSITION:
+		PCODE(PCD_SETACTORPOSITION):
 			{
 				bool result = false;
 				AActor *actor = SingleActorFromTID (STACK(5), activator);
@@ -8720,9 +9961,9 @@ scriptwait:
 			}
 			break;
 
-		case PCD_GETACTORX:
-		case PCD_GETACTORY:
-		case PCD_GETACTORZ:
+		PCODE(PCD_GETACTORX):
+		PCODE(PCD_GETACTORY):
+		PCODE(PCD_GETACTORZ):
 			{
 				AActor *actor = SingleActorFromTID(STACK(1), activator);
 				if (actor == NULL)
@@ -8740,35 +9981,35 @@ scriptwait:
 			}
 			break;
 
-		case PCD_GETACTORFLOORZ:
+		PCODE(PCD_GETACTORFLOORZ):
 			{
 				AActor *actor = SingleActorFromTID(STACK(1), activator);
 				STACK(1) = actor == NULL ? 0 : actor->floorz;
 			}
 			break;
 
-		case PCD_GETACTORCEILINGZ:
+		PCODE(PCD_GETACTORCEILINGZ):
 			{
 				AActor *actor = SingleActorFromTID(STACK(1), activator);
 				STACK(1) = actor == NULL ? 0 : actor->ceilingz;
 			}
 			break;
 
-		case PCD_GETACTORANGLE:
+		PCODE(PCD_GETACTORANGLE):
 			{
 				AActor *actor = SingleActorFromTID(STACK(1), activator);
 				STACK(1) = actor == NULL ? 0 : actor->angle >> 16;
 			}
 			break;
 
-		case PCD_GETACTORPITCH:
+		PCODE(PCD_GETACTORPITCH):
 			{
 				AActor *actor = SingleActorFromTID(STACK(1), activator);
 				STACK(1) = actor == NULL ? 0 : actor->pitch >> 16;
 			}
 			break;
 
-		case PCD_GETLINEROWOFFSET:
+		PCODE(PCD_GETLINEROWOFFSET):
 			if (activationline != NULL)
 			{
 				PushToStack (activationline->sidedef[0]->GetTextureYOffset(side_t::mid) >> FRACBITS);
@@ -8779,8 +10020,8 @@ scriptwait:
 			}
 			break;
 
-		case PCD_GETSECTORFLOORZ:
-		case PCD_GETSECTORCEILINGZ:
+		PCODE(PCD_GETSECTORFLOORZ):
+		PCODE(PCD_GETSECTORCEILINGZ):
 			// Arguments are (tag, x, y). If you don't use slopes, then (x, y) don't
 			// really matter and can be left as (0, 0) if you like.
 			// [Dusk] If tag = 0, then this returns the z height at whatever sector
@@ -8813,7 +10054,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_GETSECTORLIGHTLEVEL:
+		PCODE(PCD_GETSECTORLIGHTLEVEL):
 			{
 				int secnum = P_FindFirstSectorFromTag (STACK(1));
 				int z = -1;
@@ -8826,19 +10067,19 @@ scriptwait:
 			}
 			break;
 
-		case PCD_SETFLOORTRIGGER:
+		PCODE(PCD_SETFLOORTRIGGER):
 			new DPlaneWatcher (activator, activationline, backSide, false, STACK(8),
 				STACK(7), STACK(6), STACK(5), STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 8;
 			break;
 
-		case PCD_SETCEILINGTRIGGER:
+		PCODE(PCD_SETCEILINGTRIGGER):
 			new DPlaneWatcher (activator, activationline, backSide, true, STACK(8),
 				STACK(7), STACK(6), STACK(5), STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 8;
 			break;
 
-		case PCD_STARTTRANSLATION:
+		PCODE(PCD_STARTTRANSLATION):
 			{
 				int i = STACK(1);
 				sp--;
@@ -8855,7 +10096,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_TRANSLATIONRANGE1:
+		PCODE(PCD_TRANSLATIONRANGE1):
 			{ // translation using palette shifting
 				int start = STACK(4);
 				int end = STACK(3);
@@ -8868,7 +10109,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_TRANSLATIONRANGE2:
+		PCODE(PCD_TRANSLATIONRANGE2):
 			{ // translation using RGB values
 			  // (would HSV be a good idea too?)
 				int start = STACK(8);
@@ -8886,7 +10127,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_TRANSLATIONRANGE3:
+		PCODE(PCD_TRANSLATIONRANGE3):
 			{ // translation using desaturation
 				int start = STACK(8);
 				int end = STACK(7);
@@ -8905,27 +10146,27 @@ scriptwait:
 			}
 			break;
 
-		case PCD_ENDTRANSLATION:
+		PCODE(PCD_ENDTRANSLATION):
 			// This might be useful for hardware rendering, but
 			// for software it is superfluous.
 			translation->UpdateNative();
 			translation = NULL;
 			break;
 
-		case PCD_SIN:
+		PCODE(PCD_SIN):
 			STACK(1) = finesine[angle_t(STACK(1)<<16)>>ANGLETOFINESHIFT];
 			break;
 
-		case PCD_COS:
+		PCODE(PCD_COS):
 			STACK(1) = finecosine[angle_t(STACK(1)<<16)>>ANGLETOFINESHIFT];
 			break;
 
-		case PCD_VECTORANGLE:
+		PCODE(PCD_VECTORANGLE):
 			STACK(2) = R_PointToAngle2 (0, 0, STACK(2), STACK(1)) >> 16;
 			sp--;
 			break;
 
-        case PCD_CHECKWEAPON:
+        PCODE(PCD_CHECKWEAPON):
             if (activator == NULL || activator->player == NULL || // Non-players do not have weapons
                 activator->player->ReadyWeapon == NULL)
             {
@@ -8937,7 +10178,7 @@ scriptwait:
             }
             break;
 
-		case PCD_SETWEAPON:
+		PCODE(PCD_SETWEAPON):
 			if (activator == NULL || activator->player == NULL)
 			{
 				STACK(1) = 0;
@@ -8976,7 +10217,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_SETMARINEWEAPON:
+		PCODE(PCD_SETMARINEWEAPON):
 			if (STACK(2) != 0)
 			{
 				AScriptedMarine *marine;
@@ -8998,7 +10239,7 @@ scriptwait:
 			sp -= 2;
 			break;
 
-		case PCD_SETMARINESPRITE:
+		PCODE(PCD_SETMARINESPRITE):
 			{
 				PClassActor *type = PClass::FindActor(FBehavior::StaticLookupString (STACK(1)));
 
@@ -9030,22 +10271,22 @@ scriptwait:
 			sp -= 2;
 			break;
 
-		case PCD_SETACTORPROPERTY:
+		PCODE(PCD_SETACTORPROPERTY):
 			SetActorProperty (STACK(3), STACK(2), STACK(1));
 			sp -= 3;
 			break;
 
-		case PCD_GETACTORPROPERTY:
+		PCODE(PCD_GETACTORPROPERTY):
 			STACK(2) = GetActorProperty (STACK(2), STACK(1));
 			sp -= 1;
 			break;
 
-		case PCD_GETPLAYERINPUT:
+		PCODE(PCD_GETPLAYERINPUT):
 			STACK(2) = GetPlayerInput (STACK(2), STACK(1));
 			sp -= 1;
 			break;
 
-		case PCD_PLAYERNUMBER:
+		PCODE(PCD_PLAYERNUMBER):
 			if (activator == NULL || activator->player == NULL)
 			{
 				PushToStack (-1);
@@ -9056,7 +10297,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_PLAYERINGAME:
+		PCODE(PCD_PLAYERINGAME):
 			if (STACK(1) < 0 || STACK(1) >= MAXPLAYERS)
 			{
 				STACK(1) = false;
@@ -9067,7 +10308,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_PLAYERISBOT:
+		PCODE(PCD_PLAYERISBOT):
 			if (STACK(1) < 0 || STACK(1) >= MAXPLAYERS || !playeringame[STACK(1)])
 			{
 				STACK(1) = false;
@@ -9078,7 +10319,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_ACTIVATORTID:
+		PCODE(PCD_ACTIVATORTID):
 			if (activator == NULL)
 			{
 				PushToStack (0);
@@ -9089,15 +10330,15 @@ scriptwait:
 			}
 			break;
 
-		case PCD_GETSCREENWIDTH:
+		PCODE(PCD_GETSCREENWIDTH):
 			PushToStack (SCREENWIDTH);
 			break;
 
-		case PCD_GETSCREENHEIGHT:
+		PCODE(PCD_GETSCREENHEIGHT):
 			PushToStack (SCREENHEIGHT);
 			break;
 
-		case PCD_THING_PROJECTILE2:
+		PCODE(PCD_THING_PROJECTILE2):
 			// Like Thing_Projectile(Gravity) specials, but you can give the
 			// projectile a TID.
 			// Thing_Projectile2 (tid, type, angle, speed, vspeed, gravity, newtid);
@@ -9106,14 +10347,14 @@ scriptwait:
 			sp -= 7;
 			break;
 
-		case PCD_SPAWNPROJECTILE:
+		PCODE(PCD_SPAWNPROJECTILE):
 			// Same, but takes an actor name instead of a spawn ID.
 			P_Thing_Projectile (STACK(7), activator, 0, FBehavior::StaticLookupString (STACK(6)), ((angle_t)(STACK(5)<<24)),
 				STACK(4)<<(FRACBITS-3), STACK(3)<<(FRACBITS-3), 0, NULL, STACK(2), STACK(1), false);
 			sp -= 7;
 			break;
 
-		case PCD_STRLEN:
+		PCODE(PCD_STRLEN):
 			{
 				const char *str = FBehavior::StaticLookupString(STACK(1));
 				if (str != NULL)
@@ -9132,11 +10373,11 @@ scriptwait:
 			}
 			break;
 
-		case PCD_GETCVAR:
+		PCODE(PCD_GETCVAR):
 			STACK(1) = GetCVar(activator, FBehavior::StaticLookupString(STACK(1)), false);
 			break;
 
-		case PCD_SETHUDSIZE:
+		PCODE(PCD_SETHUDSIZE):
 			hudwidth = abs (STACK(3));
 			hudheight = abs (STACK(2));
 			if (STACK(1) != 0)
@@ -9146,7 +10387,7 @@ scriptwait:
 			sp -= 3;
 			break;
 
-		case PCD_GETLEVELINFO:
+		PCODE(PCD_GETLEVELINFO):
 			switch (STACK(1))
 			{
 			case LEVELINFO_PAR_TIME:		STACK(1) = level.partime;			break;
@@ -9163,7 +10404,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_CHANGESKY:
+		PCODE(PCD_CHANGESKY):
 			{
 				const char *sky1name, *sky2name;
 
@@ -9182,7 +10423,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_SETCAMERATOTEXTURE:
+		PCODE(PCD_SETCAMERATOTEXTURE):
 			{
 				const char *picname = FBehavior::StaticLookupString (STACK(2));
 				AActor *camera;
@@ -9213,17 +10454,17 @@ scriptwait:
 			}
 			break;
 
-		case PCD_SETACTORANGLE:		// [GRB]
+		PCODE(PCD_SETACTORANGLE):		// [GRB]
 			SetActorAngle(activator, STACK(2), STACK(1), false);
 			sp -= 2;
 			break;
 
-		case PCD_SETACTORPITCH:
+		PCODE(PCD_SETACTORPITCH):
 			SetActorPitch(activator, STACK(2), STACK(1), false);
 			sp -= 2;
 			break;
 
-		case PCD_SETACTORSTATE:
+		PCODE(PCD_SETACTORSTATE):
 			{
 				const char *statename = FBehavior::StaticLookupString (STACK(2));
 				FState *state;
@@ -9265,7 +10506,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_PLAYERCLASS:		// [GRB]
+		PCODE(PCD_PLAYERCLASS):		// [GRB]
 			if (STACK(1) < 0 || STACK(1) >= MAXPLAYERS || !playeringame[STACK(1)])
 			{
 				STACK(1) = -1;
@@ -9276,7 +10517,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_GETPLAYERINFO:		// [GRB]
+		PCODE(PCD_GETPLAYERINFO):		// [GRB]
 			if (STACK(2) < 0 || STACK(2) >= MAXPLAYERS || !playeringame[STACK(2)])
 			{
 				STACK(2) = -1;
@@ -9303,14 +10544,14 @@ scriptwait:
 			sp -= 1;
 			break;
 
-		case PCD_CHANGELEVEL:
+		PCODE(PCD_CHANGELEVEL):
 			{
 				G_ChangeLevel(FBehavior::StaticLookupString(STACK(4)), STACK(3), STACK(2), STACK(1));
 				sp -= 4;
 			}
 			break;
 
-		case PCD_SECTORDAMAGE:
+		PCODE(PCD_SECTORDAMAGE):
 			{
 				int tag = STACK(5);
 				int amount = STACK(4);
@@ -9324,22 +10565,22 @@ scriptwait:
 			}
 			break;
 
-		case PCD_THINGDAMAGE2:
+		PCODE(PCD_THINGDAMAGE2):
 			STACK(3) = P_Thing_Damage (STACK(3), activator, STACK(2), FName(FBehavior::StaticLookupString(STACK(1))));
 			sp -= 2;
 			break;
 
-		case PCD_CHECKACTORCEILINGTEXTURE:
+		PCODE(PCD_CHECKACTORCEILINGTEXTURE):
 			STACK(2) = DoCheckActorTexture(STACK(2), activator, STACK(1), false);
 			sp--;
 			break;
 
-		case PCD_CHECKACTORFLOORTEXTURE:
+		PCODE(PCD_CHECKACTORFLOORTEXTURE):
 			STACK(2) = DoCheckActorTexture(STACK(2), activator, STACK(1), true);
 			sp--;
 			break;
 
-		case PCD_GETACTORLIGHTLEVEL:
+		PCODE(PCD_GETACTORLIGHTLEVEL):
 		{
 			AActor *actor = SingleActorFromTID(STACK(1), activator);
 			if (actor != NULL)
@@ -9350,12 +10591,12 @@ scriptwait:
 			break;
 		}
 
-		case PCD_SETMUGSHOTSTATE:
+		PCODE(PCD_SETMUGSHOTSTATE):
 			StatusBar->SetMugShotState(FBehavior::StaticLookupString(STACK(1)));
 			sp--;
 			break;
 
-		case PCD_CHECKPLAYERCAMERA:
+		PCODE(PCD_CHECKPLAYERCAMERA):
 			{
 				int playernum = STACK(1);
 
@@ -9370,11 +10611,11 @@ scriptwait:
 			}
 			break;
 
-		case PCD_CLASSIFYACTOR:
+		PCODE(PCD_CLASSIFYACTOR):
 			STACK(1) = DoClassifyActor(STACK(1));
 			break;
 
-		case PCD_MORPHACTOR:
+		PCODE(PCD_MORPHACTOR):
 			{
 				int tag = STACK(7);
 				FName playerclass_name = FBehavior::StaticLookupString(STACK(6));
@@ -9424,7 +10665,7 @@ scriptwait:
 			}	
 			break;
 
-		case PCD_UNMORPHACTOR:
+		PCODE(PCD_UNMORPHACTOR):
 			{
 				int tag = STACK(2);
 				bool force = !!STACK(1);
@@ -9484,7 +10725,7 @@ scriptwait:
 			}	
 			break;
 
-		case PCD_SAVESTRING:
+		PCODE(PCD_SAVESTRING):
 			// Saves the string
 			{
 				const int str = GlobalACSStrings.AddString(work);
@@ -9493,10 +10734,10 @@ scriptwait:
 			}		
 			break;
 
-		case PCD_STRCPYTOSCRIPTCHRANGE:
-		case PCD_STRCPYTOMAPCHRANGE:
-		case PCD_STRCPYTOWORLDCHRANGE:
-		case PCD_STRCPYTOGLOBALCHRANGE:
+		PCODE(PCD_STRCPYTOSCRIPTCHRANGE):
+		PCODE(PCD_STRCPYTOMAPCHRANGE):
+		PCODE(PCD_STRCPYTOWORLDCHRANGE):
+		PCODE(PCD_STRCPYTOGLOBALCHRANGE):
 			// source: stringid(2); stringoffset(1)
 			// destination: capacity (3); stringoffset(4); arrayid (5); offset(6)
 
@@ -9589,7 +10830,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_CONSOLECOMMAND:
+		PCODE(PCD_CONSOLECOMMAND):
 			Printf (TEXTCOLOR_RED GAMENAME " doesn't support execution of console commands from scripts\n");
 			sp -= 3;
 			break;
@@ -9600,6 +10841,7 @@ scriptwait:
 	{
 		activeBehavior->GetScriptPtr(InModuleScriptNumber)->ProfileData.AddRun(runaway);
 	}
+	ACSInstrCount += runaway;
 
 	if (state == SCRIPT_DivideBy0)
 	{
@@ -9614,17 +10856,20 @@ scriptwait:
 	if (state == SCRIPT_PleaseRemove)
 	{
 		Unlink ();
+		controller->Unschedule (this);
 		DLevelScript **running;
 		if ((running = controller->RunningScripts.CheckKey(script)) != NULL &&
 			*running == this)
 		{
 			controller->RunningScripts.Remove(script);
+			controller->WakeWaiters (SCRIPT_ScriptWait, script);
 		}
 	}
 	else
 	{
 		this->pc = pc;
 		assert (sp == 0);
+		controller->Schedule (this, ran);
 	}
 	return resultValue;
 }
@@ -9676,6 +10921,8 @@ DLevelScript::DLevelScript (AActor *who, line_t *where, int num, const ScriptPtr
 	ClipRectLeft = ClipRectTop = ClipRectWidth = ClipRectHeight = WrapWidth = 0;
 	HandleAspect = true;
 	state = SCRIPT_Running;
+	ReadyIndex = -1;
+	ParkList = NULL;
 
 	// Hexen waited one second before executing any open scripts. I didn't realize
 	// this when I wrote my ACS implementation. Now that I know, it's still best to
@@ -9684,7 +10931,10 @@ DLevelScript::DLevelScript (AActor *who, line_t *where, int num, const ScriptPtr
 	// goes by while they're in their default state.
 
 	if (!(flags & ACS_ALWAYS))
+	{
 		DACSThinker::ActiveThinker->RunningScripts[num] = this;
+		DACSThinker::ActiveThinker->WakeWaiters (SCRIPT_ScriptWaitPre, num);
+	}
 
 	Link();
 
@@ -9692,6 +10942,7 @@ DLevelScript::DLevelScript (AActor *who, line_t *where, int num, const ScriptPtr
 	{
 		PutLast();
 	}
+	DACSThinker::ActiveThinker->Schedule (this, false);
 
 	DPrintf("%s started.\n", ScriptPresentation(num).GetChars());
 }
@@ -9707,6 +10958,42 @@ static void SetScriptState (int script, DLevelScript::EScriptState state)
 	}
 }
 
+//==========================================================================
+//
+// P_WakeScriptsForSector
+//
+// Called when a sector stops moving, for scripts waiting on its tag.
+//
+//==========================================================================
+
+void P_WakeScriptsForSector (sector_t *sector)
+{
+	DACSThinker *controller = DACSThinker::ActiveThinker;
+
+	if (controller != NULL)
+	{
+		controller->WakeTagWaiters (sector);
+	}
+}
+
+//==========================================================================
+//
+// P_WakeScriptsForPolyobj
+//
+// Called when a polyobject stops moving, for scripts waiting on it.
+//
+//==========================================================================
+
+void P_WakeScriptsForPolyobj (int polyobj)
+{
+	DACSThinker *controller = DACSThinker::ActiveThinker;
+
+	if (controller != NULL)
+	{
+		controller->WakeWaiters (DLevelScript::SCRIPT_PolyWait, polyobj);
+	}
+}
+
 void P_DoDeferedScripts ()
 {
 	acsdefered_t *def;
@@ -10190,3 +11477,381 @@ CCMD(acsprofile)
 	ShowProfileData(ScriptProfiles, limit, sorter, false);
 	ShowProfileData(FuncProfiles, limit, sorter, true);
 }
+
+//==========================================================================
+//
+// CCMD acsbench
+//
+// Translates the code of every loaded ACS module a number of times and
+// reports what it costs. Use stat acs to see the time spent running it.
+//
+//==========================================================================
+
+CCMD(acsbench)
+{
+	TArray<int> code;
+	TArray<ACSInstrOffset> byraw, bycode;
+	FBehavior *module;
+	cycle_t clock;
+	double total = 0;
+	int passes = 100;
+	int lib;
+
+	if (argv.argc() > 1)
+	{
+		passes = MAX(1, atoi(argv[1]));
+	}
+	Printf("%-12s%10s%10s%10s%10s%12s\n", "Module", "Bytes", "Instrs", "Merged", "Words", "us/pass");
+	for (lib = 0; (module = FBehavior::StaticGetModule(lib)) != NULL; ++lib)
+	{
+		unsigned int instrs = 0;
+
+		clock.Reset();
+		clock.Clock();
+		for (int i = 0; i < passes; ++i)
+		{
+			instrs = module->TranslateCode(code, byraw, bycode);
+		}
+		clock.Unclock();
+		total += clock.TimeMS();
+		Printf("%-12s%10d%10u%10u%10u%12.1f\n", module->GetModuleName(), module->GetDataSize(),
+			instrs, instrs - byraw.Size(), code.Size(), clock.TimeMS() * 1000 / passes);
+	}
+	if (lib == 0)
+	{
+		Printf("No ACS modules are loaded.\n");
+	}
+	else
+	{
+		Printf("%d modules, %.3f ms per pass\n", lib, total / passes);
+	}
+}
+
+//==========================================================================
+//
+// FACSBenchCode
+//
+// Assembles the object code for RunBenchmark.
+//
+//==========================================================================
+
+struct FACSBenchCode
+{
+	TArray<int> Words;
+
+	DWORD Here() const { return Words.Size() * 4; }
+	void Op(int pcd) { Words.Push(pcd); }
+	void Op(int pcd, int arg) { Words.Push(pcd); Words.Push(arg); }
+
+	// Emits a jump whose target is not known yet and returns its operand.
+	unsigned int Jump(int pcd) { Words.Push(pcd); return Words.Push(0); }
+	void Land(unsigned int operand) { Words[operand] = Here(); }
+};
+
+//==========================================================================
+//
+// DLevelScript :: RunBenchmark
+//
+// Runs a fixed loop of script code through TranslateCode and RunScript,
+// with the same mix of variable, arithmetic, compare-and-branch and push
+// instructions compiled scripts are made of. It only touches its own
+// local variables, so it is safe to run in any level. Returns the number
+// of p-codes executed.
+//
+//==========================================================================
+
+unsigned int DLevelScript::RunBenchmark (int passes, double &ms)
+{
+	enum { LOOPS = 10000 };
+	FACSBenchCode obj;
+	unsigned int skip, next;
+	DWORD loop;
+
+	// 0 = counter, 1 = sum, 2 = counter % 7
+	obj.Op(PCD_PUSHNUMBER, LOOPS);
+	obj.Op(PCD_ASSIGNSCRIPTVAR, 0);
+	obj.Op(PCD_PUSHNUMBER, 0);
+	obj.Op(PCD_ASSIGNSCRIPTVAR, 1);
+	loop = obj.Here();
+	obj.Op(PCD_PUSHSCRIPTVAR, 0);
+	obj.Op(PCD_PUSHNUMBER, 7);
+	obj.Op(PCD_MODULUS);
+	obj.Op(PCD_ASSIGNSCRIPTVAR, 2);
+	obj.Op(PCD_PUSHSCRIPTVAR, 2);
+	obj.Op(PCD_PUSHNUMBER, 3);
+	obj.Op(PCD_LT);
+	skip = obj.Jump(PCD_IFNOTGOTO);
+	obj.Op(PCD_PUSHSCRIPTVAR, 1);
+	obj.Op(PCD_PUSHSCRIPTVAR, 2);
+	obj.Op(PCD_MULTIPLY);
+	obj.Op(PCD_PUSHNUMBER, 1);
+	obj.Op(PCD_ADD);
+	obj.Op(PCD_ADDSCRIPTVAR, 1);
+	next = obj.Jump(PCD_GOTO);
+	obj.Land(skip);
+	obj.Op(PCD_PUSHSCRIPTVAR, 0);
+	obj.Op(PCD_PUSHNUMBER, 2);
+	obj.Op(PCD_LSHIFT);
+	obj.Op(PCD_PUSHNUMBER, 255);
+	obj.Op(PCD_ANDBITWISE);
+	obj.Op(PCD_SUBSCRIPTVAR, 1);
+	obj.Land(next);
+	obj.Op(PCD_PUSHNUMBER, 1);
+	obj.Op(PCD_PUSHNUMBER, 2);
+	obj.Op(PCD_PUSHNUMBER, 3);
+	obj.Op(PCD_DROP);
+	obj.Op(PCD_DROP);
+	obj.Op(PCD_DROP);
+	obj.Op(PCD_DECSCRIPTVAR, 0);
+	obj.Op(PCD_PUSHSCRIPTVAR, 0);
+	obj.Op(PCD_IFGOTO, loop);
+	obj.Op(PCD_TERMINATE);
+
+	TArray<BYTE> data;
+	TArray<DWORD> entries;
+	TArray<int> code;
+	TArray<ACSInstrOffset> byraw, bycode;
+
+	data.Resize(obj.Words.Size() * 4);
+	for (unsigned int i = 0; i < obj.Words.Size(); ++i)
+	{
+		DWORD word = obj.Words[i];
+		data[i*4+0] = BYTE(word);
+		data[i*4+1] = BYTE(word >> 8);
+		data[i*4+2] = BYTE(word >> 16);
+		data[i*4+3] = BYTE(word >> 24);
+	}
+	entries.Push(0);
+	TranslateCode(&data[0], data.Size(), ACS_Enhanced, entries, code, byraw, bycode);
+
+	// A module with nothing in it, so that nothing the code does can
+	// reach a real one.
+	FBehavior sandbox;
+	DLevelScript *script = new DLevelScript;
+	script->script = 0;
+	script->activator = NULL;
+	script->activationline = NULL;
+	script->backSide = false;
+	script->activeBehavior = &sandbox;
+	script->InModuleScriptNumber = -1;
+	script->numlocalvars = 3;
+	script->localvars = new SDWORD[3];
+
+	unsigned int savedcount = ACSInstrCount;
+	cycle_t clock;
+
+	ACSInstrCount = 0;
+	clock.Reset();
+	for (int i = 0; i < passes; ++i)
+	{
+		memset(script->localvars, 0, 3 * sizeof(SDWORD));
+		script->pc = &code[byraw[0].CodeOfs];
+		script->state = SCRIPT_Running;
+		script->statedata = 0;
+		clock.Clock();
+		script->RunScript();
+		clock.Unclock();
+	}
+	unsigned int instrs = ACSInstrCount;
+	ACSInstrCount = savedcount;
+	script->Destroy();
+
+	ms = clock.TimeMS();
+	return instrs;
+}
+
+//==========================================================================
+//
+// DLevelScript :: RunBenchmark
+//
+// Runs scripts from the loaded modules, without arguments or activator,
+// until each one terminates or has to wait. A script that has to wait is
+// stopped there. Unlike the other version, these run against the current
+// level and whatever they change stays changed. Returns the number of
+// p-codes executed.
+//
+//==========================================================================
+
+unsigned int DLevelScript::RunBenchmark (const TArray<ACSBenchScript> &scripts, int passes, double &ms)
+{
+	unsigned int savedcount = ACSInstrCount;
+	cycle_t clock;
+
+	ACSInstrCount = 0;
+	clock.Reset();
+	for (int i = 0; i < passes; ++i)
+	{
+		for (unsigned int j = 0; j < scripts.Size(); ++j)
+		{
+			// ACS_ALWAYS keeps these out of RunningScripts, so they do not
+			// get in the way of the level's own instances.
+			DLevelScript *script = new DLevelScript(NULL, NULL, scripts[j].Code->Number,
+				scripts[j].Code, scripts[j].Module, NULL, 0, ACS_ALWAYS);
+			clock.Clock();
+			script->RunScript();
+			clock.Unclock();
+			if (script->state != SCRIPT_PleaseRemove)
+			{
+				script->state = SCRIPT_PleaseRemove;
+				script->RunScript();
+			}
+			script->Destroy();
+		}
+	}
+	unsigned int instrs = ACSInstrCount;
+	ACSInstrCount = savedcount;
+
+	ms = clock.TimeMS();
+	return instrs;
+}
+
+//==========================================================================
+//
+// CCMD acsrunbench
+//
+// Times how fast RunScript executes p-codes. By default it uses the code
+// in DLevelScript::RunBenchmark, which is safe to run anywhere. With
+// "open" it runs the OPEN scripts of the loaded modules instead, and with
+// "script" the given script, by number or name. Those act on the level.
+//
+//==========================================================================
+
+CCMD(acsrunbench)
+{
+	TArray<ACSBenchScript> scripts;
+	int passes = 100;
+	int argn = 1;
+	double ms;
+
+	if (gamestate != GS_LEVEL)
+	{
+		Printf("Scripts can only run inside a level.\n");
+		return;
+	}
+	if (argv.argc() > 1 && (stricmp(argv[1], "open") == 0 || stricmp(argv[1], "script") == 0))
+	{
+		if (netgame)
+		{
+			Printf("Level scripts cannot be benchmarked in a net game.\n");
+			return;
+		}
+		if (stricmp(argv[1], "open") == 0)
+		{
+			FBehavior *module;
+			const ScriptPtr *code;
+
+			for (int lib = 0; (module = FBehavior::StaticGetModule(lib)) != NULL; ++lib)
+			{
+				for (int i = 0; (code = module->GetScriptPtr(i)) != NULL; ++i)
+				{
+					if (code->Type == SCRIPT_Open)
+					{
+						ACSBenchScript entry = { code, module };
+						scripts.Push(entry);
+					}
+				}
+			}
+			argn = 2;
+		}
+		else
+		{
+			if (argv.argc() < 3)
+			{
+				Printf("Usage: acsrunbench [open|script <script>] [passes]\n");
+				return;
+			}
+			ACSBenchScript entry;
+			int num = IsNum(argv[2]) ? atoi(argv[2]) : -FName(argv[2]);
+			if ((entry.Code = FBehavior::StaticFindScript(num, entry.Module)) == NULL)
+			{
+				Printf("Unknown %s\n", ScriptPresentation(num).GetChars());
+				return;
+			}
+			scripts.Push(entry);
+			argn = 3;
+		}
+		if (scripts.Size() == 0)
+		{
+			Printf("No OPEN scripts are loaded.\n");
+			return;
+		}
+	}
+	if (argv.argc() > argn)
+	{
+		passes = MAX(1, atoi(argv[argn]));
+	}
+
+	unsigned int instrs;
+	if (scripts.Size() == 0)
+	{
+		instrs = DLevelScript::RunBenchmark(passes, ms);
+	}
+	else
+	{
+		instrs = DLevelScript::RunBenchmark(scripts, passes, ms);
+		Printf("%u scripts, %d passes\n", scripts.Size(), passes);
+	}
+	Printf("%u p-codes in %.3f ms, %.2f ns per p-code, %s dispatch\n", instrs, ms, ms * 1000000 / MAX(instrs, 1u),
+#ifdef ACS_COMPUTED_GOTO
+		"computed goto"
+#else
+		"switch"
+#endif
+		);
+}
+
+//==========================================================================
+//
+// CCMD acsarraybench
+//
+// Times an indexed read-modify-write loop over a world/global array
+// against the same loop over a plain map, which is what these arrays
+// used to be.
+//
+//==========================================================================
+
+CCMD(acsarraybench)
+{
+	FWorldGlobalArray array;
+	FWorldGlobalArray::SparseMap map;
+	cycle_t arrayclock, mapclock;
+	int count = 1000;
+	int passes = 1000;
+	SDWORD sum = 0;
+
+	if (argv.argc() > 1)
+	{
+		count = MAX(1, atoi(argv[1]));
+	}
+	if (argv.argc() > 2)
+	{
+		passes = MAX(1, atoi(argv[2]));
+	}
+
+	arrayclock.Reset();
+	arrayclock.Clock();
+	for (int pass = 0; pass < passes; ++pass)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			array[i] += i;
+			sum += array[i];
+		}
+	}
+	arrayclock.Unclock();
+
+	mapclock.Reset();
+	mapclock.Clock();
+	for (int pass = 0; pass < passes; ++pass)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			map[i] += i;
+			sum -= map[i];
+		}
+	}
+	mapclock.Unclock();
+
+	Printf("%d elements, %d passes: array %.3f ms, map %.3f ms%s\n", count, passes,
+		arrayclock.TimeMS(), mapclock.TimeMS(), sum != 0 ? " (mismatch)" : "");
+}
@@ -44,6 +44,9 @@
 
 class FFont;
 class FileReader;
+struct sector_t;
+struct FACSCodeReader;
+struct FACSDecodedInstr;
 
 
 enum
@@ -59,7 +62,63 @@ struct InitIntToZero
 		v = 0;
 	}
 };
-typedef TMap<SDWORD, SDWORD, THashTraits<SDWORD>, InitIntToZero> FWorldGlobalArray;
+
+// World and global arrays. Indices from 0 up to DENSE_SIZE are kept in
+// chunks of CHUNK_SIZE elements that are allocated the first time one of
+// their elements is touched, so the loops mods run over these arrays do
+// not hash every index. Anything outside that range goes into a map.
+class FWorldGlobalArray
+{
+public:
+	typedef TMap<SDWORD, SDWORD, THashTraits<SDWORD>, InitIntToZero> SparseMap;
+
+	enum
+	{
+		CHUNK_BITS = 8,
+		CHUNK_SIZE = 1 << CHUNK_BITS,
+		DENSE_SIZE = 1 << 20
+	};
+
+	FWorldGlobalArray() {}
+	~FWorldGlobalArray() { Clear(); }
+
+	SDWORD &operator[] (SDWORD index)
+	{
+		unsigned int chunk = (unsigned int)index >> CHUNK_BITS;
+		if (chunk < Chunks.Size() && Chunks[chunk] != NULL)
+		{
+			return Chunks[chunk][index & (CHUNK_SIZE - 1)];
+		}
+		return Allocate(index);
+	}
+	void Insert (SDWORD index, SDWORD value) { (*this)[index] = value; }
+	void Clear ();
+
+	// Number of elements a save would store
+	unsigned int CountUsed () const;
+
+	// Visits every element that is set, and any sparse element that was touched.
+	class ConstIterator
+	{
+	public:
+		ConstIterator (const FWorldGlobalArray &array);
+		bool Next (SDWORD &index, SDWORD &value);
+
+	private:
+		const FWorldGlobalArray &Array;
+		unsigned int Chunk, Element;
+		SparseMap::ConstIterator SparseIt;
+	};
+
+private:
+	TArray<SDWORD *> Chunks;
+	SparseMap Sparse;
+
+	SDWORD &Allocate (SDWORD index);
+
+	FWorldGlobalArray (const FWorldGlobalArray &other);
+	FWorldGlobalArray &operator= (const FWorldGlobalArray &other);
+};
 
 // ACS variables with world scope
 extern SDWORD ACS_WorldVars[NUM_WORLDVARS];
@@ -280,6 +339,22 @@ enum
 
 enum ACSFormat { ACS_Old, ACS_Enhanced, ACS_LittleEnhanced, ACS_Unknown };
 
+// Where an instruction from the object ended up in the translated code
+struct ACSInstrOffset
+{
+	DWORD RawOfs;
+	DWORD CodeOfs;
+};
+
+class FBehavior;
+
+// A script for DLevelScript::RunBenchmark to run
+struct ACSBenchScript
+{
+	const ScriptPtr *Code;
+	FBehavior *Module;
+};
+
 class FBehavior
 {
 public:
@@ -292,8 +367,8 @@ public:
 	BYTE *NextChunk (BYTE *chunk) const;
 	const ScriptPtr *FindScript (int number) const;
 	void StartTypedScripts (WORD type, AActor *activator, bool always, int arg1, bool runNow);
-	DWORD PC2Ofs (int *pc) const { return (DWORD)((BYTE *)pc - Data); }
-	int *Ofs2PC (DWORD ofs) const {	return (int *)(Data + ofs); }
+	DWORD PC2Ofs (int *pc) const;
+	int *Ofs2PC (DWORD ofs) const;
 	int *Jump2PC (DWORD jumpPoint) const { return Ofs2PC(JumpPoints[jumpPoint]); }
 	ACSFormat GetFormat() const { return Format; }
 	ScriptFunction *GetFunction (int funcnum, FBehavior *&module) const;
@@ -305,7 +380,7 @@ public:
 	int FindMapVarName (const char *varname) const;
 	int FindMapArray (const char *arrayname) const;
 	int GetLibraryID () const { return LibraryID; }
-	int *GetScriptAddress (const ScriptPtr *ptr) const { return (int *)(ptr->Address + Data); }
+	int *GetScriptAddress (const ScriptPtr *ptr) const { return Ofs2PC(ptr->Address); }
 	int GetScriptIndex (const ScriptPtr *ptr) const { ptrdiff_t index = ptr - Scripts; return index >= NumScripts ? -1 : (int)index; }
 	ScriptPtr *GetScriptPtr(int index) const { return index >= 0 && index < NumScripts ? &Scripts[index] : NULL; }
 	int GetLumpNum() const { return LumpNum; }
@@ -314,6 +389,7 @@ public:
 	ACSProfileInfo *GetFunctionProfileData(int index) { return index >= 0 && index < NumFunctions ? &FunctionProfileData[index] : NULL; }
 	ACSProfileInfo *GetFunctionProfileData(ScriptFunction *func) { return GetFunctionProfileData((int)(func - (ScriptFunction *)Functions)); }
 	const char *LookupString (DWORD index) const;
+	unsigned int TranslateCode (TArray<int> &code, TArray<ACSInstrOffset> &byraw, TArray<ACSInstrOffset> &bycode) const;
 
 	SDWORD *MapVars[NUM_MAPVARS];
 
@@ -357,6 +433,13 @@ private:
 	char ModuleName[9];
 	TArray<int> JumpPoints;
 
+	// The script code as RunScript executes it. Offsets stored anywhere
+	// else (savegames, return addresses, jump points) are still offsets
+	// into the object and are mapped with PC2Ofs and Ofs2PC.
+	TArray<int> Code;
+	TArray<ACSInstrOffset> InstrByRaw;		// sorted by RawOfs
+	TArray<ACSInstrOffset> InstrByCode;		// sorted by CodeOfs
+
 	static TArray<FBehavior *> StaticModules;
 
 	void LoadScriptsDirectory ();
@@ -772,7 +855,17 @@ public:
 		PCD_LSPEC5EX,
 		PCD_LSPEC5EXRESULT,
 
-/*381*/	PCODE_COMMAND_COUNT
+/*381*/	PCODE_COMMAND_COUNT,
+
+		// Instructions that only exist in code made by TranslateCode
+		PCD_PUSHWORDS = PCODE_COMMAND_COUNT,
+		PCD_IFNOTEQGOTO,
+		PCD_IFNOTNEGOTO,
+		PCD_IFNOTLTGOTO,
+		PCD_IFNOTGTGOTO,
+		PCD_IFNOTLEGOTO,
+		PCD_IFNOTGEGOTO,
+		PCD_BADPCODE
 	};
 
 	// Some constants used by ACS scripts
@@ -860,11 +953,16 @@ public:
 	void Serialize (FArchive &arc);
 	int RunScript ();
 
-	inline void SetState (EScriptState newstate) { state = newstate; }
+	void SetState (EScriptState newstate);
 	inline EScriptState GetState () { return state; }
 
 	DLevelScript *GetNext() const { return next; }
 
+	static unsigned int TranslateCode (const BYTE *data, DWORD size, ACSFormat format, const TArray<DWORD> &entries,
+		TArray<int> &code, TArray<ACSInstrOffset> &byraw, TArray<ACSInstrOffset> &bycode);
+	static unsigned int RunBenchmark (int passes, double &ms);
+	static unsigned int RunBenchmark (const TArray<ACSBenchScript> &scripts, int passes, double &ms);
+
 	void MarkLocalVarStrings() const
 	{
 		GlobalACSStrings.MarkStringArray(localvars, numlocalvars);
@@ -897,6 +995,13 @@ protected:
 	FBehavior	    *activeBehavior;
 	int				InModuleScriptNumber;
 
+	// Scheduling, maintained by DACSThinker and not saved
+	SQWORD			OrderKey;			// Position in the script list
+	unsigned int	VisitTic;			// Tic to run (ready) or to wake (timer)
+	int				ReadyIndex;			// Position in the ready heap or -1
+	DLevelScript	**ParkList;			// Timer slot or wait list this is in
+	DLevelScript	*ParkNext, *ParkPrev;
+
 	void Link ();
 	void Unlink ();
 	void PutLast ();
@@ -927,6 +1032,8 @@ protected:
 	int LineFromID(int id);
 	int SideFromID(int id, int side);
 
+	static bool DecodeInstr (FACSCodeReader &reader, FACSDecodedInstr &instr, TArray<int> &args);
+
 private:
 	DLevelScript ();
 
@@ -951,10 +1058,48 @@ public:
 	void DumpScriptStatus();
 	void StopScriptsFor (AActor *actor);
 
+	void WakeWaiters (DLevelScript::EScriptState state, int data);
+	void WakeTagWaiters (sector_t *sector);
+
 private:
 	DLevelScript *LastScript;
 	DLevelScript *Scripts;				// List of all running scripts
 
+	// Only scripts that can do something get visited. Ready is a heap
+	// ordered by the tic to run on and then by position in the script list,
+	// so scripts still run in list order. Delayed scripts wait in a timer
+	// wheel, and scripts waiting on tags, polyobjs and other scripts are
+	// parked until whatever they wait for happens. None of this is saved;
+	// it is rebuilt from the script list after loading.
+	enum
+	{
+		TIMER_BITS = 8,
+		TIMER_SLOTS = 1 << TIMER_BITS,
+		TIMER_LEVELS = 3
+	};
+	TArray<DLevelScript *> Ready;
+	DLevelScript *Timers[TIMER_LEVELS][TIMER_SLOTS];
+	DLevelScript *FarTimers;
+	DLevelScript *Waiting;
+	unsigned int Tic;
+	SQWORD FirstKey, LastKey, CurrentKey;
+	bool Ticking;
+
+	void ResetSchedule ();
+	void Schedule (DLevelScript *script, bool ran);
+	void Unschedule (DLevelScript *script);
+	void Wake (DLevelScript *script);
+	void AddTimer (DLevelScript *script, unsigned int base);
+	void CascadeTimers (DLevelScript **list);
+	void RunTimers ();
+	void Park (DLevelScript *script, DLevelScript **list);
+	void Unpark (DLevelScript *script);
+	void ReadyPush (DLevelScript *script);
+	void ReadyRemove (DLevelScript *script);
+	void ReadyUp (unsigned int index);
+	void ReadyDown (unsigned int index);
+	static bool ReadyBefore (const DLevelScript *a, const DLevelScript *b);
+
 	friend class DLevelScript;
 	friend class FBehavior;
 };
@@ -0,0 +1,349 @@
+// Every p-code that RunScript has a case for. Used to build the dispatch
+// table for computed goto, so keep it in sync with the PCODE() labels.
+xx(PCD_BADPCODE)
+xx(PCD_TERMINATE)
+xx(PCD_NOP)
+xx(PCD_SUSPEND)
+xx(PCD_TAGSTRING)
+xx(PCD_PUSHNUMBER)
+xx(PCD_PUSHWORDS)
+xx(PCD_DUP)
+xx(PCD_SWAP)
+xx(PCD_LSPEC1)
+xx(PCD_LSPEC2)
+xx(PCD_LSPEC3)
+xx(PCD_LSPEC4)
+xx(PCD_LSPEC5)
+xx(PCD_LSPEC5RESULT)
+xx(PCD_LSPEC5EX)
+xx(PCD_LSPEC5EXRESULT)
+xx(PCD_LSPEC1DIRECT)
+xx(PCD_LSPEC2DIRECT)
+xx(PCD_LSPEC3DIRECT)
+xx(PCD_LSPEC4DIRECT)
+xx(PCD_LSPEC5DIRECT)
+xx(PCD_CALLFUNC)
+xx(PCD_PUSHFUNCTION)
+xx(PCD_CALL)
+xx(PCD_CALLDISCARD)
+xx(PCD_CALLSTACK)
+xx(PCD_RETURNVOID)
+xx(PCD_RETURNVAL)
+xx(PCD_ADD)
+xx(PCD_SUBTRACT)
+xx(PCD_MULTIPLY)
+xx(PCD_DIVIDE)
+xx(PCD_MODULUS)
+xx(PCD_EQ)
+xx(PCD_NE)
+xx(PCD_LT)
+xx(PCD_GT)
+xx(PCD_LE)
+xx(PCD_GE)
+xx(PCD_ASSIGNSCRIPTVAR)
+xx(PCD_ASSIGNMAPVAR)
+xx(PCD_ASSIGNWORLDVAR)
+xx(PCD_ASSIGNGLOBALVAR)
+xx(PCD_ASSIGNSCRIPTARRAY)
+xx(PCD_ASSIGNMAPARRAY)
+xx(PCD_ASSIGNWORLDARRAY)
+xx(PCD_ASSIGNGLOBALARRAY)
+xx(PCD_PUSHSCRIPTVAR)
+xx(PCD_PUSHMAPVAR)
+xx(PCD_PUSHWORLDVAR)
+xx(PCD_PUSHGLOBALVAR)
+xx(PCD_PUSHSCRIPTARRAY)
+xx(PCD_PUSHMAPARRAY)
+xx(PCD_PUSHWORLDARRAY)
+xx(PCD_PUSHGLOBALARRAY)
+xx(PCD_ADDSCRIPTVAR)
+xx(PCD_ADDMAPVAR)
+xx(PCD_ADDWORLDVAR)
+xx(PCD_ADDGLOBALVAR)
+xx(PCD_ADDSCRIPTARRAY)
+xx(PCD_ADDMAPARRAY)
+xx(PCD_ADDWORLDARRAY)
+xx(PCD_ADDGLOBALARRAY)
+xx(PCD_SUBSCRIPTVAR)
+xx(PCD_SUBMAPVAR)
+xx(PCD_SUBWORLDVAR)
+xx(PCD_SUBGLOBALVAR)
+xx(PCD_SUBSCRIPTARRAY)
+xx(PCD_SUBMAPARRAY)
+xx(PCD_SUBWORLDARRAY)
+xx(PCD_SUBGLOBALARRAY)
+xx(PCD_MULSCRIPTVAR)
+xx(PCD_MULMAPVAR)
+xx(PCD_MULWORLDVAR)
+xx(PCD_MULGLOBALVAR)
+xx(PCD_MULSCRIPTARRAY)
+xx(PCD_MULMAPARRAY)
+xx(PCD_MULWORLDARRAY)
+xx(PCD_MULGLOBALARRAY)
+xx(PCD_DIVSCRIPTVAR)
+xx(PCD_DIVMAPVAR)
+xx(PCD_DIVWORLDVAR)
+xx(PCD_DIVGLOBALVAR)
+xx(PCD_DIVSCRIPTARRAY)
+xx(PCD_DIVMAPARRAY)
+xx(PCD_DIVWORLDARRAY)
+xx(PCD_DIVGLOBALARRAY)
+xx(PCD_MODSCRIPTVAR)
+xx(PCD_MODMAPVAR)
+xx(PCD_MODWORLDVAR)
+xx(PCD_MODGLOBALVAR)
+xx(PCD_MODSCRIPTARRAY)
+xx(PCD_MODMAPARRAY)
+xx(PCD_MODWORLDARRAY)
+xx(PCD_MODGLOBALARRAY)
+xx(PCD_ANDSCRIPTVAR)
+xx(PCD_ANDMAPVAR)
+xx(PCD_ANDWORLDVAR)
+xx(PCD_ANDGLOBALVAR)
+xx(PCD_ANDSCRIPTARRAY)
+xx(PCD_ANDMAPARRAY)
+xx(PCD_ANDWORLDARRAY)
+xx(PCD_ANDGLOBALARRAY)
+xx(PCD_EORSCRIPTVAR)
+xx(PCD_EORMAPVAR)
+xx(PCD_EORWORLDVAR)
+xx(PCD_EORGLOBALVAR)
+xx(PCD_EORSCRIPTARRAY)
+xx(PCD_EORMAPARRAY)
+xx(PCD_EORWORLDARRAY)
+xx(PCD_EORGLOBALARRAY)
+xx(PCD_ORSCRIPTVAR)
+xx(PCD_ORMAPVAR)
+xx(PCD_ORWORLDVAR)
+xx(PCD_ORGLOBALVAR)
+xx(PCD_ORSCRIPTARRAY)
+xx(PCD_ORMAPARRAY)
+xx(PCD_ORWORLDARRAY)
+xx(PCD_ORGLOBALARRAY)
+xx(PCD_LSSCRIPTVAR)
+xx(PCD_LSMAPVAR)
+xx(PCD_LSWORLDVAR)
+xx(PCD_LSGLOBALVAR)
+xx(PCD_LSSCRIPTARRAY)
+xx(PCD_LSMAPARRAY)
+xx(PCD_LSWORLDARRAY)
+xx(PCD_LSGLOBALARRAY)
+xx(PCD_RSSCRIPTVAR)
+xx(PCD_RSMAPVAR)
+xx(PCD_RSWORLDVAR)
+xx(PCD_RSGLOBALVAR)
+xx(PCD_RSSCRIPTARRAY)
+xx(PCD_RSMAPARRAY)
+xx(PCD_RSWORLDARRAY)
+xx(PCD_RSGLOBALARRAY)
+xx(PCD_INCSCRIPTVAR)
+xx(PCD_INCMAPVAR)
+xx(PCD_INCWORLDVAR)
+xx(PCD_INCGLOBALVAR)
+xx(PCD_INCSCRIPTARRAY)
+xx(PCD_INCMAPARRAY)
+xx(PCD_INCWORLDARRAY)
+xx(PCD_INCGLOBALARRAY)
+xx(PCD_DECSCRIPTVAR)
+xx(PCD_DECMAPVAR)
+xx(PCD_DECWORLDVAR)
+xx(PCD_DECGLOBALVAR)
+xx(PCD_DECSCRIPTARRAY)
+xx(PCD_DECMAPARRAY)
+xx(PCD_DECWORLDARRAY)
+xx(PCD_DECGLOBALARRAY)
+xx(PCD_GOTO)
+xx(PCD_GOTOSTACK)
+xx(PCD_IFGOTO)
+xx(PCD_SETRESULTVALUE)
+xx(PCD_DROP)
+xx(PCD_DELAY)
+xx(PCD_DELAYDIRECT)
+xx(PCD_RANDOM)
+xx(PCD_RANDOMDIRECT)
+xx(PCD_THINGCOUNT)
+xx(PCD_THINGCOUNTDIRECT)
+xx(PCD_THINGCOUNTNAME)
+xx(PCD_THINGCOUNTNAMESECTOR)
+xx(PCD_THINGCOUNTSECTOR)
+xx(PCD_TAGWAIT)
+xx(PCD_TAGWAITDIRECT)
+xx(PCD_POLYWAIT)
+xx(PCD_POLYWAITDIRECT)
+xx(PCD_CHANGEFLOOR)
+xx(PCD_CHANGEFLOORDIRECT)
+xx(PCD_CHANGECEILING)
+xx(PCD_CHANGECEILINGDIRECT)
+xx(PCD_RESTART)
+xx(PCD_ANDLOGICAL)
+xx(PCD_ORLOGICAL)
+xx(PCD_ANDBITWISE)
+xx(PCD_ORBITWISE)
+xx(PCD_EORBITWISE)
+xx(PCD_NEGATELOGICAL)
+xx(PCD_NEGATEBINARY)
+xx(PCD_LSHIFT)
+xx(PCD_RSHIFT)
+xx(PCD_UNARYMINUS)
+xx(PCD_IFNOTGOTO)
+xx(PCD_IFNOTEQGOTO)
+xx(PCD_IFNOTNEGOTO)
+xx(PCD_IFNOTLTGOTO)
+xx(PCD_IFNOTGTGOTO)
+xx(PCD_IFNOTLEGOTO)
+xx(PCD_IFNOTGEGOTO)
+xx(PCD_LINESIDE)
+xx(PCD_SCRIPTWAIT)
+xx(PCD_SCRIPTWAITDIRECT)
+xx(PCD_SCRIPTWAITNAMED)
+xx(PCD_CLEARLINESPECIAL)
+xx(PCD_CASEGOTO)
+xx(PCD_CASEGOTOSORTED)
+xx(PCD_BEGINPRINT)
+xx(PCD_PRINTSTRING)
+xx(PCD_PRINTLOCALIZED)
+xx(PCD_PRINTNUMBER)
+xx(PCD_PRINTBINARY)
+xx(PCD_PRINTHEX)
+xx(PCD_PRINTCHARACTER)
+xx(PCD_PRINTFIXED)
+xx(PCD_PRINTNAME)
+xx(PCD_PRINTSCRIPTCHARARRAY)
+xx(PCD_PRINTSCRIPTCHRANGE)
+xx(PCD_PRINTMAPCHARARRAY)
+xx(PCD_PRINTMAPCHRANGE)
+xx(PCD_PRINTWORLDCHARARRAY)
+xx(PCD_PRINTWORLDCHRANGE)
+xx(PCD_PRINTGLOBALCHARARRAY)
+xx(PCD_PRINTGLOBALCHRANGE)
+xx(PCD_PRINTBIND)
+xx(PCD_ENDPRINT)
+xx(PCD_ENDPRINTBOLD)
+xx(PCD_MOREHUDMESSAGE)
+xx(PCD_ENDLOG)
+xx(PCD_OPTHUDMESSAGE)
+xx(PCD_ENDHUDMESSAGE)
+xx(PCD_ENDHUDMESSAGEBOLD)
+xx(PCD_SETFONT)
+xx(PCD_SETFONTDIRECT)
+xx(PCD_PLAYERCOUNT)
+xx(PCD_GAMETYPE)
+xx(PCD_GAMESKILL)
+xx(PCD_PLAYERHEALTH)
+xx(PCD_PLAYERARMORPOINTS)
+xx(PCD_PLAYERFRAGS)
+xx(PCD_MUSICCHANGE)
+xx(PCD_SINGLEPLAYER)
+xx(PCD_TIMER)
+xx(PCD_SECTORSOUND)
+xx(PCD_AMBIENTSOUND)
+xx(PCD_LOCALAMBIENTSOUND)
+xx(PCD_ACTIVATORSOUND)
+xx(PCD_SOUNDSEQUENCE)
+xx(PCD_SETLINETEXTURE)
+xx(PCD_REPLACETEXTURES)
+xx(PCD_SETLINEBLOCKING)
+xx(PCD_SETLINEMONSTERBLOCKING)
+xx(PCD_SETLINESPECIAL)
+xx(PCD_SETTHINGSPECIAL)
+xx(PCD_THINGSOUND)
+xx(PCD_FIXEDMUL)
+xx(PCD_FIXEDDIV)
+xx(PCD_SETGRAVITY)
+xx(PCD_SETGRAVITYDIRECT)
+xx(PCD_SETAIRCONTROL)
+xx(PCD_SETAIRCONTROLDIRECT)
+xx(PCD_SPAWN)
+xx(PCD_SPAWNDIRECT)
+xx(PCD_SPAWNSPOT)
+xx(PCD_SPAWNSPOTDIRECT)
+xx(PCD_SPAWNSPOTFACING)
+xx(PCD_CLEARINVENTORY)
+xx(PCD_CLEARACTORINVENTORY)
+xx(PCD_GIVEINVENTORY)
+xx(PCD_GIVEACTORINVENTORY)
+xx(PCD_GIVEINVENTORYDIRECT)
+xx(PCD_TAKEINVENTORY)
+xx(PCD_TAKEACTORINVENTORY)
+xx(PCD_TAKEINVENTORYDIRECT)
+xx(PCD_CHECKINVENTORY)
+xx(PCD_CHECKACTORINVENTORY)
+xx(PCD_CHECKINVENTORYDIRECT)
+xx(PCD_USEINVENTORY)
+xx(PCD_USEACTORINVENTORY)
+xx(PCD_GETSIGILPIECES)
+xx(PCD_GETAMMOCAPACITY)
+xx(PCD_SETAMMOCAPACITY)
+xx(PCD_SETMUSIC)
+xx(PCD_SETMUSICDIRECT)
+xx(PCD_LOCALSETMUSIC)
+xx(PCD_LOCALSETMUSICDIRECT)
+xx(PCD_FADETO)
+xx(PCD_FADERANGE)
+xx(PCD_CANCELFADE)
+xx(PCD_PLAYMOVIE)
+xx(PCD_SETACTORPOSITION)
+xx(PCD_GETACTORX)
+xx(PCD_GETACTORY)
+xx(PCD_GETACTORZ)
+xx(PCD_GETACTORFLOORZ)
+xx(PCD_GETACTORCEILINGZ)
+xx(PCD_GETACTORANGLE)
+xx(PCD_GETACTORPITCH)
+xx(PCD_GETLINEROWOFFSET)
+xx(PCD_GETSECTORFLOORZ)
+xx(PCD_GETSECTORCEILINGZ)
+xx(PCD_GETSECTORLIGHTLEVEL)
+xx(PCD_SETFLOORTRIGGER)
+xx(PCD_SETCEILINGTRIGGER)
+xx(PCD_STARTTRANSLATION)
+xx(PCD_TRANSLATIONRANGE1)
+xx(PCD_TRANSLATIONRANGE2)
+xx(PCD_TRANSLATIONRANGE3)
+xx(PCD_ENDTRANSLATION)
+xx(PCD_SIN)
+xx(PCD_COS)
+xx(PCD_VECTORANGLE)
+xx(PCD_CHECKWEAPON)
+xx(PCD_SETWEAPON)
+xx(PCD_SETMARINEWEAPON)
+xx(PCD_SETMARINESPRITE)
+xx(PCD_SETACTORPROPERTY)
+xx(PCD_GETACTORPROPERTY)
+xx(PCD_GETPLAYERINPUT)
+xx(PCD_PLAYERNUMBER)
+xx(PCD_PLAYERINGAME)
+xx(PCD_PLAYERISBOT)
+xx(PCD_ACTIVATORTID)
+xx(PCD_GETSCREENWIDTH)
+xx(PCD_GETSCREENHEIGHT)
+xx(PCD_THING_PROJECTILE2)
+xx(PCD_SPAWNPROJECTILE)
+xx(PCD_STRLEN)
+xx(PCD_GETCVAR)
+xx(PCD_SETHUDSIZE)
+xx(PCD_GETLEVELINFO)
+xx(PCD_CHANGESKY)
+xx(PCD_SETCAMERATOTEXTURE)
+xx(PCD_SETACTORANGLE)
+xx(PCD_SETACTORPITCH)
+xx(PCD_SETACTORSTATE)
+xx(PCD_PLAYERCLASS)
+xx(PCD_GETPLAYERINFO)
+xx(PCD_CHANGELEVEL)
+xx(PCD_SECTORDAMAGE)
+xx(PCD_THINGDAMAGE2)
+xx(PCD_CHECKACTORCEILINGTEXTURE)
+xx(PCD_CHECKACTORFLOORTEXTURE)
+xx(PCD_GETACTORLIGHTLEVEL)
+xx(PCD_SETMUGSHOTSTATE)
+xx(PCD_CHECKPLAYERCAMERA)
+xx(PCD_CLASSIFYACTOR)
+xx(PCD_MORPHACTOR)
+xx(PCD_UNMORPHACTOR)
+xx(PCD_SAVESTRING)
+xx(PCD_STRCPYTOSCRIPTCHRANGE)
+xx(PCD_STRCPYTOMAPCHRANGE)
+xx(PCD_STRCPYTOWORLDCHRANGE)
+xx(PCD_STRCPYTOGLOBALCHRANGE)
+xx(PCD_CONSOLECOMMAND)
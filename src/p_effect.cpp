@@ -51,6 +51,7 @@
 #include "gi.h"
 #include "v_palette.h"
 #include "colormatcher.h"
+#include "x86.h"
 
 CVAR (Int, cl_rockettrails, 1, CVAR_ARCHIVE);
 CVAR (Bool, r_rail_smartspiral, 0, CVAR_ARCHIVE);
@@ -62,12 +63,19 @@ FRandom pr_railtrail("RailTrail");
 
 #define FADEFROMTTL(a)	(255/(a))
 
+#define MAX_PARTICLES	1000000
+
 // [RH] particle globals
-WORD			NumParticles;
-WORD			ActiveParticles;
-WORD			InactiveParticles;
-particle_t		*Particles;
-TArray<WORD>	ParticlesInSubsec;
+DWORD			NumParticles;
+DWORD			ActiveParticles;
+FParticleStore	Particles;
+TArray<DWORD>	ParticlesInSubsec;
+
+// Particles spawned since the store was last updated. Spawning code fills
+// them in through the pointer NewParticle returns, which is good until
+// the next call to NewParticle.
+static particle_t	NewParticles[256];
+static int			NumNewParticles;
 
 static int grey1, grey2, grey3, grey4, red, green, blue, yellow, black,
 		   red1, green1, blue1, yellow1, purple, purple1, white,
@@ -107,16 +115,131 @@ static const struct ColorList {
 	{NULL, 0, 0, 0 }
 };
 
+//==========================================================================
+//
+// FParticleStore :: Alloc
+//
+// All arrays come out of one block. Each one starts 16-byte aligned and
+// has room for a multiple of 16 particles, so they can be worked on in
+// whole SIMD registers.
+//
+//==========================================================================
+
+template<class T> static T *CarveParticleArray (BYTE *&mem, size_t count)
+{
+	T *array = (T *)mem;
+	mem += count * sizeof(T);
+	return array;
+}
+
+void FParticleStore::Alloc (DWORD count)
+{
+	size_t padded = (count + 15) & ~15;
+	size_t size = 9 * sizeof(fixed_t) + 5 * sizeof(BYTE) + sizeof(WORD) +
+		sizeof(int) + sizeof(DWORD) + sizeof(subsector_t *);
+
+	Free ();
+	Block = new BYTE[padded * size + 15];
+
+	BYTE *mem = (BYTE *)(((size_t)Block + 15) & ~(size_t)15);
+	X = CarveParticleArray<fixed_t> (mem, padded);
+	Y = CarveParticleArray<fixed_t> (mem, padded);
+	Z = CarveParticleArray<fixed_t> (mem, padded);
+	VelX = CarveParticleArray<fixed_t> (mem, padded);
+	VelY = CarveParticleArray<fixed_t> (mem, padded);
+	VelZ = CarveParticleArray<fixed_t> (mem, padded);
+	AccX = CarveParticleArray<fixed_t> (mem, padded);
+	AccY = CarveParticleArray<fixed_t> (mem, padded);
+	AccZ = CarveParticleArray<fixed_t> (mem, padded);
+	Subsector = CarveParticleArray<subsector_t *> (mem, padded);
+	Color = CarveParticleArray<int> (mem, padded);
+	SNext = CarveParticleArray<DWORD> (mem, padded);
+	Size = CarveParticleArray<WORD> (mem, padded);
+	TTL = CarveParticleArray<BYTE> (mem, padded);
+	Trans = CarveParticleArray<BYTE> (mem, padded);
+	Fade = CarveParticleArray<BYTE> (mem, padded);
+	Bright = CarveParticleArray<BYTE> (mem, padded);
+	Expired = CarveParticleArray<BYTE> (mem, padded);
+}
+
+void FParticleStore::Free ()
+{
+	if (Block != NULL)
+	{
+		delete[] Block;
+		Block = NULL;
+	}
+}
+
+void FParticleStore::Move (DWORD dest, DWORD src)
+{
+	X[dest] = X[src];
+	Y[dest] = Y[src];
+	Z[dest] = Z[src];
+	VelX[dest] = VelX[src];
+	VelY[dest] = VelY[src];
+	VelZ[dest] = VelZ[src];
+	AccX[dest] = AccX[src];
+	AccY[dest] = AccY[src];
+	AccZ[dest] = AccZ[src];
+	Subsector[dest] = Subsector[src];
+	Color[dest] = Color[src];
+	SNext[dest] = SNext[src];
+	Size[dest] = Size[src];
+	TTL[dest] = TTL[src];
+	Trans[dest] = Trans[src];
+	Fade[dest] = Fade[src];
+	Bright[dest] = Bright[src];
+	Expired[dest] = Expired[src];
+}
+
+//==========================================================================
+//
+// P_AddNewParticles
+//
+// Moves the particles spawned since the last call into the store.
+//
+//==========================================================================
+
+static void P_AddNewParticles ()
+{
+	for (int i = 0; i < NumNewParticles; ++i)
+	{
+		const particle_t *p = &NewParticles[i];
+		DWORD j = ActiveParticles++;
+
+		Particles.X[j] = p->x;
+		Particles.Y[j] = p->y;
+		Particles.Z[j] = p->z;
+		Particles.VelX[j] = p->velx;
+		Particles.VelY[j] = p->vely;
+		Particles.VelZ[j] = p->velz;
+		Particles.AccX[j] = p->accx;
+		Particles.AccY[j] = p->accy;
+		Particles.AccZ[j] = p->accz;
+		Particles.Subsector[j] = NULL;
+		Particles.Color[j] = p->color;
+		Particles.Size[j] = p->size;
+		Particles.TTL[j] = p->ttl;
+		Particles.Trans[j] = p->trans;
+		Particles.Fade[j] = p->fade;
+		Particles.Bright[j] = p->bright;
+	}
+	NumNewParticles = 0;
+}
+
 inline particle_t *NewParticle (void)
 {
-	particle_t *result = NULL;
-	if (InactiveParticles != NO_PARTICLE)
+	if (ActiveParticles + NumNewParticles >= NumParticles)
+	{
+		return NULL;
+	}
+	if (NumNewParticles == countof(NewParticles))
 	{
-		result = Particles + InactiveParticles;
-		InactiveParticles = result->tnext;
-		result->tnext = ActiveParticles;
-		ActiveParticles = WORD(result - Particles);
+		P_AddNewParticles ();
 	}
+	particle_t *result = &NewParticles[NumNewParticles++];
+	memset (result, 0, sizeof(*result));
 	return result;
 }
 
@@ -132,8 +255,8 @@ CUSTOM_CVAR( Int, r_maxparticles, 4000, CVAR_ARCHIVE )
 {
 	if ( self == 0 )
 		self = 4000;
-	else if (self > 65535)
-		self = 65535;
+	else if (self > MAX_PARTICLES)
+		self = MAX_PARTICLES;
 	else if (self < 100)
 		self = 100;
 
@@ -155,38 +278,50 @@ void P_InitParticles ()
 		NumParticles = r_maxparticles;
 
 	// This should be good, but eh...
-	NumParticles = clamp<WORD>(NumParticles, 100, 65535);
+	NumParticles = clamp<DWORD>(NumParticles, 100, MAX_PARTICLES);
 
 	P_DeinitParticles();
-	Particles = new particle_t[NumParticles];
+	Particles.Alloc (NumParticles);
 	P_ClearParticles ();
 	atterm (P_DeinitParticles);
 }
 
 void P_DeinitParticles()
 {
-	if (Particles != NULL)
-	{
-		delete[] Particles;
-		Particles = NULL;
-	}
+	Particles.Free ();
+	NumParticles = 0;
+	ActiveParticles = 0;
+	NumNewParticles = 0;
 }
 
 void P_ClearParticles ()
 {
-	int i;
+	ActiveParticles = 0;
+	NumNewParticles = 0;
+}
 
-	memset (Particles, 0, NumParticles * sizeof(particle_t));
-	ActiveParticles = NO_PARTICLE;
-	InactiveParticles = 0;
-	for (i = 0; i < NumParticles-1; i++)
-		Particles[i].tnext = i + 1;
-	Particles[i].tnext = NO_PARTICLE;
+// Checks if a point is still inside a subsector by testing it against the
+// subsector's segs. This only works if the segs close the subsector,
+// which is not always so without GL nodes, so gaps count as outside.
+
+static bool P_PointInParticleSubsector (fixed_t x, fixed_t y, const subsector_t *sub)
+{
+	const seg_t *seg = sub->firstline;
+	const vertex_t *start = seg->v1;
+
+	for (DWORD i = sub->numlines; i > 0; --i, ++seg)
+	{
+		if (seg->v2 != (i > 1 ? seg[1].v1 : start))
+			return false;
+		if (DMulScale32 (y - seg->v1->y, seg->v2->x - seg->v1->x, seg->v1->x - x, seg->v2->y - seg->v1->y) > 0)
+			return false;
+	}
+	return true;
 }
 
-// Group particles by subsectors. Because particles are always
-// in motion, there is little benefit to caching this information
-// from one frame to the next.
+// Group particles by subsectors. Most particles are still in the subsector
+// they were found in the frame before, so only the ones that left it need
+// a walk down the BSP.
 
 void P_FindParticleSubsectors ()
 {
@@ -195,18 +330,26 @@ void P_FindParticleSubsectors ()
 		ParticlesInSubsec.Reserve (numsubsectors - ParticlesInSubsec.Size());
 	}
 
-	clearbufshort (&ParticlesInSubsec[0], numsubsectors, NO_PARTICLE);
+	clearbuf (&ParticlesInSubsec[0], numsubsectors, (SDWORD)NO_PARTICLE);
 
 	if (!r_particles)
 	{
 		return;
 	}
-	for (WORD i = ActiveParticles; i != NO_PARTICLE; i = Particles[i].tnext)
+	P_AddNewParticles ();
+	for (DWORD i = 0; i < ActiveParticles; i++)
 	{
-		subsector_t *ssec = R_PointInSubsector (Particles[i].x, Particles[i].y);
+		fixed_t x = Particles.X[i];
+		fixed_t y = Particles.Y[i];
+		subsector_t *ssec = Particles.Subsector[i];
+
+		if (ssec == NULL || !P_PointInParticleSubsector (x, y, ssec))
+		{
+			ssec = R_PointInSubsector (x, y);
+			Particles.Subsector[i] = ssec;
+		}
 		int ssnum = int(ssec-subsectors);
-		Particles[i].subsector = ssec;
-		Particles[i].snext = ParticlesInSubsec[ssnum];
+		Particles.SNext[i] = ParticlesInSubsec[ssnum];
 		ParticlesInSubsec[ssnum] = i;
 	}
 }
@@ -250,39 +393,65 @@ void P_InitEffects ()
 }
 
 
+static void ParticleFade (BYTE *trans, const BYTE *fade, BYTE *ttl, BYTE *expired, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		BYTE oldtrans = trans[i];
+		trans[i] -= fade[i];
+		expired[i] = (oldtrans < trans[i] || --ttl[i] == 0);
+	}
+}
+
+static void ParticleIntegrate (fixed_t *pos, fixed_t *vel, const fixed_t *acc, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		pos[i] += vel[i];
+		vel[i] += acc[i];
+	}
+}
+
+// Fades and moves every particle a whole array at a time, then fills the
+// holes left by the expired ones with particles from the end.
+
 void P_ThinkParticles ()
 {
-	int i;
-	particle_t *particle, *prev;
-
-	i = ActiveParticles;
-	prev = NULL;
-	while (i != NO_PARTICLE)
-	{
-		BYTE oldtrans;
-
-		particle = Particles + i;
-		i = particle->tnext;
-		oldtrans = particle->trans;
-		particle->trans -= particle->fade;
-		if (oldtrans < particle->trans || --particle->ttl == 0)
-		{ // The particle has expired, so free it
-			memset (particle, 0, sizeof(particle_t));
-			if (prev)
-				prev->tnext = i;
-			else
-				ActiveParticles = i;
-			particle->tnext = InactiveParticles;
-			InactiveParticles = (int)(particle - Particles);
-			continue;
+	P_AddNewParticles ();
+
+	int count = ActiveParticles;
+	if (count == 0)
+	{
+		return;
+	}
+#if defined(_M_X64) || defined(_M_IX86) || defined(__i386__) || defined(__amd64__)
+	if (CPU.bSSE2)
+	{
+		ParticleFade_SSE2 (Particles.Trans, Particles.Fade, Particles.TTL, Particles.Expired, count);
+		ParticleIntegrate_SSE2 (Particles.X, Particles.VelX, Particles.AccX, count);
+		ParticleIntegrate_SSE2 (Particles.Y, Particles.VelY, Particles.AccY, count);
+		ParticleIntegrate_SSE2 (Particles.Z, Particles.VelZ, Particles.AccZ, count);
+	}
+	else
+#endif
+	{
+		ParticleFade (Particles.Trans, Particles.Fade, Particles.TTL, Particles.Expired, count);
+		ParticleIntegrate (Particles.X, Particles.VelX, Particles.AccX, count);
+		ParticleIntegrate (Particles.Y, Particles.VelY, Particles.AccY, count);
+		ParticleIntegrate (Particles.Z, Particles.VelZ, Particles.AccZ, count);
+	}
+
+	DWORD i = 0;
+	while (i < ActiveParticles)
+	{
+		if (Particles.Expired[i])
+		{ // The particle has expired, so replace it with the last one
+			Particles.Move (i, --ActiveParticles);
+		}
+		else
+		{
+			i++;
 		}
-		particle->x += particle->velx;
-		particle->y += particle->vely;
-		particle->z += particle->velz;
-		particle->velx += particle->accx;
-		particle->vely += particle->accy;
-		particle->velz += particle->accz;
-		prev = particle;
 	}
 }
 
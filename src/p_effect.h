@@ -52,6 +52,8 @@
 struct subsector_t;
 
 // [RH] Particle details
+// This is what a particle is spawned from. Once it has been handed to
+// the particle store, it lives in the arrays of FParticleStore instead.
 struct particle_t
 {
 	fixed_t	x,y,z;
@@ -63,15 +65,40 @@ struct particle_t
 	BYTE	bright:1;
 	BYTE	fade;
 	int		color;
-	WORD	tnext;
-	WORD	snext;
-	subsector_t * subsector;
 };
 
-extern particle_t *Particles;
-extern TArray<WORD>		ParticlesInSubsec;
+// The live particles, kept one array per field so that P_ThinkParticles
+// can work on many at once. Entries 0 to ActiveParticles-1 are in use;
+// expiring particles are replaced by the last one, so the index of a
+// particle is only good until the next P_ThinkParticles.
+struct FParticleStore
+{
+	fixed_t	*X, *Y, *Z;
+	fixed_t	*VelX, *VelY, *VelZ;
+	fixed_t	*AccX, *AccY, *AccZ;
+	BYTE	*TTL;
+	BYTE	*Trans;
+	BYTE	*Fade;
+	BYTE	*Bright;
+	BYTE	*Expired;
+	WORD	*Size;
+	int		*Color;
+	DWORD	*SNext;					// next particle in the same subsector
+	subsector_t **Subsector;		// where P_FindParticleSubsectors last saw it
+
+	void Alloc(DWORD count);
+	void Free();
+	void Move(DWORD dest, DWORD src);
+
+private:
+	BYTE	*Block;
+};
+
+extern FParticleStore	Particles;
+extern DWORD			ActiveParticles;
+extern TArray<DWORD>	ParticlesInSubsec;
 
-const WORD NO_PARTICLE = 0xffff;
+const DWORD NO_PARTICLE = 0xffffffff;
 
 void P_ClearParticles ();
 void P_FindParticleSubsectors ();
@@ -2609,7 +2609,7 @@ static bool P_CheckForResurrection(AActor *self, bool usevilestates)
 				{
 					// For Dehacked compatibility this has to use the Arch Vile's
 					// heal state as a default if the actor doesn't define one itself.
-					PClassActor *archvile = PClass::FindActor("Archvile");
+					PClassActor *archvile = PClass::FindActor(NAME_LITERAL("Archvile"));
 					if (archvile != NULL)
 					{
 						self->SetState(archvile->FindState(NAME_Heal));
@@ -188,6 +188,7 @@ void DFloor::Tick ()
 			}
 
 			m_Sector->floordata = NULL; //jff 2/22/98
+			P_WakeScriptsForSector (m_Sector);
 			StopInterpolation();
 
 			//jff 2/26/98 implement stair retrigger lockout while still building
@@ -1242,7 +1242,7 @@ bool AActor::Grind(bool items)
 				A_BossDeath(this);
 			}
 
-			PClassActor *i = PClass::FindActor("RealGibs");
+			PClassActor *i = PClass::FindActor(NAME_LITERAL("RealGibs"));
 
 			if (i != NULL)
 			{
@@ -4957,7 +4957,7 @@ AActor *P_SpawnMapThing (FMapThing *mthing, int position)
 
 			Printf ("%s at (%i, %i) has no frames\n",
 					i->TypeName.GetChars(), mthing->x>>FRACBITS, mthing->y>>FRACBITS);
-			i = PClass::FindActor("Unknown");
+			i = PClass::FindActor(NAME_LITERAL("Unknown"));
 			assert(i->IsKindOf(RUNTIME_CLASS(PClassActor)));
 		}
 
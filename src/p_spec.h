@@ -940,6 +940,8 @@ int  P_StartScript (AActor *who, line_t *where, int script, const char *map, con
 void P_SuspendScript (int script, const char *map);
 void P_TerminateScript (int script, const char *map);
 void P_DoDeferedScripts (void);
+void P_WakeScriptsForSector (sector_t *sector);
+void P_WakeScriptsForPolyobj (int polyobj);
 
 //
 // [RH] p_quake.c
@@ -662,7 +662,7 @@ bool EV_TeleportGroup (int group_tid, AActor *victim, int source_tid, int dest_t
 	}
 
 	bool didSomething = false;
-	bool floorz = !destOrigin->IsKindOf (PClass::FindClass("TeleportDest2"));
+	bool floorz = !destOrigin->IsKindOf (PClass::FindClass(NAME_TeleportDest2));
 
 	// Use the passed victim if group_tid is 0
 	if (group_tid == 0 && victim != NULL)
@@ -717,7 +717,7 @@ bool EV_TeleportSector (int tag, int source_tid, int dest_tid, bool fog, int gro
 	}
 
 	bool didSomething = false;
-	bool floorz = !destOrigin->IsKindOf (PClass::FindClass("TeleportDest2"));
+	bool floorz = !destOrigin->IsKindOf (PClass::FindClass(NAME_TeleportDest2));
 	int secnum;
 
 	secnum = -1;
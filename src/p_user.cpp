@@ -92,6 +92,24 @@ static TArray<sector_t *> PredictionTouchingSectorsBackup;
 static TArray<AActor *> PredictionSectorListBackup;
 static TArray<msecnode_t *> PredictionSector_sprev_Backup;
 
+// The predicted state after each tic, along with the command that produced
+// it. Until the next tic runs, frames can pick up from here instead of
+// running every tic from gametic again, as long as the commands stay the
+// same. Once gametic moves on, the rest of the world has moved too, so
+// everything is predicted again.
+struct PredictionSnapshot
+{
+	int tic;
+	ticcmd_t cmd;
+	player_t player;
+	BYTE actor[sizeof(APlayerPawn)];
+};
+static PredictionSnapshot PredictionCache[BACKUPTICS];
+static int PredictionCacheBase = -1;	// gametic the cached tics were predicted from
+static int PredictionCacheEnd;			// first tic that is not cached
+static BYTE PredictionCacheBaseActor[sizeof(APlayerPawn)];
+static player_t PredictionCacheBasePlayer;
+
 // [GRB] Custom player classes
 TArray<FPlayerClass> PlayerClasses;
 
@@ -2755,6 +2773,152 @@ bool P_LerpCalculate(PredictPos from, PredictPos to, PredictPos &result, float s
 	return (delta.LengthSquared() > cl_predict_lerpthreshold && scale <= 1.00f);
 }
 
+//==========================================================================
+//
+// Prediction cache
+//
+// The actor is only saved from snext on, the same as for the backup.
+//
+//==========================================================================
+
+static size_t P_PredictionActorSize(APlayerPawn *act)
+{
+	return sizeof(APlayerPawn) - ((BYTE *)&act->snext - (BYTE *)act);
+}
+
+// Object pointers are never taken from a snapshot. The collector may have
+// run since it was saved, and copying them would bypass its write barrier,
+// so restoring keeps the ones the actor has now.
+#define PREDICTION_KEPT_POINTERS(X) \
+	X(target) X(lastenemy) X(LastHeard) X(LastLookActor) X(tracer) X(master) \
+	X(goal) X(Poisoner) X(Inventory) X(InvFirst) X(InvSel) X(BlockingMobj)
+
+// The player_t fields prediction can change, besides cheats, psprites and
+// the original command. Everything else is left alone while predicting
+// (P_PlayerThink skips counters, specials and psprites then), so it is
+// taken from the real player instead of from a cached prediction.
+#define PREDICTED_PLAYER_FIELDS(X) \
+	X(viewz) X(viewheight) X(deltaviewheight) X(bob) X(velx) X(vely) \
+	X(centering) X(turnticks) X(attackdown) X(usedown) X(oldbuttons) \
+	X(WeaponState) X(refire) X(morphTics) X(jumpTics) X(onground) \
+	X(crouching) X(crouchdir) X(crouchfactor) X(crouchoffset) \
+	X(crouchviewdelta) X(FOV)
+
+static bool P_PredictedPlayerMatches(const player_t *a, const player_t *b)
+{
+#define COMPAREFIELD(field) if (a->field != b->field) return false;
+	PREDICTED_PLAYER_FIELDS(COMPAREFIELD)
+#undef COMPAREFIELD
+	if (a->ReadyWeapon != b->ReadyWeapon || a->PendingWeapon != b->PendingWeapon ||
+		((a->cheats ^ b->cheats) & ~CF_PREDICTING))
+	{
+		return false;
+	}
+	for (int i = 0; i < NUMPSPRITES; ++i)
+	{
+		if (a->psprites[i].state != b->psprites[i].state || a->psprites[i].tics != b->psprites[i].tics ||
+			a->psprites[i].sx != b->psprites[i].sx || a->psprites[i].sy != b->psprites[i].sy)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// P_PredictionCacheStart
+//
+// Returns the first tic that needs to be predicted. Cached tics are only
+// good while no tic has run since they were predicted, because they were
+// predicted against the rest of the world as it was then. The player must
+// still be where the prediction started, and the commands for the cached
+// tics must not have changed.
+//
+//==========================================================================
+
+static int P_PredictionCacheStart(player_t *player, int maxtic)
+{
+	APlayerPawn *act = player->mo;
+	int i;
+
+	if (PredictionCacheBase != gametic || gametic >= PredictionCacheEnd ||
+		memcmp(PredictionCacheBaseActor, PredictionActorBackup, P_PredictionActorSize(act)) != 0 ||
+		!P_PredictedPlayerMatches(player, &PredictionCacheBasePlayer))
+	{
+		return gametic;
+	}
+
+	for (i = gametic; i < PredictionCacheEnd && i < maxtic; ++i)
+	{
+		PredictionSnapshot *snap = &PredictionCache[i % BACKUPTICS];
+		if (snap->tic != i || memcmp(&snap->cmd, &localcmds[i % LOCALCMDTICS], sizeof(ticcmd_t)) != 0)
+		{
+			break;
+		}
+	}
+	return i;
+}
+
+//==========================================================================
+//
+// P_RestorePrediction
+//
+// Puts the player where the prediction for the given tic left them. The
+// actor is relinked in the normal way; P_UnPredictPlayer puts the links
+// back the way they were before prediction started. Only the player
+// fields prediction changes are restored. The rest still hold the values
+// from PredictionPlayerBackup, which may have changed since the cached
+// tics were predicted.
+//
+//==========================================================================
+
+static void P_RestorePrediction(player_t *player, int tic)
+{
+	static BYTE restore[sizeof(APlayerPawn)];
+	PredictionSnapshot *snap = &PredictionCache[tic % BACKUPTICS];
+	const player_t *predicted = &snap->player;
+	APlayerPawn *act = player->mo;
+	BYTE *base = (BYTE *)&act->snext;
+
+	memcpy(restore, snap->actor, P_PredictionActorSize(act));
+#define KEEPFIELD(field) memcpy(restore + ((BYTE *)&act->field - base), &act->field, sizeof(act->field));
+	PREDICTION_KEPT_POINTERS(KEEPFIELD)
+#undef KEEPFIELD
+
+	act->UnlinkFromWorld();
+	memcpy(base, restore, P_PredictionActorSize(act));
+	act->snext = NULL;
+	act->sprev = NULL;
+	act->touching_sectorlist = NULL;
+	act->BlockNode = NULL;
+	act->LinkToWorld(act->Sector);
+
+#define RESTOREFIELD(field) player->field = predicted->field;
+	PREDICTED_PLAYER_FIELDS(RESTOREFIELD)
+#undef RESTOREFIELD
+	player->cheats = (predicted->cheats & ~CF_PREDICTING) | (player->cheats & CF_PREDICTING);
+	player->original_cmd = predicted->original_cmd;
+	player->original_oldbuttons = predicted->original_oldbuttons;
+	memcpy(player->psprites, predicted->psprites, sizeof(player->psprites));
+}
+
+//==========================================================================
+//
+// P_SavePrediction
+//
+//==========================================================================
+
+static void P_SavePrediction(player_t *player, int tic)
+{
+	PredictionSnapshot *snap = &PredictionCache[tic % BACKUPTICS];
+
+	snap->tic = tic;
+	snap->cmd = localcmds[tic % LOCALCMDTICS];
+	snap->player = *player;
+	memcpy(snap->actor, &player->mo->snext, P_PredictionActorSize(player->mo));
+}
+
 void P_PredictPlayer (player_t *player)
 {
 	int maxtic;
@@ -2840,9 +3004,22 @@ void P_PredictPlayer (player_t *player)
 	}
 	act->BlockNode = NULL;
 
+	// Skip the tics that were already predicted with the same commands.
+	int starttic = P_PredictionCacheStart(player, maxtic);
+	if (starttic == gametic)
+	{
+		PredictionCacheBase = gametic;
+		memcpy(PredictionCacheBaseActor, PredictionActorBackup, P_PredictionActorSize(act));
+		PredictionCacheBasePlayer = PredictionPlayerBackup;
+	}
+	else
+	{
+		P_RestorePrediction(player, starttic - 1);
+	}
+
 	// Values too small to be usable for lerping can be considered "off".
 	bool CanLerp = (!(cl_predict_lerpscale < 0.01f) && (ticdup == 1)), DoLerp = false, NoInterpolateOld = R_GetViewInterpolationStatus();
-	for (int i = gametic; i < maxtic; ++i)
+	for (int i = starttic; i < maxtic; ++i)
 	{
 		if (!NoInterpolateOld)
 			R_RebuildViewInterpolation(player);
@@ -2850,6 +3027,7 @@ void P_PredictPlayer (player_t *player)
 		player->cmd = localcmds[i % LOCALCMDTICS];
 		P_PlayerThink (player);
 		player->mo->Tick ();
+		P_SavePrediction(player, i);
 
 		if (CanLerp && PredictionLast.gametic > 0 && i == PredictionLast.gametic && !NoInterpolateOld)
 		{
@@ -2869,6 +3047,8 @@ void P_PredictPlayer (player_t *player)
 		}
 	}
 
+	PredictionCacheEnd = maxtic;
+
 	if (CanLerp)
 	{
 		if (NoInterpolateOld)
@@ -242,6 +242,7 @@ void DPolyAction::Destroy()
 	if (poly->specialdata == this)
 	{
 		poly->specialdata = NULL;
+		P_WakeScriptsForPolyobj (m_PolyObj);
 	}
 
 	StopInterpolation();
@@ -73,8 +73,24 @@ private:
 	bool NeedGammaUpdate;
 	bool NotPaletted;
 
+	// With vid_presentthread, a copy of the frame is converted into the
+	// locked texture by another thread while the next frame is rendered.
+	// The texture is uploaded and presented at the start of the next Update.
+	SDL_Thread *PresentThread;
+	SDL_sem *PresentStart;
+	SDL_sem *PresentDone;
+	TArray<BYTE> PresentBuffer;
+	void *PresentPixels;
+	int PresentPitch;
+	bool PresentPending;
+	bool PresentQuit;
+
 	void UpdateColors ();
+	void ApplyColorChanges ();
 	void ResetSDLRenderer ();
+	void FinishPresent ();
+	void StopPresentThread ();
+	static int PresentThreadFunc (void *fb);
 
 	SDLFB () {}
 };
@@ -107,6 +123,10 @@ CVAR (Int, vid_displaybits, 32, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 
 CVAR (Bool, vid_forcesurface, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 
+// Converts and presents each frame while the next one is rendered, at the
+// cost of one frame of latency.
+CVAR (Bool, vid_presentthread, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
 CUSTOM_CVAR (Float, rgamma, 1.f, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 {
 	if (screen != NULL)
@@ -356,6 +376,11 @@ SDLFB::SDLFB (int width, int height, bool fullscreen, SDL_Window *oldwin)
 	UpdatePending = false;
 	NotPaletted = false;
 	FlashAmount = 0;
+	PresentThread = NULL;
+	PresentStart = NULL;
+	PresentDone = NULL;
+	PresentPending = false;
+	PresentQuit = false;
 
 	if (oldwin)
 	{
@@ -399,6 +424,8 @@ SDLFB::SDLFB (int width, int height, bool fullscreen, SDL_Window *oldwin)
 
 SDLFB::~SDLFB ()
 {
+	StopPresentThread ();
+
 	if (Renderer)
 	{
 		if (Texture)
@@ -474,8 +501,40 @@ void SDLFB::Update ()
 	SDLFlipCycles.Reset();
 	BlitCycles.Clock();
 
+	// Present the frame that was handed to the present thread last time.
+	FinishPresent ();
+
 	void *pixels;
 	int pitch;
+	if (vid_presentthread && UsingRenderer && NotPaletted)
+	{
+		if (PresentThread == NULL)
+		{
+			PresentStart = SDL_CreateSemaphore (0);
+			PresentDone = SDL_CreateSemaphore (0);
+			PresentThread = SDL_CreateThread (PresentThreadFunc, "Present", this);
+		}
+		if (PresentThread != NULL)
+		{
+			// Palette changes must not happen while the thread converts.
+			ApplyColorChanges ();
+
+			if (SDL_LockTexture (Texture, NULL, &pixels, &pitch))
+			{
+				BlitCycles.Unclock();
+				return;
+			}
+			PresentBuffer.Resize (Pitch * Height);
+			memcpy (&PresentBuffer[0], MemBuffer, Pitch * Height);
+			PresentPixels = pixels;
+			PresentPitch = pitch;
+			PresentPending = true;
+			SDL_SemPost (PresentStart);
+			BlitCycles.Unclock();
+			return;
+		}
+	}
+
 	if (UsingRenderer)
 	{
 		if (SDL_LockTexture (Texture, NULL, &pixels, &pitch))
@@ -532,6 +591,11 @@ void SDLFB::Update ()
 
 	BlitCycles.Unclock();
 
+	ApplyColorChanges ();
+}
+
+void SDLFB::ApplyColorChanges ()
+{
 	if (NeedGammaUpdate)
 	{
 		bool Windowed = false;
@@ -549,6 +613,73 @@ void SDLFB::Update ()
 	}
 }
 
+//==========================================================================
+//
+// SDLFB :: FinishPresent
+//
+// Waits for the present thread to convert the last frame it was given,
+// then uploads and presents it.
+//
+//==========================================================================
+
+void SDLFB::FinishPresent ()
+{
+	if (!PresentPending)
+	{
+		return;
+	}
+	PresentPending = false;
+	SDL_SemWait (PresentDone);
+	SDL_UnlockTexture (Texture);
+
+	SDLFlipCycles.Clock();
+	SDL_RenderClear(Renderer);
+	SDL_RenderCopy(Renderer, Texture, NULL, NULL);
+	SDL_RenderPresent(Renderer);
+	SDLFlipCycles.Unclock();
+}
+
+void SDLFB::StopPresentThread ()
+{
+	FinishPresent ();
+	if (PresentThread != NULL)
+	{
+		PresentQuit = true;
+		SDL_SemPost (PresentStart);
+		SDL_WaitThread (PresentThread, NULL);
+		PresentThread = NULL;
+	}
+	if (PresentStart != NULL)
+	{
+		SDL_DestroySemaphore (PresentStart);
+		PresentStart = NULL;
+	}
+	if (PresentDone != NULL)
+	{
+		SDL_DestroySemaphore (PresentDone);
+		PresentDone = NULL;
+	}
+}
+
+int SDLFB::PresentThreadFunc (void *data)
+{
+	SDLFB *fb = (SDLFB *)data;
+
+	for (;;)
+	{
+		SDL_SemWait (fb->PresentStart);
+		if (fb->PresentQuit)
+		{
+			break;
+		}
+		GPfx.Convert (&fb->PresentBuffer[0], fb->Pitch,
+			fb->PresentPixels, fb->PresentPitch, fb->Width, fb->Height,
+			FRACUNIT, FRACUNIT, 0, 0);
+		SDL_SemPost (fb->PresentDone);
+	}
+	return 0;
+}
+
 void SDLFB::UpdateColors ()
 {
 	if (NotPaletted)
@@ -652,6 +783,8 @@ bool SDLFB::IsFullscreen ()
 
 void SDLFB::ResetSDLRenderer ()
 {
+	FinishPresent ();
+
 	if (Renderer)
 	{
 		if (Texture)
@@ -56,6 +56,7 @@
 #include "r_sky.h"
 #include "po_man.h"
 #include "r_data/colormaps.h"
+#include "r_profile.h"
 #include "portal.h"
 
 seg_t*			curline;
@@ -1216,7 +1217,9 @@ void R_Subsector (subsector_t *sub)
 					frontsector->sky,
 					NULL);
 
+				R_EnterPhase(RP_3DFloors);
 				R_FakeDrawLoop(sub);
+				R_LeavePhase(RP_3DFloors);
 				fake3D = 0;
 				frontsector = sub->sector;
 			}
@@ -1281,7 +1284,9 @@ void R_Subsector (subsector_t *sub)
 					frontsector->sky,
 					NULL);
 
+				R_EnterPhase(RP_3DFloors);
 				R_FakeDrawLoop(sub);
+				R_LeavePhase(RP_3DFloors);
 				fake3D = 0;
 				frontsector = sub->sector;
 			}
@@ -1307,9 +1312,9 @@ void R_Subsector (subsector_t *sub)
 	if ((unsigned int)(sub - subsectors) < (unsigned int)numsubsectors)
 	{ // Only do it for the main BSP.
 		int shade = LIGHT2SHADE((floorlightlevel + ceilinglightlevel)/2 + r_actualextralight);
-		for (WORD i = ParticlesInSubsec[(unsigned int)(sub-subsectors)]; i != NO_PARTICLE; i = Particles[i].snext)
+		for (DWORD i = ParticlesInSubsec[(unsigned int)(sub-subsectors)]; i != NO_PARTICLE; i = Particles.SNext[i])
 		{
-			R_ProjectParticle (Particles + i, subsectors[sub-subsectors].sector, shade, FakeSide);
+			R_ProjectParticle (i, subsectors[sub-subsectors].sector, shade, FakeSide);
 		}
 	}
 
@@ -1323,6 +1328,7 @@ void R_Subsector (subsector_t *sub)
 			// kg3D - fake planes bounding calculation
 			if (r_3dfloors && line->backsector && frontsector->e && line->backsector->e->XFloor.ffloors.Size())
 			{
+				R_EnterPhase(RP_3DFloors);
 				backupfp = floorplane;
 				backupcp = ceilingplane;
 				floorplane = NULL;
@@ -1357,6 +1363,7 @@ void R_Subsector (subsector_t *sub)
 				fake3D = 0;
 				floorplane = backupfp;
 				ceilingplane = backupcp;
+				R_LeavePhase(RP_3DFloors);
 			}
 			R_AddLine (line); // now real
 		}
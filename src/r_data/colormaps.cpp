@@ -482,23 +482,22 @@ void R_InitColormaps ()
 	cm.blend = 0;
 	fakecmaps.Push(cm);
 
-	DWORD NumLumps = Wads.GetNumLumps();
+	TArray<int> lumps;
+	Wads.GetNamespaceLumps(ns_colormaps, lumps);
 
-	for (DWORD i = 0; i < NumLumps; i++)
+	for (unsigned k = 0; k < lumps.Size(); k++)
 	{
-		if (Wads.GetLumpNamespace(i) == ns_colormaps)
-		{
-			char name[9];
-			name[8] = 0;
-			Wads.GetLumpName (name, i);
+		int i = lumps[k];
+		char name[9];
+		name[8] = 0;
+		Wads.GetLumpName (name, i);
 
-			if (Wads.CheckNumForName (name, ns_colormaps) == (int)i)
-			{
-				strncpy(cm.name, name, 8);
-				cm.blend = 0;
-				cm.lump = i;
-				fakecmaps.Push(cm);
-			}
+		if (Wads.CheckNumForName (name, ns_colormaps) == i)
+		{
+			strncpy(cm.name, name, 8);
+			cm.blend = 0;
+			cm.lump = i;
+			fakecmaps.Push(cm);
 		}
 	}
 	realcolormaps = new BYTE[256*NUMCOLORMAPS*fakecmaps.Size()];
@@ -65,7 +65,7 @@ public:
 	void Destroy();
 	void UpdateInterpolation();
 	void Restore();
-	void Interpolate(fixed_t smoothratio);
+	bool Interpolate(fixed_t smoothratio);
 	void Serialize(FArchive &arc);
 	size_t PointerSubstitution (DObject *old, DObject *notOld);
 	size_t PropagateMark();
@@ -93,7 +93,7 @@ public:
 	void Destroy();
 	void UpdateInterpolation();
 	void Restore();
-	void Interpolate(fixed_t smoothratio);
+	bool Interpolate(fixed_t smoothratio);
 	void Serialize(FArchive &arc);
 };
 
@@ -120,7 +120,7 @@ public:
 	void Destroy();
 	void UpdateInterpolation();
 	void Restore();
-	void Interpolate(fixed_t smoothratio);
+	bool Interpolate(fixed_t smoothratio);
 	void Serialize(FArchive &arc);
 };
 
@@ -146,7 +146,7 @@ public:
 	void Destroy();
 	void UpdateInterpolation();
 	void Restore();
-	void Interpolate(fixed_t smoothratio);
+	bool Interpolate(fixed_t smoothratio);
 	void Serialize(FArchive &arc);
 };
 
@@ -157,10 +157,7 @@ public:
 //
 //==========================================================================
 
-IMPLEMENT_ABSTRACT_POINTY_CLASS(DInterpolation)
-DECLARE_POINTER(Next)
-DECLARE_POINTER(Prev)
-END_POINTERS
+IMPLEMENT_ABSTRACT_CLASS(DInterpolation)
 IMPLEMENT_CLASS(DSectorPlaneInterpolation)
 IMPLEMENT_CLASS(DSectorScrollInterpolation)
 IMPLEMENT_CLASS(DWallScrollInterpolation)
@@ -169,7 +166,7 @@ IMPLEMENT_CLASS(DPolyobjInterpolation)
 //==========================================================================
 //
 // Important note:
-// The linked list of interpolations and the pointers in the interpolated
+// The list of interpolations and the pointers in the interpolated
 // objects are not processed by the garbage collector. This is intentional!
 //
 // If an interpolation is no longer owned by any thinker it should
@@ -190,7 +187,7 @@ FInterpolator interpolator;
 
 int FInterpolator::CountInterpolations ()
 {
-	return count;
+	return Interpolations.Size();
 }
 
 //==========================================================================
@@ -201,9 +198,31 @@ int FInterpolator::CountInterpolations ()
 
 void FInterpolator::UpdateInterpolations()
 {
-	for (DInterpolation *probe = Head; probe != NULL; probe = probe->Next)
+	for (unsigned int i = 0; i < Interpolations.Size(); i++)
 	{
-		probe->UpdateInterpolation ();
+		// Whatever did not move during the last tic is still where
+		// it was when that tic started.
+		if (Moved[i])
+		{
+			Interpolations[i]->UpdateInterpolation ();
+		}
+		Moved[i] = true;
+	}
+	Moving.Clear();
+	checked = false;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FInterpolator::MarkInterpolations()
+{
+	if (Interpolations.Size() > 0)
+	{
+		GC::MarkArray(Interpolations);
 	}
 }
 
@@ -215,11 +234,9 @@ void FInterpolator::UpdateInterpolations()
 
 void FInterpolator::AddInterpolation(DInterpolation *interp)
 {
-	interp->Next = Head;
-	if (Head != NULL) Head->Prev = interp;
-	interp->Prev = NULL;
-	Head = interp;
-	count++;
+	interp->Index = Interpolations.Push(interp);
+	Moved.Push(true);
+	checked = false;
 }
 
 //==========================================================================
@@ -230,19 +247,31 @@ void FInterpolator::AddInterpolation(DInterpolation *interp)
 
 void FInterpolator::RemoveInterpolation(DInterpolation *interp)
 {
-	if (Head == interp)
-	{
-		Head = interp->Next;
-		if (Head != NULL) Head->Prev = NULL;
-	}
-	else
+	unsigned int index = interp->Index;
+
+	if (index < Interpolations.Size() && Interpolations[index] == interp)
 	{
-		if (interp->Prev != NULL) interp->Prev->Next = interp->Next;
-		if (interp->Next != NULL) interp->Next->Prev = interp->Prev;
+		if (checked && Moved[index])
+		{
+			for (unsigned int i = 0; i < Moving.Size(); i++)
+			{
+				if (Moving[i] == interp)
+				{
+					Moving.Delete(i);
+					break;
+				}
+			}
+		}
+
+		// Fill the hole with the last interpolation.
+		unsigned int last = Interpolations.Size() - 1;
+		Interpolations[index] = Interpolations[last];
+		Interpolations[index]->Index = index;
+		Moved[index] = Moved[last];
+		Interpolations.Pop();
+		Moved.Pop();
 	}
-	interp->Next = NULL;
-	interp->Prev = NULL;
-	count--;
+	interp->Index = ~0u;
 }
 
 //==========================================================================
@@ -261,12 +290,34 @@ void FInterpolator::DoInterpolations(fixed_t smoothratio)
 
 	didInterp = true;
 
-	DInterpolation *probe = Head;
-	while (probe != NULL)
+	if (!checked)
 	{
-		DInterpolation *next = probe->Next;
-		probe->Interpolate(smoothratio);
-		probe = next;
+		// The first frame after a tic finds out what moved during it. Later
+		// frames until the next tic only need to look at those. Going
+		// backwards lets interpolations that are no longer needed remove
+		// themselves along the way.
+		Moving.Clear();
+		for (unsigned int i = Interpolations.Size(); i-- > 0; )
+		{
+			DInterpolation *interp = Interpolations[i];
+
+			if (interp->Interpolate(smoothratio))
+			{
+				Moving.Push(interp);
+			}
+			else if (i < Interpolations.Size() && Interpolations[i] == interp)
+			{
+				Moved[i] = false;
+			}
+		}
+		checked = true;
+	}
+	else
+	{
+		for (unsigned int i = Moving.Size(); i-- > 0; )
+		{
+			Moving[i]->Interpolate(smoothratio);
+		}
 	}
 }
 
@@ -281,9 +332,9 @@ void FInterpolator::RestoreInterpolations()
 	if (didInterp)
 	{
 		didInterp = false;
-		for (DInterpolation *probe = Head; probe != NULL; probe = probe->Next)
+		for (unsigned int i = 0; i < Moving.Size(); i++)
 		{
-			probe->Restore();
+			Moving[i]->Restore();
 		}
 	}
 }
@@ -296,15 +347,13 @@ void FInterpolator::RestoreInterpolations()
 
 void FInterpolator::ClearInterpolations()
 {
-	DInterpolation *probe = Head;
-	Head = NULL;
-	while (probe != NULL)
+	// Destroying an interpolation removes it from the list.
+	while (Interpolations.Size() > 0)
 	{
-		DInterpolation *next = probe->Next;
-		probe->Next = probe->Prev = NULL;
-		probe->Destroy();
-		probe = next;
+		Interpolations.Last()->Destroy();
 	}
+	Moving.Clear();
+	checked = false;
 }
 
 
@@ -322,8 +371,7 @@ void FInterpolator::ClearInterpolations()
 
 DInterpolation::DInterpolation()
 {
-	Next = NULL;
-	Prev = NULL;
+	Index = ~0u;
 	refcount = 0;
 }
 
@@ -476,7 +524,7 @@ void DSectorPlaneInterpolation::Restore()
 //
 //==========================================================================
 
-void DSectorPlaneInterpolation::Interpolate(fixed_t smoothratio)
+bool DSectorPlaneInterpolation::Interpolate(fixed_t smoothratio)
 {
 	fixed_t *pheight;
 	int pos;
@@ -495,16 +543,22 @@ void DSectorPlaneInterpolation::Interpolate(fixed_t smoothratio)
 	bakheight = *pheight;
 	baktexz = sector->GetPlaneTexZ(pos);
 
-	if (refcount == 0 && oldheight == bakheight)
+	if (oldheight == bakheight)
 	{
-		Destroy();
-	}
-	else
-	{
-		*pheight = oldheight + FixedMul(bakheight - oldheight, smoothratio);
-		sector->SetPlaneTexZ(pos, oldtexz + FixedMul(baktexz - oldtexz, smoothratio));
-		P_RecalculateAttached3DFloors(sector);
+		if (refcount == 0)
+		{
+			Destroy();
+			return false;
+		}
+		if (oldtexz == baktexz)
+		{
+			return false;
+		}
 	}
+	*pheight = oldheight + FixedMul(bakheight - oldheight, smoothratio);
+	sector->SetPlaneTexZ(pos, oldtexz + FixedMul(baktexz - oldtexz, smoothratio));
+	P_RecalculateAttached3DFloors(sector);
+	return true;
 }
 
 //==========================================================================
@@ -623,20 +677,22 @@ void DSectorScrollInterpolation::Restore()
 //
 //==========================================================================
 
-void DSectorScrollInterpolation::Interpolate(fixed_t smoothratio)
+bool DSectorScrollInterpolation::Interpolate(fixed_t smoothratio)
 {
 	bakx = sector->GetXOffset(ceiling);
 	baky = sector->GetYOffset(ceiling, false);
 
-	if (refcount == 0 && oldx == bakx && oldy == baky)
-	{
-		Destroy();
-	}
-	else
+	if (oldx == bakx && oldy == baky)
 	{
-		sector->SetXOffset(ceiling, oldx + FixedMul(bakx - oldx, smoothratio));
-		sector->SetYOffset(ceiling, oldy + FixedMul(baky - oldy, smoothratio));
+		if (refcount == 0)
+		{
+			Destroy();
+		}
+		return false;
 	}
+	sector->SetXOffset(ceiling, oldx + FixedMul(bakx - oldx, smoothratio));
+	sector->SetYOffset(ceiling, oldy + FixedMul(baky - oldy, smoothratio));
+	return true;
 }
 
 //==========================================================================
@@ -714,20 +770,22 @@ void DWallScrollInterpolation::Restore()
 //
 //==========================================================================
 
-void DWallScrollInterpolation::Interpolate(fixed_t smoothratio)
+bool DWallScrollInterpolation::Interpolate(fixed_t smoothratio)
 {
 	bakx = side->GetTextureXOffset(part);
 	baky = side->GetTextureYOffset(part);
 
-	if (refcount == 0 && oldx == bakx && oldy == baky)
+	if (oldx == bakx && oldy == baky)
 	{
-		Destroy();
-	}
-	else
-	{
-		side->SetTextureXOffset(part, oldx + FixedMul(bakx - oldx, smoothratio));
-		side->SetTextureYOffset(part, oldy + FixedMul(baky - oldy, smoothratio));
+		if (refcount == 0)
+		{
+			Destroy();
+		}
+		return false;
 	}
+	side->SetTextureXOffset(part, oldx + FixedMul(bakx - oldx, smoothratio));
+	side->SetTextureYOffset(part, oldy + FixedMul(baky - oldy, smoothratio));
+	return true;
 }
 
 //==========================================================================
@@ -816,7 +874,7 @@ void DPolyobjInterpolation::Restore()
 //
 //==========================================================================
 
-void DPolyobjInterpolation::Interpolate(fixed_t smoothratio)
+bool DPolyobjInterpolation::Interpolate(fixed_t smoothratio)
 {
 	bool changed = false;
 	for(unsigned int i = 0; i < poly->Vertices.Size(); i++)
@@ -834,19 +892,26 @@ void DPolyobjInterpolation::Interpolate(fixed_t smoothratio)
 			*py = oldverts[i * 2 + 1] + FixedMul(bakverts[i * 2 + 1] - oldverts[i * 2 + 1], smoothratio);
 		}
 	}
-	if (refcount == 0 && !changed)
+	bakcx = poly->CenterSpot.x;
+	bakcy = poly->CenterSpot.y;
+
+	if (!changed)
 	{
-		Destroy();
+		if (refcount == 0)
+		{
+			Destroy();
+			return false;
+		}
+		if (bakcx == oldcx && bakcy == oldcy)
+		{
+			return false;
+		}
 	}
-	else
-	{
-		bakcx = poly->CenterSpot.x;
-		bakcy = poly->CenterSpot.y;
-		poly->CenterSpot.x = bakcx + FixedMul(bakcx - oldcx, smoothratio);
-		poly->CenterSpot.y = bakcy + FixedMul(bakcy - oldcy, smoothratio);
+	poly->CenterSpot.x = bakcx + FixedMul(bakcx - oldcx, smoothratio);
+	poly->CenterSpot.y = bakcy + FixedMul(bakcy - oldcy, smoothratio);
 
-		poly->ClearSubsectorLinks();
-	}
+	poly->ClearSubsectorLinks();
+	return true;
 }
 
 //==========================================================================
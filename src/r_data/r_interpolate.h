@@ -13,10 +13,8 @@ class DInterpolation : public DObject
 	friend struct FInterpolator;
 
 	DECLARE_ABSTRACT_CLASS(DInterpolation, DObject)
-	HAS_OBJECT_POINTERS
 
-	TObjPtr<DInterpolation> Next;
-	TObjPtr<DInterpolation> Prev;
+	unsigned int Index;		// position in the interpolator's list
 
 protected:
 	int refcount;
@@ -30,7 +28,9 @@ public:
 	virtual void Destroy();
 	virtual void UpdateInterpolation() = 0;
 	virtual void Restore() = 0;
-	virtual void Interpolate(fixed_t smoothratio) = 0;
+	// Returns false if nothing moved since UpdateInterpolation. Nothing
+	// was changed then, and Restore need not be called.
+	virtual bool Interpolate(fixed_t smoothratio) = 0;
 	virtual void Serialize(FArchive &arc);
 };
 
@@ -42,20 +42,25 @@ public:
 
 struct FInterpolator
 {
-	TObjPtr<DInterpolation> Head;
+	// All interpolations, and whether each one moved during the current
+	// tic. That is only known once the first frame after the tic has
+	// checked them all; until then, everything counts as moving.
+	TArray<DInterpolation *> Interpolations;
+	TArray<BYTE> Moved;
+	TArray<DInterpolation *> Moving;
 	bool didInterp;
-	int count;
+	bool checked;
 
 	int CountInterpolations ();
 
 public:
 	FInterpolator()
 	{
-		Head = NULL;
 		didInterp = false;
-		count = 0;
+		checked = false;
 	}
 	void UpdateInterpolations();
+	void MarkInterpolations();
 	void AddInterpolation(DInterpolation *);
 	void RemoveInterpolation(DInterpolation *);
 	void DoInterpolations(fixed_t smoothratio);
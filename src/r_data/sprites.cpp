@@ -262,8 +262,9 @@ void R_InitSpriteDefs ()
 		int Head, Next, Name, Spin;
 		char Frame;
 	} *vhashes;
-	unsigned int i, j, smax, vmax;
+	unsigned int i, j, k, smax, vmax;
 	DWORD intname;
+	TArray<int> voxellumps;
 
 	// Create a hash table to speed up the process
 	smax = TexMan.NumTextures();
@@ -284,56 +285,55 @@ void R_InitSpriteDefs ()
 	vmax = Wads.GetNumLumps();
 	vhashes = new VHasher[vmax];
 	clearbuf(vhashes, sizeof(VHasher)*vmax/4, -1);
-	for (i = 0; i < vmax; ++i)
+	Wads.GetNamespaceLumps(ns_voxels, voxellumps);
+	for (k = 0; k < voxellumps.Size(); ++k)
 	{
-		if (Wads.GetLumpNamespace(i) == ns_voxels)
-		{
-			char name[9];
-			size_t namelen;
-			int spin;
-			int sign;
-
-			Wads.GetLumpName(name, i);
-			name[8] = 0;
-			namelen = strlen(name);
-			if (namelen < 4)
-			{ // name is too short
-				continue;
-			}
-			if (name[4] != '\0' && name[4] != ' ' && (name[4] < 'A' || name[4] >= 'A' + MAX_SPRITE_FRAMES))
-			{ // frame char is invalid
-				continue;
-			}
-			spin = 0;
-			sign = 2;	// 2 to convert from deg/halfsec to deg/sec
-			j = 5;
-			if (j < namelen && name[j] == '-')
-			{ // a minus sign is okay, but only before any digits
-				j++;
-				sign = -2;
-			}
-			for (; j < namelen; ++j)
-			{ // the remainder to the end of the name must be digits
-				if (name[j] >= '0' && name[j] <= '9')
-				{
-					spin = spin * 10 + name[j] - '0';
-				}
-				else
-				{
-					break;
-				}
+		char name[9];
+		size_t namelen;
+		int spin;
+		int sign;
+
+		i = voxellumps[k];
+		Wads.GetLumpName(name, i);
+		name[8] = 0;
+		namelen = strlen(name);
+		if (namelen < 4)
+		{ // name is too short
+			continue;
+		}
+		if (name[4] != '\0' && name[4] != ' ' && (name[4] < 'A' || name[4] >= 'A' + MAX_SPRITE_FRAMES))
+		{ // frame char is invalid
+			continue;
+		}
+		spin = 0;
+		sign = 2;	// 2 to convert from deg/halfsec to deg/sec
+		j = 5;
+		if (j < namelen && name[j] == '-')
+		{ // a minus sign is okay, but only before any digits
+			j++;
+			sign = -2;
+		}
+		for (; j < namelen; ++j)
+		{ // the remainder to the end of the name must be digits
+			if (name[j] >= '0' && name[j] <= '9')
+			{
+				spin = spin * 10 + name[j] - '0';
 			}
-			if (j < namelen)
-			{ // the spin part is invalid
-				continue;
+			else
+			{
+				break;
 			}
-			memcpy(&vhashes[i].Name, name, 4);
-			vhashes[i].Frame = name[4];
-			vhashes[i].Spin = spin * sign;
-			size_t bucket = vhashes[i].Name % vmax;
-			vhashes[i].Next = vhashes[bucket].Head;
-			vhashes[bucket].Head = i;
 		}
+		if (j < namelen)
+		{ // the spin part is invalid
+			continue;
+		}
+		memcpy(&vhashes[i].Name, name, 4);
+		vhashes[i].Frame = name[4];
+		vhashes[i].Spin = spin * sign;
+		size_t bucket = vhashes[i].Name % vmax;
+		vhashes[i].Next = vhashes[bucket].Head;
+		vhashes[bucket].Head = i;
 	}
 
 	// scan all the lump names for each of the names, noting the highest frame letter.
@@ -312,6 +312,7 @@ FVoxel *R_LoadKVX(int lumpnum)
 			delete voxel;
 			return NULL;
 		}
+		voxel->Mips[i].CreateColumnLists();
 	}
 
 	voxel->LumpNum = lumpnum;
@@ -362,6 +363,8 @@ FVoxelMipLevel::FVoxelMipLevel()
 	OffsetX = NULL;
 	OffsetXY = NULL;
 	SlabData = NULL;
+	Columns = NULL;
+	ColumnStart = NULL;
 }
 
 //==========================================================================
@@ -376,6 +379,109 @@ FVoxelMipLevel::~FVoxelMipLevel()
 	{
 		delete[] OffsetX;
 	}
+	if (Columns != NULL)
+	{
+		delete[] Columns;
+	}
+	if (ColumnStart != NULL)
+	{
+		delete[] ColumnStart;
+	}
+}
+
+//==========================================================================
+//
+// QuadrantFaces
+//
+// The faces R_DrawVoxel can draw for a viewer in quadrant q: one side in
+// each of x and y, plus the top and bottom.
+//
+//==========================================================================
+
+static inline BYTE QuadrantFaces(int q)
+{
+	return (1 << (q & 1)) + (1 << ((q >> 1) + 2)) + 16 + 32;
+}
+
+//==========================================================================
+//
+// FVoxelMipLevel :: CreateColumnLists
+//
+// Sorts out which columns can show any faces when seen from each of the
+// four quadrants around them, so the renderer does not need to walk the
+// slabs of columns that would be backface culled completely. The z
+// extents of each column are kept too, so columns outside the visible
+// slab range can be rejected without walking their slabs either.
+//
+//==========================================================================
+
+void FVoxelMipLevel::CreateColumnLists()
+{
+	TArray<BYTE> faces;
+	TArray<FVoxelColumn> extents;
+	int numcols = SizeX * SizeY;
+	int count = 0;
+	int q, x, y;
+
+	if (SlabData == NULL || numcols == 0)
+	{
+		return;
+	}
+	faces.Resize(numcols);
+	extents.Resize(numcols);
+	for (x = 0; x < SizeX; ++x)
+	{
+		const BYTE *slabxoffs = &SlabData[OffsetX[x]];
+		const short *xyoffs = &OffsetXY[x * (SizeY + 1)];
+
+		for (y = 0; y < SizeY; ++y)
+		{
+			const kvxslab_t *slab = (const kvxslab_t *)(slabxoffs + xyoffs[y]);
+			const kvxslab_t *end = (const kvxslab_t *)(slabxoffs + xyoffs[y + 1]);
+			FVoxelColumn &ext = extents[x * SizeY + y];
+			BYTE mask = 0;
+
+			ext.Y = y;
+			ext.ZTop = 0xFFFF;
+			ext.ZBottom = 0;
+			for (; slab < end; slab = (const kvxslab_t *)((const BYTE *)slab + slab->zleng + 3))
+			{
+				mask |= slab->backfacecull;
+				ext.ZTop = MIN<WORD>(ext.ZTop, slab->ztop);
+				ext.ZBottom = MAX<WORD>(ext.ZBottom, slab->ztop + slab->zleng);
+			}
+			faces[x * SizeY + y] = mask;
+			for (q = 0; q < 4; ++q)
+			{
+				if (mask & QuadrantFaces(q))
+				{
+					count++;
+				}
+			}
+		}
+	}
+
+	Columns = new FVoxelColumn[MAX(count, 1)];
+	ColumnStart = new int[4 * (SizeX + 1)];
+	count = 0;
+	for (q = 0; q < 4; ++q)
+	{
+		BYTE qmask = QuadrantFaces(q);
+		int *start = &ColumnStart[q * (SizeX + 1)];
+
+		for (x = 0; x < SizeX; ++x)
+		{
+			start[x] = count;
+			for (y = 0; y < SizeY; ++y)
+			{
+				if (faces[x * SizeY + y] & qmask)
+				{
+					Columns[count++] = extents[x * SizeY + y];
+				}
+			}
+		}
+		start[SizeX] = count;
+	}
 }
 
 //==========================================================================
@@ -15,6 +15,13 @@ struct kvxslab_t
 	BYTE		col[1/*zleng*/];// color data from top to bottom
 };
 
+struct FVoxelColumn
+{
+	WORD		Y;
+	WORD		ZTop;			// smallest ztop of the column's slabs
+	WORD		ZBottom;		// largest ztop + zleng of the column's slabs
+};
+
 struct FVoxelMipLevel
 {
 	FVoxelMipLevel();
@@ -29,6 +36,14 @@ struct FVoxelMipLevel
 	int			*OffsetX;
 	short		*OffsetXY;
 	BYTE		*SlabData;
+
+	// For each quadrant the viewer can be in relative to a column, the
+	// columns with a face showing toward it, sorted by y for every x.
+	// The quadrant is (viewer is past the column in x) + 2 * (ditto in y).
+	FVoxelColumn *Columns;
+	int			*ColumnStart;	// [4][SizeX + 1] indices into Columns
+
+	void CreateColumnLists();
 };
 
 struct FVoxel
@@ -57,6 +57,7 @@
 #include "st_start.h"
 #include "v_font.h"
 #include "r_data/colormaps.h"
+#include "r_profile.h"
 #include "farchive.h"
 #include "portal.h"
 
@@ -81,6 +82,7 @@ void R_DeinitSprites();
 // PRIVATE FUNCTION PROTOTYPES ---------------------------------------------
 
 static void R_ShutdownRenderer();
+static void R_VoxelBenchView();
 
 // EXTERNAL DATA DECLARATIONS ----------------------------------------------
 
@@ -160,6 +162,10 @@ void (*hcolfunc_post2) (int hx, int sx, int yl, int yh);
 void (STACK_ARGS *hcolfunc_post4) (int sx, int yl, int yh);
 
 cycle_t WallCycles, PlaneCycles, MaskedCycles, WallScanCycles;
+cycle_t SpriteSortCycles;
+int MaskedSprites;
+cycle_t VoxelCycles;
+int VoxelsDrawn, VoxelColumns, VoxelColumnsCulled;
 
 // PRIVATE DATA DEFINITIONS ------------------------------------------------
 
@@ -773,12 +779,18 @@ void R_EnterPortal (PortalDrawseg* pds, int depth)
 	memcpy (ceilingclip + pds->x1, &pds->ceilingclip[0], pds->len*sizeof(*ceilingclip));
 	memcpy (floorclip + pds->x1, &pds->floorclip[0], pds->len*sizeof(*floorclip));
 
+	R_EnterPhase (RP_BSP);
 	R_RenderBSPNode (nodes + numnodes - 1);
+	R_LeavePhase (RP_BSP);
 	R_3D_ResetClip(); // reset clips (floor/ceiling)
 
 	PlaneCycles.Clock();
+	R_EnterPhase (RP_Planes);
 	R_DrawPlanes ();
+	R_LeavePhase (RP_Planes);
+	R_EnterPhase (RP_SkyBoxes);
 	R_DrawSkyBoxes ();
+	R_LeavePhase (RP_SkyBoxes);
 	PlaneCycles.Unclock();
 
 	fixed_t vzp = viewz;
@@ -788,7 +800,9 @@ void R_EnterPortal (PortalDrawseg* pds, int depth)
 	unsigned int portalsAtEnd = WallPortals.Size ();
 	for (; portalsAtStart < portalsAtEnd; portalsAtStart++)
 	{
+		R_EnterPhase (RP_Portals);
 		R_EnterPortal (&WallPortals[portalsAtStart], depth + 1);
+		R_LeavePhase (RP_Portals);
 	}
 	int prevuniq2 = CurrentPortalUniq;
 	CurrentPortalUniq = prevuniq;
@@ -796,7 +810,9 @@ void R_EnterPortal (PortalDrawseg* pds, int depth)
 	NetUpdate();
 
 	MaskedCycles.Clock(); // [ZZ] count sprites in portals/mirrors along with normal ones.
+	R_EnterPhase (RP_Masked);
 	R_DrawMasked ();	  //      this is required since with portals there often will be cases when more than 80% of the view is inside a portal.
+	R_LeavePhase (RP_Masked);
 	MaskedCycles.Unclock();
 
 	NetUpdate();
@@ -861,6 +877,10 @@ void R_RenderActorView (AActor *actor, bool dontmaplines)
 	PlaneCycles.Reset();
 	MaskedCycles.Reset();
 	WallScanCycles.Reset();
+	SpriteSortCycles.Reset();
+	MaskedSprites = 0;
+	VoxelCycles.Reset();
+	VoxelsDrawn = VoxelColumns = VoxelColumnsCulled = 0;
 
 	fakeActive = 0; // kg3D - reset fake floor indicator
 	R_3D_ResetClip(); // reset clips (floor/ceiling)
@@ -917,7 +937,9 @@ void R_RenderActorView (AActor *actor, bool dontmaplines)
 	}
 	// Link the polyobjects right before drawing the scene to reduce the amounts of calls to this function
 	PO_LinkToSubsectors();
+	R_EnterPhase (RP_BSP);
 	R_RenderBSPNode (nodes + numnodes - 1);	// The head node is the last node output.
+	R_LeavePhase (RP_BSP);
 	R_3D_ResetClip(); // reset clips (floor/ceiling)
 	camera->renderflags = savedflags;
 	WallCycles.Unclock();
@@ -927,8 +949,12 @@ void R_RenderActorView (AActor *actor, bool dontmaplines)
 	if (viewactive)
 	{
 		PlaneCycles.Clock();
+		R_EnterPhase (RP_Planes);
 		R_DrawPlanes ();
+		R_LeavePhase (RP_Planes);
+		R_EnterPhase (RP_SkyBoxes);
 		R_DrawSkyBoxes ();
+		R_LeavePhase (RP_SkyBoxes);
 		PlaneCycles.Unclock();
 
 		// [RH] Walk through mirrors
@@ -936,7 +962,9 @@ void R_RenderActorView (AActor *actor, bool dontmaplines)
 		size_t lastportal = WallPortals.Size();
 		for (unsigned int i = 0; i < lastportal; i++)
 		{
+			R_EnterPhase (RP_Portals);
 			R_EnterPortal(&WallPortals[i], 0);
+			R_LeavePhase (RP_Portals);
 		}
 
 		CurrentPortal = NULL;
@@ -945,7 +973,9 @@ void R_RenderActorView (AActor *actor, bool dontmaplines)
 		NetUpdate ();
 		
 		MaskedCycles.Clock();
+		R_EnterPhase (RP_Masked);
 		R_DrawMasked ();
+		R_LeavePhase (RP_Masked);
 		MaskedCycles.Unclock();
 
 		NetUpdate ();
@@ -953,6 +983,7 @@ void R_RenderActorView (AActor *actor, bool dontmaplines)
 	WallPortals.Clear ();
 	interpolator.RestoreInterpolations ();
 	R_SetupBuffer ();
+	R_VoxelBenchView ();
 
 	// If we don't want shadered colormaps, NULL it now so that the
 	// copy to the screen does not use a special colormap shader.
@@ -1028,6 +1059,91 @@ ADD_STAT (fps)
 }
 
 
+//==========================================================================
+//
+// STAT sprites
+//
+// Displays how many sprites the last frame had, and how long sorting
+// them and drawing everything masked took
+//
+//==========================================================================
+
+ADD_STAT (sprites)
+{
+	FString out;
+	out.Format("%d sprites  masked=%04.1f ms  sort=%04.2f ms",
+		MaskedSprites, MaskedCycles.TimeMS(), SpriteSortCycles.TimeMS());
+	return out;
+}
+
+//==========================================================================
+//
+// STAT voxels
+//
+// Displays how many voxels the last frame had, how many of their columns
+// were thrown out for being clipped away, and how long drawing them took
+//
+//==========================================================================
+
+ADD_STAT (voxels)
+{
+	FString out;
+	out.Format("%d voxels  %d columns  %d clipped  draw=%04.2f ms",
+		VoxelsDrawn, VoxelColumns, VoxelColumnsCulled, VoxelCycles.TimeMS());
+	return out;
+}
+
+//==========================================================================
+//
+// CCMD voxelbench
+//
+// Averages the voxel drawing time over the next views rendered. Start it
+// somewhere with lots of voxels in view, or before a timedemo of such a
+// map, to compare r_voxelmipbias settings and the like.
+//
+//==========================================================================
+
+static int VoxelBenchViews, VoxelBenchCount;
+static double VoxelBenchMS, VoxelBenchMaxMS;
+static double VoxelBenchVoxels, VoxelBenchColumns, VoxelBenchCulled;
+
+CCMD (voxelbench)
+{
+	VoxelBenchViews = argv.argc() > 1 ? atoi(argv[1]) : 200;
+	if (VoxelBenchViews <= 0)
+	{
+		Printf ("Usage: voxelbench [views]\n");
+		VoxelBenchViews = 0;
+		return;
+	}
+	VoxelBenchCount = 0;
+	VoxelBenchMS = VoxelBenchMaxMS = 0;
+	VoxelBenchVoxels = VoxelBenchColumns = VoxelBenchCulled = 0;
+	Printf ("Timing voxels over the next %d views\n", VoxelBenchViews);
+}
+
+static void R_VoxelBenchView ()
+{
+	if (VoxelBenchViews == 0)
+	{
+		return;
+	}
+	double ms = VoxelCycles.TimeMS();
+	VoxelBenchMS += ms;
+	VoxelBenchMaxMS = MAX(VoxelBenchMaxMS, ms);
+	VoxelBenchVoxels += VoxelsDrawn;
+	VoxelBenchColumns += VoxelColumns;
+	VoxelBenchCulled += VoxelColumnsCulled;
+	VoxelBenchCount++;
+	if (--VoxelBenchViews == 0)
+	{
+		Printf ("voxelbench: %d views  avg=%.3f ms  max=%.3f ms  %.1f voxels  %.0f columns  %.0f clipped per view\n",
+			VoxelBenchCount, VoxelBenchMS / VoxelBenchCount, VoxelBenchMaxMS,
+			VoxelBenchVoxels / VoxelBenchCount, VoxelBenchColumns / VoxelBenchCount,
+			VoxelBenchCulled / VoxelBenchCount);
+	}
+}
+
 static double f_acc, w_acc,p_acc,m_acc;
 static int acc_c;
 
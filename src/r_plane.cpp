@@ -56,6 +56,7 @@
 #include "r_plane.h"
 #include "r_segs.h"
 #include "r_3dfloors.h"
+#include "r_profile.h"
 #include "v_palette.h"
 #include "r_data/colormaps.h"
 #include "portal.h"
@@ -1117,7 +1118,9 @@ void R_DrawSinglePlane (visplane_t *pl, fixed_t alpha, bool additive, bool maske
 	}
 	else if (pl->picnum == skyflatnum)
 	{ // sky flat
+		R_EnterPhase (RP_SkyPlanes);
 		R_DrawSkyPlane (pl);
+		R_LeavePhase (RP_SkyPlanes);
 	}
 	else
 	{ // regular flat
@@ -1146,11 +1149,15 @@ void R_DrawSinglePlane (visplane_t *pl, fixed_t alpha, bool additive, bool maske
 
 		if (r_drawflat || ((pl->height.a == 0 && pl->height.b == 0) && !tilt))
 		{
+			R_EnterPhase (RP_FlatPlanes);
 			R_DrawNormalPlane (pl, alpha, additive, masked);
+			R_LeavePhase (RP_FlatPlanes);
 		}
 		else
 		{
+			R_EnterPhase (RP_TiltedPlanes);
 			R_DrawTiltedPlane (pl, alpha, additive, masked);
+			R_LeavePhase (RP_TiltedPlanes);
 		}
 	}
 	NetUpdate ();
@@ -1315,9 +1322,13 @@ void R_DrawSkyBoxes ()
 		viewzStack.Push (viewz);
 		visplaneStack.Push (pl);
 
+		R_EnterPhase (RP_BSP);
 		R_RenderBSPNode (nodes + numnodes - 1);
+		R_LeavePhase (RP_BSP);
 		R_3D_ResetClip(); // reset clips (floor/ceiling)
+		R_EnterPhase (RP_Planes);
 		R_DrawPlanes ();
+		R_LeavePhase (RP_Planes);
 
 		sky->bInSkybox = false;
 		if (mate != NULL) mate->bInSkybox = false;
@@ -1338,7 +1349,9 @@ void R_DrawSkyBoxes ()
 		viewyStack.Pop (viewy); // coordinates restored for proper positioning.
 		viewzStack.Pop (viewz);
 
+		R_EnterPhase (RP_Masked);
 		R_DrawMasked ();
+		R_LeavePhase (RP_Masked);
 
 		ds_p = firstdrawseg;
 		vissprite_p = firstvissprite;
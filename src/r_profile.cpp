@@ -0,0 +1,351 @@
+/*
+** r_profile.cpp
+** Renderer frame profiler
+**
+**---------------------------------------------------------------------------
+** Copyright 2016 The ZDoom Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+#include <stdio.h>
+#include <float.h>
+#include <assert.h>
+
+#include "doomtype.h"
+#include "r_profile.h"
+#include "stats.h"
+#include "tarray.h"
+#include "templates.h"
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "g_level.h"
+
+// MACROS ------------------------------------------------------------------
+
+#define PROFILE_HISTORY		256
+
+// TYPES -------------------------------------------------------------------
+
+struct FPhaseInfo
+{
+	const char *Name;
+	int Parent;
+};
+
+struct FPhaseTimer
+{
+	cycle_t Self;		// time not spent in other phases entered from this one
+	cycle_t Total;		// time from the outermost enter to the matching leave
+	int Depth;
+	int Calls;
+};
+
+struct FProfiledFrame
+{
+	float Self[NUM_RENDERPHASES];
+	float Total[NUM_RENDERPHASES];
+	int Calls[NUM_RENDERPHASES];
+};
+
+// PUBLIC DATA DEFINITIONS -------------------------------------------------
+
+bool RenderProfiling;
+
+CVAR (Bool, r_profile, false, 0)
+
+// PRIVATE DATA DEFINITIONS ------------------------------------------------
+
+static const FPhaseInfo PhaseInfo[NUM_RENDERPHASES] =
+{
+	{ "frame",				-1 },
+	{ "bsp",				RP_Frame },
+	{ "walls",				RP_BSP },
+	{ "segloop",			RP_Walls },
+	{ "3d floors",			RP_BSP },
+	{ "planes",				RP_Frame },
+	{ "flat",				RP_Planes },
+	{ "tilted",				RP_Planes },
+	{ "sky",				RP_Planes },
+	{ "skyboxes",			RP_Frame },
+	{ "portals",			RP_Frame },
+	{ "masked",				RP_Frame },
+	{ "sprites",			RP_Masked },
+	{ "masked mids",		RP_Masked },
+	{ "particles",			RP_Masked },
+	{ "voxels",				RP_Masked },
+	{ "3d floor planes",	RP_Masked },
+	{ "player sprites",		RP_Masked },
+	{ "camera textures",	RP_Frame },
+};
+
+static FPhaseTimer Phases[NUM_RENDERPHASES];
+static TArray<BYTE> PhaseStack;
+
+static FProfiledFrame History[PROFILE_HISTORY];
+static int HistoryPos, HistoryCount;
+static FString HistoryMap;
+
+// CODE --------------------------------------------------------------------
+
+//==========================================================================
+//
+// R_BeginProfileFrame
+//
+// Starts timing a frame if r_profile is on. The history is cleared when
+// the map changes, so each dump only covers one map.
+//
+//==========================================================================
+
+void R_BeginProfileFrame()
+{
+	RenderProfiling = r_profile;
+	if (!RenderProfiling)
+	{
+		return;
+	}
+	if (HistoryMap.CompareNoCase(level.MapName) != 0)
+	{
+		HistoryMap = level.MapName;
+		HistoryPos = HistoryCount = 0;
+	}
+	for (int i = 0; i < NUM_RENDERPHASES; ++i)
+	{
+		Phases[i].Self.Reset();
+		Phases[i].Total.Reset();
+		Phases[i].Depth = 0;
+		Phases[i].Calls = 0;
+	}
+	PhaseStack.Clear();
+	PhaseStack.Push(RP_Frame);
+	Phases[RP_Frame].Depth = 1;
+	Phases[RP_Frame].Calls = 1;
+	Phases[RP_Frame].Total.Clock();
+	Phases[RP_Frame].Self.Clock();
+}
+
+//==========================================================================
+//
+// R_EndProfileFrame
+//
+// Stops the clocks and adds the frame to the history.
+//
+//==========================================================================
+
+void R_EndProfileFrame()
+{
+	if (!RenderProfiling)
+	{
+		return;
+	}
+	// Anything still open was left through an early return somewhere.
+	while (PhaseStack.Size() > 1)
+	{
+		R_ProfileLeave(ERenderPhase(PhaseStack.Last()));
+	}
+	Phases[RP_Frame].Self.Unclock();
+	Phases[RP_Frame].Total.Unclock();
+	RenderProfiling = false;
+
+	FProfiledFrame &frame = History[HistoryPos];
+	for (int i = 0; i < NUM_RENDERPHASES; ++i)
+	{
+		frame.Self[i] = float(Phases[i].Self.TimeMS());
+		frame.Total[i] = float(Phases[i].Total.TimeMS());
+		frame.Calls[i] = Phases[i].Calls;
+	}
+	HistoryPos = (HistoryPos + 1) % PROFILE_HISTORY;
+	HistoryCount = MIN(HistoryCount + 1, PROFILE_HISTORY);
+}
+
+//==========================================================================
+//
+// R_ProfileEnter
+//
+//==========================================================================
+
+void R_ProfileEnter(ERenderPhase phase)
+{
+	FPhaseTimer &timer = Phases[phase];
+
+	Phases[PhaseStack.Last()].Self.Unclock();
+	if (timer.Depth++ == 0)
+	{
+		timer.Total.Clock();
+	}
+	timer.Self.Clock();
+	timer.Calls++;
+	PhaseStack.Push(phase);
+}
+
+//==========================================================================
+//
+// R_ProfileLeave
+//
+//==========================================================================
+
+void R_ProfileLeave(ERenderPhase phase)
+{
+	FPhaseTimer &timer = Phases[phase];
+
+	assert(PhaseStack.Size() > 1 && PhaseStack.Last() == phase);
+	if (PhaseStack.Size() <= 1)
+	{
+		return;
+	}
+	PhaseStack.Pop();
+	timer.Self.Unclock();
+	if (--timer.Depth == 0)
+	{
+		timer.Total.Unclock();
+	}
+	Phases[PhaseStack.Last()].Self.Clock();
+}
+
+//==========================================================================
+//
+// PhaseDepth
+//
+//==========================================================================
+
+static int PhaseDepth(int phase)
+{
+	int depth = 0;
+	while (PhaseInfo[phase].Parent >= 0)
+	{
+		phase = PhaseInfo[phase].Parent;
+		depth++;
+	}
+	return depth;
+}
+
+//==========================================================================
+//
+// FormatHistory
+//
+// Lists the average, minimum and maximum of every phase over the frames
+// in the history.
+//
+//==========================================================================
+
+static FString FormatHistory()
+{
+	FString out;
+
+	out.Format("Render profile of %s over %d frames\n", HistoryMap.GetChars(), HistoryCount);
+	out.AppendFormat("%-20s %8s %8s %8s %8s %8s\n", "phase", "avg ms", "min ms", "max ms", "self ms", "calls");
+	for (int i = 0; i < NUM_RENDERPHASES; ++i)
+	{
+		double total = 0, self = 0, calls = 0;
+		float mintotal = FLT_MAX, maxtotal = 0;
+
+		for (int j = 0; j < HistoryCount; ++j)
+		{
+			const FProfiledFrame &frame = History[j];
+			total += frame.Total[i];
+			self += frame.Self[i];
+			calls += frame.Calls[i];
+			mintotal = MIN(mintotal, frame.Total[i]);
+			maxtotal = MAX(maxtotal, frame.Total[i]);
+		}
+		int indent = PhaseDepth(i) * 2;
+		out.AppendFormat("%*s%-*s %8.3f %8.3f %8.3f %8.3f %8.1f\n", indent, "", 20 - indent, PhaseInfo[i].Name,
+			total / HistoryCount, mintotal, maxtotal, self / HistoryCount, calls / HistoryCount);
+	}
+	return out;
+}
+
+//==========================================================================
+//
+// CCMD dumprenderprofile
+//
+// Prints the profile history for the current map. If a file name is
+// given, it is appended to that file too, so several maps can be
+// collected in one place and compared.
+//
+//==========================================================================
+
+CCMD (dumprenderprofile)
+{
+	if (HistoryCount == 0)
+	{
+		Printf ("No frames have been profiled. Set r_profile to 1 first.\n");
+		return;
+	}
+	FString report = FormatHistory();
+	Printf ("%s", report.GetChars());
+	if (argv.argc() > 1)
+	{
+		FILE *f = fopen(argv[1], "a");
+		if (f == NULL)
+		{
+			Printf ("Could not open %s\n", argv[1]);
+			return;
+		}
+		fprintf(f, "%s\n", report.GetChars());
+		fclose(f);
+		Printf ("Appended to %s\n", argv[1]);
+	}
+}
+
+//==========================================================================
+//
+// STAT renderprofile
+//
+// Shows the last profiled frame, along with the average total time of
+// each phase over the history.
+//
+//==========================================================================
+
+ADD_STAT (renderprofile)
+{
+	FString out;
+
+	if (HistoryCount == 0)
+	{
+		out = "Set r_profile to 1 to profile the renderer";
+		return out;
+	}
+	const FProfiledFrame &last = History[(HistoryPos + PROFILE_HISTORY - 1) % PROFILE_HISTORY];
+	out.Format("%-20s %7s %7s %7s %6s", "phase", "total", "avg", "self", "calls");
+	for (int i = 0; i < NUM_RENDERPHASES; ++i)
+	{
+		double avg = 0;
+		for (int j = 0; j < HistoryCount; ++j)
+		{
+			avg += History[j].Total[i];
+		}
+		int indent = PhaseDepth(i) * 2;
+		out.AppendFormat("\n%*s%-*s %7.2f %7.2f %7.2f %6d", indent, "", 20 - indent, PhaseInfo[i].Name,
+			last.Total[i], avg / HistoryCount, last.Self[i], last.Calls[i]);
+	}
+	if (!r_profile)
+	{
+		out += "\n(r_profile is off)";
+	}
+	return out;
+}
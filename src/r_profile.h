@@ -0,0 +1,87 @@
+/*
+** r_profile.h
+** Renderer frame profiler
+**
+**---------------------------------------------------------------------------
+** Copyright 2016 The ZDoom Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+#ifndef __R_PROFILE_H__
+#define __R_PROFILE_H__
+
+// Parts of a frame the software renderer can be timed in. The order is
+// the order the profile is listed in, with each phase after its parent.
+enum ERenderPhase
+{
+	RP_Frame,
+	RP_BSP,
+	RP_Walls,
+	RP_SegLoop,
+	RP_3DFloors,
+	RP_Planes,
+	RP_FlatPlanes,
+	RP_TiltedPlanes,
+	RP_SkyPlanes,
+	RP_SkyBoxes,
+	RP_Portals,
+	RP_Masked,
+	RP_Sprites,
+	RP_MaskedMids,
+	RP_Particles,
+	RP_Voxels,
+	RP_3DFloorPlanes,
+	RP_PlayerSprites,
+	RP_CameraTextures,
+
+	NUM_RENDERPHASES
+};
+
+// True between R_BeginProfileFrame and R_EndProfileFrame when r_profile
+// is on. Never changes in the middle of a frame.
+extern bool RenderProfiling;
+
+void R_BeginProfileFrame();
+void R_EndProfileFrame();
+void R_ProfileEnter(ERenderPhase phase);
+void R_ProfileLeave(ERenderPhase phase);
+
+// Phases must be left in the reverse order they were entered. Time spent
+// in a phase entered from inside another is taken out of the outer one's
+// own time, but still counts towards its total.
+inline void R_EnterPhase(ERenderPhase phase)
+{
+	if (RenderProfiling) R_ProfileEnter(phase);
+}
+
+inline void R_LeavePhase(ERenderPhase phase)
+{
+	if (RenderProfiling) R_ProfileLeave(phase);
+}
+
+#endif
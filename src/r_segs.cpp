@@ -50,6 +50,7 @@
 #include "r_plane.h"
 #include "r_segs.h"
 #include "r_3dfloors.h"
+#include "r_profile.h"
 #include "v_palette.h"
 #include "r_data/colormaps.h"
 #include "portal.h"
@@ -2370,6 +2371,8 @@ void R_StoreWallRange (int start, int stop)
 		I_FatalError ("Bad R_StoreWallRange: %i to %i", start , stop);
 #endif
 
+	R_EnterPhase (RP_Walls);
+
 	// don't overflow and crash
 	R_CheckDrawSegs ();
 	
@@ -2592,10 +2595,13 @@ void R_StoreWallRange (int start, int stop)
 		}
 	}
 
+	R_EnterPhase (RP_SegLoop);
 	R_RenderSegLoop ();
+	R_LeavePhase (RP_SegLoop);
 
 	if(fake3D & 7) {
 		ds_p++;
+		R_LeavePhase (RP_Walls);
 		return;
 	}
 
@@ -2657,6 +2663,7 @@ void R_StoreWallRange (int start, int stop)
 	}
 
 	ds_p++;
+	R_LeavePhase (RP_Walls);
 }
 
 int OWallMost (short *mostbuf, fixed_t z, const FWallCoords *wallc)
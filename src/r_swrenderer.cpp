@@ -40,6 +40,7 @@
 #include "r_bsp.h"
 #include "r_swrenderer.h"
 #include "r_3dfloors.h"
+#include "r_profile.h"
 #include "textures/textures.h"
 #include "r_data/voxels.h"
 
@@ -108,9 +109,13 @@ void FSoftwareRenderer::PrecacheTexture(FTexture *tex, int cache)
 
 void FSoftwareRenderer::RenderView(player_t *player)
 {
+	R_BeginProfileFrame ();
 	R_RenderActorView (player->mo);
 	// [RH] Let cameras draw onto textures that were visible this frame.
+	R_EnterPhase (RP_CameraTextures);
 	FCanvasTextureInfo::UpdateAll ();
+	R_LeavePhase (RP_CameraTextures);
+	R_EndProfileFrame ();
 }
 
 //==========================================================================
@@ -62,6 +62,7 @@
 #include "r_data/r_translate.h"
 #include "r_data/colormaps.h"
 #include "r_data/voxels.h"
+#include "r_profile.h"
 #include "p_local.h"
 
 // [RH] A c-buffer. Used for keeping track of offscreen voxel spans.
@@ -88,6 +89,10 @@ struct FCoverageBuffer
 };
 
 extern fixed_t globaluclip, globaldclip;
+extern cycle_t SpriteSortCycles;
+extern cycle_t VoxelCycles;
+extern int VoxelsDrawn, VoxelColumns, VoxelColumnsCulled;
+extern int MaskedSprites;
 
 
 #define MINZ			(2048*4)
@@ -146,10 +151,19 @@ vissprite_t		**lastvissprite;
 int 			newvissprite;
 bool			DrewAVoxel;
 
-static vissprite_t **spritesorter;
+static vissprite_t **spritesorter, **spritesorter2;
 static int spritesortersize = 0;
 static int vsprcount;
 
+// Drawsegs sorted into buckets by the screen columns they cover, so that
+// R_DrawSprite only needs to look at the ones that can overlap a sprite.
+#define DSBUCKETSHIFT	5
+#define NUMDSBUCKETS	((MAXWIDTH >> DSBUCKETSHIFT) + 1)
+
+static TArray<unsigned int> DrawSegBuckets[NUMDSBUCKETS];
+static TArray<unsigned int> SpriteDrawSegs;
+static size_t DrawSegIndexStart, DrawSegIndexEnd;
+
 static void R_ProjectWallSprite(AActor *thing, fixed_t fx, fixed_t fy, fixed_t fz, FTextureID picnum, fixed_t xscale, fixed_t yscale, INTBOOL flip);
 
 
@@ -170,8 +184,10 @@ void R_DeinitSprites()
 	if (spritesorter != NULL)
 	{
 		delete[] spritesorter;
+		delete[] spritesorter2;
 		spritesortersize = 0;
 		spritesorter = NULL;
+		spritesorter2 = NULL;
 	}
 
 	// Free offscreen buffer
@@ -1821,12 +1837,73 @@ static void swap(vissprite_t *&a, vissprite_t *&b)
 }
 #endif
 
+//
+// R_RadixSortVisSprites
+//
+// Puts spritesorter in the same order as a stable sort with sv_compare,
+// but without comparing sprites: idepth is an integer, so this sorts it
+// a byte at a time, skipping bytes that are the same for every sprite.
+//
+
+static inline DWORD R_VisSpriteSortKey (const vissprite_t *spr)
+{
+	// Flip the sign bit so the key orders like idepth, then invert it
+	// so that the nearest sprite comes first.
+	return ~(DWORD(spr->idepth) ^ 0x80000000u);
+}
+
+static void R_RadixSortVisSprites ()
+{
+	unsigned int counts[4][256];
+	vissprite_t **src = spritesorter, **dest = spritesorter2;
+	int i;
+
+	memset (counts, 0, sizeof(counts));
+	for (i = 0; i < vsprcount; ++i)
+	{
+		DWORD key = R_VisSpriteSortKey (src[i]);
+		counts[0][key & 255]++;
+		counts[1][(key >> 8) & 255]++;
+		counts[2][(key >> 16) & 255]++;
+		counts[3][key >> 24]++;
+	}
+	for (int pass = 0; pass < 4; ++pass)
+	{
+		unsigned int *count = counts[pass];
+		int shift = pass * 8;
+
+		if (count[(R_VisSpriteSortKey (src[0]) >> shift) & 255] == (unsigned int)vsprcount)
+		{ // Every sprite has the same byte here.
+			continue;
+		}
+		unsigned int offset = 0;
+		for (int j = 0; j < 256; ++j)
+		{
+			unsigned int c = count[j];
+			count[j] = offset;
+			offset += c;
+		}
+		for (i = 0; i < vsprcount; ++i)
+		{
+			dest[count[(R_VisSpriteSortKey (src[i]) >> shift) & 255]++] = src[i];
+		}
+		vissprite_t **t = src;
+		src = dest;
+		dest = t;
+	}
+	if (src != spritesorter)
+	{
+		memcpy (spritesorter, src, vsprcount * sizeof(*src));
+	}
+}
+
 void R_SortVisSprites (bool (*compare)(vissprite_t *, vissprite_t *), size_t first)
 {
 	int i;
 	vissprite_t **spr;
 
 	vsprcount = int(vissprite_p - &vissprites[first]);
+	MaskedSprites += vsprcount;
 
 	if (vsprcount == 0)
 		return;
@@ -1834,11 +1911,17 @@ void R_SortVisSprites (bool (*compare)(vissprite_t *, vissprite_t *), size_t fir
 	if (spritesortersize < MaxVisSprites)
 	{
 		if (spritesorter != NULL)
+		{
 			delete[] spritesorter;
+			delete[] spritesorter2;
+		}
 		spritesorter = new vissprite_t *[MaxVisSprites];
+		spritesorter2 = new vissprite_t *[MaxVisSprites];
 		spritesortersize = MaxVisSprites;
 	}
 
+	SpriteSortCycles.Clock();
+
 	if (!(i_compatflags & COMPATF_SPRITESORT))
 	{
 		for (i = 0, spr = firstvissprite; i < vsprcount; i++, spr++)
@@ -1857,7 +1940,101 @@ void R_SortVisSprites (bool (*compare)(vissprite_t *, vissprite_t *), size_t fir
 		}
 	}
 
-	std::stable_sort(&spritesorter[0], &spritesorter[vsprcount], compare);
+	if (compare == sv_compare)
+	{
+		R_RadixSortVisSprites ();
+	}
+	else
+	{
+		std::stable_sort(&spritesorter[0], &spritesorter[vsprcount], compare);
+	}
+	SpriteSortCycles.Unclock();
+}
+
+//
+// R_IndexDrawSegs
+//
+// Sorts the drawsegs of the current view into DrawSegBuckets.
+//
+
+static void R_IndexDrawSegs ()
+{
+	for (int i = 0; i < NUMDSBUCKETS; ++i)
+	{
+		DrawSegBuckets[i].Clear();
+	}
+	DrawSegIndexStart = firstdrawseg - drawsegs;
+	DrawSegIndexEnd = ds_p - drawsegs;
+
+	for (size_t i = DrawSegIndexStart; i < DrawSegIndexEnd; ++i)
+	{
+		drawseg_t *ds = &drawsegs[i];
+
+		// kg3D - no clipping on fake segs
+		if (ds->fake || ds->x1 >= ds->x2)
+			continue;
+
+		int last = (ds->x2 - 1) >> DSBUCKETSHIFT;
+		for (int b = ds->x1 >> DSBUCKETSHIFT; b <= last; ++b)
+		{
+			DrawSegBuckets[b].Push((unsigned int)i);
+		}
+	}
+}
+
+//
+// R_GetSpriteDrawSegs
+//
+// Gets the indices of the drawsegs that may overlap columns x1 to x2-1,
+// in the order they were added.
+//
+
+static unsigned int R_GetSpriteDrawSegs (int x1, int x2, unsigned int *&list)
+{
+	size_t start = firstdrawseg - drawsegs;
+	size_t end = ds_p - drawsegs;
+	int b1 = x1 >> DSBUCKETSHIFT;
+	int b2 = (x2 - 1) >> DSBUCKETSHIFT;
+	bool indexed = (start == DrawSegIndexStart && end == DrawSegIndexEnd);
+
+	if (indexed && b1 == b2)
+	{
+		list = DrawSegBuckets[b1].Size() > 0 ? &DrawSegBuckets[b1][0] : NULL;
+		return DrawSegBuckets[b1].Size();
+	}
+
+	size_t total = 0;
+	if (indexed)
+	{
+		for (int b = b1; b <= b2; ++b)
+		{
+			total += DrawSegBuckets[b].Size();
+		}
+	}
+
+	SpriteDrawSegs.Clear();
+	if (!indexed || total >= end - start)
+	{ // Checking every drawseg is no more work.
+		for (size_t i = start; i < end; ++i)
+		{
+			SpriteDrawSegs.Push((unsigned int)i);
+		}
+	}
+	else if (total > 0)
+	{
+		for (int b = b1; b <= b2; ++b)
+		{
+			for (unsigned int j = 0; j < DrawSegBuckets[b].Size(); ++j)
+			{
+				SpriteDrawSegs.Push(DrawSegBuckets[b][j]);
+			}
+		}
+		// Drawsegs wider than a bucket show up once for every bucket.
+		std::sort(&SpriteDrawSegs[0], &SpriteDrawSegs[0] + SpriteDrawSegs.Size());
+		SpriteDrawSegs.Resize(unsigned(std::unique(&SpriteDrawSegs[0], &SpriteDrawSegs[0] + SpriteDrawSegs.Size()) - &SpriteDrawSegs[0]));
+	}
+	list = SpriteDrawSegs.Size() > 0 ? &SpriteDrawSegs[0] : NULL;
+	return SpriteDrawSegs.Size();
 }
 
 //
@@ -1883,7 +2060,9 @@ void R_DrawSprite (vissprite_t *spr)
 		// kg3D - reject invisible parts
 		if ((fake3D & FAKE3D_CLIPBOTTOM) && spr->gz <= sclipBottom) return;
 		if ((fake3D & FAKE3D_CLIPTOP)    && spr->gz >= sclipTop) return;
+		R_EnterPhase (RP_Particles);
 		R_DrawParticle (spr);
+		R_LeavePhase (RP_Particles);
 		return;
 	}
 
@@ -2152,8 +2331,14 @@ void R_DrawSprite (vissprite_t *spr)
 
 	//		for (ds=ds_p-1 ; ds >= drawsegs ; ds--)    old buggy code
 
-	for (ds = ds_p; ds-- > firstdrawseg; )  // new -- killough
+	// Only look at the drawsegs that share columns with the sprite.
+	unsigned int *dslist;
+	unsigned int dscount = R_GetSpriteDrawSegs (x1, x2, dslist);
+
+	while (dscount-- > 0)  // new -- killough
 	{
+		ds = &drawsegs[dslist[dscount]];
+
 		// [ZZ] portal handling here
 		//if (ds->CurrentPortalUniq != spr->CurrentPortalUniq)
 		//	continue;
@@ -2193,7 +2378,11 @@ void R_DrawSprite (vissprite_t *spr)
 			// seg is behind sprite, so draw the mid texture if it has one
 			if (ds->CurrentPortalUniq == CurrentPortalUniq && // [ZZ] instead, portal uniq check is made here
 				(ds->maskedtexturecol != -1 || ds->bFogBoundary))
+			{
+				R_EnterPhase (RP_MaskedMids);
 				R_RenderMaskedSegRange (ds, r1, r2);
+				R_LeavePhase (RP_MaskedMids);
+			}
 			continue;
 		}
 
@@ -2276,7 +2465,12 @@ void R_DrawSprite (vissprite_t *spr)
 		}
 		int minvoxely = spr->gzt <= hzt ? 0 : (spr->gzt - hzt) / spr->yscale;
 		int maxvoxely = spr->gzb > hzb ? INT_MAX : (spr->gzt - hzb) / spr->yscale;
+		VoxelCycles.Clock();
+		R_EnterPhase (RP_Voxels);
 		R_DrawVisVoxel(spr, minvoxely, maxvoxely, cliptop, clipbot);
+		R_LeavePhase (RP_Voxels);
+		VoxelCycles.Unclock();
+		VoxelsDrawn++;
 	}
 	spr->Style.colormap = colormap;
 }
@@ -2298,7 +2492,9 @@ void R_DrawMaskedSingle (bool renew)
 	{
 		if (spritesorter[i-1]->CurrentPortalUniq != CurrentPortalUniq)
 			continue; // probably another time
+		R_EnterPhase (RP_Sprites);
 		R_DrawSprite (spritesorter[i-1]);
+		R_LeavePhase (RP_Sprites);
 	}
 
 	// render any remaining masked mid textures
@@ -2322,7 +2518,9 @@ void R_DrawMaskedSingle (bool renew)
 		if (ds->fake) continue;
 		if (ds->maskedtexturecol != -1 || ds->bFogBoundary)
 		{
+			R_EnterPhase (RP_MaskedMids);
 			R_RenderMaskedSegRange (ds, ds->x1, ds->x2);
+			R_LeavePhase (RP_MaskedMids);
 		}
 	}
 }
@@ -2332,6 +2530,7 @@ void R_DrawHeightPlanes(fixed_t height); // kg3D - fake planes
 void R_DrawMasked (void)
 {
 	R_SortVisSprites (DrewAVoxel ? sv_compare2d : sv_compare, firstvissprite - vissprites);
+	R_IndexDrawSegs ();
 
 	if (height_top == NULL)
 	{ // kg3D - no visible 3D floors, normal rendering
@@ -2355,7 +2554,9 @@ void R_DrawMasked (void)
 			}
 			sclipBottom = hl->height;
 			R_DrawMaskedSingle(true);
+			R_EnterPhase (RP_3DFloorPlanes);
 			R_DrawHeightPlanes(hl->height);
+			R_LeavePhase (RP_3DFloorPlanes);
 		}
 
 		// floors
@@ -2365,7 +2566,9 @@ void R_DrawMasked (void)
 		hl = height_top;
 		for (hl = height_top; hl != NULL && hl->height < viewz; hl = hl->next)
 		{
+			R_EnterPhase (RP_3DFloorPlanes);
 			R_DrawHeightPlanes(hl->height);
+			R_LeavePhase (RP_3DFloorPlanes);
 			if (hl->next)
 			{
 				fake3D = FAKE3D_DOWN2UP | FAKE3D_CLIPTOP | FAKE3D_CLIPBOTTOM;
@@ -2381,11 +2584,13 @@ void R_DrawMasked (void)
 		R_3D_DeleteHeights();
 		fake3D = 0;
 	}
+	R_EnterPhase (RP_PlayerSprites);
 	R_DrawPlayerSprites ();
+	R_LeavePhase (RP_PlayerSprites);
 }
 
 
-void R_ProjectParticle (particle_t *particle, const sector_t *sector, int shade, int fakeside)
+void R_ProjectParticle (DWORD index, const sector_t *sector, int shade, int fakeside)
 {
 	fixed_t 			tr_x;
 	fixed_t 			tr_y;
@@ -2396,14 +2601,17 @@ void R_ProjectParticle (particle_t *particle, const sector_t *sector, int shade,
 	vissprite_t*		vis;
 	sector_t*			heightsec = NULL;
 	BYTE*				map;
+	fixed_t				px = Particles.X[index];
+	fixed_t				py = Particles.Y[index];
+	fixed_t				pz = Particles.Z[index];
 
 	// [ZZ] Particle not visible through the portal plane
-	if (CurrentPortal && !!P_PointOnLineSide(particle->x, particle->y, CurrentPortal->dst))
+	if (CurrentPortal && !!P_PointOnLineSide(px, py, CurrentPortal->dst))
 		return;
 
 	// transform the origin point
-	tr_x = particle->x - viewx;
-	tr_y = particle->y - viewy;
+	tr_x = px - viewx;
+	tr_y = py - viewy;
 
 	tz = DMulScale20 (tr_x, viewtancos, tr_y, viewtansin);
 
@@ -2427,7 +2635,7 @@ void R_ProjectParticle (particle_t *particle, const sector_t *sector, int shade,
 	xscale = centerx * tiz;
 
 	// calculate edges of the shape
-	int psize = particle->size << (12-3);
+	int psize = Particles.Size[index] << (12-3);
 
 	x1 = MAX<int> (WindowLeft, (centerxfrac + MulScale12 (tx-psize, xscale)) >> FRACBITS);
 	x2 = MIN<int> (WindowRight, (centerxfrac + MulScale12 (tx+psize, xscale)) >> FRACBITS);
@@ -2436,7 +2644,7 @@ void R_ProjectParticle (particle_t *particle, const sector_t *sector, int shade,
 		return;
 
 	yscale = MulScale16 (yaspectmul, xscale);
-	ty = particle->z - viewz;
+	ty = pz - viewz;
 	psize <<= 4;
 	y1 = (centeryfrac - FixedMul (ty+psize, yscale)) >> FRACBITS;
 	y2 = (centeryfrac - FixedMul (ty-psize, yscale)) >> FRACBITS;
@@ -2497,9 +2705,9 @@ void R_ProjectParticle (particle_t *particle, const sector_t *sector, int shade,
 		map = sector->ColorMap->Maps;
 	}
 
-	if (botpic != skyflatnum && particle->z < botplane->ZatPoint (particle->x, particle->y))
+	if (botpic != skyflatnum && pz < botplane->ZatPoint (px, py))
 		return;
-	if (toppic != skyflatnum && particle->z >= topplane->ZatPoint (particle->x, particle->y))
+	if (toppic != skyflatnum && pz >= topplane->ZatPoint (px, py))
 		return;
 
 	// store information in a vissprite
@@ -2511,18 +2719,18 @@ void R_ProjectParticle (particle_t *particle, const sector_t *sector, int shade,
 	vis->yscale = xscale;
 	vis->depth = tz;
 	vis->idepth = (DWORD)DivScale32 (1, tz) >> 1;
-	vis->gx = particle->x;
-	vis->gy = particle->y;
-	vis->gz = particle->z; // kg3D
+	vis->gx = px;
+	vis->gy = py;
+	vis->gz = pz; // kg3D
 	vis->gzb = y1;
 	vis->gzt = y2;
 	vis->x1 = x1;
 	vis->x2 = x2;
 	vis->Translation = 0;
-	vis->startfrac = 255 & (particle->color >>24);
+	vis->startfrac = 255 & (Particles.Color[index] >>24);
 	vis->pic = NULL;
 	vis->bIsVoxel = false;
-	vis->renderflags = particle->trans;
+	vis->renderflags = Particles.Trans[index];
 	vis->FakeFlatStat = fakeside;
 	vis->floorclip = 0;
 	vis->ColormapNum = 0;
@@ -2535,7 +2743,7 @@ void R_ProjectParticle (particle_t *particle, const sector_t *sector, int shade,
 	{
 		vis->Style.colormap = fixedcolormap;
 	}
-	else if(particle->bright) {
+	else if(Particles.Bright[index]) {
 		vis->Style.colormap = map;
 	}
 	else
@@ -2567,7 +2775,11 @@ static void R_DrawMaskedSegsBehindParticle (const vissprite_t *vis)
 		{
 			// [ZZ] only draw stuff that's inside the same portal as the particle, other portals will care for themselves
 			if (ds->CurrentPortalUniq == vis->CurrentPortalUniq)
+			{
+				R_EnterPhase (RP_MaskedMids);
 				R_RenderMaskedSegRange (ds, MAX<int>(ds->x1, x1), MIN<int>(ds->x2, x2));
+				R_LeavePhase (RP_MaskedMids);
+			}
 		}
 	}
 }
@@ -2639,6 +2851,41 @@ void R_DrawParticle (vissprite_t *vis)
 
 extern fixed_t baseyaspectmul;
 
+// How much sooner to switch to smaller mip levels, in mip levels. Each
+// step halves the distance up to which the larger mip is kept, so a voxel
+// needs twice the projected size to keep it.
+static double VoxelMipScale = 0.5;
+
+CUSTOM_CVAR (Float, r_voxelmipbias, 1.f, CVAR_ARCHIVE)
+{
+	VoxelMipScale = pow(2.0, -self);
+}
+
+//==========================================================================
+//
+// R_FindVoxelColumn
+//
+// Returns the first column in [first, last) with a Y of at least y.
+//
+//==========================================================================
+
+static inline const FVoxelColumn *R_FindVoxelColumn(const FVoxelColumn *first, const FVoxelColumn *last, int y)
+{
+	while (first < last)
+	{
+		const FVoxelColumn *mid = first + (last - first) / 2;
+		if (mid->Y < y)
+		{
+			first = mid + 1;
+		}
+		else
+		{
+			last = mid;
+		}
+	}
+	return first;
+}
+
 void R_DrawVoxel(fixed_t globalposx, fixed_t globalposy, fixed_t globalposz, angle_t viewang,
 	fixed_t dasprx, fixed_t daspry, fixed_t dasprz, angle_t dasprang,
 	fixed_t daxscale, fixed_t dayscale, FVoxel *voxobj,
@@ -2649,7 +2896,7 @@ void R_DrawVoxel(fixed_t globalposx, fixed_t globalposy, fixed_t globalposz, ang
 	int backx, backy, gxinc, gyinc;
 	int daxscalerecip, dayscalerecip, cnt, gxstart, gystart, dazscale;
 	int lx, rx, nx, ny, x1=0, y1=0, x2=0, y2=0, yinc=0;
-	int yoff, xs=0, ys=0, xe, ye, xi=0, yi=0, cbackx, cbacky, dagxinc, dagyinc;
+	int yoff, xs=0, ys=0, xe, ye, xi=0, yi=0, cbackx, cbacky, nxinc, nxstart, nystart;
 	kvxslab_t *voxptr, *voxend;
 	FVoxelMipLevel *mip;
 	int z1a[64], z2a[64], yplc[64];
@@ -2683,14 +2930,14 @@ void R_DrawVoxel(fixed_t globalposx, fixed_t globalposy, fixed_t globalposz, ang
 	// Select mip level
 	i = abs(DMulScale6(dasprx - globalposx, cosang, daspry - globalposy, sinang));
 	i = DivScale6(i, MIN(daxscale, dayscale));
-	j = FocalLengthX >> 3;
+	j = MAX(1, xs_RoundToInt((FocalLengthX >> 3) * VoxelMipScale));
 	for (k = 0; i >= j && k < voxobj->NumMips; ++k)
 	{
 		i >>= 1;
 	}
 	if (k >= voxobj->NumMips) k = voxobj->NumMips - 1;
 
-	mip = &voxobj->Mips[k];		if (mip->SlabData == NULL) return;
+	mip = &voxobj->Mips[k];		if (mip->SlabData == NULL || mip->Columns == NULL) return;
 
 	minslabz >>= k;
 	maxslabz >>= k;
@@ -2726,6 +2973,17 @@ void R_DrawVoxel(fixed_t globalposx, fixed_t globalposy, fixed_t globalposz, ang
 	gyinc = DMulScale10(sprcosang, cosang, sprsinang,  sinang);
 	if ((abs(globalposz - dasprz) >> 10) >= abs(dazscale)) return;
 
+	// Count the open screen columns left of each screen column, so voxel
+	// columns that only cover clipped screen columns can be thrown out
+	// before walking their slabs.
+	int *openbefore = (int *)alloca((viewwidth + 1) * sizeof(int));
+	openbefore[0] = 0;
+	for (x = 0; x < viewwidth; ++x)
+	{
+		openbefore[x + 1] = openbefore[x] + (daumost[x] < dadmost[x]);
+	}
+	if (openbefore[viewwidth] == 0) return;
+
 	x = 0; y = 0; j = MAX(mip->SizeX, mip->SizeY);
 	fixed_t *ggxinc = (fixed_t *)alloca((j + 1) * sizeof(fixed_t) * 2);
 	fixed_t *ggyinc = ggxinc + (j + 1);
@@ -2786,9 +3044,14 @@ void R_DrawVoxel(fixed_t globalposx, fixed_t globalposy, fixed_t globalposz, ang
 		BYTE oand = (1 << int(xs<backx)) + (1 << (int(ys<backy)+2));
 		BYTE oand16 = oand + 16;
 		BYTE oand32 = oand + 32;
+		const int *colstart = &mip->ColumnStart[(int(xs<backx) + int(ys<backy)*2) * (mip->SizeX + 1)];
 
-		if (yi > 0) { dagxinc =  gxinc; dagyinc =  FixedMul(gyinc, viewingrangerecip); }
-			   else { dagxinc = -gxinc; dagyinc = -FixedMul(gyinc, viewingrangerecip); }
+		// The y range this pass covers, as [ylo, yhi).
+		int ylo, yhi;
+		if (yi < 0)		{ ylo = ye + 1; yhi = ys + 1; }
+		else if (yi == 1)	{ ylo = ys; yhi = ye; }
+		else			{ ylo = ys; yhi = ys + 1; }
+		nxinc = FixedMul(gyinc, viewingrangerecip);
 
 			/* Fix for non 90 degree viewing ranges */
 		nxoff = FixedMul(x2 - x1, viewingrangerecip);
@@ -2802,10 +3065,24 @@ void R_DrawVoxel(fixed_t globalposx, fixed_t globalposy, fixed_t globalposz, ang
 			BYTE *slabxoffs = &mip->SlabData[mip->OffsetX[x]];
 			short *xyoffs = &mip->OffsetXY[x * (mip->SizeY + 1)];
 
-			nx = FixedMul(ggxstart + ggxinc[x], viewingrangerecip) + x1;
-			ny = ggystart + ggyinc[x];
-			for (y = ys; y != ye; y += yi, nx += dagyinc, ny -= dagxinc)
+			nxstart = FixedMul(ggxstart + ggxinc[x], viewingrangerecip) + x1;
+			nystart = ggystart + ggyinc[x];
+
+			// Only visit the columns with faces toward the viewer, in the same
+			// order as stepping y from ys to ye would.
+			const FVoxelColumn *colfirst = &mip->Columns[colstart[x]];
+			const FVoxelColumn *collast = &mip->Columns[colstart[x + 1]];
+			colfirst = R_FindVoxelColumn(colfirst, collast, ylo);
+			collast = R_FindVoxelColumn(colfirst, collast, yhi);
+			int colstep = yi > 0 ? 1 : -1;
+			const FVoxelColumn *column = yi > 0 ? colfirst : collast - 1;
+
+			for (int colcount = int(collast - colfirst); colcount > 0; --colcount, column += colstep)
 			{
+				if (column->ZBottom <= minslabz || column->ZTop >= maxslabz) continue;
+				y = column->Y;
+				nx = nxstart + (y - ys) * nxinc;
+				ny = nystart - (y - ys) * gxinc;
 				if ((ny <= nytooclose) || (ny >= nytoofar)) continue;
 				voxptr = (kvxslab_t *)(slabxoffs + xyoffs[y]);
 				voxend = (kvxslab_t *)(slabxoffs + xyoffs[y+1]);
@@ -2823,6 +3100,12 @@ void R_DrawVoxel(fixed_t globalposx, fixed_t globalposy, fixed_t globalposz, ang
 					lx = viewwidth - rx;
 					rx = t;
 				}
+				VoxelColumns++;
+				if (openbefore[rx] == openbefore[lx])
+				{ // Everything this column covers has already been clipped away.
+					VoxelColumnsCulled++;
+					continue;
+				}
 
 				fixed_t l1 = xs_RoundToInt(centerxwidebig_f / (ny - yoff));
 				fixed_t l2 = xs_RoundToInt(centerxwidebig_f / (ny + yoff));
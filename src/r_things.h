@@ -83,10 +83,9 @@ struct vissprite_t
 	int				CurrentPortalUniq; // [ZZ] to identify the portal that this thing is in. used for clipping.
 };
 
-struct particle_t;
 
 void R_DrawParticle (vissprite_t *);
-void R_ProjectParticle (particle_t *, const sector_t *sector, int shade, int fakeside);
+void R_ProjectParticle (DWORD index, const sector_t *sector, int shade, int fakeside);
 
 extern int MaxVisSprites;
 
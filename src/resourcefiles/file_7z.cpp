@@ -46,6 +46,7 @@
 #include "w_zip.h"
 #include "i_system.h"
 #include "w_wad.h"
+#include "d_startupprof.h"
 
 
 
@@ -350,6 +351,7 @@ int F7ZLump::FillCache()
 {
 	Cache = new char[LumpSize];
 	static_cast<F7ZFile*>(Owner)->Archive->Extract(Position, Cache);
+	D_StartupLumpDecompressed(LumpSize);
 	RefCount = 1;
 	return 1;
 }
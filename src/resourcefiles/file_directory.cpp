@@ -71,6 +71,7 @@ struct FDirectoryLump : public FResourceLump
 {
 	virtual FileReader *NewReader();
 	virtual int FillCache();
+	virtual const char *GetDiskPath() const { return mFullPath; }
 
 	FString mFullPath;
 };
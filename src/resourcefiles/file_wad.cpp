@@ -39,6 +39,7 @@
 #include "v_text.h"
 #include "w_wad.h"
 #include "gi.h"
+#include "d_startupprof.h"
 
 // Console Doom LZSS wrapper.
 class FileReaderLZSS : public FileReaderBase
@@ -237,7 +238,7 @@ public:
 	bool Compressed;
 	int	Position;
 
-	int GetFileOffset() { return Position; }
+	int GetFileOffset() { return Compressed ? -1 : Position; }
 	FileReader *GetReader()
 	{
 		if(!Compressed)
@@ -269,6 +270,7 @@ public:
 		{
 			FileReaderLZSS lzss(*Owner->Reader);
 			lzss.Read(Cache, LumpSize);
+			D_StartupLumpDecompressed(LumpSize);
 		}
 		else
 			Owner->Reader->Read(Cache, LumpSize);
@@ -41,6 +41,7 @@
 #include "w_zip.h"
 #include "i_system.h"
 #include "ancientzip.h"
+#include "d_startupprof.h"
 
 #define BUFREADCOMMENT (0x400)
 
@@ -394,6 +395,10 @@ int FZipLump::FillCache()
 			assert(0);
 			return 0;
 	}
+	if (Method != METHOD_STORED)
+	{
+		D_StartupLumpDecompressed(LumpSize);
+	}
 	RefCount = 1;
 	return 1;
 }
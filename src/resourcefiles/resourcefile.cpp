@@ -307,12 +307,14 @@ FResourceFile::FResourceFile(const char *filename, FileReader *r)
 	if (filename != NULL) Filename = copystring(filename);
 	else Filename = NULL;
 	Reader = r;
+	Index = NULL;
 }
 
 
 FResourceFile::~FResourceFile()
 {
 	if (Filename != NULL) delete [] Filename;
+	if (Index != NULL) delete Index;
 	delete Reader;
 }
 
@@ -550,6 +552,242 @@ bool FResourceFile::FindPrefixRange(FString filter, void *lumps, size_t lumpsize
 	return true;
 }
 
+//==========================================================================
+//
+// FResourceFile :: GetIndex
+//
+//==========================================================================
+
+const FResourceIndex &FResourceFile::GetIndex()
+{
+	if (Index == NULL)
+	{
+		Index = new FResourceIndex;
+		Index->Build(this);
+	}
+	return *Index;
+}
+
+//==========================================================================
+//
+// Resource index
+//
+//==========================================================================
+
+static const char *GetExtension(const FString &fullname)
+{
+	const char *name = fullname.GetChars();
+	const char *dot = strrchr(name, '.');
+	const char *slash = strrchr(name, '/');
+
+	if (dot == NULL || (slash != NULL && dot < slash))
+	{
+		return "";
+	}
+	return dot + 1;
+}
+
+static int STACK_ARGS indexnamecmp(const void *a, const void *b)
+{
+	const FResourceIndexEntry *rec1 = (const FResourceIndexEntry *)a;
+	const FResourceIndexEntry *rec2 = (const FResourceIndexEntry *)b;
+
+	int cmp = rec1->Lump->FullName.CompareNoCase(rec2->Lump->FullName);
+	return cmp != 0 ? cmp : rec1->Index - rec2->Index;
+}
+
+static int STACK_ARGS indexextcmp(const void *a, const void *b)
+{
+	const FResourceIndexEntry *rec1 = (const FResourceIndexEntry *)a;
+	const FResourceIndexEntry *rec2 = (const FResourceIndexEntry *)b;
+
+	int cmp = stricmp(GetExtension(rec1->Lump->FullName), GetExtension(rec2->Lump->FullName));
+	return cmp != 0 ? cmp : indexnamecmp(a, b);
+}
+
+static int STACK_ARGS indexnscmp(const void *a, const void *b)
+{
+	const FResourceIndexEntry *rec1 = (const FResourceIndexEntry *)a;
+	const FResourceIndexEntry *rec2 = (const FResourceIndexEntry *)b;
+
+	if (rec1->Lump->Namespace != rec2->Lump->Namespace)
+	{
+		return rec1->Lump->Namespace < rec2->Lump->Namespace ? -1 : 1;
+	}
+	return rec1->Index - rec2->Index;
+}
+
+//==========================================================================
+//
+// FResourceIndex :: Build
+//
+//==========================================================================
+
+void FResourceIndex::Build(FResourceFile *file)
+{
+	DWORD count = file->LumpCount();
+
+	ByName.Clear();
+	ByExtension.Clear();
+	ByNamespace.Clear();
+	MaybeFlats.Clear();
+
+	for (DWORD i = 0; i < count; i++)
+	{
+		FResourceIndexEntry entry = { file->GetLump(i), (int)i };
+
+		ByNamespace.Push(entry);
+		if (entry.Lump->FullName.IsNotEmpty())
+		{
+			ByName.Push(entry);
+		}
+		if (entry.Lump->Flags & LUMPF_MAYBEFLAT)
+		{
+			MaybeFlats.Push(i);
+		}
+	}
+	ByExtension = ByName;
+
+	// Archive directories usually come in sorted already, but filtered
+	// lumps are moved to the end, so don't count on it.
+	if (ByName.Size() > 1)
+	{
+		qsort(&ByName[0], ByName.Size(), sizeof(FResourceIndexEntry), indexnamecmp);
+		qsort(&ByExtension[0], ByExtension.Size(), sizeof(FResourceIndexEntry), indexextcmp);
+	}
+	if (ByNamespace.Size() > 1)
+	{
+		qsort(&ByNamespace[0], ByNamespace.Size(), sizeof(FResourceIndexEntry), indexnscmp);
+	}
+}
+
+//==========================================================================
+//
+// FResourceIndex :: FindFullName
+//
+//==========================================================================
+
+int FResourceIndex::FindFullName(const char *name) const
+{
+	unsigned min = 0, max = ByName.Size();
+
+	// Find the first entry past all matches, then step back onto the last one.
+	while (min < max)
+	{
+		unsigned mid = min + (max - min) / 2;
+		if (ByName[mid].Lump->FullName.CompareNoCase(name) <= 0)
+			min = mid + 1;
+		else
+			max = mid;
+	}
+	if (min > 0 && ByName[min - 1].Lump->FullName.CompareNoCase(name) == 0)
+	{
+		return ByName[min - 1].Index;
+	}
+	return -1;
+}
+
+//==========================================================================
+//
+// FResourceIndex :: FindPrefix
+//
+//==========================================================================
+
+bool FResourceIndex::FindPrefix(const char *prefix, unsigned &start, unsigned &end) const
+{
+	int len = (int)strlen(prefix);
+	unsigned min = 0, max = ByName.Size();
+
+	while (min < max)
+	{
+		unsigned mid = min + (max - min) / 2;
+		if (ByName[mid].Lump->FullName.CompareNoCase(prefix, len) < 0)
+			min = mid + 1;
+		else
+			max = mid;
+	}
+	start = min;
+
+	max = ByName.Size();
+	while (min < max)
+	{
+		unsigned mid = min + (max - min) / 2;
+		if (ByName[mid].Lump->FullName.CompareNoCase(prefix, len) <= 0)
+			min = mid + 1;
+		else
+			max = mid;
+	}
+	end = min;
+	return start < end;
+}
+
+//==========================================================================
+//
+// FResourceIndex :: FindExtension
+//
+//==========================================================================
+
+bool FResourceIndex::FindExtension(const char *ext, unsigned &start, unsigned &end) const
+{
+	unsigned min = 0, max = ByExtension.Size();
+
+	if (*ext == '.') ext++;
+	while (min < max)
+	{
+		unsigned mid = min + (max - min) / 2;
+		if (stricmp(GetExtension(ByExtension[mid].Lump->FullName), ext) < 0)
+			min = mid + 1;
+		else
+			max = mid;
+	}
+	start = min;
+
+	max = ByExtension.Size();
+	while (min < max)
+	{
+		unsigned mid = min + (max - min) / 2;
+		if (stricmp(GetExtension(ByExtension[mid].Lump->FullName), ext) <= 0)
+			min = mid + 1;
+		else
+			max = mid;
+	}
+	end = min;
+	return start < end;
+}
+
+//==========================================================================
+//
+// FResourceIndex :: FindNamespace
+//
+//==========================================================================
+
+bool FResourceIndex::FindNamespace(int ns, unsigned &start, unsigned &end) const
+{
+	unsigned min = 0, max = ByNamespace.Size();
+
+	while (min < max)
+	{
+		unsigned mid = min + (max - min) / 2;
+		if (ByNamespace[mid].Lump->Namespace < ns)
+			min = mid + 1;
+		else
+			max = mid;
+	}
+	start = min;
+
+	max = ByNamespace.Size();
+	while (min < max)
+	{
+		unsigned mid = min + (max - min) / 2;
+		if (ByNamespace[mid].Lump->Namespace <= ns)
+			min = mid + 1;
+		else
+			max = mid;
+	}
+	end = min;
+	return start < end;
+}
+
 //==========================================================================
 //
 // Needs to be virtual in the base class. Implemented only for WADs
@@ -42,8 +42,9 @@ struct FResourceLump
 	virtual ~FResourceLump();
 	virtual FileReader *GetReader();
 	virtual FileReader *NewReader();
-	virtual int GetFileOffset() { return -1; }
+	virtual int GetFileOffset() { return -1; }	// -1 if the lump's data isn't stored in the file as-is
 	virtual int GetIndexNum() const { return 0; }
+	virtual const char *GetDiskPath() const { return NULL; }
 	void LumpNameSetup(FString iname);
 	void CheckEmbedded();
 
@@ -55,6 +56,44 @@ protected:
 
 };
 
+//==========================================================================
+//
+// FResourceIndex
+//
+// Sorted views of one resource file's directory, so that lookups by full
+// name, path prefix, extension or namespace are binary searches instead
+// of walks over every lump. Entries refer to lumps by their number within
+// the owning file.
+//
+//==========================================================================
+
+struct FResourceIndexEntry
+{
+	FResourceLump *Lump;
+	int Index;
+};
+
+class FResourceIndex
+{
+public:
+	void Build(FResourceFile *file);
+
+	// Returns the file-relative lump number or -1. If a name occurs more
+	// than once the last one wins, as it does for the global lookup.
+	int FindFullName(const char *name) const;
+
+	// These return the [start, end) range of matching entries in ByName,
+	// ByExtension and ByNamespace respectively.
+	bool FindPrefix(const char *prefix, unsigned &start, unsigned &end) const;
+	bool FindExtension(const char *ext, unsigned &start, unsigned &end) const;
+	bool FindNamespace(int ns, unsigned &start, unsigned &end) const;
+
+	TArray<FResourceIndexEntry> ByName;			// lumps with a full name, by name
+	TArray<FResourceIndexEntry> ByExtension;	// the same lumps, by extension and then name
+	TArray<FResourceIndexEntry> ByNamespace;	// all lumps, by namespace and then number
+	TArray<int> MaybeFlats;						// lumps flagged LUMPF_MAYBEFLAT, in order
+};
+
 class FResourceFile
 {
 public:
@@ -70,6 +109,7 @@ protected:
 
 private:
 	DWORD FirstLump;
+	FResourceIndex *Index;
 
 	int FilterLumps(FString filtername, void *lumps, size_t lumpsize, DWORD max);
 	int FilterLumpsByGameType(int gametype, void *lumps, size_t lumpsize, DWORD max);
@@ -85,6 +125,10 @@ public:
 	DWORD GetFirstLump() const { return FirstLump; }
 	void SetFirstLump(DWORD f) { FirstLump = f; }
 
+	// The index is built on first use, once Open has settled the names
+	// and namespaces of all lumps.
+	const FResourceIndex &GetIndex();
+
 	virtual void FindStrifeTeaserVoices ();
 	virtual bool Open(bool quiet) = 0;
 	virtual FResourceLump *GetLump(int no) = 0;
@@ -51,6 +51,7 @@
 #include "i_system.h"
 #include "d_player.h"
 #include "farchive.h"
+#include "s_sfxcache.h"
 
 // MACROS ------------------------------------------------------------------
 
@@ -869,6 +870,7 @@ static void S_ClearSoundData()
 	{
 		S_UnloadSound(&S_sfx[i]);
 	}
+	S_ClearSfxCache();
 	S_sfx.Clear();
 	Ambients.Clear();
 	while (MusicVolumes != NULL)
@@ -0,0 +1,550 @@
+/*
+** s_sfxcache.cpp
+** Background decoding and caching of compressed sound effects
+**
+**---------------------------------------------------------------------------
+** Copyright 2016 The ZDoom Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** Ogg, FLAC and MP3 sound effects used to be decoded on the game thread
+** the first time they were played. S_PrecacheLevel now queues them here
+** instead, and a worker thread decodes them to PCM in the background.
+** The PCM is kept in a cache with a byte budget, least recently used
+** first out, so sounds that are unloaded between levels come back
+** without being decoded again. Sounds longer than snd_streamsfx seconds
+** are left to the sound system, which may stream them.
+*/
+
+// HEADER FILES ------------------------------------------------------------
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "doomtype.h"
+#include "s_sfxcache.h"
+#include "s_sound.h"
+#include "i_sound.h"
+#include "w_wad.h"
+#include "files.h"
+#include "c_cvars.h"
+#include "stats.h"
+#include "templates.h"
+#include "m_swap.h"
+
+// TYPES -------------------------------------------------------------------
+
+struct FDecodedSfx
+{
+	enum EState
+	{
+		Queued,
+		Decoding,
+		Done,
+		Failed,
+		TooLong
+	};
+
+	int LumpNum;
+	EState State;
+	TArray<BYTE> Source;	// Encoded lump; only kept until it is decoded
+	TArray<char> PCM;
+	int Rate;
+	int Channels;
+	int Bits;
+	double DecodeMS;
+	FDecodedSfx *Older;		// LRU list, for Done entries only
+	FDecodedSfx *Newer;
+};
+
+// PRIVATE FUNCTION PROTOTYPES ---------------------------------------------
+
+static void TrimCache();
+
+// PRIVATE DATA DEFINITIONS ------------------------------------------------
+
+static std::mutex CacheLock;
+static std::condition_variable WorkReady;
+static std::condition_variable WorkDone;
+static std::thread Worker;
+static bool WorkerQuit;
+
+static TMap<int, FDecodedSfx *> DecodedSfx;
+static TArray<FDecodedSfx *> DecodeQueue;
+static FDecodedSfx *MostRecent, *LeastRecent;
+static size_t CachedBytes;
+
+static unsigned int CacheHits, CacheMisses, BackgroundDecodes;
+static double DecodeTime;
+
+// PUBLIC DATA DEFINITIONS -------------------------------------------------
+
+// Sounds longer than this many seconds are not decoded into memory by the
+// cache. 0 decodes everything.
+CVAR (Float, snd_streamsfx, 10.f, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
+// Size of the decoded sound cache, in megabytes.
+CUSTOM_CVAR (Int, snd_sfxcachesize, 32, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+{
+	if (self < 0)
+	{
+		self = 0;
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lock(CacheLock);
+		TrimCache();
+	}
+}
+
+// CODE --------------------------------------------------------------------
+
+//==========================================================================
+//
+// Unlink / LinkNewest
+//
+// LRU list maintenance. Must be called with the cache locked.
+//
+//==========================================================================
+
+static void Unlink(FDecodedSfx *entry)
+{
+	if (entry->Older != NULL) entry->Older->Newer = entry->Newer;
+	else LeastRecent = entry->Newer;
+	if (entry->Newer != NULL) entry->Newer->Older = entry->Older;
+	else MostRecent = entry->Older;
+	entry->Older = entry->Newer = NULL;
+}
+
+static void LinkNewest(FDecodedSfx *entry)
+{
+	entry->Older = MostRecent;
+	entry->Newer = NULL;
+	if (MostRecent != NULL) MostRecent->Newer = entry;
+	else LeastRecent = entry;
+	MostRecent = entry;
+}
+
+//==========================================================================
+//
+// TrimCache
+//
+// Evicts the least recently used sounds until the cache fits its budget.
+// The most recently used sound always stays, even if it alone is too big,
+// since someone is about to use it. Must be called with the cache locked.
+//
+//==========================================================================
+
+static void TrimCache()
+{
+	size_t budget = size_t(MAX(0, *snd_sfxcachesize)) << 20;
+
+	while (CachedBytes > budget && LeastRecent != NULL && LeastRecent != MostRecent)
+	{
+		FDecodedSfx *entry = LeastRecent;
+		Unlink(entry);
+		CachedBytes -= entry->PCM.Size();
+		DecodedSfx.Remove(entry->LumpNum);
+		delete entry;
+	}
+}
+
+//==========================================================================
+//
+// DecodeEntry
+//
+// Decodes an entry's source. This is called without the cache locked:
+// while an entry is in the Decoding state nobody else touches it.
+//
+//==========================================================================
+
+static void DecodeEntry(FDecodedSfx *entry)
+{
+	cycle_t timer;
+	timer.Reset();
+	timer.Clock();
+
+	MemoryReader reader((const char *)&entry->Source[0], entry->Source.Size());
+	SoundDecoder *decoder = CreateSoundDecoder(&reader);
+	ChannelConfig chans;
+	SampleType type;
+
+	entry->State = FDecodedSfx::Failed;
+	if (decoder != NULL)
+	{
+		decoder->getInfo(&entry->Rate, &chans, &type);
+		if (chans == ChannelConfig_Mono || chans == ChannelConfig_Stereo)
+		{
+			entry->Channels = chans == ChannelConfig_Mono ? 1 : 2;
+			entry->Bits = type == SampleType_UInt8 ? 8 : 16;
+
+			if (snd_streamsfx > 0 && decoder->getSampleLength() > entry->Rate * snd_streamsfx)
+			{
+				entry->State = FDecodedSfx::TooLong;
+			}
+			else
+			{
+				entry->PCM = decoder->readAll();
+				if (entry->PCM.Size() > 0)
+				{
+					entry->State = FDecodedSfx::Done;
+				}
+			}
+		}
+		delete decoder;
+	}
+
+	timer.Unclock();
+	entry->DecodeMS = timer.TimeMS();
+}
+
+//==========================================================================
+//
+// FinishEntry
+//
+// Must be called with the cache locked.
+//
+//==========================================================================
+
+static void FinishEntry(FDecodedSfx *entry)
+{
+	entry->Source.Clear();
+	entry->Source.ShrinkToFit();
+	DecodeTime += entry->DecodeMS;
+	if (entry->State == FDecodedSfx::Done)
+	{
+		entry->PCM.ShrinkToFit();
+		CachedBytes += entry->PCM.Size();
+		LinkNewest(entry);
+		TrimCache();
+	}
+	WorkDone.notify_all();
+}
+
+//==========================================================================
+//
+// DecodeThread
+//
+//==========================================================================
+
+static void DecodeThread()
+{
+	std::unique_lock<std::mutex> lock(CacheLock);
+
+	for (;;)
+	{
+		while (!WorkerQuit && DecodeQueue.Size() == 0)
+		{
+			WorkReady.wait(lock);
+		}
+		if (WorkerQuit)
+		{
+			break;
+		}
+
+		FDecodedSfx *entry = DecodeQueue[0];
+		DecodeQueue.Delete(0);
+		entry->State = FDecodedSfx::Decoding;
+
+		lock.unlock();
+		DecodeEntry(entry);
+		lock.lock();
+
+		BackgroundDecodes++;
+		FinishEntry(entry);
+	}
+}
+
+//==========================================================================
+//
+// IsEncodedSfx
+//
+// Returns true for lumps S_LoadSound would hand to GSnd->LoadSound that
+// are worth decoding ahead of time, i.e. anything that isn't VOC, raw,
+// DMX or a wave file. Wave files are usually plain PCM already.
+//
+//==========================================================================
+
+static bool IsEncodedSfx(const sfxinfo_t *sfx, const BYTE *data, int size)
+{
+	if (sfx->bLoadRAW || size < 8)
+	{
+		return false;
+	}
+	if (size >= 12 && memcmp(data, "RIFF", 4) == 0 && memcmp(data + 8, "WAVE", 4) == 0)
+	{
+		return false;
+	}
+	if (size >= 19 && strncmp((const char *)data, "Creative Voice File", 19) == 0)
+	{
+		return false;
+	}
+	if (data[0] == 3 && data[1] == 0 && LittleLong(((SDWORD *)data)[1]) <= size - 8)
+	{
+		return false;
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// HasLoopTags
+//
+// Checks for the LOOP_START, LOOP_END and LOOP_BIDI tags FMOD reads from
+// Vorbis comments and ID3 frames. They are stored as plain text, so there
+// is no need to parse the container to find them. Sounds with them must
+// go through GSnd->LoadSound, since the decoded PCM loses them.
+//
+//==========================================================================
+
+static bool HasLoopTags(const BYTE *data, int size)
+{
+	for (int i = 0; i + 8 <= size; ++i)
+	{
+		if ((data[i] == 'L' || data[i] == 'l') && strnicmp((const char *)data + i, "LOOP_", 5) == 0)
+		{
+			const char *tag = (const char *)data + i + 5;
+			int left = size - i - 5;
+			if ((left >= 5 && strnicmp(tag, "START", 5) == 0) ||
+				(left >= 3 && strnicmp(tag, "END", 3) == 0) ||
+				(left >= 4 && strnicmp(tag, "BIDI", 4) == 0))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+//==========================================================================
+//
+// S_QueueSfxDecode
+//
+//==========================================================================
+
+bool S_QueueSfxDecode(sfxinfo_t *sfx)
+{
+	if (GSnd == NULL || GSnd->IsNull() || sfx->data.isValid() || sfx->lumpnum < 0 || sfx->link != sfxinfo_t::NO_LINK)
+	{
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(CacheLock);
+
+	FDecodedSfx **pentry = DecodedSfx.CheckKey(sfx->lumpnum);
+	if (pentry != NULL)
+	{
+		return (*pentry)->State != FDecodedSfx::Failed && (*pentry)->State != FDecodedSfx::TooLong;
+	}
+	lock.unlock();
+
+	// Reading the lump has to happen on this thread. Look at the header
+	// first so that plain sounds don't get read twice.
+	FWadLump wlump = Wads.OpenLumpNum(sfx->lumpnum);
+	int size = wlump.GetLength();
+	BYTE header[32];
+	if (size <= 0 || wlump.Read(header, MIN<int>(size, sizeof(header))) != MIN<int>(size, sizeof(header)) ||
+		!IsEncodedSfx(sfx, header, size))
+	{
+		return false;
+	}
+	FDecodedSfx *entry = new FDecodedSfx;
+	entry->Source.Resize(size);
+	memcpy(&entry->Source[0], header, MIN<int>(size, sizeof(header)));
+	if (size > (int)sizeof(header))
+	{
+		wlump.Read(&entry->Source[sizeof(header)], size - sizeof(header));
+	}
+	if (HasLoopTags(&entry->Source[0], size))
+	{
+		delete entry;
+		return false;
+	}
+	entry->LumpNum = sfx->lumpnum;
+	entry->State = FDecodedSfx::Queued;
+	entry->Older = entry->Newer = NULL;
+
+	lock.lock();
+	DecodedSfx[entry->LumpNum] = entry;
+	DecodeQueue.Push(entry);
+	if (!Worker.joinable())
+	{
+		WorkerQuit = false;
+		Worker = std::thread(DecodeThread);
+	}
+	WorkReady.notify_one();
+	return true;
+}
+
+//==========================================================================
+//
+// S_LoadDecodedSound
+//
+//==========================================================================
+
+SoundHandle S_LoadDecodedSound(sfxinfo_t *sfx, BYTE *sfxdata, int size)
+{
+	SoundHandle retval = { NULL };
+
+	if (!IsEncodedSfx(sfx, sfxdata, size) || HasLoopTags(sfxdata, size))
+	{
+		return retval;
+	}
+
+	std::unique_lock<std::mutex> lock(CacheLock);
+
+	FDecodedSfx **pentry = DecodedSfx.CheckKey(sfx->lumpnum);
+	FDecodedSfx *entry = pentry != NULL ? *pentry : NULL;
+
+	if (entry != NULL && entry->State == FDecodedSfx::Decoding)
+	{ // Almost there; wait for it.
+		while ((pentry = DecodedSfx.CheckKey(sfx->lumpnum)) != NULL && (*pentry)->State == FDecodedSfx::Decoding)
+		{
+			WorkDone.wait(lock);
+		}
+		entry = pentry != NULL ? *pentry : NULL;
+	}
+	if (entry == NULL || entry->State == FDecodedSfx::Queued)
+	{ // Needed before the decode thread got to it, so do it here.
+		if (entry == NULL)
+		{
+			entry = new FDecodedSfx;
+			entry->LumpNum = sfx->lumpnum;
+			entry->Older = entry->Newer = NULL;
+			entry->Source.Resize(size);
+			memcpy(&entry->Source[0], sfxdata, size);
+			DecodedSfx[entry->LumpNum] = entry;
+		}
+		else
+		{
+			DecodeQueue.Delete(DecodeQueue.Find(entry));
+		}
+		entry->State = FDecodedSfx::Decoding;
+		CacheMisses++;
+
+		lock.unlock();
+		DecodeEntry(entry);
+		lock.lock();
+
+		FinishEntry(entry);
+	}
+	else if (entry->State == FDecodedSfx::Done)
+	{
+		CacheHits++;
+		Unlink(entry);
+		LinkNewest(entry);
+	}
+
+	if (entry->State == FDecodedSfx::Done)
+	{
+		retval = GSnd->LoadSoundRaw((BYTE *)&entry->PCM[0], entry->PCM.Size(), entry->Rate,
+			entry->Channels, entry->Bits, sfx->LoopStart);
+	}
+	return retval;
+}
+
+//==========================================================================
+//
+// S_ForgetSfxDecode
+//
+//==========================================================================
+
+void S_ForgetSfxDecode(int lumpnum)
+{
+	std::unique_lock<std::mutex> lock(CacheLock);
+	FDecodedSfx **pentry;
+
+	while ((pentry = DecodedSfx.CheckKey(lumpnum)) != NULL && (*pentry)->State == FDecodedSfx::Decoding)
+	{
+		WorkDone.wait(lock);
+	}
+	if (pentry == NULL)
+	{
+		return;
+	}
+
+	FDecodedSfx *entry = *pentry;
+	if (entry->State == FDecodedSfx::Queued)
+	{
+		DecodeQueue.Delete(DecodeQueue.Find(entry));
+	}
+	else if (entry->State == FDecodedSfx::Done)
+	{
+		Unlink(entry);
+		CachedBytes -= entry->PCM.Size();
+	}
+	DecodedSfx.Remove(lumpnum);
+	delete entry;
+}
+
+//==========================================================================
+//
+// S_ClearSfxCache
+//
+//==========================================================================
+
+void S_ClearSfxCache()
+{
+	if (Worker.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(CacheLock);
+			WorkerQuit = true;
+			WorkReady.notify_one();
+		}
+		Worker.join();
+	}
+
+	// The worker is gone, so nothing can be in the Decoding state now.
+	TMap<int, FDecodedSfx *>::Iterator it(DecodedSfx);
+	TMap<int, FDecodedSfx *>::Pair *pair;
+	while (it.NextPair(pair))
+	{
+		delete pair->Value;
+	}
+	DecodedSfx.Clear();
+	DecodeQueue.Clear();
+	MostRecent = LeastRecent = NULL;
+	CachedBytes = 0;
+}
+
+//==========================================================================
+//
+// STAT sfxcache
+//
+//==========================================================================
+
+ADD_STAT (sfxcache)
+{
+	FString out;
+	std::lock_guard<std::mutex> lock(CacheLock);
+
+	out.Format("%u sounds, %.1f/%d MB, %u queued, %u hits, %u misses, %u decoded in background, %.1f ms decoding",
+		DecodedSfx.CountUsed(), CachedBytes / 1048576., *snd_sfxcachesize, DecodeQueue.Size(),
+		CacheHits, CacheMisses, BackgroundDecodes, DecodeTime);
+	return out;
+}
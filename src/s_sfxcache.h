@@ -0,0 +1,59 @@
+/*
+** s_sfxcache.h
+** Background decoding and caching of compressed sound effects
+**
+**---------------------------------------------------------------------------
+** Copyright 2016 The ZDoom Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+#ifndef __S_SFXCACHE_H__
+#define __S_SFXCACHE_H__
+
+#include "i_sound.h"
+
+struct sfxinfo_t;
+
+// Hands a compressed sound to the decode thread. Returns false if the
+// sound is not something the decoder handles, in which case it should
+// be loaded right away as before.
+bool S_QueueSfxDecode(sfxinfo_t *sfx);
+
+// Loads a compressed sound into the sound system from its decoded PCM,
+// decoding it now if the decode thread hasn't gotten to it yet. Returns
+// an invalid handle if the sound could not or should not be decoded here.
+SoundHandle S_LoadDecodedSound(sfxinfo_t *sfx, BYTE *sfxdata, int size);
+
+// Drops whatever the cache holds for a lump whose data changed.
+void S_ForgetSfxDecode(int lumpnum);
+
+// Cancels pending work and frees everything. The lump numbers the cache
+// is keyed on are only valid until the sound data is reset.
+void S_ClearSfxCache();
+
+#endif
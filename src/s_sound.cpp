@@ -51,6 +51,7 @@
 #include "g_level.h"
 #include "po_man.h"
 #include "farchive.h"
+#include "s_sfxcache.h"
 
 // MACROS ------------------------------------------------------------------
 
@@ -112,6 +113,8 @@ static void CalcPolyobjSoundOrg(const FPolyObj *poly, fixed_t *x, fixed_t *y, fi
 static FSoundChan *S_StartSound(AActor *mover, const sector_t *sec, const FPolyObj *poly,
 	const FVector3 *pt, int channel, FSoundID sound_id, float volume, float attenuation, FRolloffInfo *rolloff);
 static void S_SetListener(SoundListener &listener, AActor *listenactor);
+static void S_LinkSfxChannel(FSoundChan *chan);
+static void S_UnlinkSfxChannel(FSoundChan *chan);
 
 // PRIVATE DATA DEFINITIONS ------------------------------------------------
 
@@ -122,6 +125,15 @@ static FString	 LastSong;			// last music that was played
 static FPlayList *PlayList;
 static int		RestartEvictionsAt;	// do not restart evicted channels before this level.time
 
+// Playing channels grouped by sound ID, so that S_CheckSoundLimit only
+// needs to look at copies of the sound it is checking.
+static TArray<FSoundChan *> SfxChannels;
+
+// Listener state the sound system was last updated with.
+static FVector3	LastListenerPos;
+static float	LastListenerAngle;
+static bool		LastListenerValid;
+
 // PUBLIC DATA DEFINITIONS -------------------------------------------------
 
 int sfx_empty;
@@ -536,7 +548,12 @@ void S_CacheSound (sfxinfo_t *sfx)
 				sfx = &S_sfx[sfx->link];
 			}
 			sfx->bUsed = true;
-			S_LoadSound (sfx);
+			// Compressed sounds are decoded in the background and only
+			// loaded when they are first played.
+			if (!S_QueueSfxDecode (sfx))
+			{
+				S_LoadSound (sfx);
+			}
 		}
 	}
 }
@@ -557,6 +574,46 @@ void S_UnloadSound (sfxinfo_t *sfx)
 	}
 }
 
+//==========================================================================
+//
+// S_ReloadSoundLump
+//
+// Stops and unloads all sounds made from a lump whose data changed, so
+// they are loaded again the next time they play. Returns the number of
+// sounds that use the lump.
+//
+//==========================================================================
+
+int S_ReloadSoundLump (int lumpnum)
+{
+	FSoundChan *chan, *next;
+	unsigned int i;
+	int count = 0;
+
+	if (GSnd == NULL)
+	{
+		return 0;
+	}
+	for (chan = Channels; chan != NULL; chan = next)
+	{
+		next = chan->NextChan;
+		if (S_sfx[chan->SoundID].lumpnum == lumpnum)
+		{
+			S_StopChannel(chan);
+		}
+	}
+	for (i = 1; i < S_sfx.Size(); ++i)
+	{
+		if (S_sfx[i].lumpnum == lumpnum)
+		{
+			S_UnloadSound(&S_sfx[i]);
+			count++;
+		}
+	}
+	S_ForgetSfxDecode(lumpnum);
+	return count;
+}
+
 //==========================================================================
 //
 // S_GetChannel
@@ -594,6 +651,7 @@ FISoundChannel *S_GetChannel(void *syschan)
 
 void S_ReturnChannel(FSoundChan *chan)
 {
+	S_UnlinkSfxChannel(chan);
 	S_UnlinkChannel(chan);
 	memset(chan, 0, sizeof(*chan));
 	S_LinkChannel(chan, &FreeChannels);
@@ -631,6 +689,75 @@ void S_LinkChannel(FSoundChan *chan, FSoundChan **head)
 	chan->PrevChan = head;
 }
 
+//==========================================================================
+//
+// S_LinkSfxChannel
+//
+// Adds a channel to the list for the sound it is playing. The newest
+// channel goes first, matching the order of the main Channels list.
+//
+//==========================================================================
+
+static void S_LinkSfxChannel(FSoundChan *chan)
+{
+	unsigned int id = chan->SoundID;
+
+	while (SfxChannels.Size() <= id)
+	{
+		SfxChannels.Push(NULL);
+	}
+	chan->PrevSfxChan = NULL;
+	chan->NextSfxChan = SfxChannels[id];
+	if (chan->NextSfxChan != NULL)
+	{
+		chan->NextSfxChan->PrevSfxChan = chan;
+	}
+	SfxChannels[id] = chan;
+	chan->InSfxList = true;
+}
+
+//==========================================================================
+//
+// S_UnlinkSfxChannel
+//
+//==========================================================================
+
+static void S_UnlinkSfxChannel(FSoundChan *chan)
+{
+	if (!chan->InSfxList)
+	{
+		return;
+	}
+	if (chan->PrevSfxChan != NULL)
+	{
+		chan->PrevSfxChan->NextSfxChan = chan->NextSfxChan;
+	}
+	else
+	{
+		SfxChannels[chan->SoundID] = chan->NextSfxChan;
+	}
+	if (chan->NextSfxChan != NULL)
+	{
+		chan->NextSfxChan->PrevSfxChan = chan->PrevSfxChan;
+	}
+	chan->InSfxList = false;
+}
+
+//==========================================================================
+//
+// SoundCell
+//
+// Converts a sound coordinate to a coarse cell index for limit checks.
+//
+//==========================================================================
+
+#define SOUND_CELL_SIZE		512.f
+
+static inline int SoundCell(float coord)
+{
+	return int(floorf(coord * (1.f / SOUND_CELL_SIZE)));
+}
+
 // [RH] Split S_StartSoundAtVolume into multiple parts so that sounds can
 //		be specified both by id and by name. Also borrowed some stuff from
 //		Hexen and parameters from Quake.
@@ -1110,6 +1237,9 @@ static FSoundChan *S_StartSound(AActor *actor, const sector_t *sec, const FPolyO
 	if (chan != NULL)
 	{
 		chan->SoundID = sound_id;
+		S_LinkSfxChannel(chan);
+		chan->LastPos = pos;
+		chan->LastVel = vel;
 		chan->OrgID = FSoundID(org_id);
 		chan->EntChannel = channel;
 		chan->Volume = float(volume);
@@ -1184,6 +1314,8 @@ void S_RestartSound(FSoundChan *chan)
 		S_SetListener(listener, players[consoleplayer].camera);
 
 		chan->ChanFlags &= ~(CHAN_EVICTED|CHAN_ABSTIME);
+		chan->LastPos = pos;
+		chan->LastVel = vel;
 		ochan = (FSoundChan*)GSnd->StartSound3D(sfx->data, &listener, chan->Volume, &chan->Rolloff, chan->DistanceScale, chan->Pitch,
 			chan->Priority, pos, vel, chan->EntChannel, startflags, chan);
 	}
@@ -1345,7 +1477,11 @@ sfxinfo_t *S_LoadSound(sfxinfo_t *sfx)
 			// If that fails, let the sound system try and figure it out.
 			else
 			{
-				sfx->data = GSnd->LoadSound(sfxdata, size);
+				sfx->data = S_LoadDecodedSound(sfx, sfxdata, size);
+				if (!sfx->data.isValid())
+				{
+					sfx->data = GSnd->LoadSound(sfxdata, size);
+				}
 			}
 
 			delete[] sfxdata;
@@ -1399,6 +1535,11 @@ bool S_CheckSingular(int sound_id)
 //
 // Returns true if the sound should not play.
 //
+// Only channels playing this sound are visited. 3D channels whose last
+// known position is clearly out of range, going by coarse cells with one
+// cell of slack for movement since the last update, are skipped without
+// working out their current position.
+//
 //==========================================================================
 
 bool S_CheckSoundLimit(sfxinfo_t *sfx, const FVector3 &pos, int near_limit, float limit_range,
@@ -1406,10 +1547,22 @@ bool S_CheckSoundLimit(sfxinfo_t *sfx, const FVector3 &pos, int near_limit, floa
 {
 	FSoundChan *chan;
 	int count;
-	
-	for (chan = Channels, count = 0; chan != NULL && count < near_limit; chan = chan->NextChan)
+	unsigned int id = unsigned(sfx - &S_sfx[0]);
+
+	if (id >= SfxChannels.Size())
+	{
+		return false;
+	}
+
+	// The range can span one more cell than it covers whole cells, because
+	// it need not start on a cell boundary. The +1 is slack for movement.
+	int reach = int((sqrtf(limit_range) + SOUND_CELL_SIZE) / SOUND_CELL_SIZE) + 1;
+	int cellx = SoundCell(pos.X);
+	int cellz = SoundCell(pos.Z);
+
+	for (chan = SfxChannels[id], count = 0; chan != NULL && count < near_limit; chan = chan->NextSfxChan)
 	{
-		if (!(chan->ChanFlags & CHAN_EVICTED) && &S_sfx[chan->SoundID] == sfx)
+		if (!(chan->ChanFlags & CHAN_EVICTED))
 		{
 			FVector3 chanorigin;
 
@@ -1419,6 +1572,12 @@ bool S_CheckSoundLimit(sfxinfo_t *sfx, const FVector3 &pos, int near_limit, floa
 				return false;
 			}
 
+			if ((chan->ChanFlags & CHAN_IS3D) &&
+				(abs(SoundCell(chan->LastPos.X) - cellx) > reach || abs(SoundCell(chan->LastPos.Z) - cellz) > reach))
+			{
+				continue;
+			}
+
 			CalcPosVel(chan, &chanorigin, NULL);
 			if ((chanorigin - pos).LengthSquared() <= limit_range)
 			{
@@ -1920,12 +2079,25 @@ void S_UpdateSounds (AActor *listenactor)
 	// should never happen
 	S_SetListener(listener, listenactor);
 
+	// Channel parameters are relative to the listener, so they all need
+	// to be refreshed if it moved. Otherwise only moving sources do.
+	bool listenermoved = listener.valid != LastListenerValid ||
+		listener.position != LastListenerPos || listener.angle != LastListenerAngle;
+	LastListenerValid = listener.valid;
+	LastListenerPos = listener.position;
+	LastListenerAngle = listener.angle;
+
 	for (FSoundChan *chan = Channels; chan != NULL; chan = chan->NextChan)
 	{
 		if ((chan->ChanFlags & (CHAN_EVICTED | CHAN_IS3D)) == CHAN_IS3D)
 		{
 			CalcPosVel(chan, &pos, &vel);
-			GSnd->UpdateSoundParams3D(&listener, chan, !!(chan->ChanFlags & CHAN_AREA), pos, vel);
+			if (listenermoved || pos != chan->LastPos || vel != chan->LastVel)
+			{
+				GSnd->UpdateSoundParams3D(&listener, chan, !!(chan->ChanFlags & CHAN_AREA), pos, vel);
+				chan->LastPos = pos;
+				chan->LastVel = vel;
+			}
 		}
 		chan->ChanFlags &= ~CHAN_JUSTSTARTED;
 	}
@@ -2243,6 +2415,7 @@ void S_SerializeSounds(FArchive &arc)
 		{
 			chan = (FSoundChan*)S_GetChannel(NULL);
 			arc << *chan;
+			S_LinkSfxChannel(chan);
 			// Sounds always start out evicted when restored from a save.
 			chan->ChanFlags |= CHAN_EVICTED | CHAN_ABSTIME;
 		}
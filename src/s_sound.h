@@ -195,6 +195,11 @@ struct FSoundChan : public FISoundChannel
 		const FPolyObj	*Poly;		// Polyobject sound source.
 		float			 Point[3];	// Sound is not attached to any source.
 	};
+	FSoundChan	*NextSfxChan;	// Next channel playing the same sound.
+	FSoundChan	*PrevSfxChan;	// Previous channel playing the same sound.
+	bool		InSfxList;
+	FVector3	LastPos;		// Position and velocity last sent to the sound system.
+	FVector3	LastVel;
 };
 extern FSoundChan *Channels;
 
@@ -365,6 +370,7 @@ int S_AddPlayerSoundExisting (const char *playerclass, const int gender, int ref
 void S_MarkPlayerSounds (const char *playerclass);
 void S_ShrinkPlayerSoundLists ();
 void S_UnloadSound (sfxinfo_t *sfx);
+int S_ReloadSoundLump (int lumpnum);
 sfxinfo_t *S_LoadSound(sfxinfo_t *sfx);
 unsigned int S_GetMSLength(FSoundID sound);
 void S_ParseMusInfo();
@@ -23,6 +23,12 @@
 #include "templates.h"
 #include "doomstat.h"
 #include "v_text.h"
+#include "d_startupprof.h"
+#include "sc_prescan.h"
+#include "c_dispatch.h"
+#include "stats.h"
+#include "doomerrors.h"
+#include "resourcefiles/resourcefile.h"
 
 // MACROS ------------------------------------------------------------------
 
@@ -51,6 +57,8 @@
 FScanner::FScanner()
 {
 	ScriptOpen = false;
+	ParseTimer = 0;
+	Prescanned = NULL;
 }
 
 //==========================================================================
@@ -61,7 +69,7 @@ FScanner::FScanner()
 
 FScanner::~FScanner()
 {
-	// Humm... Nothing to do in here.
+	D_StartupEndParse(ParseTimer);
 }
 
 //==========================================================================
@@ -73,6 +81,8 @@ FScanner::~FScanner()
 FScanner::FScanner(const FScanner &other)
 {
 	ScriptOpen = false;
+	ParseTimer = 0;
+	Prescanned = NULL;
 	*this = other;
 }
 
@@ -85,6 +95,8 @@ FScanner::FScanner(const FScanner &other)
 FScanner::FScanner(int lumpnum)
 {
 	ScriptOpen = false;
+	ParseTimer = 0;
+	Prescanned = NULL;
 	OpenLumpNum(lumpnum);
 }
 
@@ -120,6 +132,9 @@ FScanner &FScanner::operator=(const FScanner &other)
 	CMode = other.CMode;
 	Escape = other.Escape;
 	StateMode = other.StateMode;
+	ViewMode = other.ViewMode;
+	View = other.View;
+	Prescanned = other.Prescanned;
 
 	// Copy public members
 	if (other.String == other.StringBuffer)
@@ -136,6 +151,10 @@ FScanner &FScanner::operator=(const FScanner &other)
 		BigStringBuffer = other.BigStringBuffer;
 		String = BigStringBuffer.LockBuffer();
 	}
+	if (View.Chars == other.String)
+	{
+		View.Chars = String;
+	}
 	StringLen = other.StringLen;
 	TokenType = other.TokenType;
 	Number = other.Number;
@@ -228,6 +247,12 @@ void FScanner::OpenString (const char *name, FString buffer)
 void FScanner :: OpenLumpNum (int lump)
 {
 	Close ();
+	Prescanned = SC_GetPrescan(lump);
+	if (Prescanned != NULL)
+	{
+		ScriptBuffer = Prescanned->Script;
+	}
+	else
 	{
 		FMemLump mem = Wads.ReadLump(lump);
 		ScriptBuffer = mem.GetString();
@@ -235,6 +260,7 @@ void FScanner :: OpenLumpNum (int lump)
 	ScriptName = Wads.GetLumpFullPath(lump);
 	LumpNum = lump;
 	PrepareScript ();
+	ParseTimer = D_StartupBeginParse(lump);
 }
 
 //==========================================================================
@@ -277,6 +303,9 @@ void FScanner::PrepareScript ()
 	CMode = false;
 	Escape = true;
 	StateMode = 0;
+	ViewMode = false;
+	View.Chars = StringBuffer;
+	View.Len = 0;
 	StringBuffer[0] = '\0';
 	BigStringBuffer = "";
 }
@@ -289,6 +318,9 @@ void FScanner::PrepareScript ()
 
 void FScanner::Close ()
 {
+	D_StartupEndParse(ParseTimer);
+	ParseTimer = 0;
+	Prescanned = NULL;
 	ScriptOpen = false;
 	ScriptBuffer = "";
 	BigStringBuffer = "";
@@ -392,6 +424,23 @@ void FScanner::SetEscape (bool esc)
 	Escape = esc;
 }
 
+//==========================================================================
+//
+// FScanner :: SetViewMode
+//
+// In view mode, View holds the text and length of every token the scanner
+// returns, so ViewName can look it up without measuring it again. The
+// hash is only worked out when a name is actually wanted. String is still
+// filled in as usual, because parsers read it after UnGet and in error
+// messages.
+//
+//==========================================================================
+
+void FScanner::SetViewMode (bool view)
+{
+	ViewMode = view;
+}
+
 //==========================================================================
 //
 // FScanner :: SetStateMode
@@ -455,6 +504,17 @@ bool FScanner::ScanString (bool tokens)
 	LastGotPtr = ScriptPtr;
 	LastGotLine = Line;
 
+	if (Prescanned != NULL && !tokens && Escape && ReplayPrescan(return_val))
+	{
+		LastGotToken = false;
+		if (ViewMode)
+		{
+			View.Chars = String;
+			View.Len = StringLen;
+		}
+		return return_val;
+	}
+
 	// In case the generated scanner does not use marker, avoid compiler warnings.
 	marker;
 #include "sc_man_scanner.h"
@@ -538,7 +598,7 @@ bool FScanner::GetToken ()
 	{
 		if (TokenType == TK_NameConst)
 		{
-			Name = FName(String);
+			Name = ViewName();
 		}
 		else if (TokenType == TK_IntConst)
 		{
@@ -565,6 +625,10 @@ bool FScanner::GetToken ()
 		else if (TokenType == TK_StringConst)
 		{
 			StringLen = strbin(String);
+			if (ViewMode)
+			{
+				View.Len = StringLen;
+			}
 		}
 		return true;
 	}
@@ -872,6 +936,38 @@ bool FScanner::Compare (const char *text)
 	return (stricmp (text, String) == 0);
 }
 
+//==========================================================================
+//
+// FScanner :: ViewCompare
+//
+// Compare for view mode.
+//
+//==========================================================================
+
+bool FScanner::ViewCompare (const char *text) const
+{
+	return strnicmp (text, View.Chars, View.Len) == 0 && text[View.Len] == '\0';
+}
+
+//==========================================================================
+//
+// FScanner :: ViewName
+//
+// Returns the name for the last token. Outside of view mode, it is looked
+// up from String, so parsing code that can be called with either kind of
+// scanner can use it.
+//
+//==========================================================================
+
+FName FScanner::ViewName (bool noCreate) const
+{
+	if (!ViewMode)
+	{
+		return FName(String, noCreate);
+	}
+	return FName(View.Chars, View.Len, noCreate);
+}
+
 //==========================================================================
 //
 // FScanner :: TokenName
@@ -1000,6 +1096,7 @@ void FScanner::CheckOpen()
 //
 //==========================================================================
 int FScriptPosition::ErrorCounter;
+int FScriptPosition::WarnCounter;
 
 FScriptPosition::FScriptPosition(const FScriptPosition &other)
 {
@@ -1059,6 +1156,7 @@ void STACK_ARGS FScriptPosition::Message (int severity, const char *message, ...
 		return;
 
 	case MSG_WARNING:
+		WarnCounter++;
 		type = "warning";
 		color = TEXTCOLOR_YELLOW;
 		break;
@@ -1092,3 +1190,125 @@ void STACK_ARGS FScriptPosition::Message (int severity, const char *message, ...
 }
 
 
+
+//==========================================================================
+//
+// CCMD scannerbench
+//
+// Tokenizes all the script lumps in a file both with and without view
+// mode, looking up every identifier as a name the way parsers do.
+//
+//==========================================================================
+
+static const char *BenchLumpNames[] =
+{
+	"ANIMDEFS", "DECALDEF", "DECORATE", "FONTDEFS", "GAMEINFO", "GLDEFS",
+	"KEYCONF", "LANGUAGE", "LOCKDEFS", "MAPINFO", "MENUDEF", "SBARINFO",
+	"SNDINFO", "SNDSEQ", "TERRAIN", "TEXTURES", "ZMAPINFO", "ZSCRIPT"
+};
+
+static void BenchScript(const FString &text, const char *name, bool tokens, bool view,
+	unsigned int &count, unsigned int &namesum)
+{
+	FScanner sc;
+
+	sc.OpenString(name, text);
+	sc.SetCMode(true);
+	sc.SetViewMode(view);
+	try
+	{
+		if (tokens)
+		{
+			while (sc.GetToken())
+			{
+				if (sc.TokenType == TK_Identifier)
+				{
+					FName fname = view ? sc.ViewName() : FName(sc.String);
+					namesum += fname.GetIndex();
+				}
+				count++;
+			}
+		}
+		else
+		{
+			while (sc.GetString())
+			{
+				FName fname = view ? sc.ViewName() : FName(sc.String);
+				namesum += fname.GetIndex();
+				count++;
+			}
+		}
+	}
+	catch (CRecoverableError &)
+	{
+		// Not everything in the list is necessarily valid in C mode, so
+		// just stop there. Both runs stop at the same place.
+	}
+}
+
+CCMD (scannerbench)
+{
+	if (argv.argc() < 2)
+	{
+		Printf ("Usage: scannerbench <file> [passes]\n");
+		return;
+	}
+
+	FResourceFile *resfile = FResourceFile::OpenResourceFile(argv[1], NULL, true);
+	if (resfile == NULL)
+	{
+		Printf ("Could not open %s\n", argv[1]);
+		return;
+	}
+
+	int passes = argv.argc() > 2 ? MAX(1, atoi(argv[2])) : 5;
+	TArray<FString> scripts;
+	TArray<FString> names;
+	size_t bytes = 0;
+
+	for (DWORD i = 0; i < resfile->LumpCount(); ++i)
+	{
+		FResourceLump *lump = resfile->GetLump(i);
+		for (size_t j = 0; j < countof(BenchLumpNames); ++j)
+		{
+			if (stricmp(lump->Name, BenchLumpNames[j]) == 0)
+			{
+				const char *data = (const char *)lump->CacheLump();
+				scripts.Push(FString(data, lump->LumpSize));
+				names.Push(lump->FullName.IsNotEmpty() ? lump->FullName : FString(lump->Name));
+				bytes += lump->LumpSize;
+				lump->ReleaseCache();
+				break;
+			}
+		}
+	}
+	delete resfile;
+
+	Printf ("%u script lumps, %.1f KB, %d passes\n", scripts.Size(), bytes / 1024., passes);
+	for (int tokens = 1; tokens >= 0; --tokens)
+	{
+		double ms[2];
+		unsigned int counts[2], namesums[2];
+
+		for (int view = 0; view < 2; ++view)
+		{
+			cycle_t timer;
+			timer.Reset();
+			counts[view] = namesums[view] = 0;
+			for (int pass = 0; pass < passes; ++pass)
+			{
+				timer.Clock();
+				for (unsigned i = 0; i < scripts.Size(); ++i)
+				{
+					BenchScript(scripts[i], names[i], !!tokens, !!view, counts[view], namesums[view]);
+				}
+				timer.Unclock();
+			}
+			ms[view] = timer.TimeMS() / passes;
+		}
+		Printf ("%s: %u tokens, copied %.2f ms, viewed %.2f ms (%.1f MB/s)%s\n",
+			tokens ? "GetToken" : "GetString", counts[0] / passes, ms[0], ms[1],
+			ms[1] > 0 ? bytes / 1048.576 / ms[1] : 0.,
+			counts[0] != counts[1] || namesums[0] != namesums[1] ? TEXTCOLOR_RED " MISMATCH" : "");
+	}
+}
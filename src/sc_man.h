@@ -1,6 +1,8 @@
 #ifndef __SC_MAN_H__
 #define __SC_MAN_H__
 
+struct FPrescannedScript;
+
 class FScanner
 {
 public:
@@ -10,6 +12,13 @@ public:
 		int SavedScriptLine;
 	};
 
+	// The text and length of the last token.
+	struct TokenView
+	{
+		const char *Chars;
+		int Len;
+	};
+
 	// Methods ------------------------------------------------------
 	FScanner();
 	FScanner(const FScanner &other);
@@ -28,6 +37,7 @@ public:
 	void SetCMode(bool cmode);
 	void SetEscape(bool esc);
 	void SetStateMode(bool stately);
+	void SetViewMode(bool view);
 	const SavedPos SavePos();
 	void RestorePos(const SavedPos &pos);
 
@@ -56,6 +66,8 @@ public:
 	void UnGet();
 
 	bool Compare(const char *text);
+	bool ViewCompare(const char *text) const;
+	FName ViewName(bool noCreate = false) const;
 	int MatchString(const char * const *strings, size_t stride = sizeof(char*));
 	int MustMatchString(const char * const *strings, size_t stride = sizeof(char*));
 	int GetMessageLine();
@@ -65,6 +77,9 @@ public:
 
 	bool isText();
 
+	// Records every GetString result for the script; see sc_prescan.cpp.
+	void PrescanTokens(FPrescannedScript &out, int modes);
+
 	// Members ------------------------------------------------------
 	char *String;
 	int StringLen;
@@ -77,11 +92,13 @@ public:
 	bool Crossed;
 	int LumpNum;
 	FString ScriptName;
+	TokenView View;
 
 protected:
 	void PrepareScript();
 	void CheckOpen();
 	bool ScanString(bool tokens);
+	bool ReplayPrescan(bool &result);
 
 	// Strings longer than this minus one will be dynamically allocated.
 	static const int MAX_STRING_SIZE = 128;
@@ -100,6 +117,9 @@ protected:
 	bool CMode;
 	BYTE StateMode;
 	bool Escape;
+	bool ViewMode;
+	int ParseTimer;
+	const FPrescannedScript *Prescanned;
 };
 
 enum
@@ -137,6 +157,7 @@ enum
 struct FScriptPosition
 {
 	static int ErrorCounter;
+	static int WarnCounter;
 	FString FileName;
 	int ScriptLine;
 
@@ -0,0 +1,561 @@
+/*
+** sc_prescan.cpp
+** Tokenizes definition lumps on worker threads during startup
+**
+**---------------------------------------------------------------------------
+** Copyright 2016 The ZDoom Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** The definition lumps read at startup are all tokenized through FScanner
+** with GetString, and for a given position and mode the scanner always
+** produces the same result. So the lumps are read up front and each one is
+** run through a scanner on a worker thread, recording every token. When the
+** real parser opens the lump on the main thread later, its scanner replays
+** the recorded tokens instead of scanning the text again, and only falls
+** back to scanning when it asks for something that wasn't recorded (such as
+** the other C mode, or SC_GetToken).
+**
+** Parsing itself still happens on the main thread in the usual order. The
+** parser table below declares what each one depends on; it decides the
+** order the lumps are handed to the workers in, and with -checkprescan
+** any parser that runs before one it depends on is reported. -checkprescan
+** also scans every token normally and compares it with the recorded one.
+*/
+
+// HEADER FILES ------------------------------------------------------------
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "doomtype.h"
+#include "doomerrors.h"
+#include "sc_man.h"
+#include "sc_prescan.h"
+#include "w_wad.h"
+#include "m_argv.h"
+#include "stats.h"
+#include "templates.h"
+#include "v_text.h"
+
+// TYPES -------------------------------------------------------------------
+
+enum
+{
+	PSM_Hexen	= 1,		// scanned with C mode off
+	PSM_C		= 2,		// scanned with C mode on
+};
+
+struct FPrescanParser
+{
+	const char *Name;
+	const char *Lumps[3];
+	int Modes;
+	const char *Deps[3];
+	bool Applied;
+};
+
+struct FPrescanTask
+{
+	enum EState
+	{
+		Queued,
+		Running,
+		Done
+	};
+
+	int Lump;
+	int Parser;
+	EState State;
+	FString Name;
+	FPrescannedScript Result;
+};
+
+// PRIVATE DATA DEFINITIONS ------------------------------------------------
+
+static FPrescanParser Parsers[] =
+{
+	{ "LANGUAGE",	{ "LANGUAGE" },				PSM_C,				{ NULL } },
+	{ "SNDINFO",	{ "SNDINFO" },				PSM_Hexen,			{ NULL } },
+	{ "MAPINFO",	{ "MAPINFO", "ZMAPINFO" },	PSM_Hexen|PSM_C,	{ "LANGUAGE", "SNDINFO" } },
+	{ "TEXTURES",	{ "TEXTURES" },				PSM_C,				{ NULL } },
+	{ "ANIMDEFS",	{ "ANIMDEFS" },				PSM_Hexen,			{ "TEXTURES", "SNDINFO" } },
+	{ "FONTDEFS",	{ "FONTDEFS" },				PSM_Hexen,			{ "TEXTURES" } },
+	{ "DECALDEF",	{ "DECALDEF" },				PSM_Hexen,			{ "TEXTURES" } },
+	{ "TERRAIN",	{ "TERRAIN" },				PSM_Hexen,			{ "TEXTURES", "SNDINFO" } },
+};
+
+static std::mutex PrescanLock;
+static std::condition_variable TaskDone;
+static TArray<std::thread *> Workers;
+
+static TArray<FPrescanTask *> Tasks;
+static TMap<int, FPrescanTask *> TaskMap;
+static unsigned int NextTask;
+static bool CheckPrescan;
+
+static unsigned int PrescanHits, PrescanMisses, PrescanMismatches, PrescanCancelled;
+
+// CODE --------------------------------------------------------------------
+
+//==========================================================================
+//
+// FindParser
+//
+//==========================================================================
+
+static int FindParser(const char *name)
+{
+	for (unsigned i = 0; i < countof(Parsers); ++i)
+	{
+		if (stricmp(Parsers[i].Name, name) == 0)
+		{
+			return i;
+		}
+	}
+	assert(0 && "Prescan dependency on unknown parser");
+	return -1;
+}
+
+//==========================================================================
+//
+// SortParsers
+//
+// Orders the parser table so that every parser comes after the ones it
+// depends on.
+//
+//==========================================================================
+
+static void SortParsers(TArray<int> &order)
+{
+	bool placed[countof(Parsers)] = { false };
+
+	while (order.Size() < countof(Parsers))
+	{
+		unsigned int before = order.Size();
+
+		for (unsigned i = 0; i < countof(Parsers); ++i)
+		{
+			if (placed[i]) continue;
+
+			bool ready = true;
+			for (int j = 0; j < 3 && Parsers[i].Deps[j] != NULL; ++j)
+			{
+				int dep = FindParser(Parsers[i].Deps[j]);
+				if (dep >= 0 && !placed[dep])
+				{
+					ready = false;
+					break;
+				}
+			}
+			if (ready)
+			{
+				placed[i] = true;
+				order.Push(i);
+			}
+		}
+		if (order.Size() == before)
+		{
+			assert(0 && "Prescan parser dependencies are circular");
+			break;
+		}
+	}
+}
+
+//==========================================================================
+//
+// FPrescannedScript :: Find
+//
+// Returns the token recorded for a scan starting at offset, if any.
+//
+//==========================================================================
+
+const FPrescanToken *FPrescannedScript::Find(bool cmode, int offset) const
+{
+	const TArray<FPrescanToken> &tokens = Tokens[cmode];
+	unsigned int min = 0, max = tokens.Size();
+
+	while (min < max)
+	{
+		unsigned int mid = (min + max) / 2;
+		if (tokens[mid].Start < offset)
+		{
+			min = mid + 1;
+		}
+		else
+		{
+			max = mid;
+		}
+	}
+	if (min < tokens.Size() && tokens[min].Start == offset)
+	{
+		return &tokens[min];
+	}
+	return NULL;
+}
+
+//==========================================================================
+//
+// FScanner :: PrescanTokens
+//
+// Runs through the whole script once for every requested mode, recording
+// each GetString result. A script error just ends the recording; the
+// parser will hit it again when it gets there.
+//
+//==========================================================================
+
+void FScanner::PrescanTokens(FPrescannedScript &out, int modes)
+{
+	const char *base = ScriptBuffer.GetChars();
+
+	out.Script = ScriptBuffer;
+	for (int cmode = 0; cmode < 2; ++cmode)
+	{
+		if (!(modes & (1 << cmode)))
+		{
+			continue;
+		}
+
+		TArray<FPrescanToken> &tokens = out.Tokens[cmode];
+
+		ScriptPtr = base;
+		Line = 1;
+		End = false;
+		AlreadyGot = false;
+		CMode = !!cmode;
+		Escape = true;
+		StateMode = 0;
+		try
+		{
+			bool result;
+			do
+			{
+				FPrescanToken tok;
+				int line = Line;
+
+				tok.Start = int(ScriptPtr - base);
+				result = ScanString(false);
+				tok.End = int(ScriptPtr - base);
+				tok.Lines = Line - line;
+				tok.Crossed = Crossed;
+				tok.Result = result;
+				tok.Text = out.Text.Size();
+				tok.TextLen = 0;
+				if (result && StringLen > 0)
+				{
+					tok.TextLen = StringLen;
+					memcpy(&out.Text[out.Text.Reserve(StringLen)], String, StringLen);
+				}
+				tokens.Push(tok);
+			}
+			while (result);
+		}
+		catch (CRecoverableError &)
+		{
+		}
+		tokens.ShrinkToFit();
+	}
+	out.Text.ShrinkToFit();
+}
+
+//==========================================================================
+//
+// FScanner :: ReplayPrescan
+//
+// Called by ScanString when the script has prescanned tokens. Returns false
+// if there is no token recorded for the current position, in which case
+// the text needs to be scanned normally.
+//
+//==========================================================================
+
+bool FScanner::ReplayPrescan(bool &result)
+{
+	const char *base = ScriptBuffer.GetChars();
+	const FPrescanToken *tok = Prescanned->Find(CMode, int(ScriptPtr - base));
+
+	if (tok == NULL)
+	{
+		if (Prescanned->Tokens[CMode].Size() > 0)
+		{
+			PrescanMisses++;
+		}
+		return false;
+	}
+
+	const char *text = tok->TextLen > 0 ? &Prescanned->Text[tok->Text] : "";
+
+	if (CheckPrescan)
+	{
+		const FPrescannedScript *prescanned = Prescanned;
+		int line = Line;
+
+		Prescanned = NULL;
+		result = ScanString(false);
+		Prescanned = prescanned;
+
+		if (result != tok->Result || ScriptPtr - base != tok->End ||
+			Line - line != tok->Lines || Crossed != tok->Crossed ||
+			(result && (StringLen != tok->TextLen || memcmp(String, text, StringLen) != 0)))
+		{
+			Printf(TEXTCOLOR_RED "Prescanned token does not match in %s at line %d\n", ScriptName.GetChars(), line);
+			PrescanMismatches++;
+		}
+		else
+		{
+			PrescanHits++;
+		}
+		return true;
+	}
+
+	ScriptPtr = base + tok->End;
+	Line += tok->Lines;
+	Crossed = tok->Crossed;
+	if (tok->Result)
+	{
+		StringLen = tok->TextLen;
+		if (StringLen >= MAX_STRING_SIZE)
+		{
+			BigStringBuffer = FString(text, StringLen);
+			String = BigStringBuffer.LockBuffer();
+		}
+		else
+		{
+			memcpy(StringBuffer, text, StringLen);
+			StringBuffer[StringLen] = '\0';
+			String = StringBuffer;
+		}
+	}
+	result = tok->Result;
+	PrescanHits++;
+	return true;
+}
+
+//==========================================================================
+//
+// PrescanThread
+//
+// Takes lumps off the queue until it is empty. Everything a task needs was
+// set up by the main thread, so none of it touches the lump directory.
+//
+//==========================================================================
+
+static void PrescanThread()
+{
+	std::unique_lock<std::mutex> lock(PrescanLock);
+
+	for (;;)
+	{
+		while (NextTask < Tasks.Size() && Tasks[NextTask]->State != FPrescanTask::Queued)
+		{
+			NextTask++;
+		}
+		if (NextTask >= Tasks.Size())
+		{
+			break;
+		}
+
+		FPrescanTask *task = Tasks[NextTask++];
+		task->State = FPrescanTask::Running;
+		lock.unlock();
+
+		{
+			FScanner sc;
+			sc.OpenString(task->Name, task->Result.Script);
+			sc.PrescanTokens(task->Result, Parsers[task->Parser].Modes);
+		}
+
+		lock.lock();
+		task->State = FPrescanTask::Done;
+		TaskDone.notify_all();
+	}
+}
+
+//==========================================================================
+//
+// SC_StartPrescan
+//
+//==========================================================================
+
+void SC_StartPrescan()
+{
+	SC_EndPrescan();
+
+	if (Args->CheckParm("-noprescan"))
+	{
+		return;
+	}
+	CheckPrescan = !!Args->CheckParm("-checkprescan");
+
+	TArray<int> order;
+	SortParsers(order);
+
+	for (unsigned i = 0; i < order.Size(); ++i)
+	{
+		FPrescanParser &parser = Parsers[order[i]];
+
+		parser.Applied = false;
+		for (int j = 0; j < 3 && parser.Lumps[j] != NULL; ++j)
+		{
+			int lump, lastlump = 0;
+
+			while ((lump = Wads.FindLump(parser.Lumps[j], &lastlump)) != -1)
+			{
+				FPrescanTask *task = new FPrescanTask;
+				FMemLump mem = Wads.ReadLump(lump);
+
+				task->Lump = lump;
+				task->Parser = order[i];
+				task->State = FPrescanTask::Queued;
+				task->Name = Wads.GetLumpFullPath(lump);
+				task->Result.Script = mem.GetString();
+				Tasks.Push(task);
+				TaskMap[lump] = task;
+			}
+		}
+	}
+
+	if (Tasks.Size() > 0)
+	{
+		int numthreads = clamp<int>(int(std::thread::hardware_concurrency()) - 1, 1, 4);
+		numthreads = MIN<int>(numthreads, Tasks.Size());
+
+		for (int i = 0; i < numthreads; ++i)
+		{
+			Workers.Push(new std::thread(PrescanThread));
+		}
+	}
+}
+
+//==========================================================================
+//
+// SC_GetPrescan
+//
+// If no worker has gotten to the lump yet, it is taken off the queue and
+// handed back with no tokens, so the scanner at least doesn't have to read
+// it again.
+//
+//==========================================================================
+
+const FPrescannedScript *SC_GetPrescan(int lump)
+{
+	if (Tasks.Size() == 0)
+	{
+		return NULL;
+	}
+
+	std::unique_lock<std::mutex> lock(PrescanLock);
+	FPrescanTask **ptask = TaskMap.CheckKey(lump);
+	if (ptask == NULL)
+	{
+		return NULL;
+	}
+
+	FPrescanTask *task = *ptask;
+	if (task->State == FPrescanTask::Queued)
+	{
+		task->State = FPrescanTask::Done;
+		PrescanCancelled++;
+	}
+	while (task->State != FPrescanTask::Done)
+	{
+		TaskDone.wait(lock);
+	}
+
+	FPrescanParser &parser = Parsers[task->Parser];
+	if (!parser.Applied)
+	{
+		parser.Applied = true;
+		if (CheckPrescan)
+		{
+			for (int j = 0; j < 3 && parser.Deps[j] != NULL; ++j)
+			{
+				int dep = FindParser(parser.Deps[j]);
+				if (dep < 0 || Parsers[dep].Applied)
+				{
+					continue;
+				}
+				for (unsigned i = 0; i < Tasks.Size(); ++i)
+				{
+					if (Tasks[i]->Parser == dep)
+					{
+						Printf(TEXTCOLOR_RED "%s is parsed before %s, which it depends on\n", parser.Name, Parsers[dep].Name);
+						break;
+					}
+				}
+			}
+		}
+	}
+	return &task->Result;
+}
+
+//==========================================================================
+//
+// SC_CheckingPrescan
+//
+//==========================================================================
+
+bool SC_CheckingPrescan()
+{
+	return CheckPrescan;
+}
+
+//==========================================================================
+//
+// SC_EndPrescan
+//
+//==========================================================================
+
+void SC_EndPrescan()
+{
+	{
+		// Make sure the workers don't pick up anything else.
+		std::lock_guard<std::mutex> lock(PrescanLock);
+		NextTask = Tasks.Size();
+	}
+	for (unsigned i = 0; i < Workers.Size(); ++i)
+	{
+		Workers[i]->join();
+		delete Workers[i];
+	}
+	Workers.Clear();
+
+	for (unsigned i = 0; i < Tasks.Size(); ++i)
+	{
+		delete Tasks[i];
+	}
+	Tasks.Clear();
+	TaskMap.Clear();
+	NextTask = 0;
+}
+
+ADD_STAT (prescan)
+{
+	FString out;
+	out.Format("%u lumps, %u parsed before prescanning, %u hits, %u misses, %u mismatches",
+		Tasks.Size(), PrescanCancelled, PrescanHits, PrescanMisses, PrescanMismatches);
+	return out;
+}
@@ -0,0 +1,77 @@
+/*
+** sc_prescan.h
+** Tokenizes definition lumps on worker threads during startup
+**
+**---------------------------------------------------------------------------
+** Copyright 2016 The ZDoom Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+
+#ifndef __SC_PRESCAN_H__
+#define __SC_PRESCAN_H__
+
+#include "tarray.h"
+#include "zstring.h"
+
+// The result of one FScanner::GetString call, recorded ahead of time.
+struct FPrescanToken
+{
+	int Start;			// script offset the scan started at
+	int End;			// script offset after the scan
+	int Text;			// offset of the string into FPrescannedScript::Text
+	int TextLen;
+	int Lines;			// lines crossed
+	bool Crossed;
+	bool Result;		// what GetString returned
+};
+
+struct FPrescannedScript
+{
+	FString Script;						// the script as prepared by the scanner
+	TArray<FPrescanToken> Tokens[2];	// indexed by C mode
+	TArray<char> Text;
+
+	const FPrescanToken *Find(bool cmode, int offset) const;
+};
+
+// Reads the definition lumps and starts tokenizing them in the background.
+void SC_StartPrescan();
+
+// Returns the prescanned version of a lump, waiting for it if a worker is
+// busy with it. Returns NULL if the lump should just be scanned normally.
+const FPrescannedScript *SC_GetPrescan(int lump);
+
+// True if every prescanned token should be checked against the scanner.
+bool SC_CheckingPrescan();
+
+// Stops the workers and frees everything. No scanner may still be using
+// prescanned data at this point.
+void SC_EndPrescan();
+
+#endif
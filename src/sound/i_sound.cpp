@@ -55,6 +55,7 @@ extern HINSTANCE g_hInst;
 #include "except.h"
 #include "fmodsound.h"
 #include "oalsound.h"
+#include "softsound.h"
 
 #include "mpg123_decoder.h"
 #include "sndfile_decoder.h"
@@ -289,6 +290,10 @@ void I_InitSound ()
 			}
 		#endif
 	}
+	else if(stricmp(snd_backend, "soft") == 0)
+	{
+		GSnd = new SoftSoundRenderer;
+	}
 	else if(stricmp(snd_backend, "openal") == 0)
 	{
 		#ifndef NO_OPENAL
@@ -611,6 +616,13 @@ SoundStream *SoundRenderer::OpenStream(const char *url, int flags)
 }
 
 SoundDecoder *SoundRenderer::CreateDecoder(FileReader *reader)
+{
+    return CreateSoundDecoder(reader);
+}
+
+// Also used by the sound effect cache, which decodes without going through
+// a renderer.
+SoundDecoder *CreateSoundDecoder(FileReader *reader)
 {
     SoundDecoder *decoder = NULL;
     int pos = reader->Tell();
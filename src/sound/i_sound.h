@@ -172,6 +172,7 @@ void S_ChannelEnded(FISoundChannel *schan);
 void S_ChannelVirtualChanged(FISoundChannel *schan, bool is_virtual);
 float S_GetRolloff(FRolloffInfo *rolloff, float distance, bool logarithmic);
 FISoundChannel *S_GetChannel(void *syschan);
+SoundDecoder *CreateSoundDecoder(FileReader *reader);
 
 extern ReverbContainer *DefaultEnvironments[26];
 
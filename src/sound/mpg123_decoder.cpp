@@ -4,13 +4,31 @@
 #define USE_WINDOWS_DWORD
 #endif
 
+#include <mutex>
+
 #include "mpg123_decoder.h"
 #include "files.h"
 #include "except.h"
 
 #ifdef HAVE_MPG123
+// Decoders can be opened from the sound effect decode thread as well as
+// the main thread, so the library must only be initialized once.
+static std::once_flag initflag;
 static bool inited = false;
 
+static void InitMPG123()
+{
+	__try
+	{
+		inited = (mpg123_init() == MPG123_OK);
+	}
+	__except (CheckException(GetExceptionCode()))
+	{
+		// this means that the delay loaded decoder DLL was not found.
+		inited = false;
+	}
+}
+
 
 off_t MPG123Decoder::file_lseek(void *handle, off_t offset, int whence)
 {
@@ -54,20 +72,9 @@ MPG123Decoder::~MPG123Decoder()
 
 bool MPG123Decoder::open(FileReader *reader)
 {
+    std::call_once(initflag, InitMPG123);
     if(!inited)
-    {
-		__try
-		{
-			if(mpg123_init() != MPG123_OK)
-				return false;
-			inited = true;
-		}
-		__except (CheckException(GetExceptionCode()))
-		{
-			// this means that the delay loaded decoder DLL was not found.
-			return false;
-		}
-    }
+        return false;
 
     Reader = reader;
     StartOffset = 0;
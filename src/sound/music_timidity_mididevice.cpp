@@ -41,6 +41,8 @@
 #include "w_wad.h"
 #include "v_text.h"
 #include "timidity/timidity.h"
+#include "c_dispatch.h"
+#include "stats.h"
 #include <errno.h>
 
 // MACROS ------------------------------------------------------------------
@@ -338,7 +340,11 @@ TimidityWaveWriterMIDIDevice::~TimidityWaveWriterMIDIDevice()
 int TimidityWaveWriterMIDIDevice::Resume()
 {
 	float writebuffer[4096];
+	QWORD frames = 0;
+	cycle_t timer;
 
+	timer.Reset();
+	timer.Clock();
 	while (ServiceStream(writebuffer, sizeof(writebuffer)))
 	{
 		if (fwrite(writebuffer, sizeof(writebuffer), 1, File) != 1)
@@ -346,7 +352,18 @@ int TimidityWaveWriterMIDIDevice::Resume()
 			Printf("Could not write entire wave file: %s\n", strerror(errno));
 			return 1;
 		}
+		frames += sizeof(writebuffer) / (sizeof(float) * 2);
 	}
+	timer.Unclock();
+
+	double ms = timer.TimeMS();
+	Printf("Rendered %.2f seconds of audio in %.2f ms", frames / Renderer->rate, ms);
+	if (ms > 0)
+	{
+		Printf(" (%.0fx realtime, %.2f million voice samples/sec)",
+			frames / Renderer->rate * 1000 / ms, Renderer->voice_samples / (ms * 1000));
+	}
+	Printf("\n");
 	return 0;
 }
 
@@ -359,3 +376,68 @@ int TimidityWaveWriterMIDIDevice::Resume()
 void TimidityWaveWriterMIDIDevice::Stop()
 {
 }
+
+//==========================================================================
+//
+// CCMD timiditybench
+//
+// Renders a MIDI song through the internal TiMidity synth as fast as
+// possible, discarding the output, and reports how long it took.
+//
+//==========================================================================
+
+CCMD (timiditybench)
+{
+	if (argv.argc() != 2)
+	{
+		Printf("Usage: timiditybench <lump or file>\n");
+		return;
+	}
+
+	FileReader *reader;
+	int lumpnum = Wads.CheckNumForFullName(argv[1], true, ns_music);
+	if (lumpnum >= 0)
+	{
+		reader = Wads.ReopenLumpNumNewFile(lumpnum);
+	}
+	else
+	{
+		reader = new FileReader;
+		if (!reader->Open(argv[1]))
+		{
+			delete reader;
+			reader = NULL;
+		}
+	}
+	if (reader == NULL)
+	{
+		Printf("Could not open %s\n", argv[1]);
+		return;
+	}
+
+	MidiDeviceSetting device;
+	device.device = MDEV_GUS;
+	MusInfo *song = I_RegisterSong(reader, &device);
+	MusInfo *bench = NULL;
+	if (song != NULL && song->IsMIDI())
+	{
+#ifdef _WIN32
+		bench = song->GetWaveDumper("NUL", 0);
+#else
+		bench = song->GetWaveDumper("/dev/null", 0);
+#endif
+	}
+	if (bench == NULL)
+	{
+		Printf("%s is not a MIDI song\n", argv[1]);
+	}
+	else
+	{
+		bench->Play(false, 0);
+		delete bench;
+	}
+	if (song != NULL)
+	{
+		delete song;
+	}
+}
@@ -0,0 +1,2045 @@
+/*
+** softsound.cpp
+** Software sound effects mixer
+**
+**---------------------------------------------------------------------------
+** Copyright 2016 The ZDoom Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** This backend does all of its mixing itself and only needs somewhere to
+** put the result, so it works anywhere a sink can be provided: an SDL
+** audio device, a wave file, or nothing at all (for benchmarking).
+*/
+
+// HEADER FILES ------------------------------------------------------------
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define USE_WINDOWS_DWORD
+#endif
+
+#include <stdio.h>
+#include <errno.h>
+#include <math.h>
+
+#include "doomtype.h"
+#include "doomdef.h"
+#include "softsound.h"
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "i_system.h"
+#include "m_swap.h"
+#include "files.h"
+#include "templates.h"
+#include "v_text.h"
+#include "x86.h"
+#include "xs_Float.h"
+
+#ifdef HAVE_SDL_AUDIO
+#include "SDL.h"
+#endif
+
+// MACROS ------------------------------------------------------------------
+
+#define AREA_SOUND_RADIUS	(128.f)
+#define PITCH_MULT			(0.7937005f)	/* Approx. 4 semitones lower, same as the other backends */
+#define PITCH(pitch)		(snd_pitched ? (pitch)/128.f : 1.f)
+
+#define FRACBITS_SND		32
+#define FRACUNIT_SND		((QWORD)1 << FRACBITS_SND)
+
+// TYPES -------------------------------------------------------------------
+
+struct SoftSample
+{
+	TArray<float> Data;		// Interleaved, with one extra frame of padding
+	TArray<BYTE> Compressed;	// Long sounds are kept encoded and streamed instead
+	int StreamFlags;		// SoundStream format of the decoder's output
+	int Channels;
+	int Rate;
+	unsigned int Frames;
+	unsigned int LoopStart;
+	unsigned int LoopEnd;
+};
+
+struct SoftChannel
+{
+	SoftSample *Sample;
+	FISoundChannel *Chan;	// NULL once the game has let go of this channel
+	QWORD Pos;				// 32.32 fixed point frame position
+	QWORD Step;
+	float Pitch;
+	float Volume;
+	float Attenuation;
+	float Pan;				// -1 is hard left, 1 is hard right
+	float Gain[2];			// Gain to reach by the end of the next block
+	float CurGain[2];		// Gain at the start of the next block
+	bool Looping;
+	bool Pausable;
+	bool Reverb;
+	bool Deferred;			// Waiting on Sync(false)
+	bool Ended;				// Mixer reached the end; the game hasn't been told yet
+
+	// Streamed samples only. Each channel decodes the sample on its own.
+	FileReader *Reader;
+	SoundDecoder *Decoder;
+	TArray<BYTE> Raw;
+	TArray<float> Buffer;	// First frame is carried over from the previous buffer
+	unsigned int BufferFrames;
+	QWORD Played;			// 32.32 fixed point frames played, for GetPosition
+};
+
+struct FmtChunk16
+{
+	DWORD ChunkID;
+	DWORD ChunkLen;
+	WORD  FormatTag;
+	WORD  Channels;
+	DWORD SamplesPerSec;
+	DWORD AvgBytesPerSec;
+	WORD  BlockAlign;
+	WORD  BitsPerSample;
+};
+
+class SoftNullSink : public SoftSoundSink
+{
+public:
+	SoftNullSink(int rate, int frames) : Rate(rate), Frames(frames) {}
+	bool IsValid() { return true; }
+	bool IsPull() { return false; }
+	int GetSampleRate() { return Rate; }
+	int GetBlockFrames() { return Frames; }
+	const char *GetName() { return "null"; }
+
+protected:
+	int Rate, Frames;
+};
+
+class SoftWaveSink : public SoftNullSink
+{
+public:
+	SoftWaveSink(const char *filename, int rate, int frames);
+	~SoftWaveSink();
+	bool IsValid() { return File != NULL; }
+	const char *GetName() { return "wave"; }
+	void Write(const float *buffer, int frames);
+
+protected:
+	FILE *File;
+	TArray<SWORD> Conv;
+};
+
+#ifdef HAVE_SDL_AUDIO
+class SoftSDLSink : public SoftSoundSink
+{
+public:
+	SoftSDLSink(int rate, int frames);
+	~SoftSDLSink();
+	bool IsValid() { return Device != 0; }
+	bool IsPull() { return true; }
+	int GetSampleRate() { return Spec.freq; }
+	int GetBlockFrames() { return Spec.samples; }
+	const char *GetName() { return "SDL"; }
+	void Start(SoftSoundRenderer *renderer);
+	void Stop();
+
+protected:
+	static void SDLCALL Callback(void *userdata, Uint8 *stream, int len);
+
+	SDL_AudioDeviceID Device;
+	SDL_AudioSpec Spec;
+	SoftSoundRenderer *Renderer;
+};
+#endif
+
+class SoftSoundStream : public SoundStream
+{
+public:
+	SoftSoundStream(SoftSoundRenderer *renderer, SoundStreamCallback callback, int buffbytes, int flags, int samplerate, void *userdata);
+	SoftSoundStream(SoftSoundRenderer *renderer, FileReader *reader, SoundDecoder *decoder, int flags);
+	~SoftSoundStream();
+
+	bool Play(bool looping, float volume);
+	void Stop();
+	void SetVolume(float volume);
+	bool SetPaused(bool paused);
+	unsigned int GetPosition();
+	bool IsEnded();
+	bool SetPosition(unsigned int ms_pos);
+	FString GetStats();
+
+	bool Refill();
+
+	SoftSoundRenderer *Renderer;
+	SoundStreamCallback Callback;
+	void *UserData;
+	FileReader *Reader;
+	SoundDecoder *Decoder;
+
+	int Rate;
+	int Channels;
+	int Flags;
+	TArray<BYTE> Raw;
+	TArray<float> Data;		// First frame is carried over from the previous buffer
+	unsigned int DataFrames;
+	QWORD Pos;
+	QWORD Step;
+	QWORD FramesPlayed;
+	float Volume;
+	float CurGain;
+	bool Playing;
+	bool Paused;
+	bool Ended;
+	bool Looping;
+
+private:
+	void Init(int buffbytes);
+};
+
+// EXTERNAL FUNCTION PROTOTYPES --------------------------------------------
+
+// PUBLIC FUNCTION PROTOTYPES ----------------------------------------------
+
+// PRIVATE FUNCTION PROTOTYPES ---------------------------------------------
+
+// EXTERNAL DATA DECLARATIONS ----------------------------------------------
+
+EXTERN_CVAR (Int, snd_channels)
+EXTERN_CVAR (Int, snd_samplerate)
+EXTERN_CVAR (Int, snd_buffersize)
+EXTERN_CVAR (Bool, snd_waterreverb)
+EXTERN_CVAR (Bool, snd_pitched)
+EXTERN_CVAR (Float, snd_streamsfx)
+
+// PUBLIC DATA DEFINITIONS -------------------------------------------------
+
+// "device" uses the platform's audio output when there is one, "wave"
+// records everything to snd_softwavefile, and "null" mixes into nothing.
+CVAR (String, snd_softsink, "device", CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+CVAR (String, snd_softwavefile, "softsound.wav", CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
+// PRIVATE DATA DEFINITIONS ------------------------------------------------
+
+// CODE --------------------------------------------------------------------
+
+//==========================================================================
+//
+// ConvertToFloat
+//
+// Converts samples in one of the SoundStream formats to floats.
+//
+//==========================================================================
+
+static void ConvertToFloat(float *out, const BYTE *in, int samples, int flags)
+{
+	if (flags & SoundStream::Float)
+	{
+		memcpy(out, in, samples * sizeof(float));
+	}
+	else if (flags & SoundStream::Bits32)
+	{
+		const int *in32 = (const int *)in;
+		for (int i = 0; i < samples; ++i)
+		{
+			out[i] = in32[i] * (1.f / 2147483648.f);
+		}
+	}
+	else if (flags & SoundStream::Bits8)
+	{
+		for (int i = 0; i < samples; ++i)
+		{
+			out[i] = (in[i] - 128) * (1.f / 128.f);
+		}
+	}
+	else
+	{
+		const SWORD *in16 = (const SWORD *)in;
+		for (int i = 0; i < samples; ++i)
+		{
+			out[i] = in16[i] * (1.f / 32768.f);
+		}
+	}
+}
+
+//==========================================================================
+//
+// FrameBytes
+//
+//==========================================================================
+
+static unsigned int FrameBytes(int channels, int flags)
+{
+	return channels * ((flags & SoundStream::Bits8) ? 1 : (flags & (SoundStream::Bits32|SoundStream::Float)) ? 4 : 2);
+}
+
+//==========================================================================
+//
+// ReadDecoder
+//
+// Fills raw from the decoder, going back to the start for looping sounds.
+// Returns the number of bytes read.
+//
+//==========================================================================
+
+static size_t ReadDecoder(SoundDecoder *decoder, TArray<BYTE> &raw, bool looping)
+{
+	size_t got = decoder->read((char *)&raw[0], raw.Size());
+	while (got < raw.Size() && looping && decoder->seek(0))
+	{
+		size_t more = decoder->read((char *)&raw[got], raw.Size() - got);
+		if (more == 0) break;
+		got += more;
+	}
+	return got;
+}
+
+//==========================================================================
+//
+// AppendFrames
+//
+// Replaces a stream buffer with the next frames read from its source. The
+// last frame of the old buffer is kept in front so interpolation carries
+// across the seam, and pos is moved back to match.
+//
+//==========================================================================
+
+static void AppendFrames(TArray<float> &data, unsigned int &dataframes, QWORD &pos,
+	const BYTE *raw, unsigned int frames, int channels, int flags)
+{
+	pos -= QWORD(dataframes - 1) << FRACBITS_SND;
+	memmove(&data[0], &data[(dataframes - 1) * channels], channels * sizeof(float));
+	data.Resize((frames + 1) * channels);
+	ConvertToFloat(&data[channels], raw, frames * channels, flags);
+	dataframes = frames + 1;
+}
+
+//==========================================================================
+//
+// Resample
+//
+// Linearly interpolates count frames from src, starting at the 32.32
+// fixed point frame position pos. src must have a valid frame after the
+// last one touched.
+//
+//==========================================================================
+
+static void Resample(float *out, const float *src, int channels, QWORD pos, QWORD step, int count)
+{
+	const float scale = 1.f / 4294967296.f;
+
+	if (channels == 1)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			const float *s = src + (size_t)(pos >> FRACBITS_SND);
+			float frac = (DWORD)pos * scale;
+			out[i] = s[0] + (s[1] - s[0]) * frac;
+			pos += step;
+		}
+	}
+	else
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			const float *s = src + (size_t)(pos >> FRACBITS_SND) * 2;
+			float frac = (DWORD)pos * scale;
+			out[i*2+0] = s[0] + (s[2] - s[0]) * frac;
+			out[i*2+1] = s[1] + (s[3] - s[1]) * frac;
+			pos += step;
+		}
+	}
+}
+
+//==========================================================================
+//
+// MixRamp
+//
+// Adds count frames of mono or stereo input to the stereo output while
+// sliding the gains linearly from (gl,gr) by (dl,dr) per frame.
+//
+//==========================================================================
+
+static void MixRamp(float *out, const float *in, int channels, int count, float gl, float gr, float dl, float dr)
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__i386__) || defined(__amd64__)
+#if !defined(__SSE2__) && !defined(_M_X64)
+	if (CPU.bSSE2)
+#endif
+	{
+		if (channels == 1)
+			SoftMixMono_SSE2(out, in, count, gl, gr, dl, dr);
+		else
+			SoftMixStereo_SSE2(out, in, count, gl, gr, dl, dr);
+		return;
+	}
+#endif
+	if (channels == 1)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			out[i*2+0] += in[i] * gl;
+			out[i*2+1] += in[i] * gr;
+			gl += dl;
+			gr += dr;
+		}
+	}
+	else
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			out[i*2+0] += in[i*2+0] * gl;
+			out[i*2+1] += in[i*2+1] * gr;
+			gl += dl;
+			gr += dr;
+		}
+	}
+}
+
+//==========================================================================
+//
+// SoftWaveSink Constructor
+//
+// Records the mixer output as a 16-bit stereo wave file.
+//
+//==========================================================================
+
+SoftWaveSink::SoftWaveSink(const char *filename, int rate, int frames)
+	: SoftNullSink(rate, frames)
+{
+	File = fopen(filename, "wb");
+	if (File != NULL)
+	{ // Write wave header
+		DWORD work[3];
+		FmtChunk16 fmt;
+
+		work[0] = MAKE_ID('R','I','F','F');
+		work[1] = 0;								// filled in later
+		work[2] = MAKE_ID('W','A','V','E');
+		if (3 != fwrite(work, 4, 3, File)) goto fail;
+
+		fmt.ChunkID = MAKE_ID('f','m','t',' ');
+		fmt.ChunkLen = LittleLong(DWORD(sizeof(fmt) - 8));
+		fmt.FormatTag = LittleShort(1);				// WAVE_FORMAT_PCM
+		fmt.Channels = LittleShort(2);
+		fmt.SamplesPerSec = LittleLong(rate);
+		fmt.AvgBytesPerSec = LittleLong(rate * 4);
+		fmt.BlockAlign = LittleShort(4);
+		fmt.BitsPerSample = LittleShort(16);
+		if (1 != fwrite(&fmt, sizeof(fmt), 1, File)) goto fail;
+
+		work[0] = MAKE_ID('d','a','t','a');
+		work[1] = 0;								// filled in later
+		if (2 != fwrite(work, 4, 2, File)) goto fail;
+
+		return;
+fail:
+		Printf("Failed to write %s: %s\n", filename, strerror(errno));
+		fclose(File);
+		File = NULL;
+	}
+	else
+	{
+		Printf("Could not open %s: %s\n", filename, strerror(errno));
+	}
+}
+
+//==========================================================================
+//
+// SoftWaveSink Destructor
+//
+// Fills in the chunk sizes that were left blank.
+//
+//==========================================================================
+
+SoftWaveSink::~SoftWaveSink()
+{
+	if (File != NULL)
+	{
+		long pos = ftell(File);
+		DWORD size;
+
+		size = LittleLong(DWORD(pos - 8));
+		if (0 == fseek(File, 4, SEEK_SET) && 1 == fwrite(&size, 4, 1, File))
+		{
+			size = LittleLong(DWORD(pos - 12 - sizeof(FmtChunk16) - 8));
+			if (0 == fseek(File, 12 + sizeof(FmtChunk16) + 4, SEEK_SET) && 1 == fwrite(&size, 4, 1, File))
+			{
+				fclose(File);
+				return;
+			}
+		}
+		Printf("Could not finish writing wave file: %s\n", strerror(errno));
+		fclose(File);
+	}
+}
+
+//==========================================================================
+//
+// SoftWaveSink :: Write
+//
+//==========================================================================
+
+void SoftWaveSink::Write(const float *buffer, int frames)
+{
+	Conv.Resize(frames * 2);
+	for (int i = 0; i < frames * 2; ++i)
+	{
+		int samp = xs_RoundToInt(buffer[i] * 32767.f);
+		Conv[i] = LittleShort((SWORD)clamp(samp, -32768, 32767));
+	}
+	if (frames > 0 && fwrite(&Conv[0], 4, frames, File) != (size_t)frames)
+	{
+		Printf("Failed to write wave data: %s\n", strerror(errno));
+	}
+}
+
+#ifdef HAVE_SDL_AUDIO
+//==========================================================================
+//
+// SoftSDLSink Constructor
+//
+//==========================================================================
+
+SoftSDLSink::SoftSDLSink(int rate, int frames)
+{
+	SDL_AudioSpec want;
+
+	Device = 0;
+	Renderer = NULL;
+	if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0)
+	{
+		Printf(TEXTCOLOR_RED" Could not initialize SDL audio: %s\n", SDL_GetError());
+		return;
+	}
+	memset(&want, 0, sizeof(want));
+	want.freq = rate;
+	want.format = AUDIO_F32SYS;
+	want.channels = 2;
+	want.samples = frames;
+	want.callback = Callback;
+	want.userdata = this;
+	Device = SDL_OpenAudioDevice(NULL, 0, &want, &Spec, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+	if (Device == 0)
+	{
+		Printf(TEXTCOLOR_RED" Could not open audio device: %s\n", SDL_GetError());
+		SDL_QuitSubSystem(SDL_INIT_AUDIO);
+	}
+}
+
+//==========================================================================
+//
+// SoftSDLSink Destructor
+//
+//==========================================================================
+
+SoftSDLSink::~SoftSDLSink()
+{
+	if (Device != 0)
+	{
+		SDL_CloseAudioDevice(Device);
+		SDL_QuitSubSystem(SDL_INIT_AUDIO);
+	}
+}
+
+//==========================================================================
+//
+// SoftSDLSink :: Start
+//
+// The device is opened paused and plays silence until it has a renderer
+// to pull from.
+//
+//==========================================================================
+
+void SoftSDLSink::Start(SoftSoundRenderer *renderer)
+{
+	SDL_LockAudioDevice(Device);
+	Renderer = renderer;
+	SDL_UnlockAudioDevice(Device);
+	SDL_PauseAudioDevice(Device, 0);
+}
+
+//==========================================================================
+//
+// SoftSDLSink :: Stop
+//
+//==========================================================================
+
+void SoftSDLSink::Stop()
+{
+	SDL_PauseAudioDevice(Device, 1);
+	SDL_LockAudioDevice(Device);
+	Renderer = NULL;
+	SDL_UnlockAudioDevice(Device);
+}
+
+//==========================================================================
+//
+// SoftSDLSink :: Callback												static
+//
+//==========================================================================
+
+void SDLCALL SoftSDLSink::Callback(void *userdata, Uint8 *stream, int len)
+{
+	SoftSDLSink *self = (SoftSDLSink *)userdata;
+	if (self->Renderer != NULL)
+	{
+		self->Renderer->Mix((float *)stream, len / (2 * sizeof(float)));
+	}
+	else
+	{
+		memset(stream, 0, len);
+	}
+}
+#endif
+
+//==========================================================================
+//
+// SoftSoundStream Constructor
+//
+// For streams fed by a callback.
+//
+//==========================================================================
+
+SoftSoundStream::SoftSoundStream(SoftSoundRenderer *renderer, SoundStreamCallback callback,
+	int buffbytes, int flags, int samplerate, void *userdata)
+	: Renderer(renderer), Callback(callback), UserData(userdata), Reader(NULL), Decoder(NULL)
+{
+	Rate = samplerate;
+	Flags = flags;
+	Channels = (flags & Mono) ? 1 : 2;
+	Looping = false;
+	Init(buffbytes);
+}
+
+//==========================================================================
+//
+// SoftSoundStream Constructor
+//
+// For streams read from a decoder. The stream takes ownership of both the
+// reader and the decoder.
+//
+//==========================================================================
+
+SoftSoundStream::SoftSoundStream(SoftSoundRenderer *renderer, FileReader *reader, SoundDecoder *decoder, int flags)
+	: Renderer(renderer), Callback(NULL), UserData(NULL), Reader(reader), Decoder(decoder)
+{
+	ChannelConfig chans;
+	SampleType type;
+
+	decoder->getInfo(&Rate, &chans, &type);
+	Channels = (chans == ChannelConfig_Mono) ? 1 : 2;
+	Flags = (Channels == 1 ? Mono : 0) | (type == SampleType_UInt8 ? Bits8 : 0);
+	Looping = !!(flags & Loop);
+	Init(Rate / 10 * Channels * ((Flags & Bits8) ? 1 : 2));
+}
+
+//==========================================================================
+//
+// SoftSoundStream :: Init
+//
+//==========================================================================
+
+void SoftSoundStream::Init(int buffbytes)
+{
+	Raw.Resize(buffbytes);
+	// Start with one frame of silence to interpolate from.
+	Data.Resize(Channels);
+	for (int i = 0; i < Channels; ++i)
+	{
+		Data[i] = 0;
+	}
+	DataFrames = 1;
+	Pos = FRACUNIT_SND;
+	Step = (QWORD)((double)Rate / Renderer->SampleRate * FRACUNIT_SND);
+	FramesPlayed = 0;
+	Volume = 1;
+	CurGain = 0;
+	Playing = false;
+	Paused = false;
+	Ended = false;
+}
+
+//==========================================================================
+//
+// SoftSoundStream Destructor
+//
+//==========================================================================
+
+SoftSoundStream::~SoftSoundStream()
+{
+	Stop();
+	if (Decoder != NULL) delete Decoder;
+	if (Reader != NULL) delete Reader;
+}
+
+//==========================================================================
+//
+// SoftSoundStream :: Play
+//
+//==========================================================================
+
+bool SoftSoundStream::Play(bool looping, float volume)
+{
+	Renderer->MixLock.Enter();
+	Looping = Looping || looping;
+	Volume = volume;
+	Paused = false;
+	if (!Playing)
+	{
+		Playing = true;
+		Renderer->Streams.Push(this);
+	}
+	Renderer->MixLock.Leave();
+	return true;
+}
+
+//==========================================================================
+//
+// SoftSoundStream :: Stop
+//
+//==========================================================================
+
+void SoftSoundStream::Stop()
+{
+	Renderer->MixLock.Enter();
+	if (Playing)
+	{
+		Playing = false;
+		Renderer->Streams.Delete(Renderer->Streams.Find(this));
+	}
+	Renderer->MixLock.Leave();
+}
+
+//==========================================================================
+//
+// SoftSoundStream :: SetVolume
+//
+//==========================================================================
+
+void SoftSoundStream::SetVolume(float volume)
+{
+	Volume = volume;
+}
+
+//==========================================================================
+//
+// SoftSoundStream :: SetPaused
+//
+//==========================================================================
+
+bool SoftSoundStream::SetPaused(bool paused)
+{
+	Paused = paused;
+	return true;
+}
+
+//==========================================================================
+//
+// SoftSoundStream :: GetPosition
+//
+// Returns the position in milliseconds.
+//
+//==========================================================================
+
+unsigned int SoftSoundStream::GetPosition()
+{
+	if (Decoder != NULL)
+	{
+		return unsigned(QWORD(Decoder->getSampleOffset()) * 1000 / Rate);
+	}
+	return unsigned(FramesPlayed * 1000 / Rate);
+}
+
+//==========================================================================
+//
+// SoftSoundStream :: IsEnded
+//
+//==========================================================================
+
+bool SoftSoundStream::IsEnded()
+{
+	return !Playing || Ended;
+}
+
+//==========================================================================
+//
+// SoftSoundStream :: SetPosition
+//
+//==========================================================================
+
+bool SoftSoundStream::SetPosition(unsigned int ms_pos)
+{
+	if (Decoder == NULL)
+	{
+		return false;
+	}
+	Renderer->MixLock.Enter();
+	bool ok = Decoder->seek(ms_pos);
+	if (ok)
+	{
+		DataFrames = 1;
+		Pos = FRACUNIT_SND;
+		Ended = false;
+	}
+	Renderer->MixLock.Leave();
+	return ok;
+}
+
+//==========================================================================
+//
+// SoftSoundStream :: GetStats
+//
+//==========================================================================
+
+FString SoftSoundStream::GetStats()
+{
+	FString stats;
+	stats.Format("%d Hz %s, %s, volume " TEXTCOLOR_YELLOW "%.0f%%",
+		Rate, Channels == 1 ? "mono" : "stereo",
+		Ended ? "ended" : Paused ? "paused" : Playing ? "playing" : "stopped",
+		Volume * 100);
+	return stats;
+}
+
+//==========================================================================
+//
+// SoftSoundStream :: Refill
+//
+// Fetches the next buffer from the source. Called with the mix lock held.
+//
+//==========================================================================
+
+bool SoftSoundStream::Refill()
+{
+	size_t got;
+
+	if (Decoder != NULL)
+	{
+		got = ReadDecoder(Decoder, Raw, Looping);
+	}
+	else
+	{
+		got = Callback(this, &Raw[0], Raw.Size(), UserData) ? Raw.Size() : 0;
+	}
+	unsigned int frames = unsigned(got / FrameBytes(Channels, Flags));
+	if (frames == 0)
+	{
+		Ended = true;
+		return false;
+	}
+	AppendFrames(Data, DataFrames, Pos, &Raw[0], frames, Channels, Flags);
+	return true;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer Constructor
+//
+//==========================================================================
+
+SoftSoundRenderer::SoftSoundRenderer()
+{
+	int rate = snd_samplerate > 0 ? *snd_samplerate : 44100;
+	int frames = snd_buffersize > 0 ? MAX(64, snd_buffersize * rate / 1000) : 512;
+
+	Printf("I_InitSound: Initializing software mixer\n");
+
+	Sink = NULL;
+	if (stricmp(snd_softsink, "wave") == 0)
+	{
+		Sink = new SoftWaveSink(snd_softwavefile, rate, frames);
+	}
+	else if (stricmp(snd_softsink, "null") == 0)
+	{
+		Sink = new SoftNullSink(rate, frames);
+	}
+	else
+	{
+#ifdef HAVE_SDL_AUDIO
+		Sink = new SoftSDLSink(rate, frames);
+#else
+		Printf(TEXTCOLOR_ORANGE" No audio device output on this platform. Mixing to nowhere.\n");
+		Sink = new SoftNullSink(rate, frames);
+#endif
+	}
+	if (!Sink->IsValid())
+	{
+		delete Sink;
+		Sink = NULL;
+		return;
+	}
+
+	SampleRate = Sink->GetSampleRate();
+	BlockFrames = Sink->GetBlockFrames();
+	SfxVolume = 1;
+	MusicVolume = 1;
+	SFXPaused = 0;
+	Inactive = INACTIVE_Active;
+	Syncing = false;
+	WasInWater = false;
+	ActiveCount = 0;
+	MixedFrames = 0;
+	PushStartTime = I_MSTime();
+	PushedFrames = 0;
+	BlockTimeSum = BlockTimeMax = 0;
+	BlockCount = 0;
+	StatAvgMS = StatMaxMS = 0;
+	StatMixed = ChannelsMixed = 0;
+	MixBuffer.Resize(BlockFrames * 2);
+	ResampleBuffer.Resize(BlockFrames * 2);
+
+	Printf("  Output: %s, %d Hz, %d frames per block\n", Sink->GetName(), SampleRate, BlockFrames);
+	Sink->Start(this);
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer Destructor
+//
+//==========================================================================
+
+SoftSoundRenderer::~SoftSoundRenderer()
+{
+	if (Sink != NULL)
+	{
+		Sink->Stop();
+		delete Sink;
+		Sink = NULL;
+	}
+	while (Streams.Size() > 0)
+	{
+		Streams[0]->Stop();
+	}
+	for (unsigned i = 0; i < Playing.Size(); ++i)
+	{
+		ReleaseChannel(Playing[i]);
+	}
+	for (unsigned i = 0; i < FreeChannels.Size(); ++i)
+	{
+		delete FreeChannels[i];
+	}
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: IsValid
+//
+//==========================================================================
+
+bool SoftSoundRenderer::IsValid()
+{
+	return Sink != NULL;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: SetSfxVolume
+//
+//==========================================================================
+
+void SoftSoundRenderer::SetSfxVolume(float volume)
+{
+	MixLock.Enter();
+	SfxVolume = volume;
+	for (unsigned i = 0; i < Playing.Size(); ++i)
+	{
+		SetChannelGain(Playing[i]);
+	}
+	MixLock.Leave();
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: SetMusicVolume
+//
+//==========================================================================
+
+void SoftSoundRenderer::SetMusicVolume(float volume)
+{
+	MusicVolume = volume;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: GetOutputRate
+//
+//==========================================================================
+
+float SoftSoundRenderer::GetOutputRate()
+{
+	return (float)SampleRate;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: LoadSoundRaw
+//
+//==========================================================================
+
+SoundHandle SoftSoundRenderer::LoadSoundRaw(BYTE *sfxdata, int length, int frequency, int channels, int bits, int loopstart, int loopend)
+{
+	SoundHandle retval = { NULL };
+
+	if (length <= 0 || channels < 1 || channels > 2 || (bits != 8 && bits != -8 && bits != 16))
+	{
+		return retval;
+	}
+
+	int bytes = bits == 16 ? 2 : 1;
+	int samples = length / bytes;
+	if (samples < channels)
+	{
+		return retval;
+	}
+
+	SoftSample *sample = new SoftSample;
+
+	sample->Channels = channels;
+	sample->Rate = frequency;
+	sample->Frames = samples / channels;
+	samples = sample->Frames * channels;
+	sample->Data.Resize((sample->Frames + 1) * channels);
+	for (int i = 0; i < samples; ++i)
+	{
+		if (bits == 16)
+			sample->Data[i] = ((SWORD *)sfxdata)[i] * (1.f / 32768.f);
+		else if (bits == 8)
+			sample->Data[i] = (sfxdata[i] - 128) * (1.f / 128.f);
+		else
+			sample->Data[i] = SBYTE(sfxdata[i]) * (1.f / 128.f);
+	}
+	sample->StreamFlags = 0;
+	sample->LoopStart = (loopstart > 0 && unsigned(loopstart) < sample->Frames) ? loopstart : 0;
+	sample->LoopEnd = (loopend > int(sample->LoopStart) && unsigned(loopend) < sample->Frames) ? loopend : sample->Frames;
+	for (int i = 0; i < channels; ++i)
+	{
+		sample->Data[sample->Frames * channels + i] = sample->Data[sample->LoopStart * channels + i];
+	}
+	retval.data = sample;
+	return retval;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: LoadSound
+//
+//==========================================================================
+
+SoundHandle SoftSoundRenderer::LoadSound(BYTE *sfxdata, int length)
+{
+	SoundHandle retval = { NULL };
+	MemoryReader reader((const char *)sfxdata, length);
+	ChannelConfig chans;
+	SampleType type;
+	int srate;
+
+	SoundDecoder *decoder = CreateDecoder(&reader);
+	if (decoder == NULL)
+	{
+		return retval;
+	}
+	decoder->getInfo(&srate, &chans, &type);
+	if (chans != ChannelConfig_Mono && chans != ChannelConfig_Stereo)
+	{
+		Printf("Unsupported audio format: %s, %s\n", GetChannelConfigName(chans), GetSampleTypeName(type));
+		delete decoder;
+		return retval;
+	}
+
+	size_t length_frames = decoder->getSampleLength();
+	if (snd_streamsfx > 0 && length_frames > srate * snd_streamsfx)
+	{ // Too long to be worth decoding all at once. Keep the encoded data
+	  // and let each channel that plays it decode it as it goes.
+		delete decoder;
+
+		SoftSample *sample = new SoftSample;
+		sample->Compressed.Resize(length);
+		memcpy(&sample->Compressed[0], sfxdata, length);
+		sample->StreamFlags = (type == SampleType_UInt8) ? SoundStream::Bits8 : 0;
+		sample->Channels = chans == ChannelConfig_Mono ? 1 : 2;
+		sample->Rate = srate;
+		sample->Frames = unsigned(length_frames);
+		sample->LoopStart = 0;
+		sample->LoopEnd = sample->Frames;
+		retval.data = sample;
+		return retval;
+	}
+
+	TArray<char> data = decoder->readAll();
+	delete decoder;
+	if (data.Size() == 0)
+	{
+		return retval;
+	}
+	return LoadSoundRaw((BYTE *)&data[0], data.Size(), srate, chans == ChannelConfig_Mono ? 1 : 2,
+		type == SampleType_Int16 ? 16 : 8, -1);
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: UnloadSound
+//
+//==========================================================================
+
+void SoftSoundRenderer::UnloadSound(SoundHandle sfx)
+{
+	SoftSample *sample = (SoftSample *)sfx.data;
+	if (sample == NULL)
+	{
+		return;
+	}
+
+	FSoundChan *schan = Channels;
+	while (schan != NULL)
+	{
+		FSoundChan *next = schan->NextChan;
+		if (schan->SysChannel != NULL && ((SoftChannel *)schan->SysChannel)->Sample == sample)
+		{
+			StopChannel(schan);
+		}
+		schan = next;
+	}
+
+	// Channels that are still fading out reference the sample, too.
+	MixLock.Enter();
+	for (unsigned i = Playing.Size(); i-- > 0; )
+	{
+		if (Playing[i]->Sample == sample)
+		{
+			ReleaseChannel(Playing[i]);
+			Playing.Delete(i);
+		}
+	}
+	MixLock.Leave();
+	delete sample;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: GetMSLength
+//
+//==========================================================================
+
+unsigned int SoftSoundRenderer::GetMSLength(SoundHandle sfx)
+{
+	SoftSample *sample = (SoftSample *)sfx.data;
+	if (sample == NULL)
+	{
+		return 0;
+	}
+	return unsigned(QWORD(sample->Frames) * 1000 / sample->Rate);
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: GetSampleLength
+//
+//==========================================================================
+
+unsigned int SoftSoundRenderer::GetSampleLength(SoundHandle sfx)
+{
+	SoftSample *sample = (SoftSample *)sfx.data;
+	return sample != NULL ? sample->Frames : 0;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: CreateStream
+//
+//==========================================================================
+
+SoundStream *SoftSoundRenderer::CreateStream(SoundStreamCallback callback, int buffbytes, int flags, int samplerate, void *userdata)
+{
+	return new SoftSoundStream(this, callback, buffbytes, flags, samplerate, userdata);
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: OpenStream
+//
+//==========================================================================
+
+SoundStream *SoftSoundRenderer::OpenStream(FileReader *reader, int flags)
+{
+	SoundDecoder *decoder = CreateDecoder(reader);
+	if (decoder == NULL)
+	{
+		return NULL;
+	}
+	return new SoftSoundStream(this, reader, decoder, flags);
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: AllocChannel
+//
+// Called with the mix lock held.
+//
+//==========================================================================
+
+SoftChannel *SoftSoundRenderer::AllocChannel()
+{
+	SoftChannel *schan;
+
+	if (FreeChannels.Pop(schan))
+	{
+		return schan;
+	}
+	schan = new SoftChannel;
+	schan->Reader = NULL;
+	schan->Decoder = NULL;
+	return schan;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: ReleaseChannel
+//
+// Puts a channel back on the free list. Called with the mix lock held.
+//
+//==========================================================================
+
+void SoftSoundRenderer::ReleaseChannel(SoftChannel *schan)
+{
+	if (schan->Decoder != NULL)
+	{
+		delete schan->Decoder;
+		schan->Decoder = NULL;
+	}
+	if (schan->Reader != NULL)
+	{
+		delete schan->Reader;
+		schan->Reader = NULL;
+	}
+	FreeChannels.Push(schan);
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: OpenChannelStream
+//
+// Sets up a channel playing a streamed sample to start at frame.
+// Called with the mix lock held.
+//
+//==========================================================================
+
+bool SoftSoundRenderer::OpenChannelStream(SoftChannel *schan, QWORD frame)
+{
+	SoftSample *sample = schan->Sample;
+
+	schan->Reader = new MemoryReader((const char *)&sample->Compressed[0], sample->Compressed.Size());
+	schan->Decoder = CreateDecoder(schan->Reader);
+	if (schan->Decoder == NULL || (frame > 0 && !schan->Decoder->seek(size_t(frame * 1000 / sample->Rate))))
+	{
+		return false;
+	}
+	schan->Raw.Resize(sample->Rate / 20 * FrameBytes(sample->Channels, sample->StreamFlags));
+	// Start with one frame of silence to interpolate from.
+	schan->Buffer.Resize(sample->Channels);
+	for (int i = 0; i < sample->Channels; ++i)
+	{
+		schan->Buffer[i] = 0;
+	}
+	schan->BufferFrames = 1;
+	schan->Played = frame << FRACBITS_SND;
+	schan->Pos = FRACUNIT_SND;
+	return true;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: SetChannelGain
+//
+// Sets the gains the channel will ramp to over the next block. Uses an
+// equal-power pan law so sounds don't dip when passing in front of the
+// listener.
+//
+//==========================================================================
+
+void SoftSoundRenderer::SetChannelGain(SoftChannel *schan)
+{
+	float vol = schan->Chan != NULL ? schan->Volume * schan->Attenuation * SfxVolume : 0;
+	schan->Gain[0] = vol * sqrtf((1 - schan->Pan) * 0.5f);
+	schan->Gain[1] = vol * sqrtf((1 + schan->Pan) * 0.5f);
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: SetChannelStep
+//
+//==========================================================================
+
+void SoftSoundRenderer::SetChannelStep(SoftChannel *schan)
+{
+	double pitch = schan->Pitch;
+	if (WasInWater && schan->Reverb)
+	{
+		pitch *= PITCH_MULT;
+	}
+	schan->Step = (QWORD)(pitch * schan->Sample->Rate / SampleRate * FRACUNIT_SND);
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: Spatialize
+//
+// Works out distance attenuation and stereo separation for a 3D sound.
+// Sound coordinates have Y pointing up, so only X and Z matter for the
+// pan. Area sounds are pulled to the center as the listener gets close.
+//
+//==========================================================================
+
+void SoftSoundRenderer::Spatialize(SoftChannel *schan, SoundListener *listener, bool areasound, const FVector3 &pos)
+{
+	FISoundChannel *chan = schan->Chan;
+	FVector3 dir = pos - listener->position;
+	float dist;
+
+	chan->DistanceSqr = (float)dir.LengthSquared();
+	dist = sqrtf(chan->DistanceSqr);
+	schan->Attenuation = S_GetRolloff(&chan->Rolloff, dist * chan->DistanceScale, true);
+
+	float hdist = sqrtf(dir.X * dir.X + dir.Z * dir.Z);
+	if (hdist > 0.0001f)
+	{
+		schan->Pan = (dir.X * sinf(listener->angle) - dir.Z * cosf(listener->angle)) / hdist;
+	}
+	else
+	{
+		schan->Pan = 0;
+	}
+	if (areasound && dist < AREA_SOUND_RADIUS)
+	{
+		schan->Pan *= dist / AREA_SOUND_RADIUS;
+	}
+	SetChannelGain(schan);
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: StartChannel
+//
+// Common part of StartSound and StartSound3D. Called with the mix lock
+// held. The channel is not added to the playing list yet.
+//
+//==========================================================================
+
+FISoundChannel *SoftSoundRenderer::StartChannel(SoftSample *sample, float vol, int pitch, int chanflags, FISoundChannel *reuse_chan)
+{
+	SoftChannel *schan = AllocChannel();
+
+	schan->Sample = sample;
+	schan->Pitch = PITCH(pitch);
+	schan->Volume = vol;
+	schan->Attenuation = 1;
+	schan->Pan = 0;
+	schan->Looping = !!(chanflags & SNDF_LOOP);
+	schan->Pausable = !(chanflags & SNDF_NOPAUSE);
+	schan->Reverb = !(chanflags & SNDF_NOREVERB);
+	schan->Deferred = Syncing;
+	schan->Ended = false;
+	schan->Chan = NULL;
+	SetChannelStep(schan);
+
+	schan->Pos = 0;
+	if (reuse_chan != NULL)
+	{
+		QWORD frame;
+		if (chanflags & SNDF_ABSTIME)
+		{ // StartTime is the sample position returned by GetPosition.
+			frame = reuse_chan->StartTime.AsOne;
+		}
+		else
+		{ // StartTime is the output clock from MarkStartTime.
+			QWORD elapsed = MixedFrames > reuse_chan->StartTime.AsOne ? MixedFrames - reuse_chan->StartTime.AsOne : 0;
+			frame = QWORD(elapsed * (double)schan->Step / FRACUNIT_SND);
+		}
+		if (frame >= sample->Frames)
+		{
+			if (!schan->Looping)
+			{
+				ReleaseChannel(schan);
+				return NULL;
+			}
+			frame = sample->LoopStart + (frame - sample->LoopStart) % (sample->LoopEnd - sample->LoopStart);
+		}
+		schan->Pos = frame << FRACBITS_SND;
+	}
+	if (sample->Compressed.Size() > 0 && !OpenChannelStream(schan, schan->Pos >> FRACBITS_SND))
+	{
+		ReleaseChannel(schan);
+		return NULL;
+	}
+
+	FISoundChannel *chan = reuse_chan;
+	if (chan == NULL)
+	{
+		chan = S_GetChannel(schan);
+	}
+	else
+	{
+		chan->SysChannel = schan;
+	}
+	chan->StartTime.AsOne = MixedFrames;
+	schan->Chan = chan;
+	return chan;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: StartSound
+//
+//==========================================================================
+
+FISoundChannel *SoftSoundRenderer::StartSound(SoundHandle sfx, float vol, int pitch, int chanflags, FISoundChannel *reuse_chan)
+{
+	SoftSample *sample = (SoftSample *)sfx.data;
+	if (sample == NULL)
+	{
+		return NULL;
+	}
+	if (ActiveCount >= (unsigned)*snd_channels)
+	{
+		FSoundChan *lowest = FindLowestChannel();
+		if (lowest != NULL) StopChannel(lowest);
+		if (ActiveCount >= (unsigned)*snd_channels)
+			return NULL;
+	}
+
+	MixLock.Enter();
+	FISoundChannel *chan = StartChannel(sample, vol, pitch, chanflags, reuse_chan);
+	if (chan != NULL)
+	{
+		SoftChannel *schan = (SoftChannel *)chan->SysChannel;
+		chan->Rolloff.RolloffType = ROLLOFF_Log;
+		chan->Rolloff.RolloffFactor = 0;
+		chan->Rolloff.MinDistance = 1;
+		chan->DistanceScale = 1;
+		chan->DistanceSqr = 0;
+		chan->ManualRolloff = false;
+		SetChannelGain(schan);
+		schan->CurGain[0] = schan->Gain[0];
+		schan->CurGain[1] = schan->Gain[1];
+		Playing.Push(schan);
+		ActiveCount++;
+	}
+	MixLock.Leave();
+	return chan;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: StartSound3D
+//
+//==========================================================================
+
+FISoundChannel *SoftSoundRenderer::StartSound3D(SoundHandle sfx, SoundListener *listener, float vol,
+	FRolloffInfo *rolloff, float distscale, int pitch, int priority, const FVector3 &pos, const FVector3 &vel,
+	int channum, int chanflags, FISoundChannel *reuse_chan)
+{
+	SoftSample *sample = (SoftSample *)sfx.data;
+	if (sample == NULL)
+	{
+		return NULL;
+	}
+	if (ActiveCount >= (unsigned)*snd_channels)
+	{
+		float dist_sqr = (float)(pos - listener->position).LengthSquared();
+		FSoundChan *lowest = FindLowestChannel();
+		if (lowest != NULL)
+		{
+			if (lowest->Priority < priority || (lowest->Priority == priority &&
+				lowest->DistanceSqr > dist_sqr))
+				StopChannel(lowest);
+		}
+		if (ActiveCount >= (unsigned)*snd_channels)
+			return NULL;
+	}
+
+	MixLock.Enter();
+	FISoundChannel *chan = StartChannel(sample, vol, pitch, chanflags, reuse_chan);
+	if (chan != NULL)
+	{
+		SoftChannel *schan = (SoftChannel *)chan->SysChannel;
+		chan->Rolloff = *rolloff;
+		chan->DistanceScale = distscale;
+		chan->ManualRolloff = true;
+		Spatialize(schan, listener, !!(chanflags & SNDF_AREA), pos);
+		schan->CurGain[0] = schan->Gain[0];
+		schan->CurGain[1] = schan->Gain[1];
+		Playing.Push(schan);
+		ActiveCount++;
+	}
+	MixLock.Leave();
+	return chan;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: StopChannel
+//
+// The game is done with the channel right away, but the mixer keeps it
+// for one more block to ramp it down to silence instead of clicking.
+//
+//==========================================================================
+
+void SoftSoundRenderer::StopChannel(FISoundChannel *chan)
+{
+	if (chan == NULL || chan->SysChannel == NULL)
+	{
+		return;
+	}
+	SoftChannel *schan = (SoftChannel *)chan->SysChannel;
+
+	MixLock.Enter();
+	schan->Chan = NULL;
+	if (schan->Deferred || schan->Ended)
+	{ // Never heard or already silent, so there's nothing to fade.
+		Playing.Delete(Playing.Find(schan));
+		ReleaseChannel(schan);
+	}
+	else
+	{
+		SetChannelGain(schan);
+	}
+	ActiveCount--;
+	MixLock.Leave();
+
+	S_ChannelEnded(chan);
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: ChannelVolume
+//
+//==========================================================================
+
+void SoftSoundRenderer::ChannelVolume(FISoundChannel *chan, float volume)
+{
+	if (chan == NULL || chan->SysChannel == NULL)
+	{
+		return;
+	}
+	SoftChannel *schan = (SoftChannel *)chan->SysChannel;
+	MixLock.Enter();
+	schan->Volume = volume;
+	SetChannelGain(schan);
+	MixLock.Leave();
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: MarkStartTime
+//
+//==========================================================================
+
+void SoftSoundRenderer::MarkStartTime(FISoundChannel *chan)
+{
+	chan->StartTime.AsOne = MixedFrames;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: GetPosition
+//
+//==========================================================================
+
+unsigned int SoftSoundRenderer::GetPosition(FISoundChannel *chan)
+{
+	if (chan == NULL || chan->SysChannel == NULL)
+	{
+		return 0;
+	}
+	SoftChannel *schan = (SoftChannel *)chan->SysChannel;
+	if (schan->Decoder != NULL)
+	{
+		return unsigned((schan->Played >> FRACBITS_SND) % MAX(1u, schan->Sample->Frames));
+	}
+	return unsigned(schan->Pos >> FRACBITS_SND);
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: GetAudibility
+//
+//==========================================================================
+
+float SoftSoundRenderer::GetAudibility(FISoundChannel *chan)
+{
+	if (chan == NULL || chan->SysChannel == NULL)
+	{
+		return 0;
+	}
+	SoftChannel *schan = (SoftChannel *)chan->SysChannel;
+	return schan->Volume * schan->Attenuation;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: Sync
+//
+// While syncing, new channels are held back so that everything started
+// during one tic begins on the same output frame.
+//
+//==========================================================================
+
+void SoftSoundRenderer::Sync(bool sync)
+{
+	MixLock.Enter();
+	Syncing = sync;
+	if (!sync)
+	{
+		for (unsigned i = 0; i < Playing.Size(); ++i)
+		{
+			Playing[i]->Deferred = false;
+		}
+	}
+	MixLock.Leave();
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: SetSfxPaused
+//
+//==========================================================================
+
+void SoftSoundRenderer::SetSfxPaused(bool paused, int slot)
+{
+	MixLock.Enter();
+	if (paused)
+		SFXPaused |= 1 << slot;
+	else
+		SFXPaused &= ~(1 << slot);
+	MixLock.Leave();
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: SetInactive
+//
+//==========================================================================
+
+void SoftSoundRenderer::SetInactive(SoundRenderer::EInactiveState inactive)
+{
+	MixLock.Enter();
+	Inactive = inactive;
+	MixLock.Leave();
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: UpdateSoundParams3D
+//
+//==========================================================================
+
+void SoftSoundRenderer::UpdateSoundParams3D(SoundListener *listener, FISoundChannel *chan, bool areasound, const FVector3 &pos, const FVector3 &vel)
+{
+	if (chan == NULL || chan->SysChannel == NULL)
+	{
+		return;
+	}
+	MixLock.Enter();
+	Spatialize((SoftChannel *)chan->SysChannel, listener, areasound, pos);
+	MixLock.Leave();
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: UpdateListener
+//
+// There is no reverb, but being underwater still lowers the pitch of
+// reverb-enabled sounds the same way the other backends do.
+//
+//==========================================================================
+
+void SoftSoundRenderer::UpdateListener(SoundListener *listener)
+{
+	bool inwater = listener->valid && listener->underwater && snd_waterreverb;
+
+	if (inwater != WasInWater)
+	{
+		MixLock.Enter();
+		WasInWater = inwater;
+		for (unsigned i = 0; i < Playing.Size(); ++i)
+		{
+			if (Playing[i]->Reverb)
+			{
+				SetChannelStep(Playing[i]);
+			}
+		}
+		MixLock.Leave();
+	}
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: PurgeStoppedChannels
+//
+// Tells the game about channels that played to their end. This has to
+// happen on the game thread, not the mixer's.
+//
+//==========================================================================
+
+void SoftSoundRenderer::PurgeStoppedChannels()
+{
+	FSoundChan *schan = Channels;
+	while (schan != NULL)
+	{
+		FSoundChan *next = schan->NextChan;
+		if (schan->SysChannel != NULL && ((SoftChannel *)schan->SysChannel)->Ended)
+		{
+			StopChannel(schan);
+		}
+		schan = next;
+	}
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: UpdateSounds
+//
+//==========================================================================
+
+void SoftSoundRenderer::UpdateSounds()
+{
+	PurgeStoppedChannels();
+
+	if (!Sink->IsPull())
+	{ // Mix as much as real time has advanced, but never more than half a
+	  // second at once so a long stall doesn't turn into a long stall.
+		QWORD target = QWORD(I_MSTime() - PushStartTime) * SampleRate / 1000;
+		if (target - PushedFrames > QWORD(SampleRate / 2))
+		{
+			PushedFrames = target - SampleRate / 2;
+		}
+		while (PushedFrames + BlockFrames <= target)
+		{
+			Mix(&MixBuffer[0], BlockFrames);
+			Sink->Write(&MixBuffer[0], BlockFrames);
+			PushedFrames += BlockFrames;
+		}
+	}
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: Mix
+//
+// Fills buffer with frames of output, one block at a time. Pull sinks call
+// this from their own thread.
+//
+//==========================================================================
+
+void SoftSoundRenderer::Mix(float *buffer, int frames)
+{
+	MixLock.Enter();
+	while (frames > 0)
+	{
+		int block = MIN(frames, BlockFrames);
+
+		BlockCycles.Reset();
+		BlockCycles.Clock();
+		MixBlock(buffer, block);
+		BlockCycles.Unclock();
+
+		double ms = BlockCycles.TimeMS();
+		BlockTimeSum += ms;
+		BlockTimeMax = MAX(BlockTimeMax, ms);
+		if (++BlockCount * BlockFrames >= (unsigned)SampleRate)
+		{ // Roll the stats over about once a second.
+			StatAvgMS = BlockTimeSum / BlockCount;
+			StatMaxMS = BlockTimeMax;
+			StatMixed = ChannelsMixed / BlockCount;
+			BlockTimeSum = BlockTimeMax = 0;
+			BlockCount = ChannelsMixed = 0;
+		}
+		buffer += block * 2;
+		frames -= block;
+	}
+	MixLock.Leave();
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: MixBlock
+//
+// Called with the mix lock held.
+//
+//==========================================================================
+
+void SoftSoundRenderer::MixBlock(float *buffer, int frames)
+{
+	memset(buffer, 0, frames * 2 * sizeof(float));
+	if (Inactive == INACTIVE_Complete)
+	{
+		return;
+	}
+	if (ResampleBuffer.Size() < unsigned(frames * 2))
+	{
+		ResampleBuffer.Resize(frames * 2);
+	}
+
+	for (unsigned i = 0; i < Playing.Size(); )
+	{
+		SoftChannel *schan = Playing[i];
+		if (schan->Deferred || schan->Ended || (schan->Pausable && SFXPaused))
+		{
+			++i;
+		}
+		else if (MixChannel(schan, buffer, frames) || schan->Chan != NULL)
+		{
+			++i;
+		}
+		else
+		{ // Finished fading out after being stopped.
+			Playing.Delete(i);
+			ReleaseChannel(schan);
+		}
+	}
+	for (unsigned i = 0; i < Streams.Size(); ++i)
+	{
+		if (!Streams[i]->Paused && !Streams[i]->Ended)
+		{
+			MixStream(Streams[i], buffer, frames);
+		}
+	}
+	MixedFrames += frames;
+
+	if (Inactive == INACTIVE_Mute)
+	{
+		memset(buffer, 0, frames * 2 * sizeof(float));
+	}
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: MixChannel
+//
+// Resamples and adds one channel to the block. Returns false if the
+// channel has no more sound to play.
+//
+//==========================================================================
+
+bool SoftSoundRenderer::MixChannel(SoftChannel *schan, float *buffer, int frames)
+{
+	if (schan->Decoder != NULL)
+	{
+		return MixStreamedChannel(schan, buffer, frames);
+	}
+
+	SoftSample *sample = schan->Sample;
+	QWORD end = QWORD(schan->Looping ? sample->LoopEnd : sample->Frames) << FRACBITS_SND;
+	float dl = (schan->Gain[0] - schan->CurGain[0]) / frames;
+	float dr = (schan->Gain[1] - schan->CurGain[1]) / frames;
+	int done = 0;
+
+	ChannelsMixed++;
+	while (done < frames)
+	{
+		if (schan->Pos >= end)
+		{
+			if (!schan->Looping)
+			{
+				schan->Ended = true;
+				break;
+			}
+			schan->Pos -= QWORD(sample->LoopEnd - sample->LoopStart) << FRACBITS_SND;
+			continue;
+		}
+		int count = int(MIN<QWORD>(frames - done, (end - schan->Pos + schan->Step - 1) / schan->Step));
+		Resample(&ResampleBuffer[0], &sample->Data[0], sample->Channels, schan->Pos, schan->Step, count);
+		MixRamp(buffer + done * 2, &ResampleBuffer[0], sample->Channels, count,
+			schan->CurGain[0] + dl * done, schan->CurGain[1] + dr * done, dl, dr);
+		schan->Pos += schan->Step * count;
+		done += count;
+	}
+	schan->CurGain[0] = schan->Gain[0];
+	schan->CurGain[1] = schan->Gain[1];
+	return !schan->Ended && schan->Chan != NULL;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: MixStreamedChannel
+//
+// MixChannel for samples that are decoded while they play.
+//
+//==========================================================================
+
+bool SoftSoundRenderer::MixStreamedChannel(SoftChannel *schan, float *buffer, int frames)
+{
+	SoftSample *sample = schan->Sample;
+	float dl = (schan->Gain[0] - schan->CurGain[0]) / frames;
+	float dr = (schan->Gain[1] - schan->CurGain[1]) / frames;
+	int done = 0;
+
+	ChannelsMixed++;
+	while (done < frames)
+	{
+		QWORD end = QWORD(schan->BufferFrames - 1) << FRACBITS_SND;
+		if (schan->Pos >= end)
+		{
+			size_t got = ReadDecoder(schan->Decoder, schan->Raw, schan->Looping);
+			unsigned int count = unsigned(got / FrameBytes(sample->Channels, sample->StreamFlags));
+			if (count == 0)
+			{
+				schan->Ended = true;
+				break;
+			}
+			AppendFrames(schan->Buffer, schan->BufferFrames, schan->Pos, &schan->Raw[0], count,
+				sample->Channels, sample->StreamFlags);
+			continue;
+		}
+		int count = int(MIN<QWORD>(frames - done, (end - schan->Pos + schan->Step - 1) / schan->Step));
+		Resample(&ResampleBuffer[0], &schan->Buffer[0], sample->Channels, schan->Pos, schan->Step, count);
+		MixRamp(buffer + done * 2, &ResampleBuffer[0], sample->Channels, count,
+			schan->CurGain[0] + dl * done, schan->CurGain[1] + dr * done, dl, dr);
+		schan->Pos += schan->Step * count;
+		schan->Played += schan->Step * count;
+		done += count;
+	}
+	schan->CurGain[0] = schan->Gain[0];
+	schan->CurGain[1] = schan->Gain[1];
+	return !schan->Ended && schan->Chan != NULL;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: MixStream
+//
+// Called with the mix lock held.
+//
+//==========================================================================
+
+void SoftSoundRenderer::MixStream(SoftSoundStream *stream, float *buffer, int frames)
+{
+	float gain = stream->Volume * MusicVolume;
+	float step = (gain - stream->CurGain) / frames;
+	int done = 0;
+
+	while (done < frames)
+	{
+		QWORD end = QWORD(stream->DataFrames - 1) << FRACBITS_SND;
+		if (stream->Pos >= end)
+		{
+			if (!stream->Refill())
+			{
+				break;
+			}
+			continue;
+		}
+		int count = int(MIN<QWORD>(frames - done, (end - stream->Pos + stream->Step - 1) / stream->Step));
+		float g = stream->CurGain + step * done;
+		Resample(&ResampleBuffer[0], &stream->Data[0], stream->Channels, stream->Pos, stream->Step, count);
+		MixRamp(buffer + done * 2, &ResampleBuffer[0], stream->Channels, count, g, g, step, step);
+		stream->Pos += stream->Step * count;
+		stream->FramesPlayed += (stream->Step * count) >> FRACBITS_SND;
+		done += count;
+	}
+	stream->CurGain = gain;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: FindLowestChannel
+//
+//==========================================================================
+
+FSoundChan *SoftSoundRenderer::FindLowestChannel()
+{
+	FSoundChan *schan = Channels;
+	FSoundChan *lowest = NULL;
+	while (schan != NULL)
+	{
+		if (schan->SysChannel != NULL)
+		{
+			if (lowest == NULL || schan->Priority < lowest->Priority ||
+				(schan->Priority == lowest->Priority &&
+				 schan->DistanceSqr > lowest->DistanceSqr))
+				lowest = schan;
+		}
+		schan = schan->NextChan;
+	}
+	return lowest;
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: PrintStatus
+//
+//==========================================================================
+
+void SoftSoundRenderer::PrintStatus()
+{
+	Printf("Output: " TEXTCOLOR_GREEN "%s" TEXTCOLOR_NORMAL ", %d Hz, %d frames per block\n",
+		Sink->GetName(), SampleRate, BlockFrames);
+	Printf("Channels: %u of %d in use, %u allocated\n", ActiveCount, *snd_channels, Playing.Size() + FreeChannels.Size());
+#if defined(_M_X64) || defined(_M_IX86) || defined(__i386__) || defined(__amd64__)
+	Printf("Mixing: %s\n", CPU.bSSE2 ? "SSE2" : "C");
+#else
+	Printf("Mixing: C\n");
+#endif
+	Printf("Mix cost: %.3f ms per block (%.3f ms peak) of %.3f ms\n",
+		StatAvgMS, StatMaxMS, BlockFrames * 1000. / SampleRate);
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: PrintDriversList
+//
+//==========================================================================
+
+void SoftSoundRenderer::PrintDriversList()
+{
+	Printf("The software mixer outputs to: " TEXTCOLOR_YELLOW
+#ifdef HAVE_SDL_AUDIO
+		"device, "
+#endif
+		"wave, null\n");
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer :: GatherStats
+//
+// Reports the CPU time spent mixing each block, averaged over the last
+// second, and how much of the block's real time that represents.
+//
+//==========================================================================
+
+FString SoftSoundRenderer::GatherStats()
+{
+	FString out;
+	double blockms = BlockFrames * 1000. / SampleRate;
+
+	out.Format("%u/%d channels (%u mixed), %u streams, mix " TEXTCOLOR_YELLOW "%.3f" TEXTCOLOR_NORMAL
+		" ms/block (peak %.3f) = %.1f%% of %.2f ms, %s",
+		ActiveCount, *snd_channels, StatMixed, Streams.Size(), StatAvgMS, StatMaxMS,
+		StatAvgMS * 100 / blockms, blockms, Sink->GetName());
+	return out;
+}
@@ -0,0 +1,154 @@
+#ifndef SOFTSOUND_H
+#define SOFTSOUND_H
+
+#include "i_sound.h"
+#include "s_sound.h"
+#include "stats.h"
+#include "critsec.h"
+
+class SoftSoundRenderer;
+class SoftSoundStream;
+struct SoftSample;
+struct SoftChannel;
+
+//==========================================================================
+//
+// SoftSoundSink
+//
+// Receives the interleaved stereo float output of the software mixer.
+// A pull sink (an audio device) asks the renderer for data from its own
+// thread by calling SoftSoundRenderer::Mix. A push sink (file, null) has
+// data handed to it from UpdateSounds, at the rate real time advances.
+//
+//==========================================================================
+
+class SoftSoundSink
+{
+public:
+	virtual ~SoftSoundSink() {}
+	virtual bool IsValid() = 0;
+	virtual bool IsPull() = 0;
+	virtual int GetSampleRate() = 0;
+	virtual int GetBlockFrames() = 0;
+	virtual const char *GetName() = 0;
+	virtual void Start(SoftSoundRenderer *renderer) {}
+	virtual void Stop() {}
+	virtual void Write(const float *buffer, int frames) {}
+};
+
+class SoftSoundRenderer : public SoundRenderer
+{
+public:
+	SoftSoundRenderer();
+	virtual ~SoftSoundRenderer();
+
+	virtual void SetSfxVolume(float volume);
+	virtual void SetMusicVolume(float volume);
+	virtual SoundHandle LoadSound(BYTE *sfxdata, int length);
+	virtual SoundHandle LoadSoundRaw(BYTE *sfxdata, int length, int frequency, int channels, int bits, int loopstart, int loopend = -1);
+	virtual void UnloadSound(SoundHandle sfx);
+	virtual unsigned int GetMSLength(SoundHandle sfx);
+	virtual unsigned int GetSampleLength(SoundHandle sfx);
+	virtual float GetOutputRate();
+
+	// Streaming sounds.
+	virtual SoundStream *CreateStream(SoundStreamCallback callback, int buffbytes, int flags, int samplerate, void *userdata);
+	virtual SoundStream *OpenStream(FileReader *reader, int flags);
+
+	// Starts a sound.
+	virtual FISoundChannel *StartSound(SoundHandle sfx, float vol, int pitch, int chanflags, FISoundChannel *reuse_chan);
+	virtual FISoundChannel *StartSound3D(SoundHandle sfx, SoundListener *listener, float vol, FRolloffInfo *rolloff, float distscale, int pitch, int priority, const FVector3 &pos, const FVector3 &vel, int channum, int chanflags, FISoundChannel *reuse_chan);
+
+	// Stops a sound channel.
+	virtual void StopChannel(FISoundChannel *chan);
+
+	// Changes a channel's volume.
+	virtual void ChannelVolume(FISoundChannel *chan, float volume);
+
+	// Marks a channel's start time without actually playing it.
+	virtual void MarkStartTime(FISoundChannel *chan);
+
+	// Returns position of sound on this channel, in samples.
+	virtual unsigned int GetPosition(FISoundChannel *chan);
+
+	// Gets a channel's audibility (real volume).
+	virtual float GetAudibility(FISoundChannel *chan);
+
+	// Synchronizes following sound startups.
+	virtual void Sync(bool sync);
+
+	// Pauses or resumes all sound effect channels.
+	virtual void SetSfxPaused(bool paused, int slot);
+
+	// Pauses or resumes *every* channel, including environmental reverb.
+	virtual void SetInactive(EInactiveState inactive);
+
+	// Updates the volume, separation, and pitch of a sound channel.
+	virtual void UpdateSoundParams3D(SoundListener *listener, FISoundChannel *chan, bool areasound, const FVector3 &pos, const FVector3 &vel);
+
+	virtual void UpdateListener(SoundListener *);
+	virtual void UpdateSounds();
+
+	virtual bool IsValid();
+	virtual void PrintStatus();
+	virtual void PrintDriversList();
+	virtual FString GatherStats();
+
+	// Fills buffer with frames of interleaved stereo output.
+	void Mix(float *buffer, int frames);
+
+private:
+	friend class SoftSoundStream;
+
+	FISoundChannel *StartChannel(SoftSample *sample, float vol, int pitch, int chanflags, FISoundChannel *reuse_chan);
+	SoftChannel *AllocChannel();
+	void ReleaseChannel(SoftChannel *schan);
+	bool OpenChannelStream(SoftChannel *schan, QWORD frame);
+	void SetChannelGain(SoftChannel *schan);
+	void SetChannelStep(SoftChannel *schan);
+	void Spatialize(SoftChannel *schan, SoundListener *listener, bool areasound, const FVector3 &pos);
+	void PurgeStoppedChannels();
+	FSoundChan *FindLowestChannel();
+
+	void MixBlock(float *buffer, int frames);
+	bool MixChannel(SoftChannel *schan, float *buffer, int frames);
+	bool MixStreamedChannel(SoftChannel *schan, float *buffer, int frames);
+	void MixStream(SoftSoundStream *stream, float *buffer, int frames);
+
+	SoftSoundSink *Sink;
+	FCriticalSection MixLock;
+
+	int SampleRate;
+	int BlockFrames;
+	float SfxVolume;
+	float MusicVolume;
+	int SFXPaused;
+	EInactiveState Inactive;
+	bool Syncing;
+	bool WasInWater;
+
+	TArray<SoftChannel *> Playing;
+	TArray<SoftChannel *> FreeChannels;
+	TArray<SoftSoundStream *> Streams;
+	unsigned int ActiveCount;
+
+	TArray<float> MixBuffer;
+	TArray<float> ResampleBuffer;
+
+	// Output clock, in frames. Used as the DSP clock for channel start times.
+	QWORD MixedFrames;
+
+	// Push sinks only: real time that has been accounted for.
+	unsigned int PushStartTime;
+	QWORD PushedFrames;
+
+	// Per-block mixing cost, rolled over roughly once a second.
+	cycle_t BlockCycles;
+	double BlockTimeSum, BlockTimeMax;
+	unsigned int BlockCount;
+	double StatAvgMS, StatMaxMS;
+	unsigned int StatMixed;
+	unsigned int ChannelsMixed;
+};
+
+#endif
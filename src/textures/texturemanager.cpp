@@ -486,28 +486,30 @@ bool FTextureManager::AreTexturesCompatible (FTextureID picnum1, FTextureID picn
 
 void FTextureManager::AddGroup(int wadnum, int ns, int usetype)
 {
-	int firsttx = Wads.GetFirstLump(wadnum);
-	int lasttx = Wads.GetLastLump(wadnum);
 	FString Name;
+	TArray<int> lumps;
 
 	// Go from first to last so that ANIMDEFS work as expected. However,
 	// to avoid duplicates (and to keep earlier entries from overriding
 	// later ones), the texture is only inserted if it is the one returned
 	// by doing a check by name in the list of wads.
 
-	for (; firsttx <= lasttx; ++firsttx)
+	Wads.GetNamespaceLumps(ns, lumps, wadnum, ns == ns_flats);
+
+	for (unsigned k = 0; k < lumps.Size(); k++)
 	{
+		int firsttx = lumps[k];
+
+		Wads.GetLumpName (Name, firsttx);
 		if (Wads.GetLumpNamespace(firsttx) == ns)
 		{
-			Wads.GetLumpName (Name, firsttx);
-
 			if (Wads.CheckNumForName (Name, ns) == firsttx)
 			{
 				CreateTexture (firsttx, usetype);
 			}
 			StartScreen->Progress();
 		}
-		else if (ns == ns_flats && Wads.GetLumpFlags(firsttx) & LUMPF_MAYBEFLAT)
+		else
 		{
 			if (Wads.CheckNumForName (Name, ns) < firsttx)
 			{
@@ -526,57 +528,51 @@ void FTextureManager::AddGroup(int wadnum, int ns, int usetype)
 
 void FTextureManager::AddHiresTextures (int wadnum)
 {
-	int firsttx = Wads.GetFirstLump(wadnum);
-	int lasttx = Wads.GetLastLump(wadnum);
-
 	FString Name;
 	TArray<FTextureID> tlist;
+	TArray<int> lumps;
 
-	if (firsttx == -1 || lasttx == -1)
-	{
-		return;
-	}
+	Wads.GetNamespaceLumps(ns_hires, lumps, wadnum);
 
-	for (;firsttx <= lasttx; ++firsttx)
+	for (unsigned k = 0; k < lumps.Size(); k++)
 	{
-		if (Wads.GetLumpNamespace(firsttx) == ns_hires)
-		{
-			Wads.GetLumpName (Name, firsttx);
+		int firsttx = lumps[k];
+
+		Wads.GetLumpName (Name, firsttx);
 
-			if (Wads.CheckNumForName (Name, ns_hires) == firsttx)
+		if (Wads.CheckNumForName (Name, ns_hires) == firsttx)
+		{
+			tlist.Clear();
+			int amount = ListTextures(Name, tlist);
+			if (amount == 0)
 			{
-				tlist.Clear();
-				int amount = ListTextures(Name, tlist);
-				if (amount == 0)
+				// A texture with this name does not yet exist
+				FTexture * newtex = FTexture::CreateTexture (firsttx, FTexture::TEX_Any);
+				if (newtex != NULL)
 				{
-					// A texture with this name does not yet exist
-					FTexture * newtex = FTexture::CreateTexture (firsttx, FTexture::TEX_Any);
-					if (newtex != NULL)
-					{
-						newtex->UseType=FTexture::TEX_Override;
-						AddTexture(newtex);
-					}
+					newtex->UseType=FTexture::TEX_Override;
+					AddTexture(newtex);
 				}
-				else
+			}
+			else
+			{
+				for(unsigned int i = 0; i < tlist.Size(); i++)
 				{
-					for(unsigned int i = 0; i < tlist.Size(); i++)
+					FTexture * newtex = FTexture::CreateTexture (firsttx, FTexture::TEX_Any);
+					if (newtex != NULL)
 					{
-						FTexture * newtex = FTexture::CreateTexture (firsttx, FTexture::TEX_Any);
-						if (newtex != NULL)
-						{
-							FTexture * oldtex = Textures[tlist[i].GetIndex()].Texture;
-
-							// Replace the entire texture and adjust the scaling and offset factors.
-							newtex->bWorldPanning = true;
-							newtex->SetScaledSize(oldtex->GetScaledWidth(), oldtex->GetScaledHeight());
-							newtex->LeftOffset = FixedMul(oldtex->GetScaledLeftOffset(), newtex->xScale);
-							newtex->TopOffset = FixedMul(oldtex->GetScaledTopOffset(), newtex->yScale);
-							ReplaceTexture(tlist[i], newtex, true);
-						}
+						FTexture * oldtex = Textures[tlist[i].GetIndex()].Texture;
+
+						// Replace the entire texture and adjust the scaling and offset factors.
+						newtex->bWorldPanning = true;
+						newtex->SetScaledSize(oldtex->GetScaledWidth(), oldtex->GetScaledHeight());
+						newtex->LeftOffset = FixedMul(oldtex->GetScaledLeftOffset(), newtex->xScale);
+						newtex->TopOffset = FixedMul(oldtex->GetScaledTopOffset(), newtex->yScale);
+						ReplaceTexture(tlist[i], newtex, true);
 					}
 				}
-				StartScreen->Progress();
 			}
+			StartScreen->Progress();
 		}
 	}
 }
@@ -1136,29 +1132,16 @@ int FTextureManager::ReadTexture (FArchive &arc)
 
 int FTextureManager::GuesstimateNumTextures ()
 {
-	int numtex = 0;
-	
-	for(int i = Wads.GetNumLumps()-1; i>=0; i--)
+	static const int spaces[] = { ns_sprites, ns_newtextures, ns_hires, ns_patches, ns_graphics };
+	TArray<int> lumps;
+	int numtex;
+
+	Wads.GetNamespaceLumps(ns_flats, lumps, -1, true);
+	for (size_t i = 0; i < countof(spaces); i++)
 	{
-		int space = Wads.GetLumpNamespace(i);
-		switch(space)
-		{
-		case ns_flats:
-		case ns_sprites:
-		case ns_newtextures:
-		case ns_hires:
-		case ns_patches:
-		case ns_graphics:
-			numtex++;
-			break;
-
-		default:
-			if (Wads.GetLumpFlags(i) & LUMPF_MAYBEFLAT) numtex++;
-
-			break;
-		}
+		Wads.GetNamespaceLumps(spaces[i], lumps);
 	}
-
+	numtex = lumps.Size();
 	numtex += CountBuildTiles ();
 	numtex += CountTexturesX ();
 	return numtex;
@@ -152,7 +152,7 @@ void ParseOldDecoration(FScanner &sc, EDefinitionType def)
 	parent = (def == DEF_Pickup) ? RUNTIME_CLASS(AFakeInventory) : RUNTIME_CLASS(AActor);
 
 	sc.MustGetString();
-	typeName = FName(sc.String);
+	typeName = sc.ViewName();
 	type = static_cast<PClassActor *>(parent->CreateDerivedClass (typeName, parent->Size));
 	ResetBaggage(&bag, parent);
 	bag.Info = type;
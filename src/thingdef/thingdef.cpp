@@ -284,6 +284,8 @@ static void FinishThingdef()
 
 	if (Args->CheckParm("-dumpdisasm")) dump = fopen("disasm.txt", "w");
 
+	DecorateCacheBegin();
+
 	for (i = 0; i < StateTempCalls.Size(); ++i)
 	{
 		FStateTempCall *tcall = StateTempCalls[i];
@@ -296,24 +298,36 @@ static void FinishThingdef()
 		func = tcall->Code->GetDirectFunction();
 		if (func == NULL)
 		{
-			FCompileContext ctx(tcall->ActorClass);
-			tcall->Code = static_cast<FxTailable *>(tcall->Code->Resolve(ctx));
+			FString slot;
+			slot.Format("%s.States[%d] (*%d)", tcall->ActorClass->TypeName.GetChars(), tcall->FirstState, tcall->NumStates);
+			VMScriptFunction *sfunc = DecorateCacheFind(slot);
+			int warnings = FScriptPosition::WarnCounter;
 
-			// Make sure resolving it didn't obliterate it.
-			if (tcall->Code != NULL)
+			if (sfunc == NULL)
 			{
-				VMFunctionBuilder buildit;
+				FCompileContext ctx(tcall->ActorClass);
+				tcall->Code = static_cast<FxTailable *>(tcall->Code->Resolve(ctx));
 
-				// Allocate registers used to pass parameters in.
-				// self, stateowner, state (all are pointers)
-				buildit.Registers[REGT_POINTER].Get(3);
+				// Make sure resolving it didn't obliterate it.
+				if (tcall->Code != NULL)
+				{
+					VMFunctionBuilder buildit;
 
-				// Emit a tail call via FxVMFunctionCall
-				tcall->Code->Emit(&buildit, true);
+					// Allocate registers used to pass parameters in.
+					// self, stateowner, state (all are pointers)
+					buildit.Registers[REGT_POINTER].Get(3);
 
-				VMScriptFunction *sfunc = buildit.MakeFunction();
-				sfunc->NumArgs = NAP;
+					// Emit a tail call via FxVMFunctionCall
+					tcall->Code->Emit(&buildit, true);
+
+					sfunc = buildit.MakeFunction();
+					sfunc->NumArgs = NAP;
+				}
+			}
+			if (sfunc != NULL)
+			{
 				func = sfunc;
+				DecorateCacheAdd(slot, sfunc, FScriptPosition::WarnCounter == warnings);
 
 				if (dump != NULL)
 				{
@@ -363,13 +377,21 @@ static void FinishThingdef()
 			sfunc = dmg->GetFunction();
 			if (sfunc == NULL)
 			{
-				FCompileContext ctx(ti);
-				dmg->Resolve(ctx);
-				VMFunctionBuilder buildit;
-				buildit.Registers[REGT_POINTER].Get(1);		// The self pointer
-				dmg->Emit(&buildit);
-				sfunc = buildit.MakeFunction();
-				sfunc->NumArgs = 1;
+				FString slot;
+				slot.Format("%s.Damage", ti->TypeName.GetChars());
+				sfunc = DecorateCacheFind(slot);
+				int warnings = FScriptPosition::WarnCounter;
+				if (sfunc == NULL)
+				{
+					FCompileContext ctx(ti);
+					dmg->Resolve(ctx);
+					VMFunctionBuilder buildit;
+					buildit.Registers[REGT_POINTER].Get(1);		// The self pointer
+					dmg->Emit(&buildit);
+					sfunc = buildit.MakeFunction();
+					sfunc->NumArgs = 1;
+				}
+				DecorateCacheAdd(slot, sfunc, FScriptPosition::WarnCounter == warnings);
 				// Save this function in case this damage value was reused
 				// (which happens quite easily with inheritance).
 				dmg->SetFunction(sfunc);
@@ -386,6 +408,8 @@ static void FinishThingdef()
 			}
 		}
 	}
+	DecorateCacheEnd();
+
 	if (dump != NULL)
 	{
 		fprintf(dump, "\n*************************************************************************\n%i code bytes\n", codesize * 4);
@@ -426,6 +450,7 @@ void LoadActors ()
 	timer.Reset(); timer.Clock();
 	ActorDamageFuncs.Clear();
 	FScriptPosition::ResetErrorCounter();
+	DecorateCacheInit();
 	InitThingdef();
 	lastlump = 0;
 	while ((lump = Wads.FindLump ("DECORATE", &lastlump)) != -1)
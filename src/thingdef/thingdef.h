@@ -185,6 +185,19 @@ struct AFuncDesc
 
 AFuncDesc *FindFunction(const char * string);
 
+//==========================================================================
+//
+// Compiled code cache
+//
+//==========================================================================
+
+void DecorateCacheInit();
+void DecorateCacheAddLump(int lump);
+void DecorateCacheBegin();
+VMScriptFunction *DecorateCacheFind(const FString &slot);
+void DecorateCacheAdd(const FString &slot, VMScriptFunction *func, bool cacheable = true);
+void DecorateCacheEnd();
+
 
 void ParseStates(FScanner &sc, PClassActor *actor, AActor *defaults, Baggage &bag);
 void ParseFunctionParameters(FScanner &sc, PClassActor *cls, TArray<FxExpression *> &out_params,
@@ -0,0 +1,772 @@
+/*
+** thingdef_cache.cpp
+** On-disk cache for the VM code compiled from DECORATE
+**
+**---------------------------------------------------------------------------
+** Copyright 2016 The ZDoom Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+
+#include <zlib.h>
+
+#include "doomtype.h"
+#include "actor.h"
+#include "info.h"
+#include "c_cvars.h"
+#include "cmdlib.h"
+#include "m_misc.h"
+#include "m_random.h"
+#include "md5.h"
+#include "s_sound.h"
+#include "sc_man.h"
+#include "version.h"
+#include "w_wad.h"
+#include "thingdef.h"
+#include "thingdef_exp.h"
+#include "vm.h"
+
+// MACROS ------------------------------------------------------------------
+
+#define CACHE_MAGIC		"ZDC2"
+#define MAX_CACHE_SIZE	(64*1024*1024)
+
+// TYPES -------------------------------------------------------------------
+
+typedef TArray<BYTE> MemFile;
+
+// How a constant address is found again when the cache is loaded.
+enum
+{
+	KONSTA_Null,
+	KONSTA_Class,		// by type name
+	KONSTA_Native,		// by action function name
+	KONSTA_Builtin,		// by decorate utility function name
+	KONSTA_State,		// by owning class and index into its OwnedStates
+	KONSTA_RNG,			// by name CRC
+};
+
+struct FCachedFunction
+{
+	FString Slot;
+	VMScriptFunction *Func;
+	bool Cacheable;
+};
+
+struct FCacheReader
+{
+	const BYTE *Data;
+	unsigned int Size;
+	unsigned int Pos;
+	bool Failed;
+
+	bool Need(unsigned int len)
+	{
+		if (Failed || Size - Pos < len)
+		{
+			Failed = true;
+			return false;
+		}
+		return true;
+	}
+	BYTE ReadByte()
+	{
+		return Need(1) ? Data[Pos++] : 0;
+	}
+	WORD ReadWord()
+	{
+		if (!Need(2)) return 0;
+		WORD v = Data[Pos] | (Data[Pos+1] << 8);
+		Pos += 2;
+		return v;
+	}
+	DWORD ReadLong()
+	{
+		if (!Need(4)) return 0;
+		DWORD v = Data[Pos] | (Data[Pos+1] << 8) | (Data[Pos+2] << 16) | ((DWORD)Data[Pos+3] << 24);
+		Pos += 4;
+		return v;
+	}
+	FString ReadString()
+	{
+		DWORD len = ReadLong();
+		if (!Need(len)) return FString();
+		FString str((const char *)Data + Pos, len);
+		Pos += len;
+		return str;
+	}
+};
+
+// PUBLIC DATA DEFINITIONS -------------------------------------------------
+
+CVAR(Bool, decorate_cache, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
+// PRIVATE DATA DEFINITIONS ------------------------------------------------
+
+static MD5Context LumpHash;
+static BYTE LumpKey[16];
+static BYTE EngineKey[16];
+static int NamesBefore;
+static int ErrorsBefore;
+
+static MemFile CacheData;
+static FCacheReader Reader;
+static bool Reading;
+static unsigned int EntriesLeft;
+
+static TArray<FCachedFunction> Compiled;
+
+// CODE --------------------------------------------------------------------
+
+//==========================================================================
+//
+// Writing helpers
+//
+//==========================================================================
+
+static void WriteByte(MemFile &f, BYTE b)
+{
+	f.Push(b);
+}
+
+static void WriteWord(MemFile &f, WORD b)
+{
+	int v = f.Reserve(2);
+	f[v] = (BYTE)b;
+	f[v+1] = (BYTE)(b>>8);
+}
+
+static void WriteLong(MemFile &f, DWORD b)
+{
+	int v = f.Reserve(4);
+	f[v] = (BYTE)b;
+	f[v+1] = (BYTE)(b>>8);
+	f[v+2] = (BYTE)(b>>16);
+	f[v+3] = (BYTE)(b>>24);
+}
+
+static void WriteString(MemFile &f, const char *str)
+{
+	DWORD len = (DWORD)strlen(str);
+	WriteLong(f, len);
+	if (len > 0)
+	{
+		memcpy(&f[f.Reserve(len)], str, len);
+	}
+}
+
+//==========================================================================
+//
+// CreateCacheName
+//
+// One file per set of DECORATE lumps, so switching between mods doesn't
+// throw away the other mods' caches.
+//
+//==========================================================================
+
+static FString CreateCacheName(bool create)
+{
+	FString path = M_GetCachePath(create);
+	path << "/decorate";
+	if (create) CreatePath(path);
+
+	path << '/';
+	for (int i = 0; i < 16; ++i)
+	{
+		path.AppendFormat("%02x", LumpKey[i]);
+	}
+	path << ".zdc";
+	return path;
+}
+
+//==========================================================================
+//
+// WriteAddress
+//
+// Returns false for anything that can't be found again by name, in
+// which case the function is left out of the cache.
+//
+//==========================================================================
+
+static bool WriteAddress(MemFile &f, void *ptr, VM_ATAG tag)
+{
+	if (ptr == NULL)
+	{
+		WriteByte(f, KONSTA_Null);
+		return true;
+	}
+	if (tag == ATAG_OBJECT)
+	{
+		DObject *obj = (DObject *)ptr;
+		PClass *cls = dyn_cast<PClass>(obj);
+		if (cls != NULL)
+		{
+			WriteByte(f, KONSTA_Class);
+			WriteString(f, cls->TypeName.GetChars());
+			return true;
+		}
+		VMFunction *func = dyn_cast<VMFunction>(obj);
+		if (func != NULL && func->Native)
+		{
+			AFuncDesc *desc = FindFunction(func->Name.GetChars());
+			if (desc != NULL && *desc->VMPointer == func)
+			{
+				WriteByte(f, KONSTA_Native);
+				WriteString(f, desc->Name);
+				return true;
+			}
+			if (FindDecorateBuiltin(func->Name) == func)
+			{
+				WriteByte(f, KONSTA_Builtin);
+				WriteString(f, func->Name.GetChars());
+				return true;
+			}
+		}
+	}
+	else if (tag == ATAG_STATE)
+	{
+		FState *state = (FState *)ptr;
+		PClassActor *owner = FState::StaticFindStateOwner(state);
+		if (owner != NULL)
+		{
+			WriteByte(f, KONSTA_State);
+			WriteString(f, owner->TypeName.GetChars());
+			WriteLong(f, DWORD(state - owner->OwnedStates));
+			return true;
+		}
+	}
+	else if (tag == ATAG_RNG)
+	{
+		DWORD crc = ((FRandom *)ptr)->GetNameCRC();
+		if (crc != 0)
+		{
+			WriteByte(f, KONSTA_RNG);
+			WriteLong(f, crc);
+			return true;
+		}
+	}
+	return false;
+}
+
+//==========================================================================
+//
+// ReadAddress
+//
+//==========================================================================
+
+static bool ReadAddress(FCacheReader &r, void *&ptr)
+{
+	ptr = NULL;
+	switch (r.ReadByte())
+	{
+	case KONSTA_Null:
+		return !r.Failed;
+
+	case KONSTA_Class:
+	{
+		FString name = r.ReadString();
+		ptr = PClass::FindClass(name);
+		break;
+	}
+
+	case KONSTA_Native:
+	{
+		FString name = r.ReadString();
+		AFuncDesc *desc = FindFunction(name);
+		if (desc != NULL)
+		{
+			ptr = *desc->VMPointer;
+		}
+		break;
+	}
+
+	case KONSTA_Builtin:
+	{
+		FName name(r.ReadString(), true);
+		if (name != NAME_None)
+		{
+			ptr = FindDecorateBuiltin(name);
+		}
+		break;
+	}
+
+	case KONSTA_State:
+	{
+		FString name = r.ReadString();
+		DWORD index = r.ReadLong();
+		PClassActor *owner = PClass::FindActor(name);
+		if (owner != NULL && index < (DWORD)owner->NumOwnedStates)
+		{
+			ptr = owner->OwnedStates + index;
+		}
+		break;
+	}
+
+	case KONSTA_RNG:
+		ptr = FRandom::StaticFindRNGByCRC(r.ReadLong());
+		break;
+	}
+	return !r.Failed && ptr != NULL;
+}
+
+//==========================================================================
+//
+// WriteFunction
+//
+//==========================================================================
+
+static bool WriteFunction(MemFile &f, VMScriptFunction *func)
+{
+	int i;
+
+	WriteLong(f, func->CodeSize);
+	WriteByte(f, func->NumRegD);
+	WriteByte(f, func->NumRegF);
+	WriteByte(f, func->NumRegS);
+	WriteByte(f, func->NumRegA);
+	WriteByte(f, func->NumKonstD);
+	WriteByte(f, func->NumKonstF);
+	WriteByte(f, func->NumKonstS);
+	WriteByte(f, func->NumKonstA);
+	WriteWord(f, func->MaxParam);
+	WriteByte(f, func->NumArgs);
+	WriteLong(f, func->ExtraSpace);
+
+	for (i = 0; i < func->CodeSize; ++i)
+	{
+		DWORD op;
+		memcpy(&op, &func->Code[i], 4);
+		WriteLong(f, op);
+	}
+	for (i = 0; i < func->NumKonstD; ++i)
+	{
+		WriteLong(f, func->KonstD[i]);
+	}
+	for (i = 0; i < func->NumKonstF; ++i)
+	{
+		QWORD bits;
+		memcpy(&bits, &func->KonstF[i], 8);
+		WriteLong(f, DWORD(bits));
+		WriteLong(f, DWORD(bits >> 32));
+	}
+	for (i = 0; i < func->NumKonstS; ++i)
+	{
+		WriteString(f, func->KonstS[i]);
+	}
+	for (i = 0; i < func->NumKonstA; ++i)
+	{
+		VM_ATAG tag = func->KonstATags()[i];
+		WriteByte(f, tag);
+		if (!WriteAddress(f, func->KonstA[i].v, tag))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// ReadFunction
+//
+//==========================================================================
+
+static VMScriptFunction *ReadFunction(FCacheReader &r)
+{
+	int i;
+
+	int codesize = r.ReadLong();
+	BYTE numregs[4], numkonst[4];
+	for (i = 0; i < 4; ++i) numregs[i] = r.ReadByte();
+	for (i = 0; i < 4; ++i) numkonst[i] = r.ReadByte();
+	WORD maxparam = r.ReadWord();
+	BYTE numargs = r.ReadByte();
+	int extraspace = r.ReadLong();
+
+	if (r.Failed || codesize <= 0 || !r.Need(codesize * 4))
+	{
+		return NULL;
+	}
+
+	VMScriptFunction *func = new VMScriptFunction;
+	func->Alloc(codesize, numkonst[0], numkonst[1], numkonst[2], numkonst[3]);
+	func->NumRegD = numregs[0];
+	func->NumRegF = numregs[1];
+	func->NumRegS = numregs[2];
+	func->NumRegA = numregs[3];
+	func->MaxParam = maxparam;
+	func->NumArgs = numargs;
+	func->ExtraSpace = extraspace;
+
+	for (i = 0; i < codesize; ++i)
+	{
+		DWORD op = r.ReadLong();
+		memcpy(&func->Code[i], &op, 4);
+	}
+	for (i = 0; i < func->NumKonstD; ++i)
+	{
+		func->KonstD[i] = r.ReadLong();
+	}
+	for (i = 0; i < func->NumKonstF; ++i)
+	{
+		QWORD bits = r.ReadLong();
+		bits |= (QWORD)r.ReadLong() << 32;
+		memcpy(&func->KonstF[i], &bits, 8);
+	}
+	for (i = 0; i < func->NumKonstS; ++i)
+	{
+		func->KonstS[i] = r.ReadString();
+	}
+	for (i = 0; i < func->NumKonstA; ++i)
+	{
+		func->KonstATags()[i] = r.ReadByte();
+		if (!ReadAddress(r, func->KonstA[i].v))
+		{
+			break;
+		}
+	}
+	if (r.Failed || i < func->NumKonstA)
+	{
+		// Nothing else knows about it yet.
+		func->Destroy();
+		return NULL;
+	}
+	return func;
+}
+
+//==========================================================================
+//
+// LoadCache
+//
+//==========================================================================
+
+static bool LoadCache()
+{
+	char magic[4];
+	BYTE keys[32];
+	DWORD packedlen, unpackedlen;
+
+	FString path = CreateCacheName(false);
+	FILE *f = fopen(path, "rb");
+	if (f == NULL) return false;
+
+	bool ok = fread(magic, 1, 4, f) == 4 && memcmp(magic, CACHE_MAGIC, 4) == 0 &&
+		fread(keys, 1, 32, f) == 32 && memcmp(keys, LumpKey, 16) == 0 && memcmp(keys + 16, EngineKey, 16) == 0 &&
+		fread(&unpackedlen, 4, 1, f) == 1 && fread(&packedlen, 4, 1, f) == 1;
+
+	if (ok)
+	{
+		unpackedlen = LittleLong(unpackedlen);
+		packedlen = LittleLong(packedlen);
+		// Check the sizes before allocating anything for them.
+		ok = unpackedlen > 0 && unpackedlen <= MAX_CACHE_SIZE &&
+			packedlen > 0 && packedlen <= compressBound(unpackedlen);
+	}
+	if (ok)
+	{
+		TArray<BYTE> packed(packedlen);
+		packed.Resize(packedlen);
+		CacheData.Resize(unpackedlen);
+		uLongf outlen = unpackedlen;
+		ok = fread(&packed[0], 1, packedlen, f) == packedlen &&
+			uncompress(&CacheData[0], &outlen, &packed[0], packedlen) == Z_OK && outlen == unpackedlen;
+	}
+	fclose(f);
+	if (!ok)
+	{
+		CacheData.Clear();
+		return false;
+	}
+
+	Reader.Data = &CacheData[0];
+	Reader.Size = CacheData.Size();
+	Reader.Pos = 0;
+	Reader.Failed = false;
+
+	// Names the compiler created last time have to get the same indices
+	// again, since they can be baked into the code as immediates.
+	DWORD numnames = Reader.ReadLong();
+	for (DWORD i = 0; i < numnames && !Reader.Failed; ++i)
+	{
+		FName name(Reader.ReadString());
+		if (name.GetIndex() != NamesBefore + (int)i)
+		{
+			Reader.Failed = true;
+		}
+	}
+	EntriesLeft = Reader.ReadLong();
+	return !Reader.Failed;
+}
+
+//==========================================================================
+//
+// SaveCache
+//
+//==========================================================================
+
+static void SaveCache()
+{
+	MemFile data;
+	int numnames = FName::GetNumNames();
+
+	WriteLong(data, numnames - NamesBefore);
+	for (int i = NamesBefore; i < numnames; ++i)
+	{
+		WriteString(data, FName(ENamedName(i)).GetChars());
+	}
+	WriteLong(data, Compiled.Size());
+	for (unsigned i = 0; i < Compiled.Size(); ++i)
+	{
+		WriteString(data, Compiled[i].Slot);
+		unsigned int start = data.Size();
+		WriteByte(data, 1);
+		if (!Compiled[i].Cacheable)
+		{
+			// Compile it again next time so that its warnings are shown.
+			data.Resize(start);
+			WriteByte(data, 0);
+		}
+		else if (!WriteFunction(data, Compiled[i].Func))
+		{
+			// Mark it so that just this one gets compiled when the cache is loaded.
+			DPrintf("%s references something that cannot be cached\n", Compiled[i].Slot.GetChars());
+			data.Resize(start);
+			WriteByte(data, 0);
+		}
+	}
+
+	if (data.Size() > MAX_CACHE_SIZE)
+	{
+		return;
+	}
+
+	uLongf outlen = compressBound(data.Size());
+	TArray<BYTE> packed(outlen);
+	packed.Resize(outlen);
+	if (compress(&packed[0], &outlen, &data[0], data.Size()) != Z_OK)
+	{
+		return;
+	}
+
+	FString path = CreateCacheName(true);
+	FILE *f = fopen(path, "wb");
+	if (f == NULL)
+	{
+		Printf("Cannot open DECORATE cache %s for writing\n", path.GetChars());
+		return;
+	}
+	DWORD unpackedlen = LittleLong(data.Size());
+	DWORD packedlen = LittleLong(DWORD(outlen));
+	if (fwrite(CACHE_MAGIC, 1, 4, f) != 4 || fwrite(LumpKey, 1, 16, f) != 16 || fwrite(EngineKey, 1, 16, f) != 16 ||
+		fwrite(&unpackedlen, 4, 1, f) != 1 || fwrite(&packedlen, 4, 1, f) != 1 ||
+		fwrite(&packed[0], 1, outlen, f) != outlen)
+	{
+		Printf("Error saving DECORATE cache to %s\n", path.GetChars());
+		fclose(f);
+		remove(path);
+		return;
+	}
+	fclose(f);
+}
+
+//==========================================================================
+//
+// DecorateCacheInit
+//
+// Called before any DECORATE is parsed.
+//
+//==========================================================================
+
+void DecorateCacheInit()
+{
+	LumpHash.Init();
+}
+
+//==========================================================================
+//
+// DecorateCacheAddLump
+//
+// Adds a lump's name and contents to the cache key. Called for every
+// DECORATE lump, including ones that are #included.
+//
+//==========================================================================
+
+void DecorateCacheAddLump(int lump)
+{
+	if (!decorate_cache || lump < 0)
+	{
+		return;
+	}
+	FString name = Wads.GetLumpFullPath(lump);
+	LumpHash.Update((const BYTE *)name.GetChars(), name.Len() + 1);
+	FMemLump mem = Wads.ReadLump(lump);
+	LumpHash.Update((const BYTE *)mem.GetMem(), Wads.LumpLength(lump));
+}
+
+//==========================================================================
+//
+// DecorateCacheBegin
+//
+// Called once all DECORATE has been parsed and before any of it is
+// compiled. Loads the cache if one matches.
+//
+// Besides the lumps themselves, the code depends on the engine build and
+// on name and sound indices, which are baked into it as plain integers.
+// Those are checked by hashing both tables as they are right now.
+//
+//==========================================================================
+
+void DecorateCacheBegin()
+{
+	Compiled.Clear();
+	Reading = false;
+	EntriesLeft = 0;
+	NamesBefore = FName::GetNumNames();
+	ErrorsBefore = FScriptPosition::ErrorCounter;
+
+	if (!decorate_cache)
+	{
+		return;
+	}
+
+	LumpHash.Final(LumpKey);
+
+	MD5Context md5;
+	const char *version = GetVersionString();
+	const char *hash = GetGitHash();
+	DWORD ptrsize = sizeof(void *);
+	md5.Update((const BYTE *)version, (unsigned)strlen(version) + 1);
+	md5.Update((const BYTE *)hash, (unsigned)strlen(hash) + 1);
+	md5.Update((const BYTE *)&ptrsize, sizeof(ptrsize));
+	for (int i = 0; i < NamesBefore; ++i)
+	{
+		const char *name = FName(ENamedName(i)).GetChars();
+		md5.Update((const BYTE *)name, (unsigned)strlen(name) + 1);
+	}
+	for (unsigned i = 0; i < S_sfx.Size(); ++i)
+	{
+		md5.Update((const BYTE *)S_sfx[i].name.GetChars(), S_sfx[i].name.Len() + 1);
+	}
+	md5.Final(EngineKey);
+
+	Reading = LoadCache();
+	if (Reading)
+	{
+		DPrintf("Using DECORATE cache %s\n", CreateCacheName(false).GetChars());
+	}
+	else
+	{
+		CacheData.Clear();
+	}
+}
+
+//==========================================================================
+//
+// DecorateCacheFind
+//
+// Returns the cached code for the next function to be compiled, or NULL
+// if it has to be compiled. Functions must be requested in the same order
+// they were compiled in. Functions that could not be cached are compiled
+// every time without affecting the rest. Once anything fails to match,
+// the rest of the cache is ignored.
+//
+//==========================================================================
+
+VMScriptFunction *DecorateCacheFind(const FString &slot)
+{
+	if (!Reading)
+	{
+		return NULL;
+	}
+
+	VMScriptFunction *func = NULL;
+	if (EntriesLeft > 0)
+	{
+		EntriesLeft--;
+		FString cached = Reader.ReadString();
+		if (!Reader.Failed && cached.Compare(slot) == 0)
+		{
+			BYTE present = Reader.ReadByte();
+			if (!Reader.Failed && !present)
+			{
+				return NULL;
+			}
+			func = ReadFunction(Reader);
+		}
+	}
+	if (func == NULL)
+	{
+		DPrintf("DECORATE cache does not match at %s\n", slot.GetChars());
+		Reading = false;
+		CacheData.Clear();
+	}
+	return func;
+}
+
+//==========================================================================
+//
+// DecorateCacheAdd
+//
+// Records a function, whether compiled or taken from the cache, so the
+// cache can be rewritten if it turned out to be stale. Functions that
+// produced warnings when compiled are recorded as not cacheable.
+//
+//==========================================================================
+
+void DecorateCacheAdd(const FString &slot, VMScriptFunction *func, bool cacheable)
+{
+	if (decorate_cache)
+	{
+		FCachedFunction entry = { slot, func, cacheable };
+		Compiled.Push(entry);
+	}
+}
+
+//==========================================================================
+//
+// DecorateCacheEnd
+//
+// Writes a new cache unless everything came from the old one or there
+// were errors.
+//
+//==========================================================================
+
+void DecorateCacheEnd()
+{
+	bool complete = Reading && EntriesLeft == 0;
+
+	if (decorate_cache && !complete && FScriptPosition::ErrorCounter == ErrorsBefore)
+	{
+		SaveCache();
+	}
+	Reading = false;
+	CacheData.Clear();
+	CacheData.ShrinkToFit();
+	Compiled.Clear();
+	Compiled.ShrinkToFit();
+}
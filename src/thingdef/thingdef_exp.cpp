@@ -276,7 +276,7 @@ static FxExpression *ParseExpressionA (FScanner &sc, PClassActor *cls)
 			}
 			sc.MustGetToken(TK_Identifier);
 
-			FName FieldName = sc.String;
+			FName FieldName = sc.ViewName();
 			pos = sc;
 			/* later!
 			if (SC_CheckToken('('))
@@ -344,7 +344,7 @@ static FxExpression *ParseExpression0 (FScanner &sc, PClassActor *cls)
 		// done at a higher level, as needed, but since no functions take string
 		// arguments and ACS_NamedExecuteWithResult/CallACS need names, this is
 		// a cheap way to get them working when people use "name" instead of 'name'.
-		return new FxConstant(FName(sc.String), scpos);
+		return new FxConstant(sc.ViewName(), scpos);
 	}
 	else if (sc.CheckToken(TK_Random))
 	{
@@ -457,7 +457,7 @@ static FxExpression *ParseExpression0 (FScanner &sc, PClassActor *cls)
 	}
 	else if (sc.CheckToken(TK_Identifier))
 	{
-		FName identifier = FName(sc.String);
+		FName identifier = sc.ViewName();
 		if (sc.CheckToken('('))
 		{
 			FArgumentList *args = new FArgumentList;
@@ -985,6 +985,7 @@ public:
 
 
 FxExpression *ParseExpression (FScanner &sc, PClassActor *cls);
+VMFunction *FindDecorateBuiltin(FName funcname);
 
 
 #endif
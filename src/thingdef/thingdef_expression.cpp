@@ -3878,3 +3878,37 @@ ExpEmit FxDamageValue::Emit(VMFunctionBuilder *build)
 
 	return ExpEmit();
 }
+
+//==========================================================================
+//
+// FindDecorateBuiltin
+//
+// Returns the function for a decorate utility function by name, creating
+// it if nothing has been compiled that uses it yet. Returns NULL if there
+// is no utility function with that name.
+//
+//==========================================================================
+
+VMFunction *FindDecorateBuiltin(FName funcname)
+{
+	static const struct { ENamedName Name; VMNativeFunction::NativeCallType Func; } builtins[] =
+	{
+		{ NAME_DecoRandom,					DecoRandom },
+		{ NAME_DecoFRandom,					DecoFRandom },
+		{ NAME_DecoCallLineSpecial,			DecoCallLineSpecial },
+		{ NAME_DecoNameToClass,				DecoNameToClass },
+		{ NAME_DecoFindMultiNameState,		DecoFindMultiNameState },
+		{ NAME_DecoFindSingleNameState,		DecoFindSingleNameState },
+	};
+
+	for (size_t i = 0; i < countof(builtins); ++i)
+	{
+		if (funcname == builtins[i].Name)
+		{
+			PSymbol *sym = FindDecorateBuiltinFunction(builtins[i].Name, builtins[i].Func);
+			assert(sym->IsKindOf(RUNTIME_CLASS(PSymbolVMFunction)));
+			return ((PSymbolVMFunction *)sym)->Function;
+		}
+	}
+	return NULL;
+}
@@ -108,7 +108,7 @@ FxExpression *ParseParameter(FScanner &sc, PClassActor *cls, PType *type, bool c
 		sc.SetEscape(false);
 		if (type == TypeName)
 		{
-			x = new FxConstant(sc.String[0] ? FName(sc.String) : NAME_None, sc);
+			x = new FxConstant(sc.String[0] ? sc.ViewName() : NAME_None, sc);
 		}
 		else
 		{
@@ -163,7 +163,7 @@ FxExpression *ParseParameter(FScanner &sc, PClassActor *cls, PType *type, bool c
 		sc.SetEscape(true);
 		sc.MustGetString();
 		sc.SetEscape(false);
-		x = new FxClassTypeCast(static_cast<PClassPointer *>(type)->ClassRestriction, new FxConstant(FName(sc.String), sc));
+		x = new FxClassTypeCast(static_cast<PClassPointer *>(type)->ClassRestriction, new FxConstant(sc.ViewName(), sc));
 	}
 	else
 	{
@@ -188,7 +188,7 @@ static void ParseConstant (FScanner &sc, PSymbolTable *symt, PClassActor *cls)
 	{
 		int type = sc.TokenType;
 		sc.MustGetToken(TK_Identifier);
-		FName symname = sc.String;
+		FName symname = sc.ViewName();
 		sc.MustGetToken('=');
 		FxExpression *expr = ParseExpression (sc, cls);
 		sc.MustGetToken(';');
@@ -245,7 +245,7 @@ static void ParseEnum (FScanner &sc, PSymbolTable *symt, PClassActor *cls)
 	while (!sc.CheckToken('}'))
 	{
 		sc.MustGetToken(TK_Identifier);
-		FName symname = sc.String;
+		FName symname = sc.ViewName();
 		if (sc.CheckToken('='))
 		{
 			FxExpression *expr = ParseExpression (sc, cls);
@@ -523,7 +523,7 @@ static void ParseUserVariable (FScanner &sc, PSymbolTable *symt, PClassActor *cl
 		FScriptPosition::ErrorCounter++;
 	}
 
-	FName symname = sc.String;
+	FName symname = sc.ViewName();
 
 	// We must ensure that we do not define duplicates, even when they come from a parent table.
 	if (symt->FindSymbol(symname, true) != NULL)
@@ -733,7 +733,7 @@ static FState *CheckState(FScanner &sc, PClass *type)
 
 			if (info != NULL)
 			{
-				state = info->FindState(FName(sc.String));
+				state = info->FindState(sc.ViewName());
 			}
 
 			if (sc.GetString ())
@@ -1277,6 +1277,9 @@ static void ParseDamageDefinition(FScanner &sc)
 
 void ParseDecorate (FScanner &sc)
 {
+	DecorateCacheAddLump(sc.LumpNum);
+	sc.SetViewMode(true);
+
 	// Get actor class name.
 	for(;;)
 	{
@@ -430,7 +430,7 @@ FxVMFunctionCall *ParseAction(FScanner &sc, FState state, FString statestring, B
 		return call;
 	}
 
-	PFunction *afd = dyn_cast<PFunction>(bag.Info->Symbols.FindSymbol(FName(sc.String, true), true));
+	PFunction *afd = dyn_cast<PFunction>(bag.Info->Symbols.FindSymbol(sc.ViewName(true), true));
 	if (afd != NULL)
 	{
 		FArgumentList *args = new FArgumentList;
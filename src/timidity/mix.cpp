@@ -426,60 +426,32 @@ static int update_signal(Voice *v)
 	return 0;
 }
 
-static void mix_mystery_signal(SDWORD control_ratio, const sample_t *sp, float *lp, Voice *v, int count)
+/* Adds count samples of sp, scaled by left and right, to the interleaved
+   stereo buffer at lp. A gain of 0 leaves that channel untouched. */
+static void mix_span(const sample_t *sp, float *lp, final_volume_t left, final_volume_t right, int count)
 {
-	final_volume_t 
-		left = v->left_mix, 
-		right = v->right_mix;
-	int cc;
-	sample_t s;
-
-	if (!(cc = v->control_counter))
+#ifdef TIMIDITY_SSE2
+	if (count >= 4 && sse2_available())
 	{
-		cc = control_ratio;
-		if (update_signal(v))
-			return;	/* Envelope ran out */
-
-		left = v->left_mix;
-		right = v->right_mix;
+		mix_stereo_sse2(sp, lp, left, right, count);
+		return;
 	}
-
-	while (count)
+#endif
+	while (count--)
 	{
-		if (cc < count)
-		{
-			count -= cc;
-			while (cc--)
-			{
-				s = *sp++;
-				lp[0] += left * s;
-				lp[1] += right * s;
-				lp += 2;
-			}
-			cc = control_ratio;
-			if (update_signal(v))
-				return;	/* Envelope ran out */
-			left = v->left_mix;
-			right = v->right_mix;
-		}
-		else
-		{
-			v->control_counter = cc - count;
-			while (count--)
-			{
-				s = *sp++;
-				lp[0] += left * s;
-				lp[1] += right * s;
-				lp += 2;
-			}
-			return;
-		}
+		sample_t s = *sp++;
+		lp[0] += left * s;
+		lp[1] += right * s;
+		lp += 2;
 	}
 }
 
-static void mix_single_signal(SDWORD control_ratio, const sample_t *sp, float *lp, Voice *v, float *ampat, int count)
+/* Mixes a voice whose envelope or tremolo is still changing. The volume
+   is updated every control_ratio samples, and each run between updates
+   is mixed in one go. chan is 0 or 1 to only mix into the left or right
+   channel, or -1 to mix into both. */
+static void mix_signal(SDWORD control_ratio, const sample_t *sp, float *lp, Voice *v, int chan, int count)
 {
-	final_volume_t amp;
 	int cc;
 
 	if (0 == (cc = v->control_counter))
@@ -488,131 +460,32 @@ static void mix_single_signal(SDWORD control_ratio, const sample_t *sp, float *l
 		if (update_signal(v))
 			return;		/* Envelope ran out */
 	}
-	amp = *ampat;
 
 	while (count)
 	{
-		if (cc < count)
-		{
-			count -= cc;
-			while (cc--)
-			{
-				lp[0] += *sp++ * amp;
-				lp += 2;
-			}
-			cc = control_ratio;
-			if (update_signal(v))
-				return;	/* Envelope ran out */
-			amp = *ampat;
-		}
-		else
-		{
-			v->control_counter = cc - count;
-			while (count--)
-			{
-				lp[0] += *sp++ * amp;
-				lp += 2;
-			}
-			return;
-		}
-	}
-}
-
-static void mix_single_left_signal(SDWORD control_ratio, const sample_t *sp, float *lp, Voice *v, int count)
-{
-	mix_single_signal(control_ratio, sp, lp, v, &v->left_mix, count);
-}
-
-static void mix_single_right_signal(SDWORD control_ratio, const sample_t *sp, float *lp, Voice *v, int count)
-{
-	mix_single_signal(control_ratio, sp, lp + 1, v, &v->right_mix, count);
-}
+		final_volume_t 
+			left = chan == 1 ? 0 : v->left_mix,
+			right = chan == 0 ? 0 : v->right_mix;
 
-static void mix_mono_signal(SDWORD control_ratio, const sample_t *sp, float *lp, Voice *v, int count)
-{
-	final_volume_t 
-		left = v->left_mix;
-	int cc;
-
-	if (!(cc = v->control_counter))
-	{
-		cc = control_ratio;
-		if (update_signal(v))
-			return;	/* Envelope ran out */
-		left = v->left_mix;
-	}
-
-	while (count)
-	{
 		if (cc < count)
 		{
 			count -= cc;
-			while (cc--)
-			{
-				*lp++ += *sp++ * left;
-			}
+			mix_span(sp, lp, left, right, cc);
+			sp += cc;
+			lp += cc * 2;
 			cc = control_ratio;
 			if (update_signal(v))
 				return;	/* Envelope ran out */
-			left = v->left_mix;
 		}
 		else
 		{
 			v->control_counter = cc - count;
-			while (count--)
-			{
-				*lp++ += *sp++ * left;
-			}
+			mix_span(sp, lp, left, right, count);
 			return;
 		}
 	}
 }
 
-static void mix_mystery(SDWORD control_ratio, const sample_t *sp, float *lp, Voice *v, int count)
-{
-	final_volume_t 
-		left = v->left_mix, 
-		right = v->right_mix;
-	sample_t s;
-
-	while (count--)
-	{
-		s = *sp++;
-		lp[0] += s * left;
-		lp[1] += s * right;
-		lp += 2;
-	}
-}
-
-static void mix_single(const sample_t *sp, float *lp, final_volume_t amp, int count)
-{
-	while (count--)
-	{
-		lp[0] += *sp++ * amp;
-		lp += 2;
-	}
-}
-
-static void mix_single_left(const sample_t *sp, float *lp, Voice *v, int count)
-{
-	mix_single(sp, lp, v->left_mix, count);
-}
-static void mix_single_right(const sample_t *sp, float *lp, Voice *v, int count)
-{
-	mix_single(sp, lp + 1, v->right_mix, count);
-}
-
-static void mix_mono(const sample_t *sp, float *lp, Voice *v, int count)
-{
-	final_volume_t 
-		left = v->left_mix;
-
-	while (count--)
-	{
-		*lp++ += *sp++ * left;
-	}
-}
-
 /* Ramp a note out in c samples */
 static void ramp_out(const sample_t *sp, float *lp, Voice *v, int c)
 {
@@ -709,6 +582,7 @@ void mix_voice(Renderer *song, float *buf, Voice *v, int c)
 		sp = resample_voice(song, v, &count);
 		ramp_out(sp, buf, v, count);
 		v->status = 0;
+		song->voice_samples += count;
 	}
 	else
 	{
@@ -717,40 +591,30 @@ void mix_voice(Renderer *song, float *buf, Voice *v, int c)
 		{
 			return;
 		}
+		int chan;
+
 		if (v->right_mix == 0)			// All the way to the left
 		{
-			if (v->eg1.env.bUpdating || v->tremolo_phase_increment != 0)
-			{
-				mix_single_left_signal(song->control_ratio, sp, buf, v, count);
-			}
-			else
-			{
-				mix_single_left(sp, buf, v, count);
-			}
+			chan = 0;
 		}
 		else if (v->left_mix == 0)		// All the way to the right
 		{
-			if (v->eg1.env.bUpdating || v->tremolo_phase_increment != 0)
-			{
-				mix_single_right_signal(song->control_ratio, sp, buf, v, count);
-			}
-			else
-			{
-				mix_single_right(sp, buf, v, count);
-			}
+			chan = 1;
 		}
 		else							// Somewhere in the middle
 		{
-			if (v->eg1.env.bUpdating || v->tremolo_phase_increment)
-			{
-				mix_mystery_signal(song->control_ratio, sp, buf, v, count);
-			}
-			else
-			{
-				mix_mystery(song->control_ratio, sp, buf, v, count);
-			}
+			chan = -1;
+		}
+		if (v->eg1.env.bUpdating || v->tremolo_phase_increment != 0)
+		{
+			mix_signal(song->control_ratio, sp, buf, v, chan, count);
+		}
+		else
+		{
+			mix_span(sp, buf, chan == 1 ? 0 : v->left_mix, chan == 0 ? 0 : v->right_mix, count);
 		}
 		v->sample_count += count;
+		song->voice_samples += count;
 	}
 }
 
@@ -0,0 +1,115 @@
+/*
+
+	TiMidity -- Experimental MIDI to WAVE converter
+	Copyright (C) 1995 Tuukka Toivonen <toivonen@clinet.fi>
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+	mix_sse2.c
+
+	SSE2 versions of the inner resampling and mixing loops. Like x86.cpp,
+	this file is compiled with SSE2 enabled on 32-bit targets, so callers
+	must check sse2_available() before using anything in here.
+
+*/
+
+#include "timidity.h"
+#include "x86.h"
+
+#ifdef TIMIDITY_SSE2
+
+#include <emmintrin.h>
+
+namespace Timidity
+{
+
+bool sse2_available()
+{
+#if defined(__SSE2__) || defined(_M_X64)
+	return true;
+#else
+	return !!CPU.bSSE2;
+#endif
+}
+
+/* Linear interpolation with a fixed increment. Produces exactly the same
+   output as the RESAMPLATION macro in resample.cpp. The caller guarantees
+   that every position touched lies inside the sample data. */
+void resample_linear_sse2(sample_t *dest, const sample_t *src, int ofs, int incr, int count)
+{
+	const __m128 scale = _mm_set1_ps(1.f / (1 << FRACTION_BITS));
+	const __m128i fracmask = _mm_set1_epi32(FRACTION_MASK);
+	const __m128i step = _mm_set1_epi32(incr * 4);
+	__m128i pos = _mm_setr_epi32(ofs, ofs + incr, ofs + incr * 2, ofs + incr * 3);
+#ifdef _MSC_VER
+	__declspec(align(16)) int idx[4];
+	__declspec(align(16)) float a[4], b[4];
+#else
+	int idx[4] __attribute__((aligned(16)));
+	float a[4] __attribute__((aligned(16)));
+	float b[4] __attribute__((aligned(16)));
+#endif
+
+	for (; count >= 4; count -= 4)
+	{
+		_mm_store_si128((__m128i *)idx, _mm_srai_epi32(pos, FRACTION_BITS));
+		a[0] = src[idx[0]]; b[0] = src[idx[0] + 1];
+		a[1] = src[idx[1]]; b[1] = src[idx[1] + 1];
+		a[2] = src[idx[2]]; b[2] = src[idx[2] + 1];
+		a[3] = src[idx[3]]; b[3] = src[idx[3] + 1];
+
+		__m128 va = _mm_load_ps(a);
+		__m128 frac = _mm_cvtepi32_ps(_mm_and_si128(pos, fracmask));
+		__m128 delta = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(b), va), frac);
+		_mm_storeu_ps(dest, _mm_add_ps(va, _mm_mul_ps(delta, scale)));
+		dest += 4;
+		pos = _mm_add_epi32(pos, step);
+	}
+	ofs = _mm_cvtsi128_si32(pos);
+	while (count--)
+	{
+		int o = ofs >> FRACTION_BITS, m = ofs & FRACTION_MASK;
+		*dest++ = src[o] + (src[o + 1] - src[o]) * m / (1 << FRACTION_BITS);
+		ofs += incr;
+	}
+}
+
+/* Mixes a mono voice into an interleaved stereo buffer. */
+void mix_stereo_sse2(const sample_t *sp, float *lp, final_volume_t left, final_volume_t right, int count)
+{
+	const __m128 amp = _mm_setr_ps(left, right, left, right);
+
+	for (; count >= 4; count -= 4)
+	{
+		__m128 s = _mm_loadu_ps(sp);
+		__m128 lo = _mm_unpacklo_ps(s, s);
+		__m128 hi = _mm_unpackhi_ps(s, s);
+		_mm_storeu_ps(lp, _mm_add_ps(_mm_loadu_ps(lp), _mm_mul_ps(lo, amp)));
+		_mm_storeu_ps(lp + 4, _mm_add_ps(_mm_loadu_ps(lp + 4), _mm_mul_ps(hi, amp)));
+		sp += 4;
+		lp += 8;
+	}
+	while (count--)
+	{
+		sample_t s = *sp++;
+		lp[0] += s * left;
+		lp[1] += s * right;
+		lp += 2;
+	}
+}
+
+}
+
+#endif
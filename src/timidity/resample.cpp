@@ -39,6 +39,26 @@ namespace Timidity
 #define FINALINTERP if (ofs == le) *dest++ = src[ofs >> FRACTION_BITS];
 /* So it isn't interpolation. At least it's final. */
 
+/* Runs RESAMPLATION count times with a fixed increment, advancing dest
+   and ofs. The whole span must stay inside the sample data. */
+static inline sample_t *resample_span(sample_t *dest, const sample_t *src, int &ofs, int incr, int count)
+{
+#ifdef TIMIDITY_SSE2
+	if (count >= 4 && sse2_available())
+	{
+		resample_linear_sse2(dest, src, ofs, incr, count);
+		ofs += incr * count;
+		return dest + count;
+	}
+#endif
+	while (count--)
+	{
+		RESAMPLATION;
+		ofs += incr;
+	}
+	return dest;
+}
+
 /*************** resampling with fixed increment *****************/
 
 static sample_t *rs_plain(sample_t *resample_buffer, Voice *v, int *countptr)
@@ -73,11 +93,7 @@ static sample_t *rs_plain(sample_t *resample_buffer, Voice *v, int *countptr)
 		count -= i;
 	}
 
-	while (i--) 
-	{
-		RESAMPLATION;
-		ofs += incr;
-	}
+	dest = resample_span(dest, src, ofs, incr, i);
 
 	if (ofs >= le) 
 	{
@@ -122,11 +138,7 @@ static sample_t *rs_loop(sample_t *resample_buffer, Voice *vp, int count)
 		{
 			count -= i;
 		}
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		dest = resample_span(dest, src, ofs, incr, i);
 	}
 
 	vp->sample_offset=ofs; /* Update offset */
@@ -166,11 +178,7 @@ static sample_t *rs_bidir(sample_t *resample_buffer, Voice *vp, int count)
 		{
 			count -= i;
 		}
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		dest = resample_span(dest, src, ofs, incr, i);
 	}
 
 	/* Then do the bidirectional looping */
@@ -188,11 +196,7 @@ static sample_t *rs_bidir(sample_t *resample_buffer, Voice *vp, int count)
 		{
 			count -= i;
 		}
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		dest = resample_span(dest, src, ofs, incr, i);
 		if (ofs >= le) 
 		{
 			/* fold the overshoot back in */
@@ -361,11 +365,7 @@ static sample_t *rs_vib_loop(sample_t *resample_buffer, float rate, Voice *vp, i
 			cc -= i;
 		}
 		count -= i;
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		dest = resample_span(dest, src, ofs, incr, i);
 		if (vibflag) 
 		{
 			cc = vp->vibrato_control_ratio;
@@ -419,11 +419,7 @@ static sample_t *rs_vib_bidir(sample_t *resample_buffer, float rate, Voice *vp,
 			cc -= i;
 		}
 		count -= i;
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		dest = resample_span(dest, src, ofs, incr, i);
 		if (vibflag) 
 		{
 			cc = vp->vibrato_control_ratio;
@@ -452,11 +448,7 @@ static sample_t *rs_vib_bidir(sample_t *resample_buffer, float rate, Voice *vp,
 			cc -= i;
 		}
 		count -= i;
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		dest = resample_span(dest, src, ofs, incr, i);
 		if (vibflag) 
 		{
 			cc = vp->vibrato_control_ratio;
@@ -695,6 +695,7 @@ Renderer::Renderer(float sample_rate, const char *args)
 
 	lost_notes = 0;
 	cut_notes = 0;
+	voice_samples = 0;
 
 	default_instrument = NULL;
 	default_program = DEFAULT_PROGRAM;
@@ -373,6 +373,18 @@ extern void mix_voice(struct Renderer *song, float *buf, struct Voice *v, int c)
 extern int recompute_envelope(struct Voice *v);
 extern void apply_envelope_to_amp(struct Voice *v);
 
+/*
+mix_sse2.h
+*/
+
+#if defined(__amd64__) || defined(__i386__) || defined(_M_IX86) || defined(_M_X64)
+#define TIMIDITY_SSE2
+
+extern void resample_linear_sse2(sample_t *dest, const sample_t *src, int ofs, int incr, int count);
+extern void mix_stereo_sse2(const sample_t *sp, float *lp, final_volume_t left, final_volume_t right, int count);
+extern bool sse2_available();
+#endif
+
 /*
 playmidi.h
 */
@@ -628,6 +640,7 @@ struct Renderer
 	int adjust_panning_immediately;
 	int voices;
 	int lost_notes, cut_notes;
+	QWORD voice_samples;		// Total samples mixed across all voices, for benchmarking
 
 	Renderer(float sample_rate, const char *args);
 	~Renderer();
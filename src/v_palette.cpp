@@ -110,6 +110,12 @@ extern "C" BYTE BestColor_MMX (DWORD rgb, const DWORD *pal);
 
 int BestColor (const uint32 *pal_in, int r, int g, int b, int first, int num)
 {
+	// The color matcher has a lookup table for the current game palette.
+	if (first == 1 && num == 255 && pal_in == (const uint32 *)ColorMatcher.GetPalette() &&
+		(unsigned)(r | g | b) <= 255)
+	{
+		return ColorMatcher.Pick (r, g, b);
+	}
 #ifdef X86_ASM
 	if (CPU.bMMX)
 	{
@@ -36,6 +36,7 @@
 #include "i_system.h"
 #include "v_palette.h"
 #include "v_pfx.h"
+#include "x86.h"
 
 extern "C"
 {
@@ -499,6 +500,18 @@ static void Convert16 (BYTE *src, int srcpitch,
 	if (xstep == FRACUNIT && ystep == FRACUNIT)
 	{
 		srcpitch -= destwidth;
+#if defined(_M_X64) || defined(_M_IX86) || defined(__i386__) || defined(__amd64__)
+		if (CPU.bSSE2)
+		{
+			for (y = destheight; y != 0; y--)
+			{
+				ConvertPal16_SSE2 (dest, src, destwidth, GPfxPal.Pal16);
+				dest += destwidth + destpitch;
+				src += destwidth + srcpitch;
+			}
+			return;
+		}
+#endif
 		for (y = destheight; y != 0; y--)
 		{
 			x = destwidth;
@@ -641,6 +654,18 @@ static void Convert32 (BYTE *src, int srcpitch,
 	if (xstep == FRACUNIT && ystep == FRACUNIT)
 	{
 		srcpitch -= destwidth;
+#if defined(_M_X64) || defined(_M_IX86) || defined(__i386__) || defined(__amd64__)
+		if (CPU.bSSE2)
+		{
+			for (y = destheight; y != 0; y--)
+			{
+				ConvertPal32_SSE2 (dest, src, destwidth, GPfxPal.Pal32);
+				dest += destwidth + destpitch;
+				src += destwidth + srcpitch;
+			}
+			return;
+		}
+#endif
 		for (y = destheight; y != 0; y--)
 		{
 			for (savedx = x = destwidth, x >>= 3; x != 0; x--)
@@ -0,0 +1,530 @@
+/*
+** w_dirwatch.cpp
+** Reloads loose files of directory resources when they change on disk
+**
+**---------------------------------------------------------------------------
+** Copyright 2016 The ZDoom Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** Files loaded from directory resources are watched with inotify where it
+** is available, or by polling their modification times elsewhere. When
+** a file has been quiet for a moment after changing, its lump is updated
+** in place and the caches built from it are dropped: textures are
+** unloaded (or replaced if their size changed) and sounds are stopped
+** and unloaded, so both are read again the next time they are used.
+** Data that is parsed once at startup, like DECORATE or MAPINFO, and
+** files added to or removed from the directory still need a restart.
+*/
+
+// HEADER FILES ------------------------------------------------------------
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "doomtype.h"
+#include "w_dirwatch.h"
+#include "w_wad.h"
+#include "textures/textures.h"
+#include "s_sound.h"
+#include "i_system.h"
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "stats.h"
+
+// MACROS ------------------------------------------------------------------
+
+// How long a file has to be left alone before it is reloaded, so that
+// editors that write in several steps are done with it.
+#define SETTLE_TIME		250
+
+// How often files are checked when there is no change notification.
+#define POLL_INTERVAL	1000
+
+// How long to keep trying to reload a lump that is in use.
+#define BUSY_TIMEOUT	5000
+
+#define MAX_RECORDS		256
+
+// TYPES -------------------------------------------------------------------
+
+struct FWatchedFile
+{
+	int LumpNum;
+	FString Path;
+	time_t MTime;
+	off_t Size;			// -1 once the file has been removed
+	unsigned int BusySince;	// when reloading first failed because the lump was in use, or 0
+	bool Pending;
+};
+
+struct FReloadRecord
+{
+	FString Name;
+	const char *What;
+	double MS;
+	unsigned int Time;
+};
+
+// PRIVATE DATA DEFINITIONS ------------------------------------------------
+
+static TArray<FWatchedFile> Watched;
+static TMap<FString, int> WatchedPaths;
+static TArray<FReloadRecord> Records;
+static unsigned int LastChange, LastPoll;
+static int NumPending;
+static int NumDirs;
+static bool Started;
+
+#ifdef __linux__
+static int NotifyFD = -1;
+static TMap<int, FString> WatchDirs;
+static TMap<FString, bool> Announced;
+#endif
+
+// PUBLIC DATA DEFINITIONS -------------------------------------------------
+
+// Off by default: without inotify, every watched file is polled once a
+// second, which only mod authors need.
+CUSTOM_CVAR (Bool, wad_watchdirs, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+{
+	if (!self)
+	{
+		W_StopWatching();
+	}
+	else if (Started)
+	{
+		W_WatchDirectories();
+	}
+}
+
+// CODE --------------------------------------------------------------------
+
+//==========================================================================
+//
+// W_StopWatching
+//
+//==========================================================================
+
+void W_StopWatching()
+{
+#ifdef __linux__
+	if (NotifyFD >= 0)
+	{
+		close(NotifyFD);	// this drops all the watches as well
+		NotifyFD = -1;
+	}
+	WatchDirs.Clear();
+	Announced.Clear();
+#endif
+	Watched.Clear();
+	WatchedPaths.Clear();
+	NumPending = 0;
+	NumDirs = 0;
+}
+
+//==========================================================================
+//
+// W_WatchDirectories
+//
+//==========================================================================
+
+void W_WatchDirectories()
+{
+	TMap<FString, bool> dirs;
+
+	Started = true;
+	W_StopWatching();
+	if (!wad_watchdirs)
+	{
+		return;
+	}
+
+	for (int i = 0; i < Wads.GetNumLumps(); i++)
+	{
+		const char *path = Wads.GetLumpDiskPath(i);
+		struct stat info;
+
+		if (path == NULL || stat(path, &info) != 0)
+		{
+			continue;
+		}
+
+		FWatchedFile &file = Watched[Watched.Reserve(1)];
+		file.LumpNum = i;
+		file.Path = path;
+		file.MTime = info.st_mtime;
+		file.Size = info.st_size;
+		file.BusySince = 0;
+		file.Pending = false;
+		WatchedPaths[file.Path] = Watched.Size() - 1;
+
+		const char *slash = strrchr(path, '/');
+		if (slash != NULL)
+		{
+			dirs[FString(path, slash - path + 1)] = true;
+		}
+	}
+	if (Watched.Size() == 0)
+	{
+		return;
+	}
+	NumDirs = dirs.CountUsed();
+
+#ifdef __linux__
+	NotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (NotifyFD < 0)
+	{
+		Printf("Could not watch directories for changes: %s\n", strerror(errno));
+		return;
+	}
+
+	TMap<FString, bool>::Iterator it(dirs);
+	TMap<FString, bool>::Pair *pair;
+	while (it.NextPair(pair))
+	{
+		int wd = inotify_add_watch(NotifyFD, pair->Key, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+		if (wd < 0)
+		{
+			// Probably out of watches. Fall back to polling everything.
+			Printf("Could not watch %s: %s\n", pair->Key.GetChars(), strerror(errno));
+			close(NotifyFD);
+			NotifyFD = -1;
+			WatchDirs.Clear();
+			break;
+		}
+		WatchDirs[wd] = pair->Key;
+	}
+#endif
+	LastPoll = I_MSTime();
+	DPrintf("Watching %u files in %d directories for changes\n", Watched.Size(), NumDirs);
+}
+
+//==========================================================================
+//
+// MarkChanged
+//
+//==========================================================================
+
+static void MarkChanged(FWatchedFile &file)
+{
+	if (!file.Pending)
+	{
+		file.Pending = true;
+		NumPending++;
+	}
+	LastChange = I_MSTime();
+}
+
+//==========================================================================
+//
+// ReadNotifications
+//
+//==========================================================================
+
+#ifdef __linux__
+static void ReadNotifications()
+{
+	// Aligned for struct inotify_event
+	long buffer[1024];
+	ssize_t len;
+
+	while ((len = read(NotifyFD, buffer, sizeof(buffer))) > 0)
+	{
+		const char *p = (const char *)buffer;
+		const char *end = p + len;
+
+		while (p < end)
+		{
+			const struct inotify_event *ev = (const struct inotify_event *)p;
+			p += sizeof(struct inotify_event) + ev->len;
+
+			FString *dir = WatchDirs.CheckKey(ev->wd);
+			if (dir == NULL || ev->len == 0 || (ev->mask & IN_ISDIR))
+			{
+				continue;
+			}
+			FString path = *dir + ev->name;
+			int *index = WatchedPaths.CheckKey(path);
+
+			if (index != NULL)
+			{
+				MarkChanged(Watched[*index]);
+			}
+			else if ((ev->mask & (IN_CREATE | IN_MOVED_TO)) && ev->name[0] != '.' &&
+				ev->name[strlen(ev->name) - 1] != '~' && !strstr(ev->name, ".orig") && !strstr(ev->name, ".bak") &&
+				Announced.CheckKey(path) == NULL)
+			{
+				Announced[path] = true;
+				Printf("New file %s will only be loaded after a restart.\n", path.GetChars());
+			}
+		}
+	}
+}
+#endif
+
+//==========================================================================
+//
+// PollFiles
+//
+// Used where there is no change notification.
+//
+//==========================================================================
+
+static void PollFiles()
+{
+	for (unsigned i = 0; i < Watched.Size(); i++)
+	{
+		FWatchedFile &file = Watched[i];
+		struct stat info;
+
+		if (stat(file.Path, &info) != 0)
+		{
+			if (file.Size >= 0)
+			{
+				MarkChanged(file);
+			}
+		}
+		else if (info.st_mtime != file.MTime || info.st_size != file.Size)
+		{
+			MarkChanged(file);
+		}
+	}
+}
+
+//==========================================================================
+//
+// ReloadTextures
+//
+// Returns the number of textures that were made directly from the lump.
+//
+//==========================================================================
+
+static int ReloadTextures(int lumpnum)
+{
+	int count = 0;
+
+	for (int i = 0; i < TexMan.NumTextures(); i++)
+	{
+		FTexture *tex = TexMan.ByIndex(i);
+
+		if (tex == NULL || tex->SourceLump != lumpnum)
+		{
+			continue;
+		}
+		tex->Unload();
+		tex->KillNative();
+
+		// If the header changed, the texture has to be replaced. The old one
+		// is not freed, because others may still be pointing at it.
+		FTexture *fresh = FTexture::CreateTexture(lumpnum, tex->UseType);
+		if (fresh != NULL && (fresh->GetWidth() != tex->GetWidth() || fresh->GetHeight() != tex->GetHeight() ||
+			fresh->LeftOffset != tex->LeftOffset || fresh->TopOffset != tex->TopOffset))
+		{
+			fresh->xScale = tex->xScale;
+			fresh->yScale = tex->yScale;
+			TexMan.ReplaceTexture(tex->id, fresh, false);
+		}
+		else
+		{
+			delete fresh;
+		}
+		count++;
+	}
+	if (count > 0)
+	{
+		// Composite textures may have been built from it.
+		TexMan.UnloadAll();
+	}
+	return count;
+}
+
+//==========================================================================
+//
+// ReloadFile
+//
+// Returns false if the file can't be reloaded right now.
+//
+//==========================================================================
+
+static bool ReloadFile(FWatchedFile &file)
+{
+	struct stat info;
+	const char *what;
+	cycle_t timer;
+
+	// Each change is only reported once: the new state is recorded even when
+	// the file can't be reloaded, so polling doesn't keep finding it.
+	if (stat(file.Path, &info) != 0)
+	{
+		if (file.Size >= 0)
+		{
+			Printf("%s was removed. It will stay loaded until a restart.\n", file.Path.GetChars());
+		}
+		file.MTime = 0;
+		file.Size = -1;
+		return true;
+	}
+	if (Wads.GetLumpFlags(file.LumpNum) & LUMPF_EMBEDDED)
+	{
+		Printf("%s changed. Embedded files are only reloaded by a restart.\n", file.Path.GetChars());
+		file.MTime = info.st_mtime;
+		file.Size = info.st_size;
+		return true;
+	}
+
+	timer.Reset();
+	timer.Clock();
+
+	if (!Wads.SetLumpSize(file.LumpNum, (int)info.st_size))
+	{
+		// Someone is still reading it. Try again later, but not forever.
+		unsigned int now = I_MSTime();
+		if (file.BusySince == 0)
+		{
+			file.BusySince = now;
+		}
+		if (now - file.BusySince < BUSY_TIMEOUT)
+		{
+			return false;
+		}
+		Printf("%s is in use and was not reloaded.\n", file.Path.GetChars());
+		file.BusySince = 0;
+		file.MTime = info.st_mtime;
+		file.Size = info.st_size;
+		return true;
+	}
+	file.BusySince = 0;
+	file.MTime = info.st_mtime;
+	file.Size = info.st_size;
+	if (ReloadTextures(file.LumpNum) > 0)
+	{
+		what = "texture";
+	}
+	else if (S_ReloadSoundLump(file.LumpNum) > 0)
+	{
+		what = "sound";
+	}
+	else
+	{
+		what = "data";
+	}
+
+	timer.Unclock();
+
+	if (Records.Size() == MAX_RECORDS)
+	{
+		Records.Delete(0);
+	}
+	FReloadRecord &record = Records[Records.Reserve(1)];
+	record.Name = Wads.GetLumpFullPath(file.LumpNum);
+	record.What = what;
+	record.MS = timer.TimeMS();
+	record.Time = I_MSTime();
+	Printf("Reloaded %s (%s)\n", record.Name.GetChars(), what);
+	return true;
+}
+
+//==========================================================================
+//
+// W_CheckWatchedFiles
+//
+//==========================================================================
+
+void W_CheckWatchedFiles()
+{
+	if (Watched.Size() == 0 || !wad_watchdirs)
+	{
+		return;
+	}
+
+	unsigned int now = I_MSTime();
+
+#ifdef __linux__
+	if (NotifyFD >= 0)
+	{
+		ReadNotifications();
+	}
+	else
+#endif
+	if (now - LastPoll >= POLL_INTERVAL)
+	{
+		LastPoll = now;
+		PollFiles();
+	}
+
+	if (NumPending == 0 || now - LastChange < SETTLE_TIME)
+	{
+		return;
+	}
+	for (unsigned i = 0; i < Watched.Size(); i++)
+	{
+		FWatchedFile &file = Watched[i];
+
+		if (file.Pending && ReloadFile(file))
+		{
+			file.Pending = false;
+			NumPending--;
+		}
+	}
+}
+
+//==========================================================================
+//
+// CCMD listreloaded
+//
+// Lists the files that were reloaded since startup.
+//
+//==========================================================================
+
+CCMD (listreloaded)
+{
+	double total = 0;
+	unsigned int now = I_MSTime();
+
+	for (unsigned i = 0; i < Records.Size(); i++)
+	{
+		const FReloadRecord &record = Records[i];
+
+		Printf("%6.2f ms %5us ago  %s (%s)\n", record.MS, (now - record.Time) / 1000,
+			record.Name.GetChars(), record.What);
+		total += record.MS;
+	}
+	Printf("%u files reloaded in %.2f ms, %d pending\n", Records.Size(), total, NumPending);
+#ifdef __linux__
+	if (NotifyFD >= 0)
+	{
+		Printf("Watching %u files in %d directories with inotify\n", Watched.Size(), NumDirs);
+		return;
+	}
+#endif
+	Printf("Watching %u files in %d directories by polling\n", Watched.Size(), NumDirs);
+}
@@ -0,0 +1,657 @@
+/*
+** w_hashcache.cpp
+** Threaded, cached file and lump hashing for -hashfiles
+**
+**---------------------------------------------------------------------------
+** Copyright 2016 The ZDoom Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** -hashfiles used to read and hash every file and lump one after the other
+** on the main thread. Now each file is memory mapped and its uncompressed
+** lumps are hashed straight out of the mapping by worker threads while the
+** rest of the files are being loaded. Compressed lumps and anything that
+** can't be mapped are still hashed through a FileReader on the main thread.
+**
+** The hashes for a file are kept in the cache directory, keyed on its path,
+** size and modification time, so unchanged files aren't hashed again.
+*/
+
+// HEADER FILES ------------------------------------------------------------
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define USE_WINDOWS_DWORD
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "doomtype.h"
+#include "w_hashcache.h"
+#include "files.h"
+#include "resourcefiles/resourcefile.h"
+#include "md5.h"
+#include "w_wad.h"
+#include "m_misc.h"
+#include "cmdlib.h"
+#include "templates.h"
+
+// MACROS ------------------------------------------------------------------
+
+#define HASH_CACHE_FILE		"/filehashes.txt"
+#define MAX_CACHED_FILES	256
+
+// TYPES -------------------------------------------------------------------
+
+class FMappedFile
+{
+public:
+	FMappedFile();
+	~FMappedFile();
+	bool Open(const char *filename);
+
+	const BYTE *Data;
+	size_t Size;
+
+private:
+#ifdef _WIN32
+	HANDLE File, Mapping;
+#endif
+};
+
+struct FHashedLump
+{
+	FString Name;
+	int Size;
+	bool Skip;				// embedded files are hashed on their own
+	BYTE Hash[16];
+};
+
+struct FHashedFile
+{
+	FString Name;
+	bool Directory;
+	long Length;
+	bool HaveStat;
+	long long StatSize;
+	long long MTime;
+	bool FromCache;
+	BYTE Hash[16];
+	TArray<FHashedLump> Lumps;
+	FMappedFile *Map;
+};
+
+struct FHashJob
+{
+	BYTE *Hash;
+	const BYTE *Data;
+	size_t Size;
+};
+
+struct FCachedHashes
+{
+	FString Name;
+	long long Size;
+	long long MTime;
+	BYTE Hash[16];
+	TArray<BYTE> LumpHashes;	// 16 bytes per lump; all 0xFF for skipped lumps
+	bool Replaced;
+};
+
+// PRIVATE DATA DEFINITIONS ------------------------------------------------
+
+static std::mutex HashLock;
+static std::condition_variable WorkReady;
+static std::condition_variable AllDone;
+static TArray<std::thread *> Workers;
+static bool WorkerQuit;
+
+static TArray<FHashJob> Jobs;
+static unsigned int NextJob, JobsDone;
+static TArray<FHashedFile *> HashedFiles;
+
+static TArray<FCachedHashes> HashCache;
+static bool HashCacheLoaded, HashCacheDirty;
+
+// CODE --------------------------------------------------------------------
+
+//==========================================================================
+//
+// FMappedFile
+//
+//==========================================================================
+
+FMappedFile::FMappedFile()
+{
+	Data = NULL;
+	Size = 0;
+#ifdef _WIN32
+	File = INVALID_HANDLE_VALUE;
+	Mapping = NULL;
+#endif
+}
+
+FMappedFile::~FMappedFile()
+{
+#ifdef _WIN32
+	if (Data != NULL) UnmapViewOfFile(Data);
+	if (Mapping != NULL) CloseHandle(Mapping);
+	if (File != INVALID_HANDLE_VALUE) CloseHandle(File);
+#else
+	if (Data != NULL) munmap((void *)Data, Size);
+#endif
+}
+
+bool FMappedFile::Open(const char *filename)
+{
+#ifdef _WIN32
+	LARGE_INTEGER size;
+
+	File = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (File == INVALID_HANDLE_VALUE || !GetFileSizeEx(File, &size) ||
+		size.QuadPart == 0 || (unsigned long long)size.QuadPart > (size_t)-1)
+	{
+		return false;
+	}
+	Mapping = CreateFileMapping(File, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (Mapping == NULL)
+	{
+		return false;
+	}
+	Data = (const BYTE *)MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+	Size = (size_t)size.QuadPart;
+#else
+	struct stat info;
+	int fd = open(filename, O_RDONLY);
+
+	if (fd < 0)
+	{
+		return false;
+	}
+	if (fstat(fd, &info) == 0 && info.st_size > 0)
+	{
+		void *mem = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mem != MAP_FAILED)
+		{
+			Data = (const BYTE *)mem;
+			Size = info.st_size;
+		}
+	}
+	close(fd);
+#endif
+	return Data != NULL;
+}
+
+//==========================================================================
+//
+// HashMemory
+//
+//==========================================================================
+
+static void HashMemory(const BYTE *data, size_t size, BYTE cksum[16])
+{
+	MD5Context md5;
+
+	while (size > 0)
+	{
+		unsigned int chunk = (unsigned int)MIN<size_t>(size, 1 << 30);
+		md5.Update(data, chunk);
+		data += chunk;
+		size -= chunk;
+	}
+	md5.Final(cksum);
+}
+
+//==========================================================================
+//
+// HashReader
+//
+//==========================================================================
+
+static void HashReader(FileReader *reader, long size, BYTE cksum[16])
+{
+	MD5Context md5;
+	md5.Update(reader, size);
+	md5.Final(cksum);
+}
+
+//==========================================================================
+//
+// HashThread
+//
+//==========================================================================
+
+static void HashThread()
+{
+	std::unique_lock<std::mutex> lock(HashLock);
+
+	for (;;)
+	{
+		while (NextJob >= Jobs.Size() && !WorkerQuit)
+		{
+			WorkReady.wait(lock);
+		}
+		if (NextJob >= Jobs.Size())
+		{
+			break;
+		}
+
+		FHashJob job = Jobs[NextJob++];
+		lock.unlock();
+		HashMemory(job.Data, job.Size, job.Hash);
+		lock.lock();
+
+		if (++JobsDone == Jobs.Size())
+		{
+			AllDone.notify_all();
+		}
+	}
+}
+
+//==========================================================================
+//
+// ParseHash / FormatHash
+//
+//==========================================================================
+
+static bool ParseHash(const char *text, BYTE cksum[16])
+{
+	for (int i = 0; i < 16; ++i)
+	{
+		unsigned int byte;
+		if (sscanf(text + i * 2, "%2x", &byte) != 1)
+		{
+			return false;
+		}
+		cksum[i] = BYTE(byte);
+	}
+	return true;
+}
+
+static const char *FormatHash(const BYTE cksum[16], char out[33])
+{
+	for (int i = 0; i < 16; ++i)
+	{
+		sprintf(out + i * 2, "%02X", cksum[i]);
+	}
+	return out;
+}
+
+//==========================================================================
+//
+// LoadHashCache
+//
+// The cache is a text file. Each file is a line of the form
+//
+//   F <size> <mtime> <lumps> <hash> <path>
+//
+// followed by one "L <hash>" line for each of its lumps ("L -" for lumps
+// that aren't hashed). Anything that doesn't parse ends the cache there.
+//
+//==========================================================================
+
+static void LoadHashCache()
+{
+	HashCacheLoaded = true;
+
+	FString path = M_GetCachePath(false) + HASH_CACHE_FILE;
+	FILE *f = fopen(path, "r");
+	if (f == NULL)
+	{
+		return;
+	}
+
+	char line[4096];
+	while (fgets(line, sizeof(line), f) != NULL)
+	{
+		long long size, mtime;
+		unsigned int numlumps;
+		char hash[33];
+		int pathstart;
+
+		if (sscanf(line, "F %lld %lld %u %32s %n", &size, &mtime, &numlumps, hash, &pathstart) < 4)
+		{
+			break;
+		}
+
+		FCachedHashes &entry = HashCache[HashCache.Reserve(1)];
+		entry.Name = line + pathstart;
+		entry.Name.StripRight("\r\n");
+		entry.Size = size;
+		entry.MTime = mtime;
+		entry.Replaced = false;
+
+		bool good = ParseHash(hash, entry.Hash);
+		entry.LumpHashes.Resize(numlumps * 16);
+		for (unsigned int i = 0; good && i < numlumps; ++i)
+		{
+			good = fgets(line, sizeof(line), f) != NULL && line[0] == 'L' && line[1] == ' ';
+			if (good && line[2] == '-')
+			{
+				memset(&entry.LumpHashes[i * 16], 0xFF, 16);
+			}
+			else if (good)
+			{
+				good = ParseHash(line + 2, &entry.LumpHashes[i * 16]);
+			}
+		}
+		if (!good)
+		{
+			HashCache.Pop();
+			break;
+		}
+	}
+	fclose(f);
+}
+
+//==========================================================================
+//
+// SaveHashCache
+//
+// Files hashed this time go first. Older entries follow, up to a limit.
+//
+//==========================================================================
+
+static void SaveHashCache()
+{
+	FString path = M_GetCachePath(true);
+	CreatePath(path);
+	path += HASH_CACHE_FILE;
+
+	FILE *f = fopen(path, "w");
+	if (f == NULL)
+	{
+		return;
+	}
+
+	char hash[33];
+	unsigned int written = 0;
+
+	for (unsigned i = 0; i < HashedFiles.Size() && written < MAX_CACHED_FILES; ++i)
+	{
+		FHashedFile *file = HashedFiles[i];
+		if (!file->HaveStat)
+		{
+			continue;
+		}
+		fprintf(f, "F %lld %lld %u %s %s\n", file->StatSize, file->MTime, file->Lumps.Size(),
+			FormatHash(file->Hash, hash), file->Name.GetChars());
+		for (unsigned j = 0; j < file->Lumps.Size(); ++j)
+		{
+			fprintf(f, "L %s\n", file->Lumps[j].Skip ? "-" : FormatHash(file->Lumps[j].Hash, hash));
+		}
+		written++;
+	}
+	for (unsigned i = 0; i < HashCache.Size() && written < MAX_CACHED_FILES; ++i)
+	{
+		FCachedHashes &entry = HashCache[i];
+		if (entry.Replaced)
+		{
+			continue;
+		}
+		unsigned int numlumps = entry.LumpHashes.Size() / 16;
+		fprintf(f, "F %lld %lld %u %s %s\n", entry.Size, entry.MTime, numlumps,
+			FormatHash(entry.Hash, hash), entry.Name.GetChars());
+		for (unsigned j = 0; j < numlumps; ++j)
+		{
+			static const BYTE skipped[16] = { 0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF };
+			const BYTE *lumphash = &entry.LumpHashes[j * 16];
+			fprintf(f, "L %s\n", memcmp(lumphash, skipped, 16) == 0 ? "-" : FormatHash(lumphash, hash));
+		}
+		written++;
+	}
+	fclose(f);
+}
+
+//==========================================================================
+//
+// FindCachedHashes
+//
+// Fills in all of a file's hashes from the cache if it hasn't changed.
+//
+//==========================================================================
+
+static bool FindCachedHashes(FHashedFile *file)
+{
+	for (unsigned i = 0; i < HashCache.Size(); ++i)
+	{
+		FCachedHashes &entry = HashCache[i];
+		if (entry.Name.Compare(file->Name) != 0)
+		{
+			continue;
+		}
+
+		// Whatever happens, this file's entry will be rewritten.
+		entry.Replaced = true;
+		if (entry.Size != file->StatSize || entry.MTime != file->MTime ||
+			entry.LumpHashes.Size() != file->Lumps.Size() * 16)
+		{
+			return false;
+		}
+		memcpy(file->Hash, entry.Hash, 16);
+		for (unsigned j = 0; j < file->Lumps.Size(); ++j)
+		{
+			memcpy(file->Lumps[j].Hash, &entry.LumpHashes[j * 16], 16);
+		}
+		return true;
+	}
+	return false;
+}
+
+//==========================================================================
+//
+// W_HashResourceFile
+//
+//==========================================================================
+
+void W_HashResourceFile(const char *filename, FileReader *reader, FResourceFile *resfile)
+{
+	FHashedFile *file = new FHashedFile;
+
+	file->Name = filename;
+	file->Directory = reader == NULL;
+	file->Length = reader != NULL ? reader->GetLength() : 0;
+	file->HaveStat = false;
+	file->FromCache = false;
+	file->Map = NULL;
+	file->Lumps.Resize(resfile->LumpCount());
+	for (DWORD i = 0; i < resfile->LumpCount(); ++i)
+	{
+		FResourceLump *lump = resfile->GetLump(i);
+		FHashedLump &hashed = file->Lumps[i];
+
+		hashed.Name = lump->FullName.IsNotEmpty() ? lump->FullName : FString(lump->Name);
+		hashed.Size = lump->LumpSize;
+		hashed.Skip = !!(lump->Flags & LUMPF_EMBEDDED);
+	}
+	HashedFiles.Push(file);
+
+	// Embedded files and directories can't be found again by name, so only
+	// files that are really on disk are mapped or cached.
+	struct stat info;
+	if (reader != NULL && stat(filename, &info) == 0 && !(info.st_mode & S_IFDIR) && info.st_size == file->Length)
+	{
+		file->HaveStat = true;
+		file->StatSize = info.st_size;
+		file->MTime = info.st_mtime;
+
+		if (!HashCacheLoaded)
+		{
+			LoadHashCache();
+		}
+		if (FindCachedHashes(file))
+		{
+			file->FromCache = true;
+			return;
+		}
+		HashCacheDirty = true;
+
+		file->Map = new FMappedFile;
+		if (!file->Map->Open(filename) || file->Map->Size != (size_t)file->Length)
+		{
+			delete file->Map;
+			file->Map = NULL;
+		}
+	}
+
+	TArray<FHashJob> jobs;
+	FHashJob job;
+
+	if (file->Map != NULL)
+	{
+		job.Hash = file->Hash;
+		job.Data = file->Map->Data;
+		job.Size = file->Map->Size;
+		jobs.Push(job);
+	}
+	else if (reader != NULL)
+	{
+		reader->Seek(0, SEEK_SET);
+		HashReader(reader, file->Length, file->Hash);
+	}
+
+	for (DWORD i = 0; i < resfile->LumpCount(); ++i)
+	{
+		FResourceLump *lump = resfile->GetLump(i);
+		FHashedLump &hashed = file->Lumps[i];
+
+		if (hashed.Skip)
+		{
+			continue;
+		}
+
+		// Compressed lumps have no file offset and go through their reader.
+		int offset = file->Map != NULL ? lump->GetFileOffset() : -1;
+		if (offset >= 0 && (size_t)offset + hashed.Size <= file->Map->Size)
+		{
+			job.Hash = hashed.Hash;
+			job.Data = file->Map->Data + offset;
+			job.Size = hashed.Size;
+			jobs.Push(job);
+		}
+		else
+		{
+			FileReader *lumpreader = lump->NewReader();
+			HashReader(lumpreader, hashed.Size, hashed.Hash);
+			delete lumpreader;
+		}
+	}
+
+	if (jobs.Size() > 0)
+	{
+		std::lock_guard<std::mutex> lock(HashLock);
+
+		for (unsigned i = 0; i < jobs.Size(); ++i)
+		{
+			Jobs.Push(jobs[i]);
+		}
+		if (Workers.Size() == 0)
+		{
+			int numthreads = clamp<int>(int(std::thread::hardware_concurrency()) - 1, 1, 8);
+			WorkerQuit = false;
+			for (int i = 0; i < numthreads; ++i)
+			{
+				Workers.Push(new std::thread(HashThread));
+			}
+		}
+		WorkReady.notify_all();
+	}
+}
+
+//==========================================================================
+//
+// W_FinishHashing
+//
+//==========================================================================
+
+void W_FinishHashing(FILE *out)
+{
+	{
+		std::unique_lock<std::mutex> lock(HashLock);
+		while (JobsDone < Jobs.Size())
+		{
+			AllDone.wait(lock);
+		}
+		WorkerQuit = true;
+	}
+	WorkReady.notify_all();
+	for (unsigned i = 0; i < Workers.Size(); ++i)
+	{
+		Workers[i]->join();
+		delete Workers[i];
+	}
+	Workers.Clear();
+	Jobs.Clear();
+	NextJob = JobsDone = 0;
+
+	char hash[33];
+	for (unsigned i = 0; i < HashedFiles.Size(); ++i)
+	{
+		FHashedFile *file = HashedFiles[i];
+
+		if (!file->Directory)
+		{
+			fprintf(out, "file: %s, hash: %s, size: %ld\n", file->Name.GetChars(), FormatHash(file->Hash, hash), file->Length);
+		}
+		else
+		{
+			fprintf(out, "file: %s, Directory structure\n", file->Name.GetChars());
+		}
+		for (unsigned j = 0; j < file->Lumps.Size(); ++j)
+		{
+			FHashedLump &lump = file->Lumps[j];
+			if (!lump.Skip)
+			{
+				fprintf(out, "file: %s, lump: %s, hash: %s, size: %d\n", file->Name.GetChars(),
+					lump.Name.GetChars(), FormatHash(lump.Hash, hash), lump.Size);
+			}
+		}
+	}
+
+	if (HashCacheDirty)
+	{
+		SaveHashCache();
+	}
+
+	for (unsigned i = 0; i < HashedFiles.Size(); ++i)
+	{
+		delete HashedFiles[i]->Map;
+		delete HashedFiles[i];
+	}
+	HashedFiles.Clear();
+	HashCache.Clear();
+	HashCacheLoaded = HashCacheDirty = false;
+}
@@ -57,6 +57,8 @@
 #include "resourcefiles/resourcefile.h"
 #include "md5.h"
 #include "doomstat.h"
+#include "d_startupprof.h"
+#include "w_hashcache.h"
 
 // MACROS ------------------------------------------------------------------
 
@@ -182,6 +184,10 @@ void FWadCollection::InitMultipleFiles (TArray<FString> &filenames)
 	{
 		I_FatalError ("W_InitMultipleFiles: no files found");
 	}
+	if (hashfile)
+	{
+		W_FinishHashing(hashfile);
+	}
 	RenameNerve();
 	RenameSprites();
 	FixMacHexen();
@@ -300,54 +306,7 @@ void FWadCollection::AddFile (const char *filename, FileReader *wadinfo)
 
 		if (hashfile)
 		{
-			BYTE cksum[16];
-			char cksumout[33];
-			memset(cksumout, 0, sizeof(cksumout));
-
-			FileReader *reader = wadinfo;
-
-			if (reader != NULL)
-			{
-				MD5Context md5;
-				reader->Seek(0, SEEK_SET);
-				md5.Update(reader, reader->GetLength());
-				md5.Final(cksum);
-
-				for (size_t j = 0; j < sizeof(cksum); ++j)
-				{
-					sprintf(cksumout + (j * 2), "%02X", cksum[j]);
-				}
-
-				fprintf(hashfile, "file: %s, hash: %s, size: %ld\n", filename, cksumout, reader->GetLength());
-			}
-
-			else
-				fprintf(hashfile, "file: %s, Directory structure\n", filename);
-
-			for (DWORD i = 0; i < resfile->LumpCount(); i++)
-			{
-				FResourceLump *lump = resfile->GetLump(i);
-
-				if (!(lump->Flags & LUMPF_EMBEDDED))
-				{
-					reader = lump->NewReader();
-
-					MD5Context md5;
-					md5.Update(reader, lump->LumpSize);
-					md5.Final(cksum);
-
-					for (size_t j = 0; j < sizeof(cksum); ++j)
-					{
-						sprintf(cksumout + (j * 2), "%02X", cksum[j]);
-					}
-
-					fprintf(hashfile, "file: %s, lump: %s, hash: %s, size: %d\n", filename,
-						lump->FullName.IsNotEmpty() ? lump->FullName.GetChars() : lump->Name,
-						cksumout, lump->LumpSize);
-
-					delete reader;
-				}
-			}
+			W_HashResourceFile(filename, wadinfo, resfile);
 		}
 		return;
 	}
@@ -559,22 +518,122 @@ int FWadCollection::CheckNumForFullName (const char *name, bool trynormal, int n
 
 int FWadCollection::CheckNumForFullName (const char *name, int wadnum)
 {
-	DWORD i;
+	int i;
 
 	if (wadnum < 0)
 	{
 		return CheckNumForFullName (name);
 	}
+	if ((unsigned)wadnum >= Files.Size() || name == NULL)
+	{
+		return -1;
+	}
 
-	i = FirstLumpIndex_FullName[MakeKey (name) % NumLumps];
+	// Look in the file's own directory instead of walking a hash chain
+	// shared by every file that has a lump of this name.
+	i = Files[wadnum]->GetIndex().FindFullName(name);
+	return i >= 0 ? (int)Files[wadnum]->GetFirstLump() + i : -1;
+}
 
-	while (i != NULL_INDEX && 
-		(stricmp(name, LumpInfo[i].lump->FullName) || LumpInfo[i].wadnum != wadnum))
+//==========================================================================
+//
+// GetNamespaceLumps
+//
+// Appends the numbers of all lumps in the given namespace to the list, in
+// ascending order, either for one file or for all of them. Lumps flagged
+// as potential flats can be included with the namespace's own.
+//
+//==========================================================================
+
+void FWadCollection::GetNamespaceLumps (int ns, TArray<int> &lumps, int wadnum, bool maybeflats)
+{
+	unsigned first = 0, last = Files.Size();
+
+	if (wadnum >= 0)
 	{
-		i = NextLumpIndex_FullName[i];
+		if ((unsigned)wadnum >= Files.Size()) return;
+		first = wadnum, last = wadnum + 1;
 	}
+	for (unsigned w = first; w < last; w++)
+	{
+		const FResourceIndex &index = Files[w]->GetIndex();
+		int lumpbase = Files[w]->GetFirstLump();
+		unsigned start = 0, end = 0, flat = 0;
 
-	return i != NULL_INDEX ? i : -1;
+		index.FindNamespace(ns, start, end);
+		if (!maybeflats)
+		{
+			for (; start < end; start++)
+			{
+				lumps.Push(lumpbase + index.ByNamespace[start].Index);
+			}
+			continue;
+		}
+		// Both lists are sorted by lump number, so merge them.
+		while (start < end || flat < index.MaybeFlats.Size())
+		{
+			if (flat == index.MaybeFlats.Size() ||
+				(start < end && index.ByNamespace[start].Index < index.MaybeFlats[flat]))
+			{
+				lumps.Push(lumpbase + index.ByNamespace[start++].Index);
+			}
+			else
+			{
+				lumps.Push(lumpbase + index.MaybeFlats[flat++]);
+			}
+		}
+	}
+}
+
+//==========================================================================
+//
+// GetLumpsByPrefix
+//
+// Appends the lumps of one file whose full name starts with the given
+// path, sorted by name.
+//
+//==========================================================================
+
+void FWadCollection::GetLumpsByPrefix (const char *prefix, TArray<int> &lumps, int wadnum)
+{
+	if ((unsigned)wadnum >= Files.Size()) return;
+
+	const FResourceIndex &index = Files[wadnum]->GetIndex();
+	int lumpbase = Files[wadnum]->GetFirstLump();
+	unsigned start, end;
+
+	if (index.FindPrefix(prefix, start, end))
+	{
+		for (; start < end; start++)
+		{
+			lumps.Push(lumpbase + index.ByName[start].Index);
+		}
+	}
+}
+
+//==========================================================================
+//
+// GetLumpsByExtension
+//
+// Appends the lumps of one file with the given extension, sorted by name.
+//
+//==========================================================================
+
+void FWadCollection::GetLumpsByExtension (const char *ext, TArray<int> &lumps, int wadnum)
+{
+	if ((unsigned)wadnum >= Files.Size()) return;
+
+	const FResourceIndex &index = Files[wadnum]->GetIndex();
+	int lumpbase = Files[wadnum]->GetFirstLump();
+	unsigned start, end;
+
+	if (index.FindExtension(ext, start, end))
+	{
+		for (; start < end; start++)
+		{
+			lumps.Push(lumpbase + index.ByExtension[start].Index);
+		}
+	}
 }
 
 //==========================================================================
@@ -681,6 +740,54 @@ int FWadCollection::GetLumpFlags (int lump)
 	return LumpInfo[lump].lump->Flags;
 }
 
+//==========================================================================
+//
+// GetLumpDiskPath
+//
+// Returns the path of a lump that is a file of its own, or NULL.
+//
+//==========================================================================
+
+const char *FWadCollection::GetLumpDiskPath (int lump) const
+{
+	if ((size_t)lump >= NumLumps)
+	{
+		return NULL;
+	}
+
+	return LumpInfo[lump].lump->GetDiskPath();
+}
+
+//==========================================================================
+//
+// SetLumpSize
+//
+// For lumps whose file changed on disk. Fails while the lump's data is
+// cached for someone reading it.
+//
+//==========================================================================
+
+bool FWadCollection::SetLumpSize (int lump, int size)
+{
+	if ((size_t)lump >= NumLumps)
+	{
+		return false;
+	}
+
+	FResourceLump *reslump = LumpInfo[lump].lump;
+	if (reslump->Cache != NULL)
+	{
+		if (reslump->RefCount > 0)
+		{
+			return false;
+		}
+		delete[] reslump->Cache;
+		reslump->Cache = NULL;
+	}
+	reslump->LumpSize = size;
+	return true;
+}
+
 //==========================================================================
 //
 // W_LumpNameHash
@@ -828,65 +935,66 @@ void FWadCollection::RenameSprites ()
 	}
 
 
-	for (DWORD i=0; i< LumpInfo.Size(); i++)
+	TArray<int> sprites;
+	GetNamespaceLumps(ns_sprites, sprites);
+
+	for (unsigned k = 0; k < sprites.Size(); k++)
 	{
+		int i = sprites[k];
+
 		// check for full Minotaur animations. If this is not found
 		// some frames need to be renamed.
-		if (LumpInfo[i].lump->Namespace == ns_sprites)
+		if (LumpInfo[i].lump->dwName == MAKE_ID('M', 'N', 'T', 'R') && LumpInfo[i].lump->Name[4] == 'Z' )
 		{
-			if (LumpInfo[i].lump->dwName == MAKE_ID('M', 'N', 'T', 'R') && LumpInfo[i].lump->Name[4] == 'Z' )
-			{
-				MNTRZfound = true;
-				break;
-			}
+			MNTRZfound = true;
+			break;
 		}
 	}
 
 	renameAll = !!Args->CheckParm ("-oldsprites") || nospriterename;
 	
-	for (DWORD i = 0; i < LumpInfo.Size(); i++)
+	for (unsigned k = 0; k < sprites.Size(); k++)
 	{
-		if (LumpInfo[i].lump->Namespace == ns_sprites)
+		int i = sprites[k];
+
+		// Only sprites in the IWAD normally get renamed
+		if (renameAll || LumpInfo[i].wadnum == IWAD_FILENUM)
 		{
-			// Only sprites in the IWAD normally get renamed
-			if (renameAll || LumpInfo[i].wadnum == IWAD_FILENUM)
+			for (int j = 0; j < numrenames; ++j)
 			{
-				for (int j = 0; j < numrenames; ++j)
+				if (LumpInfo[i].lump->dwName == renames[j*2])
 				{
-					if (LumpInfo[i].lump->dwName == renames[j*2])
-					{
-						LumpInfo[i].lump->dwName = renames[j*2+1];
-					}
+					LumpInfo[i].lump->dwName = renames[j*2+1];
 				}
-				if (gameinfo.gametype == GAME_Hexen)
+			}
+			if (gameinfo.gametype == GAME_Hexen)
+			{
+				if (CheckLumpName (i, "ARTIINVU"))
 				{
-					if (CheckLumpName (i, "ARTIINVU"))
-					{
-						LumpInfo[i].lump->Name[4]='D'; LumpInfo[i].lump->Name[5]='E';
-						LumpInfo[i].lump->Name[6]='F'; LumpInfo[i].lump->Name[7]='N';
-					}
+					LumpInfo[i].lump->Name[4]='D'; LumpInfo[i].lump->Name[5]='E';
+					LumpInfo[i].lump->Name[6]='F'; LumpInfo[i].lump->Name[7]='N';
 				}
 			}
+		}
 
-			if (!MNTRZfound)
+		if (!MNTRZfound)
+		{
+			if (LumpInfo[i].lump->dwName == MAKE_ID('M', 'N', 'T', 'R'))
 			{
-				if (LumpInfo[i].lump->dwName == MAKE_ID('M', 'N', 'T', 'R'))
+				if (LumpInfo[i].lump->Name[4] >= 'F' && LumpInfo[i].lump->Name[4] <= 'K')
 				{
-					if (LumpInfo[i].lump->Name[4] >= 'F' && LumpInfo[i].lump->Name[4] <= 'K')
-					{
-						LumpInfo[i].lump->Name[4] += 'U' - 'F';
-					}
+					LumpInfo[i].lump->Name[4] += 'U' - 'F';
 				}
 			}
-			
-			// When not playing Doom rename all BLOD sprites to BLUD so that
-			// the same blood states can be used everywhere
-			if (!(gameinfo.gametype & GAME_DoomChex))
+		}
+		
+		// When not playing Doom rename all BLOD sprites to BLUD so that
+		// the same blood states can be used everywhere
+		if (!(gameinfo.gametype & GAME_DoomChex))
+		{
+			if (LumpInfo[i].lump->dwName == MAKE_ID('B', 'L', 'O', 'D'))
 			{
-				if (LumpInfo[i].lump->dwName == MAKE_ID('B', 'L', 'O', 'D'))
-				{
-					LumpInfo[i].lump->dwName = MAKE_ID('B', 'L', 'U', 'D');
-				}
+				LumpInfo[i].lump->dwName = MAKE_ID('B', 'L', 'U', 'D');
 			}
 		}
 	}
@@ -1286,6 +1394,7 @@ FWadLump FWadCollection::OpenLumpNum (int lump)
 		I_Error ("W_OpenLumpNum: %u >= NumLumps", lump);
 	}
 
+	D_StartupLumpOpened(lump, LumpInfo[lump].lump->LumpSize);
 	return FWadLump(LumpInfo[lump].lump);
 }
 
@@ -1306,6 +1415,7 @@ FWadLump *FWadCollection::ReopenLumpNum (int lump)
 		I_Error ("W_ReopenLumpNum: %u >= NumLumps", lump);
 	}
 
+	D_StartupLumpOpened(lump, LumpInfo[lump].lump->LumpSize);
 	return new FWadLump(LumpInfo[lump].lump, true);
 }
 
@@ -1316,6 +1426,7 @@ FWadLump *FWadCollection::ReopenLumpNumNewFile (int lump)
 		return NULL;
 	}
 
+	D_StartupLumpOpened(lump, LumpInfo[lump].lump->LumpSize);
 	return new FWadLump(lump, LumpInfo[lump].lump);
 }
 
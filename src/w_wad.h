@@ -181,6 +181,10 @@ public:
 	inline int CheckNumForFullName (const FString &name, int wadfile) { return CheckNumForFullName(name.GetChars(), wadfile); }
 	inline int GetNumForFullName (const FString &name) { return GetNumForFullName(name.GetChars()); }
 
+	void GetNamespaceLumps (int ns, TArray<int> &lumps, int wadnum = -1, bool maybeflats = false);
+	void GetLumpsByPrefix (const char *prefix, TArray<int> &lumps, int wadnum);
+	void GetLumpsByExtension (const char *ext, TArray<int> &lumps, int wadnum);
+
 	void SetLinkedTexture(int lump, FTexture *tex);
 	FTexture *GetLinkedTexture(int lump);
 
@@ -205,6 +209,8 @@ public:
 	int LumpLength (int lump) const;
 	int GetLumpOffset (int lump);					// [RH] Returns offset of lump in the wadfile
 	int GetLumpFlags (int lump);					// Return the flags for this lump
+	const char *GetLumpDiskPath (int lump) const;	// Returns the file a loose lump was read from
+	bool SetLumpSize (int lump, int size);			// Updates a loose lump that changed on disk
 	void GetLumpName (char *to, int lump) const;	// [RH] Copies the lump name to to using uppercopy
 	void GetLumpName (FString &to, int lump) const;
 	const char *GetLumpFullName (int lump) const;	// [RH] Returns the lump's full name
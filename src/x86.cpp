@@ -365,4 +365,198 @@ void DoBlending_SSE2(const PalEntry *from, PalEntry *to, int count, int r, int g
 		}
 	}
 }
+
+//==========================================================================
+//
+// SoftMixMono_SSE2
+//
+// Adds count mono samples to an interleaved stereo buffer, ramping the
+// left and right gains linearly by dl and dr per sample.
+//
+//==========================================================================
+
+void SoftMixMono_SSE2(float *out, const float *in, int count, float gl, float gr, float dl, float dr)
+{
+	__m128 gain = _mm_setr_ps(gl, gr, gl + dl, gr + dr);
+	__m128 step = _mm_setr_ps(dl*2, dr*2, dl*2, dr*2);
+
+	for (; count >= 2; count -= 2)
+	{
+		__m128 samp = _mm_castpd_ps(_mm_load_sd((const double *)in));
+		samp = _mm_unpacklo_ps(samp, samp);			// s0 s0 s1 s1
+		_mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_mul_ps(samp, gain)));
+		gain = _mm_add_ps(gain, step);
+		in += 2;
+		out += 4;
+	}
+	if (count > 0)
+	{
+		float g[4];
+		_mm_storeu_ps(g, gain);
+		out[0] += in[0] * g[0];
+		out[1] += in[0] * g[1];
+	}
+}
+
+//==========================================================================
+//
+// SoftMixStereo_SSE2
+//
+// Like SoftMixMono_SSE2, but the input is interleaved stereo as well.
+//
+//==========================================================================
+
+void SoftMixStereo_SSE2(float *out, const float *in, int count, float gl, float gr, float dl, float dr)
+{
+	__m128 gain = _mm_setr_ps(gl, gr, gl + dl, gr + dr);
+	__m128 step = _mm_setr_ps(dl*2, dr*2, dl*2, dr*2);
+
+	for (; count >= 2; count -= 2)
+	{
+		_mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_mul_ps(_mm_loadu_ps(in), gain)));
+		gain = _mm_add_ps(gain, step);
+		in += 4;
+		out += 4;
+	}
+	if (count > 0)
+	{
+		float g[4];
+		_mm_storeu_ps(g, gain);
+		out[0] += in[0] * g[0];
+		out[1] += in[1] * g[1];
+	}
+}
+
+//==========================================================================
+//
+// ConvertPal16_SSE2
+//
+// Expands a row of count 8-bit pixels through a 16-bit palette. Once the
+// destination is aligned, eight pixels are written per store, bypassing
+// the cache: the frame is much larger than the cache and is only read
+// again when it is handed to the video driver.
+//
+//==========================================================================
+
+void ConvertPal16_SSE2(WORD *dest, const BYTE *src, int count, const WORD *palette)
+{
+	for (; ((size_t)dest & 15) && count > 0; --count)
+	{
+		*dest++ = palette[*src++];
+	}
+	for (; count >= 8; count -= 8)
+	{
+		_mm_stream_si128((__m128i *)dest, _mm_setr_epi16(
+			palette[src[0]], palette[src[1]], palette[src[2]], palette[src[3]],
+			palette[src[4]], palette[src[5]], palette[src[6]], palette[src[7]]));
+		dest += 8;
+		src += 8;
+	}
+	for (; count > 0; --count)
+	{
+		*dest++ = palette[*src++];
+	}
+	_mm_sfence();
+}
+
+//==========================================================================
+//
+// ConvertPal32_SSE2
+//
+// Like ConvertPal16_SSE2, but with a 32-bit palette and four pixels per
+// store.
+//
+//==========================================================================
+
+void ConvertPal32_SSE2(DWORD *dest, const BYTE *src, int count, const DWORD *palette)
+{
+	for (; ((size_t)dest & 15) && count > 0; --count)
+	{
+		*dest++ = palette[*src++];
+	}
+	for (; count >= 8; count -= 8)
+	{
+		_mm_stream_si128((__m128i *)dest, _mm_setr_epi32(
+			palette[src[0]], palette[src[1]], palette[src[2]], palette[src[3]]));
+		_mm_stream_si128((__m128i *)dest + 1, _mm_setr_epi32(
+			palette[src[4]], palette[src[5]], palette[src[6]], palette[src[7]]));
+		dest += 8;
+		src += 8;
+	}
+	for (; count > 0; --count)
+	{
+		*dest++ = palette[*src++];
+	}
+	_mm_sfence();
+}
+
+//==========================================================================
+//
+// ParticleFade_SSE2
+//
+// Fades and ages sixteen particles at a time. A particle has expired when
+// its alpha wraps around or its lifetime runs out, and gets a nonzero
+// byte in expired.
+//
+//==========================================================================
+
+void ParticleFade_SSE2(BYTE *trans, const BYTE *fade, BYTE *ttl, BYTE *expired, int count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i ones = _mm_set1_epi8(-1);
+
+	for (; count >= 16; count -= 16)
+	{
+		__m128i t = _mm_loadu_si128((__m128i *)trans);
+		__m128i f = _mm_loadu_si128((const __m128i *)fade);
+		__m128i l = _mm_add_epi8(_mm_loadu_si128((__m128i *)ttl), ones);
+
+		// The fade wraps exactly when it is larger than what is left.
+		__m128i kept = _mm_cmpeq_epi8(_mm_subs_epu8(f, t), zero);
+		__m128i dead = _mm_or_si128(_mm_xor_si128(kept, ones), _mm_cmpeq_epi8(l, zero));
+
+		_mm_storeu_si128((__m128i *)trans, _mm_sub_epi8(t, f));
+		_mm_storeu_si128((__m128i *)ttl, l);
+		_mm_storeu_si128((__m128i *)expired, dead);
+		trans += 16;
+		fade += 16;
+		ttl += 16;
+		expired += 16;
+	}
+	for (; count > 0; --count)
+	{
+		BYTE oldtrans = *trans;
+		*trans -= *fade++;
+		*expired++ = (oldtrans < *trans || --*ttl == 0);
+		trans++;
+		ttl++;
+	}
+}
+
+//==========================================================================
+//
+// ParticleIntegrate_SSE2
+//
+// Moves particles along one axis: pos += vel, then vel += acc.
+//
+//==========================================================================
+
+void ParticleIntegrate_SSE2(fixed_t *pos, fixed_t *vel, const fixed_t *acc, int count)
+{
+	for (; count >= 4; count -= 4)
+	{
+		__m128i v = _mm_loadu_si128((__m128i *)vel);
+		_mm_storeu_si128((__m128i *)pos, _mm_add_epi32(_mm_loadu_si128((__m128i *)pos), v));
+		_mm_storeu_si128((__m128i *)vel, _mm_add_epi32(v, _mm_loadu_si128((const __m128i *)acc)));
+		pos += 4;
+		vel += 4;
+		acc += 4;
+	}
+	for (; count > 0; --count)
+	{
+		*pos++ += *vel;
+		*vel++ += *acc++;
+	}
+}
+
 #endif
@@ -106,6 +106,12 @@ struct PalEntry;
 void CheckCPUID (CPUInfo *cpu);
 void DumpCPUInfo (const CPUInfo *cpu);
 void DoBlending_SSE2(const PalEntry *from, PalEntry *to, int count, int r, int g, int b, int a);
+void SoftMixMono_SSE2(float *out, const float *in, int count, float gl, float gr, float dl, float dr);
+void SoftMixStereo_SSE2(float *out, const float *in, int count, float gl, float gr, float dl, float dr);
+void ConvertPal16_SSE2(WORD *dest, const BYTE *src, int count, const WORD *palette);
+void ConvertPal32_SSE2(DWORD *dest, const BYTE *src, int count, const DWORD *palette);
+void ParticleFade_SSE2(BYTE *trans, const BYTE *fade, BYTE *ttl, BYTE *expired, int count);
+void ParticleIntegrate_SSE2(fixed_t *pos, fixed_t *vel, const fixed_t *acc, int count);
 
 #endif
 